@@ -1777,9 +1777,11 @@
 		[globals addObjectsFromArray:oldGlobals];
 	}
 	
-	// Next, a sorted list of functions, with () appended
+	// Next, a sorted list of functions, with () appended; the function map is a hash table, so we have to do the sorting
 	if (functionMap)
 	{
+		NSMutableArray *functionNames = [NSMutableArray array];
+		
 		for (const auto& function_iter : *functionMap)
 		{
 			const EidosFunctionSignature *sig = function_iter.second.get();
@@ -1787,8 +1789,11 @@
 			
 			// Exclude internal functions such as _Test()
 			if (![functionName hasPrefix:@"_"])
-				[globals addObject:[functionName stringByAppendingString:@"()"]];
+				[functionNames addObject:[functionName stringByAppendingString:@"()"]];
 		}
+		
+		[functionNames sortUsingSelector:@selector(compare:)];
+		[globals addObjectsFromArray:functionNames];
 	}
 	
 	// Finally, provide language keywords as an option if requested
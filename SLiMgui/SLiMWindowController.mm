@@ -56,6 +56,7 @@
 #include <iostream>
 #include <sstream>
 #include <iterator>
+#include <algorithm>
 #include <stdexcept>
 
 
@@ -1753,6 +1754,9 @@
 			}
 		}
 		
+		// the function map is a hash table, so alphabetize the functions for display
+		std::sort(userDefinedFunctions.begin(), userDefinedFunctions.end(), [](const EidosFunctionSignature *l, const EidosFunctionSignature *r) { return l->call_name_ < r->call_name_; });
+		
 		if (userDefinedFunctions.size())
 		{
 			[content eidosAppendString:@"\n" attributes:menlo11_d];
@@ -3899,6 +3903,8 @@
 		return EidosSyntaxHighlightType::kHighlightAsContextKeyword;
 	if (token_string.compare("fitness") == 0)
 		return EidosSyntaxHighlightType::kHighlightAsContextKeyword;
+	if (token_string.compare("fitnessVector") == 0)
+		return EidosSyntaxHighlightType::kHighlightAsContextKeyword;
 	if (token_string.compare("mateChoice") == 0)
 		return EidosSyntaxHighlightType::kHighlightAsContextKeyword;
 	if (token_string.compare("modifyChild") == 0)
@@ -3943,6 +3949,7 @@
 	if ([clickedText isEqualToString:@"early"])			return @"Eidos events";
 	if ([clickedText isEqualToString:@"late"])			return @"Eidos events";
 	if ([clickedText isEqualToString:@"fitness"])		return @"fitness() callbacks";
+	if ([clickedText isEqualToString:@"fitnessVector"])	return @"fitness() callbacks";
 	if ([clickedText isEqualToString:@"interaction"])	return @"interaction() callbacks";
 	if ([clickedText isEqualToString:@"mateChoice"])	return @"mateChoice() callbacks";
 	if ([clickedText isEqualToString:@"modifyChild"])	return @"modifyChild() callbacks";
@@ -4142,6 +4149,7 @@
 					// decode the parts that are important to us, without the complication of making SLiMEidosBlock objects.
 					EidosASTNode *block_statement_root = nullptr;
 					SLiMEidosBlockType block_type = SLiMEidosBlockType::SLiMEidosEventEarly;
+					bool block_vectorized = false;		// true for fitnessVector() callbacks, which share their block type with fitness(NULL)
 					
 					for (EidosASTNode *block_child : script_block_node->children_)
 					{
@@ -4155,6 +4163,7 @@
 							else if (child_string.compare(gStr_late) == 0)			block_type = SLiMEidosBlockType::SLiMEidosEventLate;
 							else if (child_string.compare(gStr_initialize) == 0)	block_type = SLiMEidosBlockType::SLiMEidosInitializeCallback;
 							else if (child_string.compare(gStr_fitness) == 0)		block_type = SLiMEidosBlockType::SLiMEidosFitnessCallback;	// can't distinguish global fitness callbacks, but no need to
+							else if (child_string.compare(gStr_fitnessVector) == 0)	{ block_type = SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback; block_vectorized = true; }
 							else if (child_string.compare(gStr_interaction) == 0)	block_type = SLiMEidosBlockType::SLiMEidosInteractionCallback;
 							else if (child_string.compare(gStr_mateChoice) == 0)	block_type = SLiMEidosBlockType::SLiMEidosMateChoiceCallback;
 							else if (child_string.compare(gStr_modifyChild) == 0)	block_type = SLiMEidosBlockType::SLiMEidosModifyChildCallback;
@@ -4239,8 +4248,15 @@
 								case SLiMEidosBlockType::SLiMEidosInitializeCallback:
 									(*typeTable)->RemoveSymbolsOfClass(gSLiM_Subpopulation_Class);	// subpops defined upstream from us still do not exist for us
 									break;
-								case SLiMEidosBlockType::SLiMEidosFitnessCallback:
 								case SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback:
+									if (block_vectorized)
+									{
+										(*typeTable)->SetTypeForSymbol(gID_individuals,	EidosTypeSpecifier{kEidosValueMaskObject, gSLiM_Individual_Class});
+										(*typeTable)->SetTypeForSymbol(gID_subpop,		EidosTypeSpecifier{kEidosValueMaskObject, gSLiM_Subpopulation_Class});
+										break;
+									}
+									// else fall through to fitness(NULL) callbacks, which have the same variables as other fitness() callbacks
+								case SLiMEidosBlockType::SLiMEidosFitnessCallback:
 									(*typeTable)->SetTypeForSymbol(gID_mut,				EidosTypeSpecifier{kEidosValueMaskObject, gSLiM_Mutation_Class});
 									(*typeTable)->SetTypeForSymbol(gID_homozygous,		EidosTypeSpecifier{kEidosValueMaskLogical, nullptr});
 									(*typeTable)->SetTypeForSymbol(gID_relFitness,		EidosTypeSpecifier{kEidosValueMaskFloat, nullptr});
@@ -4367,10 +4383,10 @@
 		// have a compound statement (meaning its starting brace has not yet been typed), or if we're completing outside of any
 		// existing script block.  In these sorts of cases, we want to return completions for the outer level of a SLiM script.
 		// This means that standard Eidos language keywords like "while", "next", etc. are not legal, but SLiM script block
-		// keywords like "early", "late", "fitness", "interaction", "mateChoice", "modifyChild", "recombination", "mutation",
-		// and "reproduction" are.
+		// keywords like "early", "late", "fitness", "fitnessVector", "interaction", "mateChoice", "modifyChild", "recombination",
+		// "mutation", and "reproduction" are.
 		[keywords removeAllObjects];
-		[keywords addObjectsFromArray:@[@"initialize() {\n\n}\n", @"early() {\n\n}\n", @"late() {\n\n}\n", @"fitness() {\n\n}\n", @"interaction() {\n\n}\n", @"mateChoice() {\n\n}\n", @"modifyChild() {\n\n}\n", @"recombination() {\n\n}\n", @"mutation() {\n\n}\n", @"reproduction() {\n\n}\n", @"function (void)name(void) {\n\n}\n"]];
+		[keywords addObjectsFromArray:@[@"initialize() {\n\n}\n", @"early() {\n\n}\n", @"late() {\n\n}\n", @"fitness() {\n\n}\n", @"fitnessVector() {\n\n}\n", @"interaction() {\n\n}\n", @"mateChoice() {\n\n}\n", @"modifyChild() {\n\n}\n", @"recombination() {\n\n}\n", @"mutation() {\n\n}\n", @"reproduction() {\n\n}\n", @"function (void)name(void) {\n\n}\n"]];
 		
 		// At the outer level, functions are also not legal
 		(*functionMap)->clear();
@@ -4528,6 +4544,15 @@
 			
 			sig = callbackSig.get();
 		}
+		else if ([signatureString hasPrefix:@"fitnessVector()"])
+		{
+			static EidosCallSignature_CSP callbackSig = nullptr;
+			
+			if (!callbackSig)
+				callbackSig = EidosCallSignature_CSP((new EidosFunctionSignature("fitnessVector", nullptr, kEidosValueMaskFloat))->AddObject_OS("subpop", gSLiM_Subpopulation_Class, gStaticEidosValueNULLInvisible));
+			
+			sig = callbackSig.get();
+		}
 		else if ([signatureString hasPrefix:@"interaction()"])
 		{
 			static EidosCallSignature_CSP callbackSig = nullptr;
@@ -4998,7 +5023,7 @@
 						case SLiMEidosBlockType::SLiMEidosEventLate:				return @"late()";
 						case SLiMEidosBlockType::SLiMEidosInitializeCallback:		return @"initialize()";
 						case SLiMEidosBlockType::SLiMEidosFitnessCallback:			return @"fitness()";
-						case SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback:	return @"fitness()";
+						case SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback:	return (scriptBlock->vectorized_ ? @"fitnessVector()" : @"fitness()");
 						case SLiMEidosBlockType::SLiMEidosInteractionCallback:		return @"interaction()";
 						case SLiMEidosBlockType::SLiMEidosMateChoiceCallback:		return @"mateChoice()";
 						case SLiMEidosBlockType::SLiMEidosModifyChildCallback:		return @"modifyChild()";
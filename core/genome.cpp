@@ -553,7 +553,7 @@ EidosValue_SP Genome::GetProperty(EidosGlobalStringID p_property_id)
 			
 			return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(genome_id_));
 		}
-		case gID_genomeType:
+		case gID_genomeType:		// ACCELERATED
 		{
 			switch (genome_type_)
 			{
@@ -562,13 +562,13 @@ EidosValue_SP Genome::GetProperty(EidosGlobalStringID p_property_id)
 				case GenomeType::kYChromosome:	return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton(gStr_Y));
 			}
 		}
-		case gID_individual:
+		case gID_individual:		// ACCELERATED
 		{
 			return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Object_singleton(individual_, gSLiM_Individual_Class));
 		}
 		case gID_isNullGenome:		// ACCELERATED
 			return ((mutrun_count_ == 0) ? gStaticEidosValue_LogicalT : gStaticEidosValue_LogicalF);
-		case gID_mutations:
+		case gID_mutations:			// ACCELERATED
 		{
 			Mutation *mut_block_ptr = gSLiM_Mutation_Block;
 			int mut_count = mutation_count();
@@ -665,6 +665,79 @@ EidosValue *Genome::GetProperty_Accelerated_tag(EidosObjectElement **p_values, s
 	return int_result;
 }
 
+EidosValue *Genome::GetProperty_Accelerated_genomeType(EidosObjectElement **p_values, size_t p_values_size)
+{
+	EidosValue_String_vector *string_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_String_vector())->Reserve((int)p_values_size);
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Genome *value = (Genome *)(p_values[value_index]);
+		
+		switch (value->genome_type_)
+		{
+			case GenomeType::kAutosome:		string_result->PushString(gStr_A); break;
+			case GenomeType::kXChromosome:	string_result->PushString(gStr_X); break;
+			case GenomeType::kYChromosome:	string_result->PushString(gStr_Y); break;
+		}
+	}
+	
+	return string_result;
+}
+
+EidosValue *Genome::GetProperty_Accelerated_individual(EidosObjectElement **p_values, size_t p_values_size)
+{
+	EidosValue_Object_vector *object_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class))->resize_no_initialize(p_values_size);
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Genome *value = (Genome *)(p_values[value_index]);
+		
+		object_result->set_object_element_no_check(value->individual_, value_index);
+	}
+	
+	return object_result;
+}
+
+void Genome::GetProperty_AcceleratedElements_individual(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result)
+{
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Genome *value = (Genome *)(p_values[value_index]);
+		
+		p_result[value_index] = value->individual_;
+	}
+}
+
+EidosValue *Genome::GetProperty_Accelerated_mutations(EidosObjectElement **p_values, size_t p_values_size)
+{
+	// count the mutations first, so that the result can be allocated once and filled directly
+	size_t total_mut_count = 0;
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+		total_mut_count += ((Genome *)(p_values[value_index]))->mutation_count();
+	
+	Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+	EidosValue_Object_vector *object_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Mutation_Class))->resize_no_initialize(total_mut_count);
+	size_t set_index = 0;
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Genome *value = (Genome *)(p_values[value_index]);
+		
+		for (int run_index = 0; run_index < value->mutrun_count_; ++run_index)
+		{
+			MutationRun *mutrun = value->mutruns_[run_index].get();
+			const MutationIndex *mut_start_ptr = mutrun->begin_pointer_const();
+			const MutationIndex *mut_end_ptr = mutrun->end_pointer_const();
+			
+			for (const MutationIndex *mut_ptr = mut_start_ptr; mut_ptr < mut_end_ptr; ++mut_ptr)
+				object_result->set_object_element_no_check(mut_block_ptr + *mut_ptr, set_index++);
+		}
+	}
+	
+	return object_result;
+}
+
 void Genome::SetProperty(EidosGlobalStringID p_property_id, const EidosValue &p_value)
 {
 	switch (p_property_id)
@@ -2035,10 +2108,10 @@ const std::vector<EidosPropertySignature_CSP> *Genome_Class::Properties(void) co
 		properties = new std::vector<EidosPropertySignature_CSP>(*EidosObjectClass::Properties());
 		
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genomePedigreeID,true,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Genome::GetProperty_Accelerated_genomePedigreeID));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genomeType,		true,	kEidosValueMaskString | kEidosValueMaskSingleton)));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_individual,		true,	kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Individual_Class)));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genomeType,		true,	kEidosValueMaskString | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Genome::GetProperty_Accelerated_genomeType));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_individual,		true,	kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Individual_Class))->DeclareAcceleratedGet(Genome::GetProperty_Accelerated_individual)->DeclareAcceleratedGetElements(Genome::GetProperty_AcceleratedElements_individual, 1));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_isNullGenome,	true,	kEidosValueMaskLogical | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Genome::GetProperty_Accelerated_isNullGenome));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_mutations,		true,	kEidosValueMaskObject, gSLiM_Mutation_Class)));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_mutations,		true,	kEidosValueMaskObject, gSLiM_Mutation_Class))->DeclareAcceleratedGet(Genome::GetProperty_Accelerated_mutations));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_tag,			false,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Genome::GetProperty_Accelerated_tag)->DeclareAcceleratedSet(Genome::SetProperty_Accelerated_tag));
 		
 		std::sort(properties->begin(), properties->end(), CompareEidosPropertySignatures);
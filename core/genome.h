@@ -392,6 +392,12 @@ public:
 	static EidosValue *GetProperty_Accelerated_genomePedigreeID(EidosObjectElement **p_values, size_t p_values_size);
 	static EidosValue *GetProperty_Accelerated_isNullGenome(EidosObjectElement **p_values, size_t p_values_size);
 	static EidosValue *GetProperty_Accelerated_tag(EidosObjectElement **p_values, size_t p_values_size);
+	static EidosValue *GetProperty_Accelerated_genomeType(EidosObjectElement **p_values, size_t p_values_size);
+	static EidosValue *GetProperty_Accelerated_individual(EidosObjectElement **p_values, size_t p_values_size);
+	static EidosValue *GetProperty_Accelerated_mutations(EidosObjectElement **p_values, size_t p_values_size);
+	
+	// Accelerated element getters; see Eidos_AcceleratedElementGetter
+	static void GetProperty_AcceleratedElements_individual(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result);
 	
 	// Accelerated property writing; see class EidosObjectElement for comments on this mechanism
 	static void SetProperty_Accelerated_tag(EidosObjectElement **p_values, size_t p_values_size, const EidosValue &p_source, size_t p_source_size);
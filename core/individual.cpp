@@ -167,7 +167,7 @@ EidosValue_SP Individual::GetProperty(EidosGlobalStringID p_property_id)
 		{
 			return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(index_));
 		}
-		case gID_genomes:
+		case gID_genomes:			// ACCELERATED
 		{
 			EidosValue_Object_vector *vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Genome_Class))->resize_no_initialize(2);
 			
@@ -184,7 +184,7 @@ EidosValue_SP Individual::GetProperty(EidosGlobalStringID p_property_id)
 		{
 			return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Object_singleton(genome2_, gSLiM_Genome_Class));
 		}
-		case gID_sex:
+		case gID_sex:				// ACCELERATED
 		{
 			static EidosValue_SP static_sex_string_H;
 			static EidosValue_SP static_sex_string_F;
@@ -223,7 +223,7 @@ EidosValue_SP Individual::GetProperty(EidosGlobalStringID p_property_id)
 			
 			return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(pedigree_id_));
 		}
-		case gID_pedigreeParentIDs:
+		case gID_pedigreeParentIDs:	// ACCELERATED
 		{
 			if (!subpopulation_.population_.sim_.PedigreesEnabledByUser())
 				EIDOS_TERMINATION << "ERROR (Individual::GetProperty): property pedigreeParentIDs is not available because pedigree recording has not been enabled." << EidosTerminate();
@@ -235,7 +235,7 @@ EidosValue_SP Individual::GetProperty(EidosGlobalStringID p_property_id)
 			
 			return EidosValue_SP(vec);
 		}
-		case gID_pedigreeGrandparentIDs:
+		case gID_pedigreeGrandparentIDs:	// ACCELERATED
 		{
 			if (!subpopulation_.population_.sim_.PedigreesEnabledByUser())
 				EIDOS_TERMINATION << "ERROR (Individual::GetProperty): property pedigreeGrandparentIDs is not available because pedigree recording has not been enabled." << EidosTerminate();
@@ -249,7 +249,7 @@ EidosValue_SP Individual::GetProperty(EidosGlobalStringID p_property_id)
 			
 			return EidosValue_SP(vec);
 		}
-		case gID_spatialPosition:
+		case gID_spatialPosition:	// ACCELERATED
 		{
 			SLiMSim &sim = subpopulation_.population_.sim_;
 			
@@ -674,6 +674,168 @@ EidosValue *Individual::GetProperty_Accelerated_genome2(EidosObjectElement **p_v
 	return object_result;
 }
 
+EidosValue *Individual::GetProperty_Accelerated_genomes(EidosObjectElement **p_values, size_t p_values_size)
+{
+	EidosValue_Object_vector *object_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Genome_Class))->resize_no_initialize(p_values_size * 2);
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Individual *value = (Individual *)(p_values[value_index]);
+		
+		object_result->set_object_element_no_check(value->genome1_, value_index * 2);
+		object_result->set_object_element_no_check(value->genome2_, value_index * 2 + 1);
+	}
+	
+	return object_result;
+}
+
+void Individual::GetProperty_AcceleratedElements_subpopulation(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result)
+{
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Individual *value = (Individual *)(p_values[value_index]);
+		
+		p_result[value_index] = &value->subpopulation_;
+	}
+}
+
+void Individual::GetProperty_AcceleratedElements_genome1(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result)
+{
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Individual *value = (Individual *)(p_values[value_index]);
+		
+		p_result[value_index] = value->genome1_;
+	}
+}
+
+void Individual::GetProperty_AcceleratedElements_genome2(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result)
+{
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Individual *value = (Individual *)(p_values[value_index]);
+		
+		p_result[value_index] = value->genome2_;
+	}
+}
+
+void Individual::GetProperty_AcceleratedElements_genomes(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result)
+{
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Individual *value = (Individual *)(p_values[value_index]);
+		
+		p_result[value_index * 2] = value->genome1_;
+		p_result[value_index * 2 + 1] = value->genome2_;
+	}
+}
+
+EidosValue *Individual::GetProperty_Accelerated_sex(EidosObjectElement **p_values, size_t p_values_size)
+{
+	static const std::string sex_string_H("H");
+	static const std::string sex_string_F("F");
+	static const std::string sex_string_M("M");
+	static const std::string sex_string_O("?");
+	
+	EidosValue_String_vector *string_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_String_vector())->Reserve((int)p_values_size);
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Individual *value = (Individual *)(p_values[value_index]);
+		
+		switch (value->sex_)
+		{
+			case IndividualSex::kHermaphrodite:	string_result->PushString(sex_string_H); break;
+			case IndividualSex::kFemale:		string_result->PushString(sex_string_F); break;
+			case IndividualSex::kMale:			string_result->PushString(sex_string_M); break;
+			default:							string_result->PushString(sex_string_O); break;
+		}
+	}
+	
+	return string_result;
+}
+
+EidosValue *Individual::GetProperty_Accelerated_pedigreeParentIDs(EidosObjectElement **p_values, size_t p_values_size)
+{
+	// check that pedigrees are enabled, once
+	if ((p_values_size > 0) && !((Individual *)(p_values[0]))->subpopulation_.population_.sim_.PedigreesEnabledByUser())
+		EIDOS_TERMINATION << "ERROR (Individual::GetProperty): property pedigreeParentIDs is not available because pedigree recording has not been enabled." << EidosTerminate();
+	
+	EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(p_values_size * 2);
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Individual *value = (Individual *)(p_values[value_index]);
+		
+		int_result->set_int_no_check(value->pedigree_p1_, value_index * 2);
+		int_result->set_int_no_check(value->pedigree_p2_, value_index * 2 + 1);
+	}
+	
+	return int_result;
+}
+
+EidosValue *Individual::GetProperty_Accelerated_pedigreeGrandparentIDs(EidosObjectElement **p_values, size_t p_values_size)
+{
+	// check that pedigrees are enabled, once
+	if ((p_values_size > 0) && !((Individual *)(p_values[0]))->subpopulation_.population_.sim_.PedigreesEnabledByUser())
+		EIDOS_TERMINATION << "ERROR (Individual::GetProperty): property pedigreeGrandparentIDs is not available because pedigree recording has not been enabled." << EidosTerminate();
+	
+	EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(p_values_size * 4);
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Individual *value = (Individual *)(p_values[value_index]);
+		
+		int_result->set_int_no_check(value->pedigree_g1_, value_index * 4);
+		int_result->set_int_no_check(value->pedigree_g2_, value_index * 4 + 1);
+		int_result->set_int_no_check(value->pedigree_g3_, value_index * 4 + 2);
+		int_result->set_int_no_check(value->pedigree_g4_, value_index * 4 + 3);
+	}
+	
+	return int_result;
+}
+
+EidosValue *Individual::GetProperty_Accelerated_spatialPosition(EidosObjectElement **p_values, size_t p_values_size)
+{
+	// all of the individuals belong to the same simulation, so the dimensionality is the same for all of them
+	int dimensionality = ((p_values_size > 0) ? ((Individual *)(p_values[0]))->subpopulation_.population_.sim_.SpatialDimensionality() : 0);
+	
+	if (dimensionality == 0)
+		EIDOS_TERMINATION << "ERROR (Individual::GetProperty): position cannot be accessed in non-spatial simulations." << EidosTerminate();
+	
+	EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(p_values_size * dimensionality);
+	double *float_result_data = float_result->data();
+	
+	switch (dimensionality)
+	{
+		case 1:
+			for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+				float_result_data[value_index] = ((Individual *)(p_values[value_index]))->spatial_x_;
+			break;
+		case 2:
+			for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+			{
+				Individual *value = (Individual *)(p_values[value_index]);
+				
+				*(float_result_data++) = value->spatial_x_;
+				*(float_result_data++) = value->spatial_y_;
+			}
+			break;
+		default:	// 3
+			for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+			{
+				Individual *value = (Individual *)(p_values[value_index]);
+				
+				*(float_result_data++) = value->spatial_x_;
+				*(float_result_data++) = value->spatial_y_;
+				*(float_result_data++) = value->spatial_z_;
+			}
+			break;
+	}
+	
+	return float_result;
+}
+
 void Individual::SetProperty(EidosGlobalStringID p_property_id, const EidosValue &p_value)
 {
 	// All of our strings are in the global registry, so we can require a successful lookup
@@ -1412,12 +1574,12 @@ const std::vector<EidosPropertySignature_CSP> *Individual_Class::Properties(void
 	{
 		properties = new std::vector<EidosPropertySignature_CSP>(*SLiMEidosDictionary_Class::Properties());
 		
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_subpopulation,			true,	kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Subpopulation_Class))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_subpopulation));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_subpopulation,			true,	kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Subpopulation_Class))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_subpopulation)->DeclareAcceleratedGetElements(Individual::GetProperty_AcceleratedElements_subpopulation, 1));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_index,					true,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_index));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genomes,				true,	kEidosValueMaskObject, gSLiM_Genome_Class)));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genome1,				true,	kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Genome_Class))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_genome1));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genome2,				true,	kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Genome_Class))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_genome2));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_sex,					true,	kEidosValueMaskString | kEidosValueMaskSingleton)));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genomes,				true,	kEidosValueMaskObject, gSLiM_Genome_Class))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_genomes)->DeclareAcceleratedGetElements(Individual::GetProperty_AcceleratedElements_genomes, 2));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genome1,				true,	kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Genome_Class))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_genome1)->DeclareAcceleratedGetElements(Individual::GetProperty_AcceleratedElements_genome1, 1));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genome2,				true,	kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Genome_Class))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_genome2)->DeclareAcceleratedGetElements(Individual::GetProperty_AcceleratedElements_genome2, 1));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_sex,					true,	kEidosValueMaskString | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_sex));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_tag,					false,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_tag)->DeclareAcceleratedSet(Individual::SetProperty_Accelerated_tag));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_tagF,					false,	kEidosValueMaskFloat | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_tagF)->DeclareAcceleratedSet(Individual::SetProperty_Accelerated_tagF));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_migrant,				true,	kEidosValueMaskLogical | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_migrant));
@@ -1429,9 +1591,9 @@ const std::vector<EidosPropertySignature_CSP> *Individual_Class::Properties(void
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_age,					false,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_age)->DeclareAcceleratedSet(Individual::SetProperty_Accelerated_age));
 #endif  // SLIM_NONWF_ONLY
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_pedigreeID,				true,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_pedigreeID));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_pedigreeParentIDs,		true,	kEidosValueMaskInt)));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_pedigreeGrandparentIDs,	true,	kEidosValueMaskInt)));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_spatialPosition,		true,	kEidosValueMaskFloat)));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_pedigreeParentIDs,		true,	kEidosValueMaskInt))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_pedigreeParentIDs));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_pedigreeGrandparentIDs,	true,	kEidosValueMaskInt))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_pedigreeGrandparentIDs));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_spatialPosition,		true,	kEidosValueMaskFloat))->DeclareAcceleratedGet(Individual::GetProperty_Accelerated_spatialPosition));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_uniqueMutations,		true,	kEidosValueMaskObject, gSLiM_Mutation_Class)));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gEidosStr_color,				false,	kEidosValueMaskString | kEidosValueMaskSingleton))->DeclareAcceleratedSet(Individual::SetProperty_Accelerated_color));
 		
@@ -198,6 +198,17 @@ public:
 	static EidosValue *GetProperty_Accelerated_subpopulation(EidosObjectElement **p_values, size_t p_values_size);
 	static EidosValue *GetProperty_Accelerated_genome1(EidosObjectElement **p_values, size_t p_values_size);
 	static EidosValue *GetProperty_Accelerated_genome2(EidosObjectElement **p_values, size_t p_values_size);
+	static EidosValue *GetProperty_Accelerated_genomes(EidosObjectElement **p_values, size_t p_values_size);
+	static EidosValue *GetProperty_Accelerated_sex(EidosObjectElement **p_values, size_t p_values_size);
+	static EidosValue *GetProperty_Accelerated_pedigreeParentIDs(EidosObjectElement **p_values, size_t p_values_size);
+	static EidosValue *GetProperty_Accelerated_pedigreeGrandparentIDs(EidosObjectElement **p_values, size_t p_values_size);
+	static EidosValue *GetProperty_Accelerated_spatialPosition(EidosObjectElement **p_values, size_t p_values_size);
+	
+	// Accelerated element getters; see Eidos_AcceleratedElementGetter
+	static void GetProperty_AcceleratedElements_subpopulation(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result);
+	static void GetProperty_AcceleratedElements_genome1(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result);
+	static void GetProperty_AcceleratedElements_genome2(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result);
+	static void GetProperty_AcceleratedElements_genomes(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result);
 	
 	// Accelerated property writing; see class EidosObjectElement for comments on this mechanism
 	static void SetProperty_Accelerated_tag(EidosObjectElement **p_values, size_t p_values_size, const EidosValue &p_source, size_t p_source_size);
@@ -27,6 +27,9 @@
 
 #include <utility>
 #include <algorithm>
+#include <string.h>
+#include <climits>
+#include <limits>
 
 
 // stream output for enumerations
@@ -81,6 +84,9 @@ void InteractionType::EvaluateSubpopulation(Subpopulation *p_subpop, bool p_imme
 	
 	auto data_iter = data_.find(subpop_id);
 	InteractionsData *subpop_data;
+	double *previous_positions = nullptr;
+	slim_popsize_t previous_individual_count = 0;
+	double previous_bounds[SLIM_MAX_DIMENSIONALITY];
 	
 	if (data_iter == data_.end())
 	{
@@ -92,31 +98,37 @@ void InteractionType::EvaluateSubpopulation(Subpopulation *p_subpop, bool p_imme
 		// There is an existing entry, so we need to rehabilitate that entry by recycling its elements safely
 		subpop_data = &(data_iter->second);
 		
+		// If there is a spatial index left over from a previous evaluation, keep it along with the positions it was built
+		// from; UpdateSpatialIndex() will compare those with the new positions below, and patch the index if it can.
+		if (subpop_data->kd_nodes_ && subpop_data->positions_)
+		{
+			previous_positions = subpop_data->positions_;
+			previous_individual_count = subpop_data->individual_count_;
+			previous_bounds[0] = subpop_data->bounds_x1_;
+			previous_bounds[1] = subpop_data->bounds_y1_;
+			previous_bounds[2] = subpop_data->bounds_z1_;
+			subpop_data->positions_ = nullptr;
+		}
+		else
+		{
+			DiscardSpatialIndex(*subpop_data);
+		}
+		
 		subpop_data->individual_count_ = subpop_size;
 		subpop_data->first_male_index_ = p_subpop->parent_first_male_index_;
-		subpop_data->kd_node_count_ = 0;
 		
 		// If the sparse array has not yet been allocated, we will continue to defer until it is needed
 		// It will never be allocated for non-spatial models, or for models that use only the k-d tree
 		if (subpop_data->dist_str_)
 			subpop_data->dist_str_->Reset();
 		
-		// Ensure that other parts of the subpop data block are correctly reset to the same state that Invalidate()
-		// uses; normally this has already been done by Initialize(), but not necessarily.
+		// Free any positional data left over from a previous evaluation that is not needed by UpdateSpatialIndex()
 		if (subpop_data->positions_)
 		{
 			free(subpop_data->positions_);
 			subpop_data->positions_ = nullptr;
 		}
 		
-		if (subpop_data->kd_nodes_)
-		{
-			free(subpop_data->kd_nodes_);
-			subpop_data->kd_nodes_ = nullptr;
-		}
-		
-		subpop_data->kd_root_ = nullptr;
-		
 		subpop_data->evaluation_interaction_callbacks_.clear();
 	}
 	
@@ -399,6 +411,20 @@ void InteractionType::EvaluateSubpopulation(Subpopulation *p_subpop, bool p_imme
 			EIDOS_TERMINATION << "ERROR (InteractionType::EvaluateSubpopulation): (internal error) illegal spatiality string value" << EidosTerminate();
 		}
 		
+		// Bring the spatial index, if any, up to date with the new positions; this frees previous_positions
+		if (previous_positions)
+		{
+			if (out_of_bounds_seen)
+			{
+				DiscardSpatialIndex(*subpop_data);
+				free(previous_positions);
+			}
+			else
+			{
+				UpdateSpatialIndex(*subpop_data, previous_positions, previous_individual_count, previous_bounds);
+			}
+		}
+		
 		if (out_of_bounds_seen)
 			EIDOS_TERMINATION << "ERROR (InteractionType::EvaluateSubpopulation): an individual position was seen that is out of bounds for a periodic spatial dimension; positions within periodic bounds are required by InteractionType since the underlying spatial engine's integrity depends upon them.  The use of pointPeriodic() is recommended to enforce periodic boundaries." << EidosTerminate();
 	}
@@ -451,9 +477,10 @@ bool InteractionType::AnyEvaluated(void)
 void InteractionType::Invalidate(void)
 {
 	// Called by SLiM when the old generation goes away; should invalidate all evaluation.  We avoid actually freeing the
-	// big blocks if possible, though, since that can incur large overhead from madvise() – see header comments.  We do free
-	// the positional data and the k-d tree, though, in an attempt to make fatal errors occur if somebody doesn't manage
-	// the buffers and evaluated state correctly.  They should be smaller, and thus not trigger madvise(), anyway.
+	// big blocks if possible, though, since that can incur large overhead from madvise() – see header comments.  We used
+	// to free the positional data and the spatial index here too; now we keep them, so that the next evaluation can
+	// patch the index rather than rebuilding it if few individuals have moved (see UpdateSpatialIndex()).  Nothing uses
+	// them while evaluated_ is false, and EvaluateSubpopulation() replaces the positional data.
 	for (auto &data_iter : data_)
 	{
 		InteractionsData &data = data_iter.second;
@@ -461,23 +488,9 @@ void InteractionType::Invalidate(void)
 		data.distances_calculated_ = false;
 		data.strengths_calculated_ = false;
 		
-		if (data.positions_)
-		{
-			free(data.positions_);
-			data.positions_ = nullptr;
-		}
-		
 		if (data.dist_str_)
 			data.dist_str_->Reset();
 		
-		if (data.kd_nodes_)
-		{
-			free(data.kd_nodes_);
-			data.kd_nodes_ = nullptr;
-		}
-		
-		data.kd_root_ = nullptr;
-		
 		data.evaluation_interaction_callbacks_.clear();
 	}
 }
@@ -494,9 +507,9 @@ void InteractionType::CalculateAllDistances(Subpopulation *p_subpop)
 		
 		if (spatiality_ > 0)
 		{
-			// Here we use the k-d tree to find all interacting pairs, and calculate their distances.
+			// Here we use the k-d tree (or the grid) to find all interacting pairs, and calculate their distances.
 			// This does not use reciprocality at all, but I don't think there's a good way to do so, so that's OK.
-			EnsureKDTreePresent(subpop_data);
+			EnsureSpatialIndexPresent(subpop_data);
 			
 			slim_popsize_t subpop_size = p_subpop->parent_subpop_size_;
 			
@@ -505,72 +518,382 @@ void InteractionType::CalculateAllDistances(Subpopulation *p_subpop)
 			else
 				subpop_data.dist_str_ = new SparseArray(subpop_size, subpop_size);
 			
-			double *position_data = subpop_data.positions_;
-			int start_row = 0, after_end_row = subpop_size, row;
+			std::vector<slim_popsize_t> receivers;
 			
-			if (receiver_sex_ == IndividualSex::kUnspecified)
-				;
-			else if (receiver_sex_ == IndividualSex::kMale)
-				start_row = subpop_data.first_male_index_;
-			else if (receiver_sex_ == IndividualSex::kFemale)
-				after_end_row = subpop_data.first_male_index_;
-			else
-				EIDOS_TERMINATION << "ERROR (InteractionType::CalculateAllDistances): (internal error) unrecognized value for receiver_sex_." << EidosTerminate();
+			ReceiversInSpatialOrder(subpop_data, subpop_size, nullptr, receivers);
+			BuildSARows(subpop_data, subpop_size, receivers.data(), receivers.size(), subpop_data.dist_str_);
+			
+			subpop_data.dist_str_->Finished();
+			subpop_data.distances_calculated_ = true;
+		}
+		else
+		{
+			// Non-spatial interactions do not cache anything, since their cache would have to be NxN, which is unacceptable
+		}
+	}
+}
+
+// Visit the individuals that can receive the interaction in a spatially coherent order, for building the sparse array; if
+// p_requested is non-null, only individuals for which p_requested[index] is non-zero are included.
+void InteractionType::ReceiversInSpatialOrder(InteractionsData &p_subpop_data, slim_popsize_t p_subpop_size, const uint8_t *p_requested, std::vector<slim_popsize_t> &p_receivers)
+{
+	int start_row = 0, after_end_row = p_subpop_size;
+	
+	if (receiver_sex_ == IndividualSex::kUnspecified)
+		;
+	else if (receiver_sex_ == IndividualSex::kMale)
+		start_row = p_subpop_data.first_male_index_;
+	else if (receiver_sex_ == IndividualSex::kFemale)
+		after_end_row = p_subpop_data.first_male_index_;
+	else
+		EIDOS_TERMINATION << "ERROR (InteractionType::ReceiversInSpatialOrder): (internal error) unrecognized value for receiver_sex_." << EidosTerminate();
+	
+	// Rather than visiting the receivers in index order, which is typically unrelated to position, we visit
+	// them in the order of the spatial index's nodes.  Both the grid and the k-d tree keep spatially close individuals close
+	// together in that order, so successive searches traverse mostly the same nodes and read mostly the same positions, and
+	// stay in cache; this substantially speeds up building the sparse array for large populations.  The sparse array
+	// allows rows to be added in any order.  With periodic boundaries, the k-d tree contains several replicas of each
+	// individual, so we visit each individual at its first replica.
+	SLiM_kdNode *node_end = p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_;
+	
+	p_receivers.reserve(after_end_row - start_row);
+	
+	if (p_subpop_data.kd_node_count_ == p_subpop_size)
+	{
+		for (SLiM_kdNode *node = p_subpop_data.kd_nodes_; node != node_end; ++node)
+		{
+			slim_popsize_t row = node->individual_index_;
+			
+			if ((row >= start_row) && (row < after_end_row) && (!p_requested || p_requested[row]))
+				p_receivers.emplace_back(row);
+		}
+	}
+	else
+	{
+		std::vector<uint8_t> visited(p_subpop_size, 0);
+		
+		for (SLiM_kdNode *node = p_subpop_data.kd_nodes_; node != node_end; ++node)
+		{
+			slim_popsize_t row = node->individual_index_;
 			
-			if (exerter_sex_ == IndividualSex::kUnspecified)
+			if ((row >= start_row) && (row < after_end_row) && (!p_requested || p_requested[row]) && !visited[row])
 			{
-				// Without a specified exerter sex, we can add each exerter with no sex test
-				switch (spatiality_)
+				visited[row] = 1;
+				p_receivers.emplace_back(row);
+			}
+		}
+	}
+}
+
+// Add the rows for the given receivers to p_sparse_array, in the given order, using the grid or k-d tree
+void InteractionType::BuildSARows(InteractionsData &p_subpop_data, slim_popsize_t p_subpop_size, const slim_popsize_t *p_receivers, size_t p_receiver_count, SparseArray *p_sparse_array)
+{
+	double *position_data = p_subpop_data.positions_;
+	const slim_popsize_t *receivers_end = p_receivers + p_receiver_count;
+	
+	if (p_subpop_data.grid_cell_starts_)
+	{
+		// The grid handles all spatialities, and tests the exerter sex by range
+		int start_exerter = 0, after_end_exerter = p_subpop_size;
+		
+		if (exerter_sex_ == IndividualSex::kMale)
+			start_exerter = p_subpop_data.first_male_index_;
+		else if (exerter_sex_ == IndividualSex::kFemale)
+			after_end_exerter = p_subpop_data.first_male_index_;
+		
+		for (const slim_popsize_t *row = p_receivers; row != receivers_end; ++row)
+			BuildSA_Grid(p_subpop_data, position_data + *row * SLIM_MAX_DIMENSIONALITY, *row, p_sparse_array, start_exerter, after_end_exerter);
+	}
+	else if (exerter_sex_ == IndividualSex::kUnspecified)
+	{
+		// Without a specified exerter sex, we can add each exerter with no sex test
+		switch (spatiality_)
+		{
+			case 1:
+				for (const slim_popsize_t *row = p_receivers; row != receivers_end; ++row)
+					BuildSA_1(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, position_data + *row * SLIM_MAX_DIMENSIONALITY, *row, p_sparse_array);
+				break;
+			case 2:
+				for (const slim_popsize_t *row = p_receivers; row != receivers_end; ++row)
+					BuildSA_2(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, position_data + *row * SLIM_MAX_DIMENSIONALITY, *row, p_sparse_array, 0);
+				break;
+			case 3:
+				for (const slim_popsize_t *row = p_receivers; row != receivers_end; ++row)
+					BuildSA_3(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, position_data + *row * SLIM_MAX_DIMENSIONALITY, *row, p_sparse_array, 0);
+				break;
+		}
+	}
+	else
+	{
+		// With a specified exerter sex, we use a special version of BuildSA_X() that tests for that by range
+		int start_exerter = 0, after_end_exerter = p_subpop_size;
+		
+		if (exerter_sex_ == IndividualSex::kMale)
+			start_exerter = p_subpop_data.first_male_index_;
+		else if (exerter_sex_ == IndividualSex::kFemale)
+			after_end_exerter = p_subpop_data.first_male_index_;
+		else
+			EIDOS_TERMINATION << "ERROR (InteractionType::BuildSARows): (internal error) unrecognized value for exerter_sex_." << EidosTerminate();
+		
+		switch (spatiality_)
+		{
+			case 1:
+				for (const slim_popsize_t *row = p_receivers; row != receivers_end; ++row)
+					BuildSA_SS_1(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, position_data + *row * SLIM_MAX_DIMENSIONALITY, *row, p_sparse_array, start_exerter, after_end_exerter);
+				break;
+			case 2:
+				for (const slim_popsize_t *row = p_receivers; row != receivers_end; ++row)
+					BuildSA_SS_2(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, position_data + *row * SLIM_MAX_DIMENSIONALITY, *row, p_sparse_array, start_exerter, after_end_exerter, 0);
+				break;
+			case 3:
+				for (const slim_popsize_t *row = p_receivers; row != receivers_end; ++row)
+					BuildSA_SS_3(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, position_data + *row * SLIM_MAX_DIMENSIONALITY, *row, p_sparse_array, start_exerter, after_end_exerter, 0);
+				break;
+		}
+	}
+}
+
+// totalOfNeighborStrengths() and interactingNeighborCount() need only a total for each receiver, not the
+// individual interactions, so when they are called for many receivers and the sparse array has not already been built, we
+// stream instead of building it: the receivers are processed in blocks, in spatial order, and each block's rows are built into a
+// scratch sparse array, reduced to totals, and then discarded.  The memory used is thus bounded by the size of one block, rather
+// than growing with the total number of interacting pairs, which can be many gigabytes for large populations with dense
+// neighborhoods.  The totals are exactly the same as those obtained from the full sparse array, since the rows are built and
+// the strengths calculated by the same code.  The full sparse array is still built on demand, by queries that need per-pair
+// values (such as strength() or drawByStrength()), and by single-receiver calls, which are often made in a loop over all
+// individuals and thus benefit from the cache.  Streaming is not used when interaction() callbacks are active, since they
+// should be called only once per interacting pair.
+
+// The number of receivers whose rows are built at one time while streaming; this bounds the memory used by the scratch array
+#define SLIM_STREAM_BLOCK_RECEIVERS		1024
+
+// Calculate the total interaction strength (or, if p_count_only is true, the number of interacting neighbors) for each of the
+// individuals in p_individuals, placing the totals in p_totals at the index of each individual in its subpopulation.  Returns
+// false, without doing the calculation, if the individuals are not all visible in p_subpop; the caller should then fall back
+// to using the sparse array, which will diagnose the problem.
+bool InteractionType::StreamNeighborTotals(Subpopulation *p_subpop, InteractionsData &p_subpop_data, EidosValue *p_individuals, bool p_count_only, std::vector<double> &p_totals)
+{
+	slim_popsize_t subpop_size = p_subpop->parent_subpop_size_;
+	int individual_count = p_individuals->Count();
+	std::vector<uint8_t> requested(subpop_size, 0);
+	
+	for (int individual_index = 0; individual_index < individual_count; ++individual_index)
+	{
+		Individual *individual = (Individual *)p_individuals->ObjectElementAtIndex(individual_index, nullptr);
+		slim_popsize_t index_in_subpop = individual->index_;
+		
+		if ((&(individual->subpopulation_) != p_subpop) || (index_in_subpop < 0))
+			return false;
+		
+		requested[index_in_subpop] = 1;
+	}
+	
+	// Find the receivers; individuals that cannot receive the interaction are left with a total of zero
+	std::vector<slim_popsize_t> receivers;
+	
+	EnsureSpatialIndexPresent(p_subpop_data);
+	ReceiversInSpatialOrder(p_subpop_data, subpop_size, requested.data(), receivers);
+	
+	p_totals.assign(subpop_size, 0.0);
+	
+	// Get the scratch sparse array; it is normally left with no rows added, but might not be after an error
+	SparseArray *block_sa = p_subpop_data.stream_sa_;
+	
+	if (!block_sa)
+		block_sa = p_subpop_data.stream_sa_ = new SparseArray(subpop_size, subpop_size);
+	else if ((block_sa->RowCount() != (uint32_t)subpop_size) || (block_sa->AddedRowCount() != 0))
+		block_sa->Reset(subpop_size, subpop_size);
+	
+	for (size_t block_start = 0; block_start < receivers.size(); block_start += SLIM_STREAM_BLOCK_RECEIVERS)
+	{
+		size_t block_count = std::min((size_t)SLIM_STREAM_BLOCK_RECEIVERS, receivers.size() - block_start);
+		const slim_popsize_t *block_receivers = receivers.data() + block_start;
+		
+		BuildSARows(p_subpop_data, subpop_size, block_receivers, block_count, block_sa);
+		block_sa->Finished();
+		
+		if (p_count_only)
+		{
+			for (size_t receiver_index = 0; receiver_index < block_count; ++receiver_index)
+			{
+				slim_popsize_t receiver = block_receivers[receiver_index];
+				uint32_t row_nnz;
+				
+				block_sa->DistancesForRow(receiver, &row_nnz, nullptr);
+				p_totals[receiver] = row_nnz;
+			}
+		}
+		else
+		{
+			FillStrengthsNoCallbacks(*block_sa);
+			
+			for (size_t receiver_index = 0; receiver_index < block_count; ++receiver_index)
+			{
+				slim_popsize_t receiver = block_receivers[receiver_index];
+				uint32_t row_nnz;
+				const sa_strength_t *strengths = block_sa->StrengthsForRow(receiver, &row_nnz, nullptr);
+				double total_strength = 0.0;
+				
+				for (uint32_t col_index = 0; col_index < row_nnz; ++col_index)
+					total_strength += strengths[col_index];
+				
+				p_totals[receiver] = total_strength;
+			}
+		}
+		
+		block_sa->ResetRows(block_receivers, block_count);
+	}
+	
+	return true;
+}
+
+// A single-precision approximation of exp(x) for x <= 0, used by CalculateAllStrengths() when fastMath is T.  It uses the
+// Cody-Waite range reduction and polynomial of the Cephes expf(), but is written without branches or floating-point comparisons
+// (the clamp is done on the bit pattern of x) so that loops calling it can be auto-vectorized.  Its relative error is below 1e-7
+// for -87 <= x <= 0; for x < -87 it returns 0 rather than a denormal.  Note that the sign of x is ignored; it must not be > 0!
+static inline __attribute__((always_inline)) float SLiM_FastExpNonPositive(float p_x)
+{
+	uint32_t magnitude;
+	
+	memcpy(&magnitude, &p_x, sizeof(float));
+	magnitude &= 0x7FFFFFFFU;
+	
+	uint32_t in_range_mask = (magnitude > 0x42AE0000U) ? 0x00000000U : 0xFFFFFFFFU;		// 0x42AE0000 is 87.0f
+	
+	magnitude = (magnitude > 0x42AE0000U) ? 0x42AE0000U : magnitude;
+	magnitude |= 0x80000000U;
+	
+	float x;
+	
+	memcpy(&x, &magnitude, sizeof(float));
+	
+	// x = n * ln(2) + r, with n integral and |r| <= ln(2)/2; adding and subtracting 1.5 * 2^23 rounds to the nearest integer
+	float n = (x * 1.44269504088896341f + 12582912.0f) - 12582912.0f;
+	float r = x - n * 0.693359375f;
+	
+	r = r + n * 2.12194440e-4f;
+	
+	// exp(r) by a minimax polynomial
+	float p = 1.9875691500e-4f;
+	
+	p = p * r + 1.3981999507e-3f;
+	p = p * r + 8.3334519073e-3f;
+	p = p * r + 4.1665795894e-2f;
+	p = p * r + 1.6666665459e-1f;
+	p = p * r + 5.0000001201e-1f;
+	p = p * r * r + r + 1.0f;
+	
+	// scale by 2^n, constructing the float directly; n >= -126, so the result is normal (or zero if out of range)
+	uint32_t scale_bits = ((uint32_t)((int32_t)n + 127) << 23) & in_range_mask;
+	float scale;
+	
+	memcpy(&scale, &scale_bits, sizeof(float));
+	
+	return p * scale;
+}
+
+// Fill in the strength for every entry of a sparse array from its distance, with no interaction() callbacks; used by
+// CalculateAllStrengths(), and by StreamNeighborTotals() for each block of receivers
+void InteractionType::FillStrengthsNoCallbacks(SparseArray &p_sparse_array)
+{
+	// The strength of an entry depends only upon its distance, not upon its row or column, so rather than walking the sparse
+	// array row by row we make a single pass over the contiguous entry buffers for all rows at once.  This gets rid of the
+	// per-row overhead (which dominated for sparse interactions) and presents the compiler with one long, branch-free loop per
+	// kernel type, which is also the natural unit of work to hand out in chunks if this is ever threaded.
+	uint32_t nnz;
+	sa_distance_t *distances;
+	sa_strength_t *strengths;
+	
+	p_sparse_array.AllInteractions(&nnz, &distances, &strengths);
+	
+	// CalculateStrengthNoCallbacks() is basically inlined here, moved outside the loop; see that function for comments
+	switch (if_type_)
+	{
+		case IFType::kFixed:
+		{
+			for (uint32_t index = 0; index < nnz; ++index)
+				strengths[index] = (sa_strength_t)if_param1_;
+			break;
+		}
+		case IFType::kLinear:
+		{
+			for (uint32_t index = 0; index < nnz; ++index)
+			{
+				sa_distance_t distance = distances[index];
+				
+				strengths[index] = (sa_strength_t)(if_param1_ * (1.0 - distance / max_distance_));
+			}
+			break;
+		}
+		case IFType::kExponential:
+		{
+			if (fast_math_ && (if_param2_ >= 0.0))
+			{
+				// With fastMath, we work in single precision so that the loop can be vectorized; see SLiM_FastExpNonPositive()
+				float fmax = (float)if_param1_;
+				float neg_lambda = (float)(-if_param2_);
+				
+				for (uint32_t index = 0; index < nnz; ++index)
+					strengths[index] = fmax * SLiM_FastExpNonPositive(neg_lambda * distances[index]);
+			}
+			else
+			{
+				for (uint32_t index = 0; index < nnz; ++index)
 				{
-					case 1:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_1(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_);
-						break;
-					case 2:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_2(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, 0);
-						break;
-					case 3:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_3(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, 0);
-						break;
+					sa_distance_t distance = distances[index];
+					
+					strengths[index] = (sa_strength_t)(if_param1_ * exp(-if_param2_ * distance));
 				}
 			}
-			else
+			break;
+		}
+		case IFType::kNormal:
+		{
+			if (fast_math_ && (if_param2_ > 0.0))
 			{
-				// With a specified exerter sex, we use a special version of BuildSA_X() that tests for that by range
-				int start_exerter = 0, after_end_exerter = subpop_size;
-				
-				if (exerter_sex_ == IndividualSex::kMale)
-					start_exerter = subpop_data.first_male_index_;
-				else if (exerter_sex_ == IndividualSex::kFemale)
-					after_end_exerter = subpop_data.first_male_index_;
-				else
-					EIDOS_TERMINATION << "ERROR (InteractionType::CalculateAllDistances): (internal error) unrecognized value for exerter_sex_." << EidosTerminate();
+				float fmax = (float)if_param1_;
+				float neg_inv_two_var = (float)(-1.0 / (2.0 * if_param2_ * if_param2_));
 				
-				switch (spatiality_)
+				for (uint32_t index = 0; index < nnz; ++index)
 				{
-					case 1:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_SS_1(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, start_exerter, after_end_exerter);
-						break;
-					case 2:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_SS_2(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, start_exerter, after_end_exerter, 0);
-						break;
-					case 3:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_SS_3(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, start_exerter, after_end_exerter, 0);
-						break;
+					sa_distance_t distance = distances[index];
+					
+					strengths[index] = fmax * SLiM_FastExpNonPositive(neg_inv_two_var * distance * distance);
 				}
 			}
-			
-			subpop_data.dist_str_->Finished();
-			subpop_data.distances_calculated_ = true;
+			else
+			{
+				for (uint32_t index = 0; index < nnz; ++index)
+				{
+					sa_distance_t distance = distances[index];
+					
+					strengths[index] = (sa_strength_t)(if_param1_ * exp(-(distance * distance) / (2.0 * if_param2_ * if_param2_)));
+				}
+			}
+			break;
 		}
-		else
+		case IFType::kCauchy:
 		{
-			// Non-spatial interactions do not cache anything, since their cache would have to be NxN, which is unacceptable
+			for (uint32_t index = 0; index < nnz; ++index)
+			{
+				sa_distance_t distance = distances[index];
+				double temp = distance / if_param2_;
+				
+				strengths[index] = (sa_strength_t)(if_param1_ / (1.0 + temp * temp));
+			}
+			break;
+		}
+		default:
+		{
+			// should never be hit, but this is the base case
+			for (uint32_t index = 0; index < nnz; ++index)
+			{
+				sa_distance_t distance = distances[index];
+				
+				strengths[index] = (sa_strength_t)CalculateStrengthNoCallbacks(distance);
+			}
+			
+			EIDOS_TERMINATION << "ERROR (InteractionType::FillStrengthsNoCallbacks): (internal error) unimplemented IFType case." << EidosTerminate();
 		}
 	}
 }
@@ -601,78 +924,7 @@ void InteractionType::CalculateAllStrengths(Subpopulation *p_subpop)
 			{
 				// No callbacks; strength calculations come from the interaction function only
 				// We do not use reciprocity here, as searching for the mirrored entry would probably take longer than just calculating twice
-				for (uint32_t row = 0; row < (uint32_t)subpop_size; ++row)
-				{
-					uint32_t row_nnz, *row_columns;
-					sa_distance_t *row_distances;
-					sa_strength_t *row_strengths;
-					
-					dist_str.InteractionsForRow(row, &row_nnz, &row_columns, &row_distances, &row_strengths);
-					
-					// CalculateStrengthNoCallbacks() is basically inlined here, moved outside the loop; see that function for comments
-					switch (if_type_)
-					{
-						case IFType::kFixed:
-						{
-							for (uint32_t col_iter = 0; col_iter < row_nnz; ++col_iter)
-								row_strengths[col_iter] = (sa_strength_t)if_param1_;
-							break;
-						}
-						case IFType::kLinear:
-						{
-							for (uint32_t col_iter = 0; col_iter < row_nnz; ++col_iter)
-							{
-								sa_distance_t distance = row_distances[col_iter];
-								
-								row_strengths[col_iter] = (sa_strength_t)(if_param1_ * (1.0 - distance / max_distance_));
-							}
-							break;
-						}
-						case IFType::kExponential:
-						{
-							for (uint32_t col_iter = 0; col_iter < row_nnz; ++col_iter)
-							{
-								sa_distance_t distance = row_distances[col_iter];
-								
-								row_strengths[col_iter] = (sa_strength_t)(if_param1_ * exp(-if_param2_ * distance));
-							}
-							break;
-						}
-						case IFType::kNormal:
-						{
-							for (uint32_t col_iter = 0; col_iter < row_nnz; ++col_iter)
-							{
-								sa_distance_t distance = row_distances[col_iter];
-								
-								row_strengths[col_iter] = (sa_strength_t)(if_param1_ * exp(-(distance * distance) / (2.0 * if_param2_ * if_param2_)));
-							}
-							break;
-						}
-						case IFType::kCauchy:
-						{
-							for (uint32_t col_iter = 0; col_iter < row_nnz; ++col_iter)
-							{
-								sa_distance_t distance = row_distances[col_iter];
-								double temp = distance / if_param2_;
-								
-								row_strengths[col_iter] = (sa_strength_t)(if_param1_ / (1.0 + temp * temp));
-							}
-							break;
-						}
-						default:
-						{
-							// should never be hit, but this is the base case
-							for (uint32_t col_iter = 0; col_iter < row_nnz; ++col_iter)
-							{
-								sa_distance_t distance = row_distances[col_iter];
-								
-								row_strengths[col_iter] = (sa_strength_t)CalculateStrengthNoCallbacks(distance);
-							}
-							
-							EIDOS_TERMINATION << "ERROR (InteractionType::CalculateAllStrengths): (internal error) unimplemented IFType case." << EidosTerminate();
-						}
-					}
-				}
+				FillStrengthsNoCallbacks(dist_str);
 			}
 			else
 			{
@@ -1096,6 +1348,9 @@ size_t InteractionType::MemoryUsageForKDTrees(void)
 	{
 		const InteractionsData &data = iter.second;
 		usage += sizeof(SLiM_kdNode) * data.individual_count_;
+		
+		if (data.grid_cell_starts_)
+			usage += sizeof(slim_popsize_t) * (data.grid_cells_[0] * data.grid_cells_[1] * data.grid_cells_[2] + 1);
 	}
 	
 	return usage;
@@ -1124,6 +1379,9 @@ size_t InteractionType::MemoryUsageForSparseArrays(void)
 		
 		if (array)
 			usage += iter.second.dist_str_->MemoryUsage();
+		
+		if (iter.second.stream_sa_)
+			usage += iter.second.stream_sa_->MemoryUsage();
 	}
 	
 	return usage;
@@ -1134,211 +1392,108 @@ size_t InteractionType::MemoryUsageForSparseArrays(void)
 #pragma mark k-d tree construction
 #pragma mark -
 
-// This k-d tree code is patterned after the C code at RosettaCode.org : https://rosettacode.org/wiki/K-d_tree#C
-// It uses a Quickselect-style algorithm to select medians to produce a balanced tree
+// This k-d tree code was originally patterned after the C code at RosettaCode.org : https://rosettacode.org/wiki/K-d_tree#C
 // Each spatiality case is coded separately, for maximum speed, but they are very parallel
 
 // Some of the code below is separated by phase.  The k-d tree cycles through phase (x, y, z) as you descend,
 // and rather than passing phase as a parameter, the code has been factored into phase-specific functions
 // that are mutually recursive, for speed.  It's not a huge win, but it does help a little.
 
-// BCH 14 August 2017: NOTE that I have found that the RosettaCode.org C example code was incorrect, which
-// is disappointing.  It tried to check for duplicates of the median and terminate early, but its logic for
-// doing so was flawed and resulted in a bad tree that produced incorrect results.  This code now follows
-// the logic of the pseudocode at Wikipedia (https://en.wikipedia.org/wiki/Quickselect), which seems correct.
-// Ironically, the incorrect logic of the RosettaCode version only produced incorrect results when there
-// were duplicated values in the coordinate vector.
+// The k-d tree now uses an implicit layout, with no child pointers.  Each subtree occupies a contiguous
+// range [start, end) of kd_nodes_; its root is the median node at start + (end - start) / 2, put there by nth_element(),
+// and its left and right subtrees occupy [start, root) and [root + 1, end).  A range of SLIM_KDTREE_BUCKET_SIZE nodes or
+// fewer is not subdivided further; it is a leaf bucket, in no particular order, that queries scan linearly.  Compared to
+// the previous pointer-based tree this makes nodes smaller, makes building cheaper (the lowest levels of the tree, which
+// hold most of its nodes, are never partitioned), and replaces the last levels of query recursion with a tight loop over
+// contiguous memory.  The median selection used to be a hand-coded Quickselect; std::nth_element() does the same job, and
+// guarantees that nodes left of the median are <= it, and nodes to the right are >= it, in the phase's coordinate.
+
+static inline __attribute__((always_inline)) bool KDNodeLess_p0(const SLiM_kdNode &p_a, const SLiM_kdNode &p_b) { return p_a.x[0] < p_b.x[0]; }
+static inline __attribute__((always_inline)) bool KDNodeLess_p1(const SLiM_kdNode &p_a, const SLiM_kdNode &p_b) { return p_a.x[1] < p_b.x[1]; }
+static inline __attribute__((always_inline)) bool KDNodeLess_p2(const SLiM_kdNode &p_a, const SLiM_kdNode &p_b) { return p_a.x[2] < p_b.x[2]; }
 
-inline __attribute__((always_inline)) void swap(SLiM_kdNode *p_x, SLiM_kdNode *p_y)
+// make k-d tree recursively for the 1D case for phase 0 (x)
+void InteractionType::MakeKDTree1_p0(SLiM_kdNode *start, SLiM_kdNode *end)
 {
-	std::swap(p_x->x, p_y->x);
-	std::swap(p_x->individual_index_, p_y->individual_index_);
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+		return;
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
+	
+	std::nth_element(start, root, end, KDNodeLess_p0);
+	
+	MakeKDTree1_p0(start, root);
+	MakeKDTree1_p0(root + 1, end);
 }
 
-// find median for phase 0 (x)
-SLiM_kdNode *InteractionType::FindMedian_p0(SLiM_kdNode *start, SLiM_kdNode *end)
+// make k-d tree recursively for the 2D case for phase 0 (x)
+void InteractionType::MakeKDTree2_p0(SLiM_kdNode *start, SLiM_kdNode *end)
 {
-	SLiM_kdNode *p, *store, *md = start + (end - start) / 2;	// md is the location where the median will eventually be placed
-	double pivot;
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+		return;
 	
-	while (1)
-	{
-		if (end == start + 1) return start;						// if end==start+1 we have reached the base case of the recursion, so return
-		
-		pivot = md->x[0];										// get a pivot value from md, which is effectively a random guess
-		
-		swap(md, end - 1);										// place the pivot value at the very end of our range
-		for (store = p = start; p < end; p++)					// loop p over our range and partition into values < vs. >= pivot
-		{
-			if (p->x[0] < pivot)								// p is less than the pivot, so store it on the left side
-			{
-				if (p != store)
-					swap(p, store);
-				store++;
-			}
-		}
-		swap(store, end - 1);									// move the pivot value, at end-1, to the end of the store
-		
-		if (store == md)		return md;						// pivot position == median; we happened to choose the median as pivot, so we're done!
-		else if (store > md)	end = store;					// pivot position > median, so look for the median to the left of pivot
-		else					start = store + 1;				// pivot position < median, so look for the median to the right of pivot
-	}
-}
-
-// find median for phase 1 (y)
-SLiM_kdNode *InteractionType::FindMedian_p1(SLiM_kdNode *start, SLiM_kdNode *end)
-{
-	SLiM_kdNode *p, *store, *md = start + (end - start) / 2;
-	double pivot;
+	SLiM_kdNode *root = start + (end - start) / 2;
 	
-	while (1)
-	{
-		if (end == start + 1) return start;
-		
-		pivot = md->x[1];
-		
-		swap(md, end - 1);
-		for (store = p = start; p < end; p++)
-		{
-			if (p->x[1] < pivot)
-			{
-				if (p != store)
-					swap(p, store);
-				store++;
-			}
-		}
-		swap(store, end - 1);
-		
-		if (store == md)		return md;
-		else if (store > md)	end = store;
-		else					start = store + 1;
-	}
-}
-
-// find median for phase 2 (z)
-SLiM_kdNode *InteractionType::FindMedian_p2(SLiM_kdNode *start, SLiM_kdNode *end)
-{
-	SLiM_kdNode *p, *store, *md = start + (end - start) / 2;
-	double pivot;
+	std::nth_element(start, root, end, KDNodeLess_p0);
 	
-	while (1)
-	{
-		if (end == start + 1) return start;
-		
-		pivot = md->x[2];
-		
-		swap(md, end - 1);
-		for (store = p = start; p < end; p++)
-		{
-			if (p->x[2] < pivot)
-			{
-				if (p != store)
-					swap(p, store);
-				store++;
-			}
-		}
-		swap(store, end - 1);
-		
-		if (store == md)		return md;
-		else if (store > md)	end = store;
-		else					start = store + 1;
-	}
+	MakeKDTree2_p1(start, root);
+	MakeKDTree2_p1(root + 1, end);
 }
 
-// make k-d tree recursively for the 1D case for phase 0 (x)
-SLiM_kdNode *InteractionType::MakeKDTree1_p0(SLiM_kdNode *t, int len)
+// make k-d tree recursively for the 2D case for phase 1 (y)
+void InteractionType::MakeKDTree2_p1(SLiM_kdNode *start, SLiM_kdNode *end)
 {
-	SLiM_kdNode *n = ((len == 1) ? t : FindMedian_p0(t, t + len));
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+		return;
 	
-	if (n)
-	{
-		int left_len = (int)(n - t);
-		n->left  = (left_len ? MakeKDTree1_p0(t, left_len) : 0);
-		
-		int right_len = (int)(t + len - (n + 1));
-		n->right = (right_len ? MakeKDTree1_p0(n + 1, right_len) : 0);
-	}
-	return n;
-}
-
-// make k-d tree recursively for the 2D case for phase 0 (x)
-SLiM_kdNode *InteractionType::MakeKDTree2_p0(SLiM_kdNode *t, int len)
-{
-	SLiM_kdNode *n = ((len == 1) ? t : FindMedian_p0(t, t + len));
+	SLiM_kdNode *root = start + (end - start) / 2;
 	
-	if (n)
-	{
-		int left_len = (int)(n - t);
-		n->left  = (left_len ? MakeKDTree2_p1(t, left_len) : 0);
-		
-		int right_len = (int)(t + len - (n + 1));
-		n->right = (right_len ? MakeKDTree2_p1(n + 1, right_len) : 0);
-	}
-	return n;
-}
-
-// make k-d tree recursively for the 2D case for phase 1 (y)
-SLiM_kdNode *InteractionType::MakeKDTree2_p1(SLiM_kdNode *t, int len)
-{
-	SLiM_kdNode *n = ((len == 1) ? t : FindMedian_p1(t, t + len));
+	std::nth_element(start, root, end, KDNodeLess_p1);
 	
-	if (n)
-	{
-		int left_len = (int)(n - t);
-		n->left  = (left_len ? MakeKDTree2_p0(t, left_len) : 0);
-		
-		int right_len = (int)(t + len - (n + 1));
-		n->right = (right_len ? MakeKDTree2_p0(n + 1, right_len) : 0);
-	}
-	return n;
+	MakeKDTree2_p0(start, root);
+	MakeKDTree2_p0(root + 1, end);
 }
 
 // make k-d tree recursively for the 3D case for phase 0 (x)
-SLiM_kdNode *InteractionType::MakeKDTree3_p0(SLiM_kdNode *t, int len)
+void InteractionType::MakeKDTree3_p0(SLiM_kdNode *start, SLiM_kdNode *end)
 {
-	SLiM_kdNode *n = ((len == 1) ? t : FindMedian_p0(t, t + len));
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+		return;
 	
-	if (n)
-	{
-		int left_len = (int)(n - t);
-		n->left  = (left_len ? MakeKDTree3_p1(t, left_len) : 0);
-		
-		int right_len = (int)(t + len - (n + 1));
-		n->right = (right_len ? MakeKDTree3_p1(n + 1, right_len) : 0);
-	}
-	return n;
+	SLiM_kdNode *root = start + (end - start) / 2;
+	
+	std::nth_element(start, root, end, KDNodeLess_p0);
+	
+	MakeKDTree3_p1(start, root);
+	MakeKDTree3_p1(root + 1, end);
 }
 
 // make k-d tree recursively for the 3D case for phase 1 (y)
-SLiM_kdNode *InteractionType::MakeKDTree3_p1(SLiM_kdNode *t, int len)
+void InteractionType::MakeKDTree3_p1(SLiM_kdNode *start, SLiM_kdNode *end)
 {
-	SLiM_kdNode *n = ((len == 1) ? t : FindMedian_p1(t, t + len));
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+		return;
 	
-	if (n)
-	{
-		int left_len = (int)(n - t);
-		n->left  = (left_len ? MakeKDTree3_p2(t, left_len) : 0);
-		
-		int right_len = (int)(t + len - (n + 1));
-		n->right = (right_len ? MakeKDTree3_p2(n + 1, right_len) : 0);
-	}
-	return n;
+	SLiM_kdNode *root = start + (end - start) / 2;
+	
+	std::nth_element(start, root, end, KDNodeLess_p1);
+	
+	MakeKDTree3_p2(start, root);
+	MakeKDTree3_p2(root + 1, end);
 }
 
 // make k-d tree recursively for the 3D case for phase 2 (z)
-SLiM_kdNode *InteractionType::MakeKDTree3_p2(SLiM_kdNode *t, int len)
+void InteractionType::MakeKDTree3_p2(SLiM_kdNode *start, SLiM_kdNode *end)
 {
-	SLiM_kdNode *n = ((len == 1) ? t : FindMedian_p2(t, t + len));
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+		return;
 	
-	if (n)
-	{
-		int left_len = (int)(n - t);
-		n->left  = (left_len ? MakeKDTree3_p0(t, left_len) : 0);
-		
-		int right_len = (int)(t + len - (n + 1));
-		n->right = (right_len ? MakeKDTree3_p0(n + 1, right_len) : 0);
-	}
-	return n;
+	SLiM_kdNode *root = start + (end - start) / 2;
+	
+	std::nth_element(start, root, end, KDNodeLess_p2);
+	
+	MakeKDTree3_p0(start, root);
+	MakeKDTree3_p0(root + 1, end);
 }
 
 void InteractionType::EnsureKDTreePresent(InteractionsData &p_subpop_data)
@@ -1497,208 +1652,491 @@ void InteractionType::EnsureKDTreePresent(InteractionsData &p_subpop_data)
 		
 		p_subpop_data.kd_nodes_ = nodes;
 		
-		if (p_subpop_data.kd_node_count_ == 0)
+		// Now call out to recursively construct the tree
+		switch (spatiality_)
 		{
-			p_subpop_data.kd_root_ = 0;
+			case 1: MakeKDTree1_p0(nodes, nodes + count);	break;
+			case 2: MakeKDTree2_p0(nodes, nodes + count);	break;
+			case 3: MakeKDTree3_p0(nodes, nodes + count);	break;
 		}
-		else
-		{
-			// Now call out to recursively construct the tree
-			switch (spatiality_)
-			{
-				case 1: p_subpop_data.kd_root_ = MakeKDTree1_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
-				case 2: p_subpop_data.kd_root_ = MakeKDTree2_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
-				case 3: p_subpop_data.kd_root_ = MakeKDTree3_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
-			}
-			
-			// Check the tree for correctness; for now I will leave this enabled in the DEBUG case,
-			// because a bug was found in the k-d tree code in 2.4.1 that would have been caught by this.
-			// Eventually, when it is clear that this code is robust, this check can be disabled.
+		
+		// Check the tree for correctness; for now I will leave this enabled in the DEBUG case,
+		// because a bug was found in the k-d tree code in 2.4.1 that would have been caught by this.
+		// Eventually, when it is clear that this code is robust, this check can be disabled.
 #ifdef DEBUG
-			int total_tree_count = 0;
-			
-			switch (spatiality_)
-			{
-				case 1: total_tree_count = CheckKDTree1_p0(p_subpop_data.kd_root_);	break;
-				case 2: total_tree_count = CheckKDTree2_p0(p_subpop_data.kd_root_);	break;
-				case 3: total_tree_count = CheckKDTree3_p0(p_subpop_data.kd_root_);	break;
-			}
-			
-			if (total_tree_count != p_subpop_data.kd_node_count_)
-				EIDOS_TERMINATION << "ERROR (InteractionType::EnsureKDTreePresent): (internal error) the k-d tree count " << total_tree_count << " does not match the allocated node count" << p_subpop_data.kd_node_count_ << "." << EidosTerminate();
+		int total_tree_count = CheckKDTree(nodes, nodes + count, 0);
+		
+		if (total_tree_count != p_subpop_data.kd_node_count_)
+			EIDOS_TERMINATION << "ERROR (InteractionType::EnsureKDTreePresent): (internal error) the k-d tree count " << total_tree_count << " does not match the allocated node count" << p_subpop_data.kd_node_count_ << "." << EidosTerminate();
 #endif
-		}
 	}
 }
 
 
 #pragma mark -
-#pragma mark k-d tree consistency checking
+#pragma mark uniform grid construction
 #pragma mark -
 
-// The general strategy is: the _pX() functions check that they are indeed a median node for all of the
-// nodes underneath the given node, for the coordinate of the given polarity.  They do this by calling
-// the pX_r() method on their left and right subtree, with their own coordinate; it recurses over the
-// subtrees.  The pX() method then makes a call on each subtree to have it check itself.  Each pX()
-// method call returns the total number of nodes found in itself and its subtrees.
+// When maxDistance is small relative to the extent of the individuals, a uniform grid of cells at least
+// maxDistance wide is both cheaper to build than a k-d tree (a counting sort, linear in the number of individuals) and cheaper
+// to query, since all of the interacting neighbors of a point lie in the 3^d cells around the cell containing it.  The grid
+// handles periodic boundaries by wrapping cell indices around, rather than by replicating the individuals as the k-d tree does.
+// The choice between the grid and the k-d tree is made automatically, by EnsureSpatialIndexPresent(), each time an index is
+// built; all queries (BuildSA_X(), FindNeighbors(), and everything based upon them) work with either index.
+
+// A grid is not used unless it has at least this many cells in total; with fewer, queries visit most of the grid anyway
+#define SLIM_GRID_MIN_CELLS		64
 
-int InteractionType::CheckKDTree1_p0(SLiM_kdNode *t)
+// A grid is not used if it would have more than this many individuals per cell on average; with dense cells, the k-d tree's
+// tighter pruning wins, since the 3^d cells scanned by a grid query cover a much larger volume than the interaction sphere
+#define SLIM_GRID_MAX_INDIVIDUALS_PER_CELL		64
+
+// The grid is coarsened as needed to have no more than this many cells per individual, to bound its memory usage
+#define SLIM_GRID_MAX_CELLS_PER_INDIVIDUAL		2
+
+bool InteractionType::ConfigureGrid(InteractionsData &p_subpop_data)
 {
-	double split = t->x[0];
+	// Decide whether a grid should be used, and if so, set up its geometry in p_subpop_data; returns false for a k-d tree
+	if (!std::isfinite(max_distance_) || (max_distance_ <= 0.0))
+		return false;
+	
+	int individual_count = p_subpop_data.individual_count_;
+	double *positions = p_subpop_data.positions_;
+	bool periodic[SLIM_MAX_DIMENSIONALITY] = {periodic_x_, periodic_y_, periodic_z_};
+	double bounds[SLIM_MAX_DIMENSIONALITY] = {p_subpop_data.bounds_x1_, p_subpop_data.bounds_y1_, p_subpop_data.bounds_z1_};
+	double extent[SLIM_MAX_DIMENSIONALITY];
+	double width[SLIM_MAX_DIMENSIONALITY];
+	double cells[SLIM_MAX_DIMENSIONALITY];
+	
+	if (individual_count == 0)
+		return false;
+	
+	// Cells are made a hair wider than maxDistance, so that roundoff in assigning individuals to cells can never put an
+	// interacting neighbor two cells away.  Periodic dimensions get a whole number of cells spanning the periodic bounds.
+	double min_width = max_distance_ * 1.000001;
+	
+	for (int dim = 0; dim < SLIM_MAX_DIMENSIONALITY; ++dim)
+	{
+		if (dim >= spatiality_)
+		{
+			p_subpop_data.grid_origin_[dim] = 0.0;
+			extent[dim] = 0.0;
+			width[dim] = 0.0;
+			cells[dim] = 1;
+		}
+		else if (periodic[dim])
+		{
+			// at least three cells are needed to wrap around without visiting a cell twice; with fewer, we use the k-d tree
+			p_subpop_data.grid_origin_[dim] = 0.0;
+			extent[dim] = bounds[dim];
+			cells[dim] = floor(bounds[dim] / min_width);
+			
+			if (!(cells[dim] >= 3))
+				return false;
+			
+			width[dim] = bounds[dim] / cells[dim];
+		}
+		else
+		{
+			double coord_min = positions[dim], coord_max = positions[dim];
+			
+			for (int ind_index = 1; ind_index < individual_count; ++ind_index)
+			{
+				double coord = positions[ind_index * SLIM_MAX_DIMENSIONALITY + dim];
+				
+				coord_min = std::min(coord_min, coord);
+				coord_max = std::max(coord_max, coord);
+			}
+			
+			if (!std::isfinite(coord_min) || !std::isfinite(coord_max))
+				return false;
+			
+			p_subpop_data.grid_origin_[dim] = coord_min;
+			extent[dim] = coord_max - coord_min;
+			width[dim] = min_width;
+			cells[dim] = floor(extent[dim] / width[dim]) + 1;
+		}
+	}
 	
-	if (t->left) CheckKDTree1_p0_r(t->left, split, true);
-	if (t->right) CheckKDTree1_p0_r(t->right, split, false);
+	// Coarsen the grid until it is not too large, by halving the cell count along each dimension that can spare it
+	double max_cells = std::max((double)individual_count * SLIM_GRID_MAX_CELLS_PER_INDIVIDUAL, (double)SLIM_GRID_MIN_CELLS);
 	
-	int left_count = t->left ? CheckKDTree1_p0(t->left) : 0;
-	int right_count = t->right ? CheckKDTree1_p0(t->right) : 0;
+	while (cells[0] * cells[1] * cells[2] > max_cells)
+	{
+		bool coarsened = false;
+		
+		for (int dim = 0; dim < spatiality_; ++dim)
+		{
+			if (periodic[dim])
+			{
+				if (cells[dim] >= 6)
+				{
+					cells[dim] = floor(cells[dim] / 2);
+					width[dim] = extent[dim] / cells[dim];
+					coarsened = true;
+				}
+			}
+			else if (cells[dim] > 1)
+			{
+				width[dim] *= 2;
+				cells[dim] = floor(extent[dim] / width[dim]) + 1;
+				coarsened = true;
+			}
+		}
+		
+		if (!coarsened)
+			break;
+	}
 	
-	return left_count + right_count + 1;
-}
-
-void InteractionType::CheckKDTree1_p0_r(SLiM_kdNode *t, double split, bool isLeftSubtree)
-{
-	double x = t->x[0];
+	double total_cells = cells[0] * cells[1] * cells[2];
 	
-	if (isLeftSubtree) {
-		if (x > split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree1_p0_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
-	} else {
-		if (x < split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree1_p0_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
+	if ((total_cells < SLIM_GRID_MIN_CELLS) || (individual_count > total_cells * SLIM_GRID_MAX_INDIVIDUALS_PER_CELL))
+		return false;
+	
+	for (int dim = 0; dim < SLIM_MAX_DIMENSIONALITY; ++dim)
+	{
+		p_subpop_data.grid_cells_[dim] = (int)cells[dim];
+		p_subpop_data.grid_inv_width_[dim] = (dim < spatiality_) ? 1.0 / width[dim] : 0.0;
 	}
-	if (t->left) CheckKDTree1_p0_r(t->left, split, isLeftSubtree);
-	if (t->right) CheckKDTree1_p0_r(t->right, split, isLeftSubtree);
+	
+	return true;
 }
 
-int InteractionType::CheckKDTree2_p0(SLiM_kdNode *t)
+// the cell coordinate of a position along one dimension, clamped to the grid; the clamp catches positions on the upper periodic bound
+static inline __attribute__((always_inline)) int GridCellCoordinate(double p_coord, double p_origin, double p_inv_width, int p_cells)
 {
-	double split = t->x[0];
+	int cell = (int)((p_coord - p_origin) * p_inv_width);
 	
-	if (t->left) CheckKDTree2_p0_r(t->left, split, true);
-	if (t->right) CheckKDTree2_p0_r(t->right, split, false);
-	
-	int left_count = t->left ? CheckKDTree2_p1(t->left) : 0;
-	int right_count = t->right ? CheckKDTree2_p1(t->right) : 0;
-	
-	return left_count + right_count + 1;
+	return (cell < 0) ? 0 : ((cell >= p_cells) ? p_cells - 1 : cell);
 }
 
-void InteractionType::CheckKDTree2_p0_r(SLiM_kdNode *t, double split, bool isLeftSubtree)
+void InteractionType::MakeGrid(InteractionsData &p_subpop_data)
 {
-	double x = t->x[0];
+	// Bin the individuals into cells with a counting sort; the geometry has already been set up by ConfigureGrid()
+	int individual_count = p_subpop_data.individual_count_;
+	double *positions = p_subpop_data.positions_;
+	int *grid_cells = p_subpop_data.grid_cells_;
+	double *grid_origin = p_subpop_data.grid_origin_;
+	double *grid_inv_width = p_subpop_data.grid_inv_width_;
+	slim_popsize_t cell_count = grid_cells[0] * grid_cells[1] * grid_cells[2];
+	slim_popsize_t *cell_starts = (slim_popsize_t *)calloc(cell_count + 1, sizeof(slim_popsize_t));
+	slim_popsize_t *cell_of_individual = (slim_popsize_t *)malloc(individual_count * sizeof(slim_popsize_t));
+	SLiM_kdNode *nodes = (SLiM_kdNode *)malloc(individual_count * sizeof(SLiM_kdNode));
+	
+	if (!cell_starts || !cell_of_individual || !nodes)
+		EIDOS_TERMINATION << "ERROR (InteractionType::MakeGrid): allocation failed; you may need to raise the memory limit for SLiM." << EidosTerminate(nullptr);
+	
+	// count the individuals in each cell, in cell_starts[cell + 1]
+	for (int ind_index = 0; ind_index < individual_count; ++ind_index)
+	{
+		double *position = positions + ind_index * SLIM_MAX_DIMENSIONALITY;
+		slim_popsize_t cell = GridCellCoordinate(position[0], grid_origin[0], grid_inv_width[0], grid_cells[0]);
+		
+		if (spatiality_ >= 2)
+			cell += grid_cells[0] * GridCellCoordinate(position[1], grid_origin[1], grid_inv_width[1], grid_cells[1]);
+		if (spatiality_ >= 3)
+			cell += grid_cells[0] * grid_cells[1] * GridCellCoordinate(position[2], grid_origin[2], grid_inv_width[2], grid_cells[2]);
+		
+		cell_of_individual[ind_index] = cell;
+		cell_starts[cell + 1]++;
+	}
+	
+	// convert the counts to starting offsets, then place the nodes; cell_starts[cell] is used as the insertion point for each
+	// cell, so that when we are done it holds the start of the next cell, and the offsets need to be shifted up by one
+	for (slim_popsize_t cell = 1; cell <= cell_count; ++cell)
+		cell_starts[cell] += cell_starts[cell - 1];
 	
-	if (isLeftSubtree) {
-		if (x > split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree2_p0_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
-	} else {
-		if (x < split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree2_p0_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
+	for (int ind_index = 0; ind_index < individual_count; ++ind_index)
+	{
+		double *position = positions + ind_index * SLIM_MAX_DIMENSIONALITY;
+		SLiM_kdNode *node = nodes + cell_starts[cell_of_individual[ind_index]]++;
+		
+		node->x[0] = position[0];
+		node->x[1] = (spatiality_ >= 2) ? position[1] : 0.0;
+		node->x[2] = (spatiality_ >= 3) ? position[2] : 0.0;
+		node->individual_index_ = ind_index;
 	}
-	if (t->left) CheckKDTree2_p0_r(t->left, split, isLeftSubtree);
-	if (t->right) CheckKDTree2_p0_r(t->right, split, isLeftSubtree);
+	
+	free(cell_of_individual);
+	
+	memmove(cell_starts + 1, cell_starts, cell_count * sizeof(slim_popsize_t));
+	cell_starts[0] = 0;
+	
+	p_subpop_data.kd_nodes_ = nodes;
+	p_subpop_data.kd_node_count_ = individual_count;
+	p_subpop_data.grid_cell_starts_ = cell_starts;
 }
 
-int InteractionType::CheckKDTree2_p1(SLiM_kdNode *t)
+void InteractionType::EnsureSpatialIndexPresent(InteractionsData &p_subpop_data)
 {
-	double split = t->x[1];
-	
-	if (t->left) CheckKDTree2_p1_r(t->left, split, true);
-	if (t->right) CheckKDTree2_p1_r(t->right, split, false);
+	if (p_subpop_data.kd_nodes_)
+		return;
 	
-	int left_count = t->left ? CheckKDTree2_p0(t->left) : 0;
-	int right_count = t->right ? CheckKDTree2_p0(t->right) : 0;
+	if (!p_subpop_data.evaluated_)
+		EIDOS_TERMINATION << "ERROR (InteractionType::EnsureSpatialIndexPresent): (internal error) the interaction has not been evaluated." << EidosTerminate();
 	
-	return left_count + right_count + 1;
+	if (ConfigureGrid(p_subpop_data))
+		MakeGrid(p_subpop_data);
+	else
+		EnsureKDTreePresent(p_subpop_data);
 }
 
-void InteractionType::CheckKDTree2_p1_r(SLiM_kdNode *t, double split, bool isLeftSubtree)
+
+#pragma mark -
+#pragma mark spatial index updating
+#pragma mark -
+
+// The spatial index (k-d tree or grid) is kept across evaluations, rather than being rebuilt from scratch by
+// every evaluate() call.  When an interaction is re-evaluated for the same number of individuals, UpdateSpatialIndex() compares
+// the new positions with the positions the index was built from, and if only a small fraction of individuals have moved, it
+// patches the index: grid nodes that stay in their cell are updated in place, and in the k-d tree, only the smallest subtrees
+// whose bounding regions contain the new positions of the moved nodes are rebuilt.  The index is discarded, to be rebuilt on
+// demand, if the number of individuals or the spatial bounds have changed, or if too many individuals have moved.  Note that
+// the index depends only on the mapping from individual index to position, so the individuals themselves need not be the same.
+
+// The spatial index is patched only if no more than this fraction of the individuals have moved; otherwise it is rebuilt
+#define SLIM_SPATIAL_INDEX_MAX_PATCH_FRACTION		0.125
+
+void InteractionType::DiscardSpatialIndex(InteractionsData &p_subpop_data)
 {
-	double x = t->x[1];
+	if (p_subpop_data.kd_nodes_)
+	{
+		free(p_subpop_data.kd_nodes_);
+		p_subpop_data.kd_nodes_ = nullptr;
+	}
 	
-	if (isLeftSubtree) {
-		if (x > split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree2_p1_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
-	} else {
-		if (x < split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree2_p1_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
+	if (p_subpop_data.grid_cell_starts_)
+	{
+		free(p_subpop_data.grid_cell_starts_);
+		p_subpop_data.grid_cell_starts_ = nullptr;
 	}
-	if (t->left) CheckKDTree2_p1_r(t->left, split, isLeftSubtree);
-	if (t->right) CheckKDTree2_p1_r(t->right, split, isLeftSubtree);
+	
+	p_subpop_data.kd_node_count_ = 0;
 }
 
-int InteractionType::CheckKDTree3_p0(SLiM_kdNode *t)
+void InteractionType::UpdateSpatialIndex(InteractionsData &p_subpop_data, double *p_previous_positions, slim_popsize_t p_previous_individual_count, double *p_previous_bounds)
 {
-	double split = t->x[0];
+	int individual_count = p_subpop_data.individual_count_;
+	double *positions = p_subpop_data.positions_;
+	double bounds[SLIM_MAX_DIMENSIONALITY] = {p_subpop_data.bounds_x1_, p_subpop_data.bounds_y1_, p_subpop_data.bounds_z1_};
 	
-	if (t->left) CheckKDTree3_p0_r(t->left, split, true);
-	if (t->right) CheckKDTree3_p0_r(t->right, split, false);
+	if ((individual_count != p_previous_individual_count) || !std::equal(bounds, bounds + SLIM_MAX_DIMENSIONALITY, p_previous_bounds))
+	{
+		DiscardSpatialIndex(p_subpop_data);
+		free(p_previous_positions);
+		return;
+	}
+	
+	// Find the individuals that have moved; note that only the first spatiality_ coordinates of each position are defined
+	std::vector<uint8_t> moved(individual_count, 0);
+	int moved_count = 0;
+	int max_moved_count = (int)(individual_count * SLIM_SPATIAL_INDEX_MAX_PATCH_FRACTION);
+	
+	for (int ind_index = 0; ind_index < individual_count; ++ind_index)
+	{
+		double *position = positions + ind_index * SLIM_MAX_DIMENSIONALITY;
+		double *previous_position = p_previous_positions + ind_index * SLIM_MAX_DIMENSIONALITY;
+		
+		for (int dim = 0; dim < spatiality_; ++dim)
+		{
+			if (position[dim] != previous_position[dim])
+			{
+				moved[ind_index] = 1;
+				moved_count++;
+				break;
+			}
+		}
+	}
+	
+	if (moved_count > max_moved_count)
+	{
+		DiscardSpatialIndex(p_subpop_data);
+		free(p_previous_positions);
+		return;
+	}
 	
-	int left_count = t->left ? CheckKDTree3_p1(t->left) : 0;
-	int right_count = t->right ? CheckKDTree3_p1(t->right) : 0;
+	if (moved_count > 0)
+	{
+		SLiM_kdNode *nodes = p_subpop_data.kd_nodes_;
+		int node_count = p_subpop_data.kd_node_count_;
+		
+		if (p_subpop_data.grid_cell_starts_)
+		{
+			// The grid can be patched only if every moved individual stays within the same cell; otherwise rebuilding it,
+			// which is a linear-time counting sort, is about as cheap as moving nodes between cells would be
+			bool periodic[SLIM_MAX_DIMENSIONALITY] = {periodic_x_, periodic_y_, periodic_z_};
+			int *grid_cells = p_subpop_data.grid_cells_;
+			double *grid_origin = p_subpop_data.grid_origin_;
+			double *grid_inv_width = p_subpop_data.grid_inv_width_;
+			
+			for (int node_index = 0; node_index < node_count; ++node_index)
+			{
+				SLiM_kdNode *node = nodes + node_index;
+				slim_popsize_t ind_index = node->individual_index_;
+				
+				if (!moved[ind_index])
+					continue;
+				
+				double *position = positions + ind_index * SLIM_MAX_DIMENSIONALITY;
+				double *previous_position = p_previous_positions + ind_index * SLIM_MAX_DIMENSIONALITY;
+				
+				for (int dim = 0; dim < spatiality_; ++dim)
+				{
+					// GridCellCoordinate() clamps to the grid, which is correct only for positions on a periodic bound; along a
+					// non-periodic dimension, a position outside the extent of the grid requires a rebuild
+					double cell_float = (position[dim] - grid_origin[dim]) * grid_inv_width[dim];
+					int cell = GridCellCoordinate(position[dim], grid_origin[dim], grid_inv_width[dim], grid_cells[dim]);
+					int previous_cell = GridCellCoordinate(previous_position[dim], grid_origin[dim], grid_inv_width[dim], grid_cells[dim]);
+					
+					if ((cell != previous_cell) || (!periodic[dim] && !((cell_float >= 0.0) && (cell_float < grid_cells[dim]))))
+					{
+						DiscardSpatialIndex(p_subpop_data);
+						free(p_previous_positions);
+						return;
+					}
+					
+					node->x[dim] = position[dim];
+				}
+			}
+		}
+		else
+		{
+			// Update the coordinates of the moved nodes, preserving the offsets of the replicates made for periodicity, and
+			// make a list of them; they are visited in order, so the list is sorted by address as PatchKDTree() requires
+			bool periodic[SLIM_MAX_DIMENSIONALITY] = {periodic_x_, periodic_y_, periodic_z_};
+			std::vector<SLiM_kdNode *> moved_nodes;
+			
+			for (int node_index = 0; node_index < node_count; ++node_index)
+			{
+				SLiM_kdNode *node = nodes + node_index;
+				slim_popsize_t ind_index = node->individual_index_;
+				
+				if (!moved[ind_index])
+					continue;
+				
+				double *position = positions + ind_index * SLIM_MAX_DIMENSIONALITY;
+				double *previous_position = p_previous_positions + ind_index * SLIM_MAX_DIMENSIONALITY;
+				
+				for (int dim = 0; dim < spatiality_; ++dim)
+				{
+					double offset = 0.0;
+					
+					if (periodic[dim])
+						offset = bounds[dim] * round((node->x[dim] - previous_position[dim]) / bounds[dim]);
+					
+					node->x[dim] = position[dim] + offset;
+				}
+				
+				moved_nodes.push_back(node);
+			}
+			
+			double region_min[SLIM_MAX_DIMENSIONALITY] = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+			double region_max[SLIM_MAX_DIMENSIONALITY] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+			
+			PatchKDTree(nodes, nodes + node_count, 0, region_min, region_max, moved_nodes.data(), moved_nodes.data() + moved_nodes.size());
+			
+#ifdef DEBUG
+			if (CheckKDTree(nodes, nodes + node_count, 0) != node_count)
+				EIDOS_TERMINATION << "ERROR (InteractionType::UpdateSpatialIndex): (internal error) the patched k-d tree has the wrong node count." << EidosTerminate();
+#endif
+		}
+	}
 	
-	return left_count + right_count + 1;
+	free(p_previous_positions);
 }
 
-void InteractionType::CheckKDTree3_p0_r(SLiM_kdNode *t, double split, bool isLeftSubtree)
+// rebuild the k-d subtree for the range [start, end), which is at the given phase in the tree
+void InteractionType::MakeKDTreeForPhase(SLiM_kdNode *start, SLiM_kdNode *end, int p_phase)
 {
-	double x = t->x[0];
-	
-	if (isLeftSubtree) {
-		if (x > split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree3_p0_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
-	} else {
-		if (x < split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree3_p0_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
+	switch (spatiality_)
+	{
+		case 1: MakeKDTree1_p0(start, end); break;
+		case 2: if (p_phase == 0) MakeKDTree2_p0(start, end); else MakeKDTree2_p1(start, end); break;
+		case 3: if (p_phase == 0) MakeKDTree3_p0(start, end); else if (p_phase == 1) MakeKDTree3_p1(start, end); else MakeKDTree3_p2(start, end); break;
 	}
-	if (t->left) CheckKDTree3_p0_r(t->left, split, isLeftSubtree);
-	if (t->right) CheckKDTree3_p0_r(t->right, split, isLeftSubtree);
 }
 
-int InteractionType::CheckKDTree3_p1(SLiM_kdNode *t)
+// Patch the k-d subtree for [start, end), at phase p_phase, after the nodes in [p_moved_begin, p_moved_end) have been moved;
+// the subtree's bounding region, defined by the splits of its ancestors, is [p_region_min, p_region_max].  Returns false,
+// without changing anything, if a moved node now lies outside that region, so that the caller must rebuild a larger subtree.
+bool InteractionType::PatchKDTree(SLiM_kdNode *start, SLiM_kdNode *end, int p_phase, double *p_region_min, double *p_region_max, SLiM_kdNode **p_moved_begin, SLiM_kdNode **p_moved_end)
 {
-	double split = t->x[1];
+	if (p_moved_begin == p_moved_end)
+		return true;
 	
-	if (t->left) CheckKDTree3_p1_r(t->left, split, true);
-	if (t->right) CheckKDTree3_p1_r(t->right, split, false);
+	for (SLiM_kdNode **moved_iter = p_moved_begin; moved_iter != p_moved_end; ++moved_iter)
+		for (int dim = 0; dim < spatiality_; ++dim)
+			if (((*moved_iter)->x[dim] < p_region_min[dim]) || ((*moved_iter)->x[dim] > p_region_max[dim]))
+				return false;
 	
-	int left_count = t->left ? CheckKDTree3_p2(t->left) : 0;
-	int right_count = t->right ? CheckKDTree3_p2(t->right) : 0;
+	// a leaf bucket is unordered, so any node within its region is fine
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+		return true;
 	
-	return left_count + right_count + 1;
-}
-
-void InteractionType::CheckKDTree3_p1_r(SLiM_kdNode *t, double split, bool isLeftSubtree)
-{
-	double x = t->x[1];
+	// if the median node itself moved, its split is no longer valid, so this subtree must be rebuilt
+	SLiM_kdNode *root = start + (end - start) / 2;
+	SLiM_kdNode **moved_split = std::lower_bound(p_moved_begin, p_moved_end, root);
 	
-	if (isLeftSubtree) {
-		if (x > split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree3_p1_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
-	} else {
-		if (x < split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree3_p1_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
+	if ((moved_split != p_moved_end) && (*moved_split == root))
+	{
+		MakeKDTreeForPhase(start, end, p_phase);
+		return true;
 	}
-	if (t->left) CheckKDTree3_p1_r(t->left, split, isLeftSubtree);
-	if (t->right) CheckKDTree3_p1_r(t->right, split, isLeftSubtree);
-}
-
-int InteractionType::CheckKDTree3_p2(SLiM_kdNode *t)
-{
-	double split = t->x[2];
 	
-	if (t->left) CheckKDTree3_p2_r(t->left, split, true);
-	if (t->right) CheckKDTree3_p2_r(t->right, split, false);
+	// otherwise, patch each child subtree within its region, and rebuild this subtree if a child cannot be patched
+	double split = root->x[p_phase];
+	int next_phase = (p_phase + 1 >= spatiality_) ? 0 : p_phase + 1;
+	double child_region[SLIM_MAX_DIMENSIONALITY];
+	
+	std::copy(p_region_max, p_region_max + SLIM_MAX_DIMENSIONALITY, child_region);
+	child_region[p_phase] = split;
+	
+	if (!PatchKDTree(start, root, next_phase, p_region_min, child_region, p_moved_begin, moved_split))
+	{
+		MakeKDTreeForPhase(start, end, p_phase);
+		return true;
+	}
 	
-	int left_count = t->left ? CheckKDTree3_p0(t->left) : 0;
-	int right_count = t->right ? CheckKDTree3_p0(t->right) : 0;
+	std::copy(p_region_min, p_region_min + SLIM_MAX_DIMENSIONALITY, child_region);
+	child_region[p_phase] = split;
 	
-	return left_count + right_count + 1;
+	if (!PatchKDTree(root + 1, end, next_phase, child_region, p_region_max, moved_split, p_moved_end))
+	{
+		MakeKDTreeForPhase(start, end, p_phase);
+		return true;
+	}
+	
+	return true;
 }
 
-void InteractionType::CheckKDTree3_p2_r(SLiM_kdNode *t, double split, bool isLeftSubtree)
+
+#pragma mark -
+#pragma mark k-d tree consistency checking
+#pragma mark -
+
+// Check that each median node splits its range correctly: nodes in its left subtree must be <= it in the coordinate for
+// its phase, and nodes in its right subtree must be >= it.  Returns the total number of nodes found in the given range.
+int InteractionType::CheckKDTree(SLiM_kdNode *start, SLiM_kdNode *end, int p_phase)
 {
-	double x = t->x[2];
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+		return (int)(end - start);
 	
-	if (isLeftSubtree) {
-		if (x > split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree3_p2_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
-	} else {
-		if (x < split)	EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree3_p2_r): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
-	}
-	if (t->left) CheckKDTree3_p2_r(t->left, split, isLeftSubtree);
-	if (t->right) CheckKDTree3_p2_r(t->right, split, isLeftSubtree);
+	SLiM_kdNode *root = start + (end - start) / 2;
+	double split = root->x[p_phase];
+	
+	for (SLiM_kdNode *node = start; node < root; ++node)
+		if (node->x[p_phase] > split)
+			EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
+	
+	for (SLiM_kdNode *node = root + 1; node < end; ++node)
+		if (node->x[p_phase] < split)
+			EIDOS_TERMINATION << "ERROR (InteractionType::CheckKDTree): (internal error) the k-d tree is not correctly sorted." << EidosTerminate();
+	
+	if (++p_phase >= spatiality_) p_phase = 0;
+	
+	return CheckKDTree(start, root, p_phase) + CheckKDTree(root + 1, end, p_phase) + 1;
 }
 
-
 #pragma mark -
 #pragma mark k-d tree sparse array building
 #pragma mark -
@@ -1752,8 +2190,22 @@ inline __attribute__((always_inline)) double dist_sq3(SLiM_kdNode *a, double *b)
 }
 
 // add neighbors to the sparse array in 1D
-void InteractionType::BuildSA_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array)
+void InteractionType::BuildSA_1(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq1(node, nd);
+			
+			if ((d <= max_distance_sq_) && (node->individual_index_ != p_focal_individual_index))
+				p_sparse_array->AddEntryDistance(p_focal_individual_index, node->individual_index_, (sa_distance_t)sqrt(d));
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq1(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[0] - nd[0];
@@ -1767,31 +2219,39 @@ void InteractionType::BuildSA_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			BuildSA_1(root->left, nd, p_focal_individual_index, p_sparse_array);
+		BuildSA_1(start, root, nd, p_focal_individual_index, p_sparse_array);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->right)
-			BuildSA_1(root->right, nd, p_focal_individual_index, p_sparse_array);
+		BuildSA_1(root + 1, end, nd, p_focal_individual_index, p_sparse_array);
 	}
 	else
 	{
-		if (root->right)
-			BuildSA_1(root->right, nd, p_focal_individual_index, p_sparse_array);
+		BuildSA_1(root + 1, end, nd, p_focal_individual_index, p_sparse_array);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->left)
-			BuildSA_1(root->left, nd, p_focal_individual_index, p_sparse_array);
+		BuildSA_1(start, root, nd, p_focal_individual_index, p_sparse_array);
 	}
 }
 
 // add neighbors to the sparse array in 2D
-#if 0
-// recursive algorithm, perhaps a bit slow but the compiler seems to do a good job with it actually
-void InteractionType::BuildSA_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int p_phase)
+void InteractionType::BuildSA_2(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int p_phase)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq2(node, nd);
+			
+			if ((d <= max_distance_sq_) && (node->individual_index_ != p_focal_individual_index))
+				p_sparse_array->AddEntryDistance(p_focal_individual_index, node->individual_index_, (sa_distance_t)sqrt(d));
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq2(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[p_phase] - nd[p_phase];
@@ -1807,126 +2267,39 @@ void InteractionType::BuildSA_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			BuildSA_2(root->left, nd, p_focal_individual_index, p_sparse_array, p_phase);
+		BuildSA_2(start, root, nd, p_focal_individual_index, p_sparse_array, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->right)
-			BuildSA_2(root->right, nd, p_focal_individual_index, p_sparse_array, p_phase);
+		BuildSA_2(root + 1, end, nd, p_focal_individual_index, p_sparse_array, p_phase);
 	}
 	else
 	{
-		if (root->right)
-			BuildSA_2(root->right, nd, p_focal_individual_index, p_sparse_array, p_phase);
+		BuildSA_2(root + 1, end, nd, p_focal_individual_index, p_sparse_array, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->left)
-			BuildSA_2(root->left, nd, p_focal_individual_index, p_sparse_array, p_phase);
+		BuildSA_2(start, root, nd, p_focal_individual_index, p_sparse_array, p_phase);
 	}
 }
-#else
-// non-recursive algorithm: barely a speed improvement as it turns out, and unsafe right now since it doesn't check for blowing out its stack.
-// for a test with 100,000 individuals, the recursive algorithm takes 55.61s, this takes 51.51s (only one replicate run).
-// I guess I'll use this version; I've made the stack plenty deep so it shouldn't ever run out.  So why not, it's faster.
-// But for now, I don't think I will do the same for the (less common) 1D and 3D cases, to keep the code base simple.
-// I'm a bit surprised by how slow this is – more than 50% of total runtime for that test model.  Maybe Boyana will have ideas.
-static SLiM_kdNode *(recurse_root[1000]);
-static int (recurse_phase[1000]);
-
-void InteractionType::BuildSA_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int p_phase)
+
+// add neighbors to the sparse array in 3D
+void InteractionType::BuildSA_3(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int p_phase)
 {
-	int recurse_top = 0;
-	double local_max_distance_sq = max_distance_sq_;	// put a few non-local things into local variables so the compiler can cache them in registers
-	double local_nd_0 = nd[0], local_nd_1 = nd[1];
-	
-recurse_SA_2:
-	double root_x_0 = root->x[0], root_x_1 = root->x[1];
-	double d = (root_x_0 - local_nd_0)*(root_x_0 - local_nd_0) + (root_x_1 - local_nd_1)*(root_x_1 - local_nd_1);
-	double dx = (p_phase == 0) ? (root_x_0 - local_nd_0) : (root_x_1 - local_nd_1);
-	double dx2 = dx * dx;
-	
-	if ((d <= local_max_distance_sq) && (root->individual_index_ != p_focal_individual_index))
-		p_sparse_array->AddEntryDistance(p_focal_individual_index, root->individual_index_, (sa_distance_t)sqrt(d));
-	
-	if (++p_phase >= 2) p_phase = 0;
-	
-	if (dx > 0)
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
 	{
-		if ((dx2 <= local_max_distance_sq) && (root->right))
-		{
-			// We want to do root->right after root->left
-			if (root->left)
-			{
-				// We have root->left to do as well, so we need to push (root = root->right, phase = p_phase) for later
-				recurse_root[recurse_top] = root->right;
-				recurse_phase[recurse_top] = p_phase;
-				recurse_top++;
-				
-				// And then do root->left
-				root = root->left;
-				goto recurse_SA_2;
-			}
-			else
-			{
-				// We don't have root->left to do, so we can do root->right immediately
-				root = root->right;
-				goto recurse_SA_2;
-			}
-		}
-		else if (root->left)
-		{
-			// We have only root->left to do, so we can do it immediately
-			root = root->left;
-			goto recurse_SA_2;
-		}
-	}
-	else
-	{
-		if ((dx2 <= local_max_distance_sq) && (root->left))
-		{
-			// We want to do root->left after root->right
-			if (root->right)
-			{
-				// We have root->right to do as well, so we need to push (root = root->left, phase = p_phase) for later
-				recurse_root[recurse_top] = root->left;
-				recurse_phase[recurse_top] = p_phase;
-				recurse_top++;
-				
-				// And then do root->right
-				root = root->right;
-				goto recurse_SA_2;
-			}
-			else
-			{
-				// We don't have root->right to do, so we can do root->left immediately
-				root = root->left;
-				goto recurse_SA_2;
-			}
-		}
-		else if (root->right)
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
 		{
-			// We have only root->right to do, so we can do it immediately
-			root = root->right;
-			goto recurse_SA_2;
+			double d = dist_sq3(node, nd);
+			
+			if ((d <= max_distance_sq_) && (node->individual_index_ != p_focal_individual_index))
+				p_sparse_array->AddEntryDistance(p_focal_individual_index, node->individual_index_, (sa_distance_t)sqrt(d));
 		}
+		return;
 	}
-	// We have finished a recursion, so we can pop a task off our stack and loop back
-	if (recurse_top)
-	{
-		--recurse_top;
-		root = recurse_root[recurse_top];
-		p_phase = recurse_phase[recurse_top];
-		
-		goto recurse_SA_2;
-	}
-}
-#endif
-
-// add neighbors to the sparse array in 3D
-void InteractionType::BuildSA_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int p_phase)
-{
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq3(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[p_phase] - nd[p_phase];
@@ -1942,29 +2315,39 @@ void InteractionType::BuildSA_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			BuildSA_3(root->left, nd, p_focal_individual_index, p_sparse_array, p_phase);
+		BuildSA_3(start, root, nd, p_focal_individual_index, p_sparse_array, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->right)
-			BuildSA_3(root->right, nd, p_focal_individual_index, p_sparse_array, p_phase);
+		BuildSA_3(root + 1, end, nd, p_focal_individual_index, p_sparse_array, p_phase);
 	}
 	else
 	{
-		if (root->right)
-			BuildSA_3(root->right, nd, p_focal_individual_index, p_sparse_array, p_phase);
+		BuildSA_3(root + 1, end, nd, p_focal_individual_index, p_sparse_array, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->left)
-			BuildSA_3(root->left, nd, p_focal_individual_index, p_sparse_array, p_phase);
+		BuildSA_3(start, root, nd, p_focal_individual_index, p_sparse_array, p_phase);
 	}
 }
 
 // add neighbors to the sparse array in 1D (exerter sex-specific)
-void InteractionType::BuildSA_SS_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter)
+void InteractionType::BuildSA_SS_1(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq1(node, nd);
+			
+			if ((d <= max_distance_sq_) && (node->individual_index_ != p_focal_individual_index) && (node->individual_index_ >= start_exerter) && (node->individual_index_ < after_end_exerter))
+				p_sparse_array->AddEntryDistance(p_focal_individual_index, node->individual_index_, (sa_distance_t)sqrt(d));
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq1(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[0] - nd[0];
@@ -1978,29 +2361,39 @@ void InteractionType::BuildSA_SS_1(SLiM_kdNode *root, double *nd, slim_popsize_t
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			BuildSA_SS_1(root->left, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter);
+		BuildSA_SS_1(start, root, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->right)
-			BuildSA_SS_1(root->right, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter);
+		BuildSA_SS_1(root + 1, end, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter);
 	}
 	else
 	{
-		if (root->right)
-			BuildSA_SS_1(root->right, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter);
+		BuildSA_SS_1(root + 1, end, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->left)
-			BuildSA_SS_1(root->left, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter);
+		BuildSA_SS_1(start, root, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter);
 	}
 }
 
 // add neighbors to the sparse array in 2D (exerter sex-specific)
-void InteractionType::BuildSA_SS_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter, int p_phase)
+void InteractionType::BuildSA_SS_2(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter, int p_phase)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq2(node, nd);
+			
+			if ((d <= max_distance_sq_) && (node->individual_index_ != p_focal_individual_index) && (node->individual_index_ >= start_exerter) && (node->individual_index_ < after_end_exerter))
+				p_sparse_array->AddEntryDistance(p_focal_individual_index, node->individual_index_, (sa_distance_t)sqrt(d));
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq2(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[p_phase] - nd[p_phase];
@@ -2016,29 +2409,39 @@ void InteractionType::BuildSA_SS_2(SLiM_kdNode *root, double *nd, slim_popsize_t
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			BuildSA_SS_2(root->left, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
+		BuildSA_SS_2(start, root, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->right)
-			BuildSA_SS_2(root->right, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
+		BuildSA_SS_2(root + 1, end, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
 	}
 	else
 	{
-		if (root->right)
-			BuildSA_SS_2(root->right, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
+		BuildSA_SS_2(root + 1, end, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->left)
-			BuildSA_SS_2(root->left, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
+		BuildSA_SS_2(start, root, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
 	}
 }
 
 // add neighbors to the sparse array in 3D (exerter sex-specific)
-void InteractionType::BuildSA_SS_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter, int p_phase)
+void InteractionType::BuildSA_SS_3(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter, int p_phase)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq3(node, nd);
+			
+			if ((d <= max_distance_sq_) && (node->individual_index_ != p_focal_individual_index) && (node->individual_index_ >= start_exerter) && (node->individual_index_ < after_end_exerter))
+				p_sparse_array->AddEntryDistance(p_focal_individual_index, node->individual_index_, (sa_distance_t)sqrt(d));
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq3(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[p_phase] - nd[p_phase];
@@ -2054,34 +2457,45 @@ void InteractionType::BuildSA_SS_3(SLiM_kdNode *root, double *nd, slim_popsize_t
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			BuildSA_SS_3(root->left, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
+		BuildSA_SS_3(start, root, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->right)
-			BuildSA_SS_3(root->right, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
+		BuildSA_SS_3(root + 1, end, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
 	}
 	else
 	{
-		if (root->right)
-			BuildSA_SS_3(root->right, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
+		BuildSA_SS_3(root + 1, end, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->left)
-			BuildSA_SS_3(root->left, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
+		BuildSA_SS_3(start, root, nd, p_focal_individual_index, p_sparse_array, start_exerter, after_end_exerter, p_phase);
 	}
 }
 
-
 #pragma mark -
 #pragma mark k-d tree neighbor searches
 #pragma mark -
 
 // find the one best neighbor in 1D
-void InteractionType::FindNeighbors1_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist)
+void InteractionType::FindNeighbors1_1(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq1(node, nd);
+			
+			if ((!*best || d < *best_dist) && (node->individual_index_ != p_focal_individual_index)) {
+				*best_dist = d;
+				*best = node;
+			}
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq1(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[0] - nd[0];
@@ -2097,29 +2511,41 @@ void InteractionType::FindNeighbors1_1(SLiM_kdNode *root, double *nd, slim_popsi
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			FindNeighbors1_1(root->left, nd, p_focal_individual_index, best, best_dist);
+		FindNeighbors1_1(start, root, nd, p_focal_individual_index, best, best_dist);
 		
-		if (dx2 >= *best_dist) return;
+		if (*best && (dx2 >= *best_dist)) return;
 		
-		if (root->right)
-			FindNeighbors1_1(root->right, nd, p_focal_individual_index, best, best_dist);
+		FindNeighbors1_1(root + 1, end, nd, p_focal_individual_index, best, best_dist);
 	}
 	else
 	{
-		if (root->right)
-			FindNeighbors1_1(root->right, nd, p_focal_individual_index, best, best_dist);
+		FindNeighbors1_1(root + 1, end, nd, p_focal_individual_index, best, best_dist);
 		
-		if (dx2 >= *best_dist) return;
+		if (*best && (dx2 >= *best_dist)) return;
 		
-		if (root->left)
-			FindNeighbors1_1(root->left, nd, p_focal_individual_index, best, best_dist);
+		FindNeighbors1_1(start, root, nd, p_focal_individual_index, best, best_dist);
 	}
 }
 
 // find the one best neighbor in 2D
-void InteractionType::FindNeighbors1_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist, int p_phase)
+void InteractionType::FindNeighbors1_2(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist, int p_phase)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq2(node, nd);
+			
+			if ((!*best || d < *best_dist) && (node->individual_index_ != p_focal_individual_index)) {
+				*best_dist = d;
+				*best = node;
+			}
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq2(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[p_phase] - nd[p_phase];
@@ -2137,29 +2563,41 @@ void InteractionType::FindNeighbors1_2(SLiM_kdNode *root, double *nd, slim_popsi
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			FindNeighbors1_2(root->left, nd, p_focal_individual_index, best, best_dist, p_phase);
+		FindNeighbors1_2(start, root, nd, p_focal_individual_index, best, best_dist, p_phase);
 		
-		if (dx2 >= *best_dist) return;
+		if (*best && (dx2 >= *best_dist)) return;
 		
-		if (root->right)
-			FindNeighbors1_2(root->right, nd, p_focal_individual_index, best, best_dist, p_phase);
+		FindNeighbors1_2(root + 1, end, nd, p_focal_individual_index, best, best_dist, p_phase);
 	}
 	else
 	{
-		if (root->right)
-			FindNeighbors1_2(root->right, nd, p_focal_individual_index, best, best_dist, p_phase);
+		FindNeighbors1_2(root + 1, end, nd, p_focal_individual_index, best, best_dist, p_phase);
 		
-		if (dx2 >= *best_dist) return;
+		if (*best && (dx2 >= *best_dist)) return;
 		
-		if (root->left)
-			FindNeighbors1_2(root->left, nd, p_focal_individual_index, best, best_dist, p_phase);
+		FindNeighbors1_2(start, root, nd, p_focal_individual_index, best, best_dist, p_phase);
 	}
 }
 
 // find the one best neighbor in 3D
-void InteractionType::FindNeighbors1_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist, int p_phase)
+void InteractionType::FindNeighbors1_3(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist, int p_phase)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq3(node, nd);
+			
+			if ((!*best || d < *best_dist) && (node->individual_index_ != p_focal_individual_index)) {
+				*best_dist = d;
+				*best = node;
+			}
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq3(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[p_phase] - nd[p_phase];
@@ -2177,29 +2615,39 @@ void InteractionType::FindNeighbors1_3(SLiM_kdNode *root, double *nd, slim_popsi
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			FindNeighbors1_3(root->left, nd, p_focal_individual_index, best, best_dist, p_phase);
+		FindNeighbors1_3(start, root, nd, p_focal_individual_index, best, best_dist, p_phase);
 		
-		if (dx2 >= *best_dist) return;
+		if (*best && (dx2 >= *best_dist)) return;
 		
-		if (root->right)
-			FindNeighbors1_3(root->right, nd, p_focal_individual_index, best, best_dist, p_phase);
+		FindNeighbors1_3(root + 1, end, nd, p_focal_individual_index, best, best_dist, p_phase);
 	}
 	else
 	{
-		if (root->right)
-			FindNeighbors1_3(root->right, nd, p_focal_individual_index, best, best_dist, p_phase);
+		FindNeighbors1_3(root + 1, end, nd, p_focal_individual_index, best, best_dist, p_phase);
 		
-		if (dx2 >= *best_dist) return;
+		if (*best && (dx2 >= *best_dist)) return;
 		
-		if (root->left)
-			FindNeighbors1_3(root->left, nd, p_focal_individual_index, best, best_dist, p_phase);
+		FindNeighbors1_3(start, root, nd, p_focal_individual_index, best, best_dist, p_phase);
 	}
 }
 
 // find all neighbors in 1D
-void InteractionType::FindNeighborsA_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals)
+void InteractionType::FindNeighborsA_1(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq1(node, nd);
+			
+			if ((d <= max_distance_sq_) && (node->individual_index_ != p_focal_individual_index))
+				p_result_vec.push_object_element(p_individuals[node->individual_index_]);
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq1(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[0] - nd[0];
@@ -2213,29 +2661,39 @@ void InteractionType::FindNeighborsA_1(SLiM_kdNode *root, double *nd, slim_popsi
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			FindNeighborsA_1(root->left, nd, p_focal_individual_index, p_result_vec, p_individuals);
+		FindNeighborsA_1(start, root, nd, p_focal_individual_index, p_result_vec, p_individuals);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->right)
-			FindNeighborsA_1(root->right, nd, p_focal_individual_index, p_result_vec, p_individuals);
+		FindNeighborsA_1(root + 1, end, nd, p_focal_individual_index, p_result_vec, p_individuals);
 	}
 	else
 	{
-		if (root->right)
-			FindNeighborsA_1(root->right, nd, p_focal_individual_index, p_result_vec, p_individuals);
+		FindNeighborsA_1(root + 1, end, nd, p_focal_individual_index, p_result_vec, p_individuals);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->left)
-			FindNeighborsA_1(root->left, nd, p_focal_individual_index, p_result_vec, p_individuals);
+		FindNeighborsA_1(start, root, nd, p_focal_individual_index, p_result_vec, p_individuals);
 	}
 }
 
 // find all neighbors in 2D
-void InteractionType::FindNeighborsA_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals, int p_phase)
+void InteractionType::FindNeighborsA_2(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals, int p_phase)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq2(node, nd);
+			
+			if ((d <= max_distance_sq_) && (node->individual_index_ != p_focal_individual_index))
+				p_result_vec.push_object_element(p_individuals[node->individual_index_]);
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq2(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[p_phase] - nd[p_phase];
@@ -2251,29 +2709,39 @@ void InteractionType::FindNeighborsA_2(SLiM_kdNode *root, double *nd, slim_popsi
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			FindNeighborsA_2(root->left, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
+		FindNeighborsA_2(start, root, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->right)
-			FindNeighborsA_2(root->right, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
+		FindNeighborsA_2(root + 1, end, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
 	}
 	else
 	{
-		if (root->right)
-			FindNeighborsA_2(root->right, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
+		FindNeighborsA_2(root + 1, end, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->left)
-			FindNeighborsA_2(root->left, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
+		FindNeighborsA_2(start, root, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
 	}
 }
 
 // find all neighbors in 3D
-void InteractionType::FindNeighborsA_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals, int p_phase)
+void InteractionType::FindNeighborsA_3(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals, int p_phase)
 {
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+		{
+			double d = dist_sq3(node, nd);
+			
+			if ((d <= max_distance_sq_) && (node->individual_index_ != p_focal_individual_index))
+				p_result_vec.push_object_element(p_individuals[node->individual_index_]);
+		}
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq3(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[p_phase] - nd[p_phase];
@@ -2289,23 +2757,19 @@ void InteractionType::FindNeighborsA_3(SLiM_kdNode *root, double *nd, slim_popsi
 	
 	if (dx > 0)
 	{
-		if (root->left)
-			FindNeighborsA_3(root->left, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
+		FindNeighborsA_3(start, root, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->right)
-			FindNeighborsA_3(root->right, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
+		FindNeighborsA_3(root + 1, end, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
 	}
 	else
 	{
-		if (root->right)
-			FindNeighborsA_3(root->right, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
+		FindNeighborsA_3(root + 1, end, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
 		
 		if (dx2 > max_distance_sq_) return;
 		
-		if (root->left)
-			FindNeighborsA_3(root->left, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
+		FindNeighborsA_3(start, root, nd, p_focal_individual_index, p_result_vec, p_individuals, p_phase);
 	}
 }
 
@@ -2314,67 +2778,82 @@ slim_popsize_t gKDTree_found_count;
 double gKDTree_worstbest;
 int gKDTree_worstbest_index;
 
-// find N neighbors in 1D
-void InteractionType::FindNeighborsN_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist)
+// consider one node as a candidate for the N best neighbors; shared by FindNeighborsN_X() for tree nodes and leaf buckets
+static inline __attribute__((always_inline)) void FindNeighborsN_Consider(SLiM_kdNode *p_node, double d, int p_count, SLiM_kdNode **best, double *best_dist, double p_max_distance_sq)
 {
-	if (!root) return;
-	
-	double d = dist_sq1(root, nd);
-#ifndef __clang_analyzer__
-	double dx = root->x[0] - nd[0];
-#else
-	double dx = 0.0;
-#endif
-	double dx2 = dx * dx;
-	
-	if (root->individual_index_ != p_focal_individual_index)
+	if (gKDTree_found_count == p_count)
 	{
-		if (gKDTree_found_count == p_count)
+		// We have a full roster of candidates, so now the question is, is this one better than the worst one?
+		if (d < gKDTree_worstbest)
 		{
-			// We have a full roster of candidates, so now the question is, is this one better than the worst one?
-			if (d < gKDTree_worstbest)
+			// Replace the worst of the best
+			best_dist[gKDTree_worstbest_index] = d;
+			best[gKDTree_worstbest_index] = p_node;
+			
+			// Scan to find the new worst of the best
+			gKDTree_worstbest = -1;
+			
+			for (int best_index = 0; best_index < p_count; ++best_index)
 			{
-				// Replace the worst of the best
-				best_dist[gKDTree_worstbest_index] = d;
-				best[gKDTree_worstbest_index] = root;
-				
-				// Scan to find the new worst of the best
-				gKDTree_worstbest = -1;
-				
-				for (int best_index = 0; best_index < p_count; ++best_index)
+				if (best_dist[best_index] > gKDTree_worstbest)
 				{
-					if (best_dist[best_index] > gKDTree_worstbest)
-					{
-						gKDTree_worstbest = best_dist[best_index];
-						gKDTree_worstbest_index = best_index;
-					}
+					gKDTree_worstbest = best_dist[best_index];
+					gKDTree_worstbest_index = best_index;
 				}
 			}
 		}
-		else
+	}
+	else
+	{
+		// We do not yet have a full roster of candidates, so if this one is qualified, it is in
+		if (d <= p_max_distance_sq)
 		{
-			// We do not yet have a full roster of candidates, so if this one is qualified, it is in
-			if (d <= max_distance_sq_)
+			// Replace the first empty entry
+			best_dist[gKDTree_found_count] = d;
+			best[gKDTree_found_count] = p_node;
+			
+			// Update the worst of the best as needed
+			if (d > gKDTree_worstbest)
 			{
-				// Replace the first empty entry
-				best_dist[gKDTree_found_count] = d;
-				best[gKDTree_found_count] = root;
-				
-				// Update the worst of the best as needed
-				if (d > gKDTree_worstbest)
-				{
-					gKDTree_worstbest = d;
-					gKDTree_worstbest_index = gKDTree_found_count;
-				}
-				
-				// Move to the next slot
-				gKDTree_found_count++;
+				gKDTree_worstbest = d;
+				gKDTree_worstbest_index = gKDTree_found_count;
 			}
+			
+			// Move to the next slot
+			gKDTree_found_count++;
 		}
 	}
+}
+
+// find N neighbors in 1D
+void InteractionType::FindNeighborsN_1(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist)
+{
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+			if (node->individual_index_ != p_focal_individual_index)
+				FindNeighborsN_Consider(node, dist_sq1(node, nd), p_count, best, best_dist, max_distance_sq_);
+		return;
+	}
+	
+	SLiM_kdNode *root = start + (end - start) / 2;
+	double d = dist_sq1(root, nd);
+#ifndef __clang_analyzer__
+	double dx = root->x[0] - nd[0];
+#else
+	double dx = 0.0;
+#endif
+	double dx2 = dx * dx;
+	
+	if (root->individual_index_ != p_focal_individual_index)
+		FindNeighborsN_Consider(root, d, p_count, best, best_dist, max_distance_sq_);
 	
 	// Continue the search
-	FindNeighborsN_1(dx > 0 ? root->left : root->right, nd, p_focal_individual_index, p_count, best, best_dist);
+	if (dx > 0)
+		FindNeighborsN_1(start, root, nd, p_focal_individual_index, p_count, best, best_dist);
+	else
+		FindNeighborsN_1(root + 1, end, nd, p_focal_individual_index, p_count, best, best_dist);
 	
 	if (gKDTree_found_count == p_count)
 	{
@@ -2387,72 +2866,43 @@ void InteractionType::FindNeighborsN_1(SLiM_kdNode *root, double *nd, slim_popsi
 		if (dx2 > max_distance_sq_) return;
 	}
 	
-	FindNeighborsN_1(dx > 0 ? root->right : root->left, nd, p_focal_individual_index, p_count, best, best_dist);
+	if (dx > 0)
+		FindNeighborsN_1(root + 1, end, nd, p_focal_individual_index, p_count, best, best_dist);
+	else
+		FindNeighborsN_1(start, root, nd, p_focal_individual_index, p_count, best, best_dist);
 }
 
 // find N neighbors in 2D
-void InteractionType::FindNeighborsN_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase)
+void InteractionType::FindNeighborsN_2(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase)
 {
-	if (!root) return;
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+			if (node->individual_index_ != p_focal_individual_index)
+				FindNeighborsN_Consider(node, dist_sq2(node, nd), p_count, best, best_dist, max_distance_sq_);
+		return;
+	}
 	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq2(root, nd);
 #ifndef __clang_analyzer__
-	double dx = root->x[p_phase] - nd[p_phase];
-#else
-	double dx = 0.0;
-#endif
-	double dx2 = dx * dx;
-	
-	if (root->individual_index_ != p_focal_individual_index)
-	{
-		if (gKDTree_found_count == p_count)
-		{
-			// We have a full roster of candidates, so now the question is, is this one better than the worst one?
-			if (d < gKDTree_worstbest)
-			{
-				// Replace the worst of the best
-				best_dist[gKDTree_worstbest_index] = d;
-				best[gKDTree_worstbest_index] = root;
-				
-				// Scan to find the new worst of the best
-				gKDTree_worstbest = -1;
-				
-				for (int best_index = 0; best_index < p_count; ++best_index)
-				{
-					if (best_dist[best_index] > gKDTree_worstbest)
-					{
-						gKDTree_worstbest = best_dist[best_index];
-						gKDTree_worstbest_index = best_index;
-					}
-				}
-			}
-		}
-		else
-		{
-			// We do not yet have a full roster of candidates, so if this one is qualified, it is in
-			if (d <= max_distance_sq_)
-			{
-				// Replace the first empty entry
-				best_dist[gKDTree_found_count] = d;
-				best[gKDTree_found_count] = root;
-				
-				// Update the worst of the best as needed
-				if (d > gKDTree_worstbest)
-				{
-					gKDTree_worstbest = d;
-					gKDTree_worstbest_index = gKDTree_found_count;
-				}
-				
-				// Move to the next slot
-				gKDTree_found_count++;
-			}
-		}
-	}
+	double dx = root->x[p_phase] - nd[p_phase];
+#else
+	double dx = 0.0;
+#endif
+	double dx2 = dx * dx;
+	
+	if (root->individual_index_ != p_focal_individual_index)
+		FindNeighborsN_Consider(root, d, p_count, best, best_dist, max_distance_sq_);
 	
 	// Continue the search
 	if (++p_phase >= 2) p_phase = 0;
 	
-	FindNeighborsN_2(dx > 0 ? root->left : root->right, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
+	if (dx > 0)
+		FindNeighborsN_2(start, root, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
+	else
+		FindNeighborsN_2(root + 1, end, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
 	
 	if (gKDTree_found_count == p_count)
 	{
@@ -2465,14 +2915,25 @@ void InteractionType::FindNeighborsN_2(SLiM_kdNode *root, double *nd, slim_popsi
 		if (dx2 > max_distance_sq_) return;
 	}
 	
-	FindNeighborsN_2(dx > 0 ? root->right : root->left, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
+	if (dx > 0)
+		FindNeighborsN_2(root + 1, end, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
+	else
+		FindNeighborsN_2(start, root, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
 }
 
 // find N neighbors in 3D
-void InteractionType::FindNeighborsN_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase)
+void InteractionType::FindNeighborsN_3(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase)
 {
-	if (!root) return;
+	if (end - start <= SLIM_KDTREE_BUCKET_SIZE)
+	{
+		// scan a leaf bucket
+		for (SLiM_kdNode *node = start; node < end; ++node)
+			if (node->individual_index_ != p_focal_individual_index)
+				FindNeighborsN_Consider(node, dist_sq3(node, nd), p_count, best, best_dist, max_distance_sq_);
+		return;
+	}
 	
+	SLiM_kdNode *root = start + (end - start) / 2;
 	double d = dist_sq3(root, nd);
 #ifndef __clang_analyzer__
 	double dx = root->x[p_phase] - nd[p_phase];
@@ -2482,68 +2943,242 @@ void InteractionType::FindNeighborsN_3(SLiM_kdNode *root, double *nd, slim_popsi
 	double dx2 = dx * dx;
 	
 	if (root->individual_index_ != p_focal_individual_index)
+		FindNeighborsN_Consider(root, d, p_count, best, best_dist, max_distance_sq_);
+	
+	// Continue the search
+	if (++p_phase >= 3) p_phase = 0;
+	
+	if (dx > 0)
+		FindNeighborsN_3(start, root, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
+	else
+		FindNeighborsN_3(root + 1, end, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
+	
+	if (gKDTree_found_count == p_count)
+	{
+		// If we now have a full roster, we are looking for better than our current worst of the best
+		if (dx2 >= gKDTree_worstbest) return;
+	}
+	else
+	{
+		// If we do not have a full roster, we are looking for better than the max distance
+		if (dx2 > max_distance_sq_) return;
+	}
+	
+	if (dx > 0)
+		FindNeighborsN_3(root + 1, end, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
+	else
+		FindNeighborsN_3(start, root, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
+}
+
+#pragma mark -
+#pragma mark uniform grid queries
+#pragma mark -
+
+// Collect the ranges of nodes in the cells around nd, which is the union of all cells that can contain neighbors within
+// maxDistance of nd; returns the number of ranges placed in p_ranges, which must have room for SLIM_GRID_MAX_RANGES.  Runs
+// of adjacent cells along x are contiguous in kd_nodes_, so each run becomes one range.  Along a periodic dimension, cell
+// indices that fall off either end wrap around to the other end, and the query point is shifted by the periodic bound to
+// compensate; this is equivalent to the replication of individuals that the k-d tree uses for periodicity.
+int InteractionType::GridRangesForPoint(InteractionsData &p_subpop_data, double *nd, SLiM_gridRange *p_ranges)
+{
+	bool periodic[SLIM_MAX_DIMENSIONALITY] = {periodic_x_, periodic_y_, periodic_z_};
+	double bounds[SLIM_MAX_DIMENSIONALITY] = {p_subpop_data.bounds_x1_, p_subpop_data.bounds_y1_, p_subpop_data.bounds_z1_};
+	int *grid_cells = p_subpop_data.grid_cells_;
+	int segment_count[SLIM_MAX_DIMENSIONALITY];
+	int segment_first[SLIM_MAX_DIMENSIONALITY][3], segment_last[SLIM_MAX_DIMENSIONALITY][3];
+	double segment_point[SLIM_MAX_DIMENSIONALITY][3];
+	
+	// Along each dimension, find the one to three cells around nd, as segments of consecutive cells with the same shift
+	for (int dim = 0; dim < SLIM_MAX_DIMENSIONALITY; ++dim)
 	{
-		if (gKDTree_found_count == p_count)
+		int cells = grid_cells[dim];
+		
+		if (dim >= spatiality_)
 		{
-			// We have a full roster of candidates, so now the question is, is this one better than the worst one?
-			if (d < gKDTree_worstbest)
+			segment_count[dim] = 1;
+			segment_first[dim][0] = 0;
+			segment_last[dim][0] = 0;
+			segment_point[dim][0] = 0.0;
+			continue;
+		}
+		
+		// clamp the cell coordinate in floating point before converting it, since the point may be anywhere (or NaN)
+		double cell_float = floor((nd[dim] - p_subpop_data.grid_origin_[dim]) * p_subpop_data.grid_inv_width_[dim]);
+		
+		if (!(cell_float >= -2.0 * cells))
+			cell_float = -2.0 * cells;
+		else if (cell_float > 3.0 * cells)
+			cell_float = 3.0 * cells;
+		
+		int cell = (int)cell_float;
+		
+		if (periodic[dim])
+		{
+			int count = 0, previous_wrap = INT_MIN;
+			
+			for (int virtual_cell = cell - 1; virtual_cell <= cell + 1; ++virtual_cell)
 			{
-				// Replace the worst of the best
-				best_dist[gKDTree_worstbest_index] = d;
-				best[gKDTree_worstbest_index] = root;
-				
-				// Scan to find the new worst of the best
-				gKDTree_worstbest = -1;
+				int wrap = (virtual_cell >= 0) ? (virtual_cell / cells) : -((cells - 1 - virtual_cell) / cells);
+				int wrapped_cell = virtual_cell - wrap * cells;
 				
-				for (int best_index = 0; best_index < p_count; ++best_index)
+				if (wrap == previous_wrap)
 				{
-					if (best_dist[best_index] > gKDTree_worstbest)
-					{
-						gKDTree_worstbest = best_dist[best_index];
-						gKDTree_worstbest_index = best_index;
-					}
+					segment_last[dim][count - 1] = wrapped_cell;
+				}
+				else
+				{
+					segment_first[dim][count] = wrapped_cell;
+					segment_last[dim][count] = wrapped_cell;
+					segment_point[dim][count] = nd[dim] - wrap * bounds[dim];
+					previous_wrap = wrap;
+					count++;
 				}
 			}
+			
+			segment_count[dim] = count;
 		}
 		else
 		{
-			// We do not yet have a full roster of candidates, so if this one is qualified, it is in
-			if (d <= max_distance_sq_)
-			{
-				// Replace the first empty entry
-				best_dist[gKDTree_found_count] = d;
-				best[gKDTree_found_count] = root;
-				
-				// Update the worst of the best as needed
-				if (d > gKDTree_worstbest)
-				{
-					gKDTree_worstbest = d;
-					gKDTree_worstbest_index = gKDTree_found_count;
-				}
-				
-				// Move to the next slot
-				gKDTree_found_count++;
-			}
+			int first = std::max(cell - 1, 0);
+			int last = std::min(cell + 1, cells - 1);
+			
+			if (first > last)
+				return 0;
+			
+			segment_count[dim] = 1;
+			segment_first[dim][0] = first;
+			segment_last[dim][0] = last;
+			segment_point[dim][0] = nd[dim];
 		}
 	}
 	
-	// Continue the search
-	if (++p_phase >= 3) p_phase = 0;
+	// Assemble ranges from the segments; each run of cells along x, at a given y and z, is one range
+	SLiM_kdNode *nodes = p_subpop_data.kd_nodes_;
+	slim_popsize_t *cell_starts = p_subpop_data.grid_cell_starts_;
+	int range_count = 0;
 	
-	FindNeighborsN_3(dx > 0 ? root->left : root->right, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
+	for (int z_segment = 0; z_segment < segment_count[2]; ++z_segment)
+		for (int z = segment_first[2][z_segment]; z <= segment_last[2][z_segment]; ++z)
+			for (int y_segment = 0; y_segment < segment_count[1]; ++y_segment)
+				for (int y = segment_first[1][y_segment]; y <= segment_last[1][y_segment]; ++y)
+				{
+					slim_popsize_t row_start = (z * grid_cells[1] + y) * grid_cells[0];
+					
+					for (int x_segment = 0; x_segment < segment_count[0]; ++x_segment)
+					{
+						slim_popsize_t start = cell_starts[row_start + segment_first[0][x_segment]];
+						slim_popsize_t end = cell_starts[row_start + segment_last[0][x_segment] + 1];
+						
+						if (start == end)
+							continue;
+						
+						SLiM_gridRange *range = p_ranges + range_count++;
+						
+						range->start_ = nodes + start;
+						range->end_ = nodes + end;
+						range->point_[0] = segment_point[0][x_segment];
+						range->point_[1] = segment_point[1][y_segment];
+						range->point_[2] = segment_point[2][z_segment];
+					}
+				}
 	
-	if (gKDTree_found_count == p_count)
+	return range_count;
+}
+
+// the squared distance from a grid node to a grid range's query point; the coordinates beyond the spatiality are zero in both
+static inline __attribute__((always_inline)) double dist_sq_grid(SLiM_kdNode *a, double *b)
+{
+	double t, d;
+	
+	t = a->x[0] - b[0];
+	d = t * t;
+	
+	t = a->x[1] - b[1];
+	d += t * t;
+	
+	t = a->x[2] - b[2];
+	d += t * t;
+	
+	return d;
+}
+
+// add neighbors to the sparse array using the grid; exerters outside [start_exerter, after_end_exerter) are excluded
+void InteractionType::BuildSA_Grid(InteractionsData &p_subpop_data, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter)
+{
+	SLiM_gridRange ranges[SLIM_GRID_MAX_RANGES];
+	int range_count = GridRangesForPoint(p_subpop_data, nd, ranges);
+	
+	for (int range_index = 0; range_index < range_count; ++range_index)
 	{
-		// If we now have a full roster, we are looking for better than our current worst of the best
-		if (dx2 >= gKDTree_worstbest) return;
+		SLiM_gridRange &range = ranges[range_index];
+		
+		for (SLiM_kdNode *node = range.start_; node < range.end_; ++node)
+		{
+			double d = dist_sq_grid(node, range.point_);
+			slim_popsize_t exerter_index = node->individual_index_;
+			
+			if ((d <= max_distance_sq_) && (exerter_index != p_focal_individual_index) && (exerter_index >= start_exerter) && (exerter_index < after_end_exerter))
+				p_sparse_array->AddEntryDistance(p_focal_individual_index, exerter_index, (sa_distance_t)sqrt(d));
+		}
 	}
-	else
+}
+
+// find the one best neighbor using the grid; unlike FindNeighbors1_X(), this only finds neighbors within the maximum distance
+void InteractionType::FindNeighbors1_Grid(InteractionsData &p_subpop_data, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist)
+{
+	SLiM_gridRange ranges[SLIM_GRID_MAX_RANGES];
+	int range_count = GridRangesForPoint(p_subpop_data, nd, ranges);
+	
+	for (int range_index = 0; range_index < range_count; ++range_index)
 	{
-		// If we do not have a full roster, we are looking for better than the max distance
-		if (dx2 > max_distance_sq_) return;
+		SLiM_gridRange &range = ranges[range_index];
+		
+		for (SLiM_kdNode *node = range.start_; node < range.end_; ++node)
+		{
+			double d = dist_sq_grid(node, range.point_);
+			
+			if ((!*best || d < *best_dist) && (node->individual_index_ != p_focal_individual_index)) {
+				*best_dist = d;
+				*best = node;
+			}
+		}
+	}
+}
+
+// find all neighbors using the grid
+void InteractionType::FindNeighborsA_Grid(InteractionsData &p_subpop_data, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals)
+{
+	SLiM_gridRange ranges[SLIM_GRID_MAX_RANGES];
+	int range_count = GridRangesForPoint(p_subpop_data, nd, ranges);
+	
+	for (int range_index = 0; range_index < range_count; ++range_index)
+	{
+		SLiM_gridRange &range = ranges[range_index];
+		
+		for (SLiM_kdNode *node = range.start_; node < range.end_; ++node)
+		{
+			double d = dist_sq_grid(node, range.point_);
+			
+			if ((d <= max_distance_sq_) && (node->individual_index_ != p_focal_individual_index))
+				p_result_vec.push_object_element(p_individuals[node->individual_index_]);
+		}
 	}
+}
+
+// find N neighbors using the grid
+void InteractionType::FindNeighborsN_Grid(InteractionsData &p_subpop_data, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist)
+{
+	SLiM_gridRange ranges[SLIM_GRID_MAX_RANGES];
+	int range_count = GridRangesForPoint(p_subpop_data, nd, ranges);
 	
-	FindNeighborsN_3(dx > 0 ? root->right : root->left, nd, p_focal_individual_index, p_count, best, best_dist, p_phase);
+	for (int range_index = 0; range_index < range_count; ++range_index)
+	{
+		SLiM_gridRange &range = ranges[range_index];
+		
+		for (SLiM_kdNode *node = range.start_; node < range.end_; ++node)
+			if (node->individual_index_ != p_focal_individual_index)
+				FindNeighborsN_Consider(node, dist_sq_grid(node, range.point_), p_count, best, best_dist, max_distance_sq_);
+	}
 }
 
 void InteractionType::FindNeighbors(Subpopulation *p_subpop, InteractionsData &p_subpop_data, double *p_point, int p_count, EidosValue_Object_vector &p_result_vec, Individual *p_excluded_individual)
@@ -2554,11 +3189,11 @@ void InteractionType::FindNeighbors(Subpopulation *p_subpop, InteractionsData &p
 	}
 	else if (!p_subpop_data.kd_nodes_)
 	{
-		EIDOS_TERMINATION << "ERROR (InteractionType::FindNeighbors): (internal error) the k-d tree has not been constructed." << EidosTerminate();
+		EIDOS_TERMINATION << "ERROR (InteractionType::FindNeighbors): (internal error) the spatial index has not been constructed." << EidosTerminate();
 	}
-	else if (!p_subpop_data.kd_root_)
+	else if (p_subpop_data.kd_node_count_ == 0)
 	{
-		EIDOS_TERMINATION << "ERROR (InteractionType::FindNeighbors): (internal error) the k-d tree is rootless." << EidosTerminate();
+		EIDOS_TERMINATION << "ERROR (InteractionType::FindNeighbors): (internal error) the spatial index is empty." << EidosTerminate();
 	}
 	else
 	{
@@ -2578,11 +3213,13 @@ void InteractionType::FindNeighbors(Subpopulation *p_subpop, InteractionsData &p
 			SLiM_kdNode *best = nullptr;
 			double best_dist = 0.0;
 			
-			switch (spatiality_)
+			if (p_subpop_data.grid_cell_starts_)
+				FindNeighbors1_Grid(p_subpop_data, p_point, focal_individual_index, &best, &best_dist);
+			else switch (spatiality_)
 			{
-				case 1: FindNeighbors1_1(p_subpop_data.kd_root_, p_point, focal_individual_index, &best, &best_dist);		break;
-				case 2: FindNeighbors1_2(p_subpop_data.kd_root_, p_point, focal_individual_index, &best, &best_dist, 0);	break;
-				case 3: FindNeighbors1_3(p_subpop_data.kd_root_, p_point, focal_individual_index, &best, &best_dist, 0);	break;
+				case 1: FindNeighbors1_1(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, p_point, focal_individual_index, &best, &best_dist);		break;
+				case 2: FindNeighbors1_2(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, p_point, focal_individual_index, &best, &best_dist, 0);	break;
+				case 3: FindNeighbors1_3(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, p_point, focal_individual_index, &best, &best_dist, 0);	break;
 			}
 			
 			if (best && (best_dist <= max_distance_sq_))
@@ -2595,11 +3232,13 @@ void InteractionType::FindNeighbors(Subpopulation *p_subpop, InteractionsData &p
 		else if (p_count >= p_subpop_data.individual_count_ - 1)	// -1 because the focal individual is excluded
 		{
 			// Finding all neighbors within the interaction distance is special-cased
-			switch (spatiality_)
+			if (p_subpop_data.grid_cell_starts_)
+				FindNeighborsA_Grid(p_subpop_data, p_point, focal_individual_index, p_result_vec, p_subpop->parent_individuals_);
+			else switch (spatiality_)
 			{
-				case 1: FindNeighborsA_1(p_subpop_data.kd_root_, p_point, focal_individual_index, p_result_vec, p_subpop->parent_individuals_);			break;
-				case 2: FindNeighborsA_2(p_subpop_data.kd_root_, p_point, focal_individual_index, p_result_vec, p_subpop->parent_individuals_, 0);		break;
-				case 3: FindNeighborsA_3(p_subpop_data.kd_root_, p_point, focal_individual_index, p_result_vec, p_subpop->parent_individuals_, 0);		break;
+				case 1: FindNeighborsA_1(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, p_point, focal_individual_index, p_result_vec, p_subpop->parent_individuals_);			break;
+				case 2: FindNeighborsA_2(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, p_point, focal_individual_index, p_result_vec, p_subpop->parent_individuals_, 0);		break;
+				case 3: FindNeighborsA_3(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, p_point, focal_individual_index, p_result_vec, p_subpop->parent_individuals_, 0);		break;
 			}
 		}
 		else
@@ -2613,11 +3252,13 @@ void InteractionType::FindNeighbors(Subpopulation *p_subpop, InteractionsData &p
 			gKDTree_found_count = 0;
 			gKDTree_worstbest = -1;
 			
-			switch (spatiality_)
+			if (p_subpop_data.grid_cell_starts_)
+				FindNeighborsN_Grid(p_subpop_data, p_point, focal_individual_index, p_count, best, best_dist);
+			else switch (spatiality_)
 			{
-				case 1: FindNeighborsN_1(p_subpop_data.kd_root_, p_point, focal_individual_index, p_count, best, best_dist);		break;
-				case 2: FindNeighborsN_2(p_subpop_data.kd_root_, p_point, focal_individual_index, p_count, best, best_dist, 0);		break;
-				case 3: FindNeighborsN_3(p_subpop_data.kd_root_, p_point, focal_individual_index, p_count, best, best_dist, 0);		break;
+				case 1: FindNeighborsN_1(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, p_point, focal_individual_index, p_count, best, best_dist);		break;
+				case 2: FindNeighborsN_2(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, p_point, focal_individual_index, p_count, best, best_dist, 0);		break;
+				case 3: FindNeighborsN_3(p_subpop_data.kd_nodes_, p_subpop_data.kd_nodes_ + p_subpop_data.kd_node_count_, p_point, focal_individual_index, p_count, best, best_dist, 0);		break;
 			}
 			
 			for (int best_index = 0; best_index < p_count; ++best_index)
@@ -2700,6 +3341,8 @@ EidosValue_SP InteractionType::GetProperty(EidosGlobalStringID p_property_id)
 			// variables
 		case gID_maxDistance:
 			return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(max_distance_));
+		case gID_fastMath:
+			return (fast_math_ ? gStaticEidosValue_LogicalT : gStaticEidosValue_LogicalF);
 		case gID_tag:						// ACCELERATED
 		{
 			slim_usertag_t tag_value = tag_value_;
@@ -2766,12 +3409,25 @@ void InteractionType::SetProperty(EidosGlobalStringID p_property_id, const Eidos
 			if ((if_type_ == IFType::kLinear) && (std::isinf(max_distance_) || (max_distance_ <= 0.0)))
 				EIDOS_TERMINATION << "ERROR (InteractionType::SetProperty): the maximum interaction distance must be finite and greater than zero when interaction type 'l' has been chosen." << EidosTerminate();
 			
+			// a grid kept from a previous evaluation was sized for the old maxDistance, so spatial indices cannot be reused
+			for (auto &data_iter : data_)
+				DiscardSpatialIndex(data_iter.second);
+			
 			// tweak a flag to make SLiMgui update
 			sim_.interaction_types_changed_ = true;
 			
 			return;
 		}
 			
+		case gID_fastMath:
+		{
+			if (AnyEvaluated())
+				EIDOS_TERMINATION << "ERROR (InteractionType::SetProperty): fastMath cannot be changed while the interaction is being evaluated; call unevaluate() first, or set fastMath prior to evaluation of the interaction." << EidosTerminate();
+			
+			fast_math_ = p_value.LogicalAtIndex(0, nullptr);
+			return;
+		}
+			
 		case gID_tag:
 		{
 			slim_usertag_t value = SLiMCastToUsertagTypeOrRaise(p_value.IntAtIndex(0, nullptr));
@@ -2794,6 +3450,7 @@ EidosValue_SP InteractionType::ExecuteInstanceMethod(EidosGlobalStringID p_metho
 		case gID_distance:					return ExecuteMethod_distance(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_distanceToPoint:			return ExecuteMethod_distanceToPoint(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_drawByStrength:			return ExecuteMethod_drawByStrength(p_method_id, p_arguments, p_argument_count, p_interpreter);
+		case gID_drawIndexByStrength:		return ExecuteMethod_drawIndexByStrength(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_evaluate:					return ExecuteMethod_evaluate(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_interactingNeighborCount:	return ExecuteMethod_interactingNeighborCount(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_interactionDistance:		return ExecuteMethod_interactionDistance(p_method_id, p_arguments, p_argument_count, p_interpreter);
@@ -3015,6 +3672,37 @@ EidosValue_SP InteractionType::ExecuteMethod_distanceToPoint(EidosGlobalStringID
 	return EidosValue_SP(result_vec);
 }
 
+// a helper function for DrawByWeights() and ExecuteMethod_drawIndexByStrength() that does a single draw by linear search
+template <typename T>
+static inline int DrawOneByWeights(const T *weights, int n_weights, double weight_total)
+{
+	double the_rose_in_the_teeth = Eidos_rng_uniform(EIDOS_GSL_RNG) * weight_total;
+	double cumulative_weight = 0.0;
+	int hit_index;
+	
+	for (hit_index = 0; hit_index < n_weights; ++hit_index)
+	{
+		double weight = weights[hit_index];
+		
+		cumulative_weight += weight;
+		
+		if (the_rose_in_the_teeth <= cumulative_weight)
+			break;
+	}
+	
+	// We might overrun the end, due to roundoff error; if so, attribute it to the first non-zero weight entry
+	if (hit_index >= n_weights)
+	{
+		for (hit_index = 0; hit_index < n_weights; ++hit_index)
+			if (weights[hit_index] > 0.0)
+				break;
+		if (hit_index >= n_weights)
+			hit_index = 0;
+	}
+	
+	return hit_index;
+}
+
 // a helper function for ExecuteMethod_drawByStrength() that does the draws using a vector of weights
 static void DrawByWeights(int draw_count, const double *weights, int n_weights, double weight_total, std::vector<int> &draw_indices)
 {
@@ -3028,8 +3716,15 @@ static void DrawByWeights(int draw_count, const double *weights, int n_weights,
 	// than the GSL; and for large counts the GSL is surely a win.  Trying to figure out exactly where
 	// the crossover is in all cases would be overkill; my testing indicates the performance difference
 	// between the two methods is not really that large anyway.
+	// gsl_ran_discrete_preproc() builds a Walker alias table, so above the crossover each draw is O(1) after
+	// O(n) setup, once per call.  Below the crossover we used to do a linear search for every draw, making a call O(count * n);
+	// now, for more than one draw, we accumulate the weights once and binary-search the cumulative weights for each draw instead.
+	// That makes exactly the same choices as the linear search (for non-negative weights), since the same partial sums are
+	// compared against the same random deviates, so results for a given random number seed are unchanged.
 	if (weight_total > 0.0)
 	{
+		draw_indices.reserve(draw_indices.size() + draw_count);
+		
 		if (draw_count > 50)		// the empirically determined crossover point in performance
 		{
 			// Use gsl_ran_discrete() to do the drawing
@@ -3044,24 +3739,22 @@ static void DrawByWeights(int draw_count, const double *weights, int n_weights,
 			
 			gsl_ran_discrete_free(gsl_lookup);
 		}
-		else
+		else if (draw_count > 1)
 		{
-			// Use linear search to do the drawing
+			// Use binary search on the cumulative weights to do the drawing
+			std::vector<double> cumulative_weights(n_weights);
+			double cumulative_weight = 0.0;
+			
+			for (int weight_index = 0; weight_index < n_weights; ++weight_index)
+			{
+				cumulative_weight += weights[weight_index];
+				cumulative_weights[weight_index] = cumulative_weight;
+			}
+			
 			for (int64_t draw_index = 0; draw_index < draw_count; ++draw_index)
 			{
 				double the_rose_in_the_teeth = Eidos_rng_uniform(EIDOS_GSL_RNG) * weight_total;
-				double cumulative_weight = 0.0;
-				int hit_index;
-				
-				for (hit_index = 0; hit_index < n_weights; ++hit_index)
-				{
-					double weight = weights[hit_index];
-					
-					cumulative_weight += weight;
-					
-					if (the_rose_in_the_teeth <= cumulative_weight)
-						break;
-				}
+				int hit_index = (int)(std::lower_bound(cumulative_weights.begin(), cumulative_weights.end(), the_rose_in_the_teeth) - cumulative_weights.begin());
 				
 				// We might overrun the end, due to roundoff error; if so, attribute it to the first non-zero weight entry
 				if (hit_index >= n_weights)
@@ -3076,7 +3769,50 @@ static void DrawByWeights(int draw_count, const double *weights, int n_weights,
 				draw_indices.push_back(hit_index);
 			}
 		}
+		else
+		{
+			// Use linear search to do the drawing
+			for (int64_t draw_index = 0; draw_index < draw_count; ++draw_index)
+				draw_indices.push_back(DrawOneByWeights(weights, n_weights, weight_total));
+		}
+	}
+}
+
+// a helper function for ExecuteMethod_drawByStrength() and ExecuteMethod_drawIndexByStrength() that calculates the strengths
+// exerted upon a receiver by all individuals in its subpopulation, for a non-spatial interaction, and returns their total
+double InteractionType::CalculateNonspatialStrengthsForReceiver(Individual *p_receiver, Subpopulation *p_subpop, InteractionsData &p_subpop_data, std::vector<double> &p_strengths)
+{
+	std::vector<SLiMEidosBlock*> &callbacks = p_subpop_data.evaluation_interaction_callbacks_;
+	bool no_callbacks = (callbacks.size() == 0);
+	std::vector<Individual *> &individuals = p_subpop->parent_individuals_;
+	slim_popsize_t subpop_size = p_subpop->parent_subpop_size_;
+	slim_popsize_t receiver_index = p_receiver->index_;
+	double total_interaction_strength = 0.0;
+	
+	p_strengths.clear();
+	p_strengths.reserve(subpop_size);
+	
+	for (slim_popsize_t exerter_index_in_subpop = 0; exerter_index_in_subpop < subpop_size; ++exerter_index_in_subpop)
+	{
+		Individual *exerter = individuals[exerter_index_in_subpop];
+		double strength = 0;
+		
+		if (exerter_index_in_subpop != receiver_index)
+		{
+			if ((exerter_sex_ == IndividualSex::kUnspecified) || (exerter_sex_ == exerter->sex_))
+			{
+				if (no_callbacks)
+					strength = CalculateStrengthNoCallbacks(NAN);
+				else
+					strength = CalculateStrengthWithCallbacks(NAN, p_receiver, exerter, p_subpop, callbacks);
+			}
+		}
+		
+		total_interaction_strength += strength;
+		p_strengths.emplace_back(strength);
 	}
+	
+	return total_interaction_strength;
 }
 
 //	*********************	– (object<Individual>)drawByStrength(object<Individual>$ individual, [integer$ count = 1])
@@ -3119,32 +3855,10 @@ EidosValue_SP InteractionType::ExecuteMethod_drawByStrength(EidosGlobalStringID
 	
 	if (spatiality_ == 0)
 	{
-		std::vector<SLiMEidosBlock*> &callbacks = subpop_data.evaluation_interaction_callbacks_;
-		bool no_callbacks = (callbacks.size() == 0);
 		EidosValue_Object_vector *result_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class));
-		double total_interaction_strength = 0.0;
 		std::vector<double> cached_strength;
 		std::vector<Individual *> &individuals = subpop->parent_individuals_;
-		
-		for (slim_popsize_t exerter_index_in_subpop = 0; exerter_index_in_subpop < subpop_size; ++exerter_index_in_subpop)
-		{
-			Individual *exerter = individuals[exerter_index_in_subpop];
-			double strength = 0;
-			
-			if (exerter_index_in_subpop != ind_index)
-			{
-				if ((exerter_sex_ == IndividualSex::kUnspecified) || (exerter_sex_ == exerter->sex_))
-				{
-					if (no_callbacks)
-						strength = CalculateStrengthNoCallbacks(NAN);
-					else
-						strength = CalculateStrengthWithCallbacks(NAN, individual, exerter, subpop, callbacks);
-				}
-			}
-			
-			total_interaction_strength += strength;
-			cached_strength.emplace_back(strength);
-		}
+		double total_interaction_strength = CalculateNonspatialStrengthsForReceiver(individual, subpop, subpop_data, cached_strength);
 		
 		if (total_interaction_strength > 0.0)
 		{
@@ -3180,6 +3894,8 @@ EidosValue_SP InteractionType::ExecuteMethod_drawByStrength(EidosGlobalStringID
 		// Total the interaction strengths, and gather a vector of strengths as doubles
 		double total_interaction_strength = 0.0;
 		
+		double_strengths.reserve(row_nnz);
+		
 		for (uint32_t col_index = 0; col_index < row_nnz; ++col_index)
 		{
 			sa_strength_t strength = strengths[col_index];
@@ -3212,6 +3928,80 @@ EidosValue_SP InteractionType::ExecuteMethod_drawByStrength(EidosGlobalStringID
 	}
 }
 
+//	*********************	– (integer)drawIndexByStrength(object<Individual> receivers)
+//
+EidosValue_SP InteractionType::ExecuteMethod_drawIndexByStrength(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
+{
+#pragma unused (p_method_id, p_arguments, p_argument_count, p_interpreter)
+	EidosValue *receivers_value = p_arguments[0].get();
+	int receivers_count = receivers_value->Count();
+	EidosValue_Int_vector *result_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(receivers_count);
+	
+	// This draws one exerter for each receiver, the vectorized equivalent of calling drawByStrength() once per receiver; each
+	// receiver's row of strengths is used in place, with a single linear search, and the subpop-level bookkeeping is done only
+	// when the subpopulation changes.  Indices are returned rather than individuals, so that receivers with no interacting
+	// exerters can be represented, by -1.
+	Subpopulation *subpop = nullptr;
+	InteractionsData *subpop_data = nullptr;
+	std::vector<double> cached_strength;
+	
+	for (int receiver_index = 0; receiver_index < receivers_count; ++receiver_index)
+	{
+		Individual *receiver = (Individual *)receivers_value->ObjectElementAtIndex(receiver_index, nullptr);
+		Subpopulation *receiver_subpop = &(receiver->subpopulation_);
+		slim_popsize_t receiver_index_in_subpop = receiver->index_;
+		int64_t drawn_index = -1;
+		
+		if (receiver_index_in_subpop < 0)
+			EIDOS_TERMINATION << "ERROR (InteractionType::ExecuteMethod_drawIndexByStrength): drawIndexByStrength() requires that the receivers are visible in a subpopulation (i.e., not new juveniles)." << EidosTerminate();
+		
+		if (receiver_subpop != subpop)
+		{
+			// switched subpops, so make sure we're up to speed
+			subpop = receiver_subpop;
+			
+			auto subpop_data_iter = data_.find(subpop->subpopulation_id_);
+			
+			if ((subpop_data_iter == data_.end()) || !subpop_data_iter->second.evaluated_)
+				EIDOS_TERMINATION << "ERROR (InteractionType::ExecuteMethod_drawIndexByStrength): drawIndexByStrength() requires that the interaction has been evaluated for the subpopulation first." << EidosTerminate();
+			
+			subpop_data = &subpop_data_iter->second;
+			
+			if (spatiality_ > 0)
+				CalculateAllStrengths(subpop);
+		}
+		
+		// If the individual cannot receive this interaction type, no draw can occur
+		if ((receiver_sex_ == IndividualSex::kUnspecified) || (receiver_sex_ == receiver->sex_))
+		{
+			if (spatiality_ == 0)
+			{
+				double total_interaction_strength = CalculateNonspatialStrengthsForReceiver(receiver, subpop, *subpop_data, cached_strength);
+				
+				if (total_interaction_strength > 0.0)
+					drawn_index = DrawOneByWeights(cached_strength.data(), (int)cached_strength.size(), total_interaction_strength);
+			}
+			else
+			{
+				uint32_t row_nnz;
+				const uint32_t *row_columns;
+				const sa_strength_t *strengths = subpop_data->dist_str_->StrengthsForRow(receiver_index_in_subpop, &row_nnz, &row_columns);
+				double total_interaction_strength = 0.0;
+				
+				for (uint32_t col_index = 0; col_index < row_nnz; ++col_index)
+					total_interaction_strength += strengths[col_index];
+				
+				if (total_interaction_strength > 0.0)
+					drawn_index = row_columns[DrawOneByWeights(strengths, (int)row_nnz, total_interaction_strength)];
+			}
+		}
+		
+		result_vec->set_int_no_check(drawn_index, receiver_index);
+	}
+	
+	return EidosValue_SP(result_vec);
+}
+
 //	*********************	- (void)evaluate([No<Subpopulation> subpops = NULL], [logical$ immediate = F])
 //
 EidosValue_SP InteractionType::ExecuteMethod_evaluate(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
@@ -3296,6 +4086,24 @@ EidosValue_SP InteractionType::ExecuteMethod_interactingNeighborCount(EidosGloba
 		if ((subpop_data_iter == data_.end()) || !subpop_data_iter->second.evaluated_)
 			EIDOS_TERMINATION << "ERROR (InteractionType::ExecuteMethod_interactingNeighborCount): interactingNeighborCount() requires that the interaction has been evaluated for the subpopulation first." << EidosTerminate();
 		
+		// If the sparse array has not been built, try to stream the counts without building it; see StreamNeighborTotals()
+		if (!subpop_data_iter->second.distances_calculated_)
+		{
+			std::vector<double> totals;
+			
+			if (StreamNeighborTotals(subpop, subpop_data_iter->second, individual_value, true, totals))
+			{
+				for (int focal_ind_index = 0; focal_ind_index < individual_count; ++focal_ind_index)
+				{
+					Individual *individual = (Individual *)individual_value->ObjectElementAtIndex(focal_ind_index, nullptr);
+					
+					result_vec->set_int_no_check((int64_t)totals[individual->index_], focal_ind_index);
+				}
+				
+				return EidosValue_SP(result_vec);
+			}
+		}
+		
 		CalculateAllDistances(subpop);
 		
 		SparseArray *sa = subpop_data_iter->second.dist_str_;
@@ -3571,7 +4379,7 @@ EidosValue_SP InteractionType::ExecuteMethod_nearestNeighbors(EidosGlobalStringI
 	double *position_data = subpop_data.positions_;
 	double *ind_position = position_data + ind_index * SLIM_MAX_DIMENSIONALITY;
 	
-	EnsureKDTreePresent(subpop_data);
+	EnsureSpatialIndexPresent(subpop_data);
 	
 	EidosValue_Object_vector *result_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class))->reserve((int)count);
 	
@@ -3625,7 +4433,7 @@ EidosValue_SP InteractionType::ExecuteMethod_nearestNeighborsOfPoint(EidosGlobal
 	// Find the neighbors
 	InteractionsData &subpop_data = subpop_data_iter->second;
 	
-	EnsureKDTreePresent(subpop_data);
+	EnsureSpatialIndexPresent(subpop_data);
 	
 	EidosValue_Object_vector *result_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class))->reserve((int)count);
 	
@@ -3938,6 +4746,26 @@ EidosValue_SP InteractionType::ExecuteMethod_totalOfNeighborStrengths(EidosGloba
 	
 	InteractionsData &subpop_data = subpop_data_iter->second;
 	
+	// If the sparse array has not been built, try to stream the totals without building it; see StreamNeighborTotals()
+	if ((count > 1) && !subpop_data.distances_calculated_ && (subpop_data.evaluation_interaction_callbacks_.size() == 0))
+	{
+		std::vector<double> totals;
+		
+		if (StreamNeighborTotals(subpop, subpop_data, individuals, false, totals))
+		{
+			EidosValue_Float_vector *result_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(count);
+			
+			for (int ind_index = 0; ind_index < count; ++ind_index)
+			{
+				Individual *individual = (Individual *)individuals->ObjectElementAtIndex(ind_index, nullptr);
+				
+				result_vec->set_float_no_check(totals[individual->index_], ind_index);
+			}
+			
+			return EidosValue_SP(result_vec);
+		}
+	}
+	
 	CalculateAllStrengths(subpop);
 	
 	if (count == 1)
@@ -4055,6 +4883,7 @@ const std::vector<EidosPropertySignature_CSP> *InteractionType_Class::Properties
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_sexSegregation,	true,	kEidosValueMaskString | kEidosValueMaskSingleton)));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_spatiality,		true,	kEidosValueMaskString | kEidosValueMaskSingleton)));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_maxDistance,	false,	kEidosValueMaskFloat | kEidosValueMaskSingleton)));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_fastMath,		false,	kEidosValueMaskLogical | kEidosValueMaskSingleton)));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_tag,			false,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(InteractionType::GetProperty_Accelerated_tag));
 		
 		std::sort(properties->begin(), properties->end(), CompareEidosPropertySignatures);
@@ -4074,6 +4903,7 @@ const std::vector<EidosMethodSignature_CSP> *InteractionType_Class::Methods(void
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_distance, kEidosValueMaskFloat))->AddObject("individuals1", gSLiM_Individual_Class)->AddObject_ON("individuals2", gSLiM_Individual_Class, gStaticEidosValueNULL));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_distanceToPoint, kEidosValueMaskFloat))->AddObject("individuals1", gSLiM_Individual_Class)->AddFloat("point"));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_drawByStrength, kEidosValueMaskObject, gSLiM_Individual_Class))->AddObject_S("individual", gSLiM_Individual_Class)->AddInt_OS("count", gStaticEidosValue_Integer1));
+		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_drawIndexByStrength, kEidosValueMaskInt))->AddObject("receivers", gSLiM_Individual_Class));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_evaluate, kEidosValueMaskVOID))->AddObject_ON("subpops", gSLiM_Subpopulation_Class, gStaticEidosValueNULL)->AddLogical_OS("immediate", gStaticEidosValue_LogicalF));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_interactingNeighborCount, kEidosValueMaskInt))->AddObject("individuals", gSLiM_Individual_Class));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_interactionDistance, kEidosValueMaskFloat))->AddObject_S("receiver", gSLiM_Individual_Class)->AddObject_ON("exerters", gSLiM_Individual_Class, gStaticEidosValueNULL));
@@ -4108,8 +4938,12 @@ _InteractionsData::_InteractionsData(_InteractionsData&& p_source)
 	kd_node_count_ = p_source.kd_node_count_;
 	positions_ = p_source.positions_;
 	dist_str_ = p_source.dist_str_;
+	stream_sa_ = p_source.stream_sa_;
 	kd_nodes_ = p_source.kd_nodes_;
-	kd_root_ = p_source.kd_root_;
+	grid_cell_starts_ = p_source.grid_cell_starts_;
+	std::copy(p_source.grid_cells_, p_source.grid_cells_ + SLIM_MAX_DIMENSIONALITY, grid_cells_);
+	std::copy(p_source.grid_origin_, p_source.grid_origin_ + SLIM_MAX_DIMENSIONALITY, grid_origin_);
+	std::copy(p_source.grid_inv_width_, p_source.grid_inv_width_ + SLIM_MAX_DIMENSIONALITY, grid_inv_width_);
 	
 	p_source.evaluated_ = false;
 	p_source.evaluation_interaction_callbacks_.clear();
@@ -4118,8 +4952,9 @@ _InteractionsData::_InteractionsData(_InteractionsData&& p_source)
 	p_source.kd_node_count_ = 0;
 	p_source.positions_ = nullptr;
 	p_source.dist_str_ = nullptr;
+	p_source.stream_sa_ = nullptr;
 	p_source.kd_nodes_ = nullptr;
-	p_source.kd_root_ = nullptr;
+	p_source.grid_cell_starts_ = nullptr;
 }
 
 _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
@@ -4130,8 +4965,12 @@ _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
 			free(positions_);
 		if (dist_str_)
 			delete dist_str_;
+		if (stream_sa_)
+			delete stream_sa_;
 		if (kd_nodes_)
 			free(kd_nodes_);
+		if (grid_cell_starts_)
+			free(grid_cell_starts_);
 		
 		evaluated_ = p_source.evaluated_;
 		evaluation_interaction_callbacks_.swap(p_source.evaluation_interaction_callbacks_);
@@ -4140,8 +4979,12 @@ _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
 		kd_node_count_ = p_source.kd_node_count_;
 		positions_ = p_source.positions_;
 		dist_str_ = p_source.dist_str_;
+		stream_sa_ = p_source.stream_sa_;
 		kd_nodes_ = p_source.kd_nodes_;
-		kd_root_ = p_source.kd_root_;
+		grid_cell_starts_ = p_source.grid_cell_starts_;
+		std::copy(p_source.grid_cells_, p_source.grid_cells_ + SLIM_MAX_DIMENSIONALITY, grid_cells_);
+		std::copy(p_source.grid_origin_, p_source.grid_origin_ + SLIM_MAX_DIMENSIONALITY, grid_origin_);
+		std::copy(p_source.grid_inv_width_, p_source.grid_inv_width_ + SLIM_MAX_DIMENSIONALITY, grid_inv_width_);
 		
 		p_source.evaluated_ = false;
 		p_source.evaluation_interaction_callbacks_.clear();
@@ -4150,8 +4993,9 @@ _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
 		p_source.kd_node_count_ = 0;
 		p_source.positions_ = nullptr;
 		p_source.dist_str_ = nullptr;
+		p_source.stream_sa_ = nullptr;
 		p_source.kd_nodes_ = nullptr;
-		p_source.kd_root_ = nullptr;
+		p_source.grid_cell_starts_ = nullptr;
 	}
 	
 	return *this;
@@ -4179,13 +5023,23 @@ _InteractionsData::~_InteractionsData(void)
 		dist_str_ = nullptr;
 	}
 	
+	if (stream_sa_)
+	{
+		delete stream_sa_;
+		stream_sa_ = nullptr;
+	}
+	
 	if (kd_nodes_)
 	{
 		free(kd_nodes_);
 		kd_nodes_ = nullptr;
 	}
 	
-	kd_root_ = nullptr;
+	if (grid_cell_starts_)
+	{
+		free(grid_cell_starts_);
+		grid_cell_starts_ = nullptr;
+	}
 	
 	// Unnecessary since it's about to be destroyed anyway
 	//evaluation_interaction_callbacks_.clear();
@@ -69,15 +69,30 @@ std::ostream& operator<<(std::ostream& p_out, IFType p_if_type);
 // subpopulation; if a subpopulation is not evaluated there is no overhead.
 #define SLIM_MAX_DIMENSIONALITY		3
 
+// The k-d tree has an implicit layout, with no child pointers; see InteractionType::MakeKDTree1_p0().  Ranges of this many
+// nodes or fewer are leaf buckets that are scanned linearly rather than being subdivided further.
+#define SLIM_KDTREE_BUCKET_SIZE		8
+
 struct _SLiM_kdNode
 {
 	double x[SLIM_MAX_DIMENSIONALITY];		// the coordinates of the individual
 	slim_popsize_t individual_index_;		// the index of the individual in its subpopulation
-	struct _SLiM_kdNode *left;				// the index of the KDNode for the left side
-	struct _SLiM_kdNode *right;				// the index of the KDNode for the right side
 };
 typedef struct _SLiM_kdNode SLiM_kdNode;
 
+// When maxDistance is small relative to the spatial extent of the individuals, a uniform grid of cells is used instead of a
+// k-d tree; see InteractionType::ConfigureGrid().  The grid stores its nodes in kd_nodes_ too, sorted by cell.  A query visits
+// the cells around the query point as a set of ranges of contiguous nodes, each with a (possibly periodically shifted) copy
+// of the query point; coordinates beyond the spatiality are zero in both the nodes and the point.
+struct _SLiM_gridRange
+{
+	SLiM_kdNode *start_, *end_;				// the nodes to scan
+	double point_[SLIM_MAX_DIMENSIONALITY];	// the query point, shifted by a multiple of the periodic bounds as needed
+};
+typedef struct _SLiM_gridRange SLiM_gridRange;
+
+#define SLIM_GRID_MAX_RANGES		27		// the maximum number of ranges needed for one query; 3^3 cells, in the worst case
+
 struct _InteractionsData
 {
 	// This flag is true when the interaction has been evaluated.  What that means in practice is that allocated blocks below
@@ -101,8 +116,13 @@ struct _InteractionsData
 	
 	double *positions_ = nullptr;			// individual_count_ * SLIM_MAX_DIMENSIONALITY entries, holding coordinate positions
 	SparseArray *dist_str_ = nullptr;		// a sparse array of interaction distances/strengths between individuals, individual_count_ x individual_count_
-	SLiM_kdNode *kd_nodes_ = nullptr;		// individual_count_ entries, holding the nodes of the k-d tree
-	SLiM_kdNode *kd_root_ = nullptr;		// the root of the k-d tree
+	SparseArray *stream_sa_ = nullptr;		// a scratch sparse array holding one block of rows at a time; see InteractionType::StreamNeighborTotals()
+	SLiM_kdNode *kd_nodes_ = nullptr;		// kd_node_count_ entries, holding the nodes of the k-d tree in its implicit layout, or of the grid
+	
+	slim_popsize_t *grid_cell_starts_ = nullptr;		// if non-null, kd_nodes_ holds a uniform grid, not a k-d tree; cell i is [grid_cell_starts_[i], grid_cell_starts_[i + 1])
+	int grid_cells_[SLIM_MAX_DIMENSIONALITY];			// the number of grid cells along each dimension; 1 beyond the spatiality
+	double grid_origin_[SLIM_MAX_DIMENSIONALITY];		// the coordinate of the lower edge of the first cell along each dimension
+	double grid_inv_width_[SLIM_MAX_DIMENSIONALITY];	// the reciprocal of the cell width along each dimension
 	
 	_InteractionsData(const _InteractionsData&) = delete;					// no copying
 	_InteractionsData& operator=(const _InteractionsData&) = delete;		// no copying
@@ -142,6 +162,7 @@ private:
 	
 	IFType if_type_;							// the interaction function (IF) to use
 	double if_param1_, if_param2_;				// the parameters for that IF (not all of which may be used)
+	bool fast_math_ = false;					// if true, "e" and "n" strengths are calculated in bulk with a vectorizable single-precision exp()
 	
 	bool periodic_x_ = false;					// true if this spatial coordinate is periodic, from SLiMSim
 	bool periodic_y_ = false;					// these are in terms of the InteractionType's spatiality, not the simulation's dimensionality!
@@ -157,47 +178,53 @@ private:
 	
 	double CalculateStrengthNoCallbacks(double p_distance);
 	double CalculateStrengthWithCallbacks(double p_distance, Individual *p_receiver, Individual *p_exerter, Subpopulation *p_subpop, std::vector<SLiMEidosBlock*> &p_interaction_callbacks);
-	
-	SLiM_kdNode *FindMedian_p0(SLiM_kdNode *start, SLiM_kdNode *end);
-	SLiM_kdNode *FindMedian_p1(SLiM_kdNode *start, SLiM_kdNode *end);
-	SLiM_kdNode *FindMedian_p2(SLiM_kdNode *start, SLiM_kdNode *end);
-	SLiM_kdNode *MakeKDTree1_p0(SLiM_kdNode *t, int len);
-	SLiM_kdNode *MakeKDTree2_p0(SLiM_kdNode *t, int len);
-	SLiM_kdNode *MakeKDTree2_p1(SLiM_kdNode *t, int len);
-	SLiM_kdNode *MakeKDTree3_p0(SLiM_kdNode *t, int len);
-	SLiM_kdNode *MakeKDTree3_p1(SLiM_kdNode *t, int len);
-	SLiM_kdNode *MakeKDTree3_p2(SLiM_kdNode *t, int len);
+	void FillStrengthsNoCallbacks(SparseArray &p_sparse_array);
+	double CalculateNonspatialStrengthsForReceiver(Individual *p_receiver, Subpopulation *p_subpop, InteractionsData &p_subpop_data, std::vector<double> &p_strengths);
+	
+	void MakeKDTree1_p0(SLiM_kdNode *start, SLiM_kdNode *end);
+	void MakeKDTree2_p0(SLiM_kdNode *start, SLiM_kdNode *end);
+	void MakeKDTree2_p1(SLiM_kdNode *start, SLiM_kdNode *end);
+	void MakeKDTree3_p0(SLiM_kdNode *start, SLiM_kdNode *end);
+	void MakeKDTree3_p1(SLiM_kdNode *start, SLiM_kdNode *end);
+	void MakeKDTree3_p2(SLiM_kdNode *start, SLiM_kdNode *end);
 	void EnsureKDTreePresent(InteractionsData &p_subpop_data);
 	
-	int CheckKDTree1_p0(SLiM_kdNode *t);
-	void CheckKDTree1_p0_r(SLiM_kdNode *t, double split, bool isLeftSubtree);
-	int CheckKDTree2_p0(SLiM_kdNode *t);
-	void CheckKDTree2_p0_r(SLiM_kdNode *t, double split, bool isLeftSubtree);
-	int CheckKDTree2_p1(SLiM_kdNode *t);
-	void CheckKDTree2_p1_r(SLiM_kdNode *t, double split, bool isLeftSubtree);
-	int CheckKDTree3_p0(SLiM_kdNode *t);
-	void CheckKDTree3_p0_r(SLiM_kdNode *t, double split, bool isLeftSubtree);
-	int CheckKDTree3_p1(SLiM_kdNode *t);
-	void CheckKDTree3_p1_r(SLiM_kdNode *t, double split, bool isLeftSubtree);
-	int CheckKDTree3_p2(SLiM_kdNode *t);
-	void CheckKDTree3_p2_r(SLiM_kdNode *t, double split, bool isLeftSubtree);
-	
-	void BuildSA_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array);
-	void BuildSA_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int p_phase);
-	void BuildSA_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int p_phase);
-	void BuildSA_SS_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter);
-	void BuildSA_SS_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter, int p_phase);
-	void BuildSA_SS_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter, int p_phase);
-	
-	void FindNeighbors1_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist);
-	void FindNeighbors1_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist, int p_phase);
-	void FindNeighbors1_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist, int p_phase);
-	void FindNeighborsA_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals);
-	void FindNeighborsA_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals, int p_phase);
-	void FindNeighborsA_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals, int p_phase);
-	void FindNeighborsN_1(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist);
-	void FindNeighborsN_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase);
-	void FindNeighborsN_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase);
+	bool ConfigureGrid(InteractionsData &p_subpop_data);
+	void MakeGrid(InteractionsData &p_subpop_data);
+	void EnsureSpatialIndexPresent(InteractionsData &p_subpop_data);
+	
+	void DiscardSpatialIndex(InteractionsData &p_subpop_data);
+	void UpdateSpatialIndex(InteractionsData &p_subpop_data, double *p_previous_positions, slim_popsize_t p_previous_individual_count, double *p_previous_bounds);
+	void MakeKDTreeForPhase(SLiM_kdNode *start, SLiM_kdNode *end, int p_phase);
+	bool PatchKDTree(SLiM_kdNode *start, SLiM_kdNode *end, int p_phase, double *p_region_min, double *p_region_max, SLiM_kdNode **p_moved_begin, SLiM_kdNode **p_moved_end);
+	
+	int CheckKDTree(SLiM_kdNode *start, SLiM_kdNode *end, int p_phase);
+	
+	void BuildSA_1(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array);
+	void BuildSA_2(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int p_phase);
+	void BuildSA_3(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int p_phase);
+	void BuildSA_SS_1(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter);
+	void BuildSA_SS_2(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter, int p_phase);
+	void BuildSA_SS_3(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter, int p_phase);
+	void ReceiversInSpatialOrder(InteractionsData &p_subpop_data, slim_popsize_t p_subpop_size, const uint8_t *p_requested, std::vector<slim_popsize_t> &p_receivers);
+	void BuildSARows(InteractionsData &p_subpop_data, slim_popsize_t p_subpop_size, const slim_popsize_t *p_receivers, size_t p_receiver_count, SparseArray *p_sparse_array);
+	bool StreamNeighborTotals(Subpopulation *p_subpop, InteractionsData &p_subpop_data, EidosValue *p_individuals, bool p_count_only, std::vector<double> &p_totals);
+	
+	void FindNeighbors1_1(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist);
+	void FindNeighbors1_2(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist, int p_phase);
+	void FindNeighbors1_3(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist, int p_phase);
+	void FindNeighborsA_1(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals);
+	void FindNeighborsA_2(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals, int p_phase);
+	void FindNeighborsA_3(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals, int p_phase);
+	void FindNeighborsN_1(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist);
+	void FindNeighborsN_2(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase);
+	void FindNeighborsN_3(SLiM_kdNode *start, SLiM_kdNode *end, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase);
+	int GridRangesForPoint(InteractionsData &p_subpop_data, double *nd, SLiM_gridRange *p_ranges);
+	void BuildSA_Grid(InteractionsData &p_subpop_data, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int start_exerter, int after_end_exerter);
+	void FindNeighbors1_Grid(InteractionsData &p_subpop_data, double *nd, slim_popsize_t p_focal_individual_index, SLiM_kdNode **best, double *best_dist);
+	void FindNeighborsA_Grid(InteractionsData &p_subpop_data, double *nd, slim_popsize_t p_focal_individual_index, EidosValue_Object_vector &p_result_vec, std::vector<Individual *> &p_individuals);
+	void FindNeighborsN_Grid(InteractionsData &p_subpop_data, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist);
+	
 	void FindNeighbors(Subpopulation *p_subpop, InteractionsData &p_subpop_data, double *p_point, int p_count, EidosValue_Object_vector &p_result_vec, Individual *p_excluded_individual);
 	
 public:
@@ -240,6 +267,7 @@ public:
 	EidosValue_SP ExecuteMethod_distance(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_distanceToPoint(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_drawByStrength(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
+	EidosValue_SP ExecuteMethod_drawIndexByStrength(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_evaluate(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_interactingNeighborCount(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_interactionDistance(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
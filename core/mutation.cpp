@@ -485,6 +485,16 @@ EidosValue *Mutation::GetProperty_Accelerated_mutationType(EidosObjectElement **
 	return object_result;
 }
 
+void Mutation::GetProperty_AcceleratedElements_mutationType(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result)
+{
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Mutation *value = (Mutation *)(p_values[value_index]);
+		
+		p_result[value_index] = value->mutation_type_ptr_;
+	}
+}
+
 void Mutation::SetProperty(EidosGlobalStringID p_property_id, const EidosValue &p_value)
 {
 	// All of our strings are in the global registry, so we can require a successful lookup
@@ -579,7 +589,7 @@ EidosValue_SP Mutation::ExecuteInstanceMethod(EidosGlobalStringID p_method_id, c
 {
 	switch (p_method_id)
 	{
-		case gID_setSelectionCoeff:	return ExecuteMethod_setSelectionCoeff(p_method_id, p_arguments, p_argument_count, p_interpreter);
+		//case gID_setSelectionCoeff:	return ExecuteMethod_Accelerated_setSelectionCoeff(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_setMutationType:	return ExecuteMethod_setMutationType(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		default:					return SLiMEidosDictionary::ExecuteInstanceMethod(p_method_id, p_arguments, p_argument_count, p_interpreter);
 	}
@@ -587,44 +597,41 @@ EidosValue_SP Mutation::ExecuteInstanceMethod(EidosGlobalStringID p_method_id, c
 
 //	*********************	- (void)setSelectionCoeff(float$ selectionCoeff)
 //
-EidosValue_SP Mutation::ExecuteMethod_setSelectionCoeff(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
+EidosValue_SP Mutation::ExecuteMethod_Accelerated_setSelectionCoeff(EidosObjectElement **p_elements, size_t p_elements_size, EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
 {
 #pragma unused (p_method_id, p_arguments, p_argument_count, p_interpreter)
 	EidosValue *selectionCoeff_value = p_arguments[0].get();
+	SLiMSim &sim = SLiM_GetSimFromInterpreter(p_interpreter);
 	
 	double value = selectionCoeff_value->FloatAtIndex(0, nullptr);
-	slim_selcoeff_t old_coeff = selection_coeff_;
-	
-	selection_coeff_ = static_cast<slim_selcoeff_t>(value);
+	slim_selcoeff_t new_coeff = static_cast<slim_selcoeff_t>(value);
 	// intentionally no lower or upper bound; -1.0 is lethal, but DFEs may generate smaller values, and we don't want to prevent or bowdlerize that
 	// also, the dominance coefficient modifies the selection coefficient, so values < -1 are in fact meaningfully different
 	
-	// since this selection coefficient came from the user, check and set pure_neutral_ and all_pure_neutral_DFE_
-	if (selection_coeff_ != 0.0)
+	// since this selection coefficient came from the user, check and set pure_neutral_
+	if (new_coeff != 0.0)
+		sim.pure_neutral_ = false;							// let the sim know that it is no longer a pure-neutral simulation
+	
+	for (size_t element_index = 0; element_index < p_elements_size; ++element_index)
 	{
-		SLiMSim &sim = SLiM_GetSimFromInterpreter(p_interpreter);
+		Mutation *element = (Mutation *)(p_elements[element_index]);
+		slim_selcoeff_t old_coeff = element->selection_coeff_;
 		
-		sim.pure_neutral_ = false;							// let the sim know that it is no longer a pure-neutral simulation
-		mutation_type_ptr_->all_pure_neutral_DFE_ = false;	// let the mutation type for this mutation know that it is no longer pure neutral
+		element->selection_coeff_ = new_coeff;
+		
+		// check and set all_pure_neutral_DFE_ for the mutation type of this mutation
+		if (new_coeff != 0.0)
+			element->mutation_type_ptr_->all_pure_neutral_DFE_ = false;	// let the mutation type for this mutation know that it is no longer pure neutral
 		
 		// If a selection coefficient has changed from zero to non-zero, or vice versa, MutationRun's nonneutral mutation caches need revalidation
-		if (old_coeff == 0.0)
-		{
+		if ((old_coeff == 0.0) != (new_coeff == 0.0))
 			sim.nonneutral_change_counter_++;
-		}
-	}
-	else if (old_coeff != 0.0)	// && (selection_coeff_ == 0.0) implied by the "else"
-	{
-		SLiMSim &sim = SLiM_GetSimFromInterpreter(p_interpreter);
 		
-		// If a selection coefficient has changed from zero to non-zero, or vice versa, MutationRun's nonneutral mutation caches need revalidation
-		sim.nonneutral_change_counter_++;
+		// cache values used by the fitness calculation code for speed; see header
+		element->cached_one_plus_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + new_coeff);
+		element->cached_one_plus_dom_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + element->mutation_type_ptr_->dominance_coeff_ * new_coeff);
 	}
 	
-	// cache values used by the fitness calculation code for speed; see header
-	cached_one_plus_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + selection_coeff_);
-	cached_one_plus_dom_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + mutation_type_ptr_->dominance_coeff_ * selection_coeff_);
-	
 	return gStaticEidosValueVOID;
 }
 
@@ -693,7 +700,7 @@ const std::vector<EidosPropertySignature_CSP> *Mutation_Class::Properties(void)
 		properties = new std::vector<EidosPropertySignature_CSP>(*SLiMEidosDictionary_Class::Properties());
 		
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_id,						true,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Mutation::GetProperty_Accelerated_id));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_mutationType,			true,	kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_MutationType_Class))->DeclareAcceleratedGet(Mutation::GetProperty_Accelerated_mutationType));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_mutationType,			true,	kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_MutationType_Class))->DeclareAcceleratedGet(Mutation::GetProperty_Accelerated_mutationType)->DeclareAcceleratedGetElements(Mutation::GetProperty_AcceleratedElements_mutationType, 1));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_nucleotide,				false,	kEidosValueMaskString | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Mutation::GetProperty_Accelerated_nucleotide));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_nucleotideValue,		false,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Mutation::GetProperty_Accelerated_nucleotideValue));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_originGeneration,		true,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Mutation::GetProperty_Accelerated_originGeneration));
@@ -716,7 +723,7 @@ const std::vector<EidosMethodSignature_CSP> *Mutation_Class::Methods(void) const
 	{
 		methods = new std::vector<EidosMethodSignature_CSP>(*SLiMEidosDictionary_Class::Methods());
 		
-		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_setSelectionCoeff, kEidosValueMaskVOID))->AddFloat_S("selectionCoeff"));
+		methods->emplace_back(((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_setSelectionCoeff, kEidosValueMaskVOID))->AddFloat_S("selectionCoeff"))->DeclareAcceleratedImp(Mutation::ExecuteMethod_Accelerated_setSelectionCoeff));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_setMutationType, kEidosValueMaskVOID))->AddIntObject_S("mutType", gSLiM_MutationType_Class));
 		
 		std::sort(methods->begin(), methods->end(), CompareEidosCallSignatures);
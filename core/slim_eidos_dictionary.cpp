@@ -119,7 +119,8 @@ EidosValue_SP SLiMEidosDictionary::ExecuteMethod_Accelerated_setValue(EidosObjec
 		// If we have the only reference to the value, we don't need to copy it; otherwise we copy, since we don't want to hold
 		// onto a reference that somebody else might modify under us (or that we might modify under them, with syntaxes like
 		// x[2]=...; and x=x+1;). If the value is invisible then we copy it, since the symbol table never stores invisible values.
-		if ((value->UseCount() != 1) || value->Invisible())
+		// As in EidosSymbolTable::SetValueForSymbol(), only singletons are copied now; vectors are shared copy-on-write.
+		if (value->Invisible() || ((value->UseCount() != 1) && value->IsSingleton()))
 			value = value->CopyValues();
 		
 		for (size_t element_index = 0; element_index < p_elements_size; ++element_index)
@@ -1082,6 +1082,7 @@ const std::string gStr_periodicity = "periodicity";
 const std::string gStr_spatiality = "spatiality";
 const std::string gStr_spatialPosition = "spatialPosition";
 const std::string gStr_maxDistance = "maxDistance";
+const std::string gStr_fastMath = "fastMath";
 
 // mostly method names
 const std::string gStr_ancestralNucleotides = "ancestralNucleotides";
@@ -1142,12 +1143,17 @@ const std::string gStr_treeSeqCoalesced = "treeSeqCoalesced";
 const std::string gStr_treeSeqSimplify = "treeSeqSimplify";
 const std::string gStr_treeSeqRememberIndividuals = "treeSeqRememberIndividuals";
 const std::string gStr_treeSeqOutput = "treeSeqOutput";
+const std::string gStr_treeSeqDiversity = "treeSeqDiversity";
+const std::string gStr_treeSeqDivergence = "treeSeqDivergence";
+const std::string gStr_treeSeqFst = "treeSeqFst";
+const std::string gStr_treeSeqSFS = "treeSeqSFS";
 const std::string gStr_setMigrationRates = "setMigrationRates";
 const std::string gStr_pointInBounds = "pointInBounds";
 const std::string gStr_pointReflected = "pointReflected";
 const std::string gStr_pointStopped = "pointStopped";
 const std::string gStr_pointPeriodic = "pointPeriodic";
 const std::string gStr_pointUniform = "pointUniform";
+const std::string gStr_deviatePositions = "deviatePositions";
 const std::string gStr_setCloningRate = "setCloningRate";
 const std::string gStr_setSelfingRate = "setSelfingRate";
 const std::string gStr_setSexRatio = "setSexRatio";
@@ -1185,6 +1191,7 @@ const std::string gStr_strength = "strength";
 const std::string gStr_totalOfNeighborStrengths = "totalOfNeighborStrengths";
 const std::string gStr_unevaluate = "unevaluate";
 const std::string gStr_drawByStrength = "drawByStrength";
+const std::string gStr_drawIndexByStrength = "drawIndexByStrength";
 
 // mostly SLiM variable names used in callbacks and such
 const std::string gStr_sim = "sim";
@@ -1259,6 +1266,7 @@ const std::string gStr_early = "early";
 const std::string gStr_late = "late";
 const std::string gStr_initialize = "initialize";
 const std::string gStr_fitness = "fitness";
+const std::string gStr_fitnessVector = "fitnessVector";
 const std::string gStr_interaction = "interaction";
 const std::string gStr_mateChoice = "mateChoice";
 const std::string gStr_modifyChild = "modifyChild";
@@ -1425,6 +1433,7 @@ void SLiM_RegisterGlobalStringsAndIDs(void)
 		Eidos_RegisterStringForGlobalID(gStr_spatiality, gID_spatiality);
 		Eidos_RegisterStringForGlobalID(gStr_spatialPosition, gID_spatialPosition);
 		Eidos_RegisterStringForGlobalID(gStr_maxDistance, gID_maxDistance);
+		Eidos_RegisterStringForGlobalID(gStr_fastMath, gID_fastMath);
 		
 		Eidos_RegisterStringForGlobalID(gStr_ancestralNucleotides, gID_ancestralNucleotides);
 		Eidos_RegisterStringForGlobalID(gStr_nucleotides, gID_nucleotides);
@@ -1482,12 +1491,17 @@ void SLiM_RegisterGlobalStringsAndIDs(void)
 		Eidos_RegisterStringForGlobalID(gStr_treeSeqSimplify, gID_treeSeqSimplify);
 		Eidos_RegisterStringForGlobalID(gStr_treeSeqRememberIndividuals, gID_treeSeqRememberIndividuals);
 		Eidos_RegisterStringForGlobalID(gStr_treeSeqOutput, gID_treeSeqOutput);
+		Eidos_RegisterStringForGlobalID(gStr_treeSeqDiversity, gID_treeSeqDiversity);
+		Eidos_RegisterStringForGlobalID(gStr_treeSeqDivergence, gID_treeSeqDivergence);
+		Eidos_RegisterStringForGlobalID(gStr_treeSeqFst, gID_treeSeqFst);
+		Eidos_RegisterStringForGlobalID(gStr_treeSeqSFS, gID_treeSeqSFS);
 		Eidos_RegisterStringForGlobalID(gStr_setMigrationRates, gID_setMigrationRates);
 		Eidos_RegisterStringForGlobalID(gStr_pointInBounds, gID_pointInBounds);
 		Eidos_RegisterStringForGlobalID(gStr_pointReflected, gID_pointReflected);
 		Eidos_RegisterStringForGlobalID(gStr_pointStopped, gID_pointStopped);
 		Eidos_RegisterStringForGlobalID(gStr_pointPeriodic, gID_pointPeriodic);
 		Eidos_RegisterStringForGlobalID(gStr_pointUniform, gID_pointUniform);
+		Eidos_RegisterStringForGlobalID(gStr_deviatePositions, gID_deviatePositions);
 		Eidos_RegisterStringForGlobalID(gStr_setCloningRate, gID_setCloningRate);
 		Eidos_RegisterStringForGlobalID(gStr_setSelfingRate, gID_setSelfingRate);
 		Eidos_RegisterStringForGlobalID(gStr_setSexRatio, gID_setSexRatio);
@@ -1525,6 +1539,7 @@ void SLiM_RegisterGlobalStringsAndIDs(void)
 		Eidos_RegisterStringForGlobalID(gStr_totalOfNeighborStrengths, gID_totalOfNeighborStrengths);
 		Eidos_RegisterStringForGlobalID(gStr_unevaluate, gID_unevaluate);
 		Eidos_RegisterStringForGlobalID(gStr_drawByStrength, gID_drawByStrength);
+		Eidos_RegisterStringForGlobalID(gStr_drawIndexByStrength, gID_drawIndexByStrength);
 		
 		Eidos_RegisterStringForGlobalID(gStr_sim, gID_sim);
 		Eidos_RegisterStringForGlobalID(gStr_self, gID_self);
@@ -567,6 +567,7 @@ extern const std::string gStr_periodicity;
 extern const std::string gStr_spatiality;
 extern const std::string gStr_spatialPosition;
 extern const std::string gStr_maxDistance;
+extern const std::string gStr_fastMath;
 
 extern const std::string gStr_ancestralNucleotides;
 extern const std::string gStr_nucleotides;
@@ -626,12 +627,17 @@ extern const std::string gStr_treeSeqCoalesced;
 extern const std::string gStr_treeSeqSimplify;
 extern const std::string gStr_treeSeqRememberIndividuals;
 extern const std::string gStr_treeSeqOutput;
+extern const std::string gStr_treeSeqDiversity;
+extern const std::string gStr_treeSeqDivergence;
+extern const std::string gStr_treeSeqFst;
+extern const std::string gStr_treeSeqSFS;
 extern const std::string gStr_setMigrationRates;
 extern const std::string gStr_pointInBounds;
 extern const std::string gStr_pointReflected;
 extern const std::string gStr_pointStopped;
 extern const std::string gStr_pointPeriodic;
 extern const std::string gStr_pointUniform;
+extern const std::string gStr_deviatePositions;
 extern const std::string gStr_setCloningRate;
 extern const std::string gStr_setSelfingRate;
 extern const std::string gStr_setSexRatio;
@@ -669,6 +675,7 @@ extern const std::string gStr_strength;
 extern const std::string gStr_totalOfNeighborStrengths;
 extern const std::string gStr_unevaluate;
 extern const std::string gStr_drawByStrength;
+extern const std::string gStr_drawIndexByStrength;
 
 extern const std::string gStr_sim;
 extern const std::string gStr_self;
@@ -739,6 +746,7 @@ extern const std::string gStr_early;
 extern const std::string gStr_late;
 extern const std::string gStr_initialize;
 extern const std::string gStr_fitness;
+extern const std::string gStr_fitnessVector;
 extern const std::string gStr_interaction;
 extern const std::string gStr_mateChoice;
 extern const std::string gStr_modifyChild;
@@ -870,6 +878,7 @@ enum _SLiMGlobalStringID : int {
 	gID_spatiality,
 	gID_spatialPosition,
 	gID_maxDistance,
+	gID_fastMath,
 	
 	gID_ancestralNucleotides,
 	gID_nucleotides,
@@ -929,12 +938,17 @@ enum _SLiMGlobalStringID : int {
 	gID_treeSeqSimplify,
 	gID_treeSeqRememberIndividuals,
 	gID_treeSeqOutput,
+	gID_treeSeqDiversity,
+	gID_treeSeqDivergence,
+	gID_treeSeqFst,
+	gID_treeSeqSFS,
 	gID_setMigrationRates,
 	gID_pointInBounds,
 	gID_pointReflected,
 	gID_pointStopped,
 	gID_pointPeriodic,
 	gID_pointUniform,
+	gID_deviatePositions,
 	gID_setCloningRate,
 	gID_setSelfingRate,
 	gID_setSexRatio,
@@ -972,6 +986,7 @@ enum _SLiMGlobalStringID : int {
 	gID_totalOfNeighborStrengths,
 	gID_unevaluate,
 	gID_drawByStrength,
+	gID_drawIndexByStrength,
 	
 	gID_sim,
 	gID_self,
@@ -45,6 +45,7 @@
 #include <unordered_map>
 #include <float.h>
 #include <ctime>
+#include <chrono>
 
 //TREE SEQUENCE
 #include <stdio.h>
@@ -1743,7 +1744,7 @@ void SLiMSim::OptimizeScriptBlock(SLiMEidosBlock *p_script_block)
 	// we're not going to do this for very many cases, but sometimes it is worth it.
 	if (!p_script_block->has_cached_optimization_)
 	{
-		if (p_script_block->type_ == SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback)
+		if ((p_script_block->type_ == SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback) && !p_script_block->vectorized_)
 		{
 			const EidosASTNode *base_node = p_script_block->compound_statement_node_;
 			
@@ -3436,6 +3437,9 @@ bool SLiMSim::_RunOneGenerationWF(void)
 			// note that this causes simplification, so it will confuse the auto-simplification code
 			if (running_treeseq_crosschecks_ && (generation_ % treeseq_crosschecks_interval_ == 0))
 				CrosscheckTreeSeqIntegrity();
+			
+			if (table_log_.is_open())
+				LogTreeSequenceTables();
 		}
 		
 		cached_value_generation_.reset();
@@ -3864,6 +3868,9 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 			// note that this causes simplification, so it will confuse the auto-simplification code
 			if (running_treeseq_crosschecks_ && (generation_ % treeseq_crosschecks_interval_ == 0))
 				CrosscheckTreeSeqIntegrity();
+			
+			if (table_log_.is_open())
+				LogTreeSequenceTables();
 		}
 		
 		cached_value_generation_.reset();
@@ -4671,10 +4678,11 @@ void SLiMSim::handle_error(std::string msg, int err)
 	EIDOS_TERMINATION << msg << ": " << tsk_strerror(err) << EidosTerminate();
 }
 
-void SLiMSim::ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vector<int> p_individual_map, bool p_keep_unmapped)
+void SLiMSim::ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vector<int> &p_individual_map, bool p_keep_unmapped)
 {
 	// Modifies the tables in place so that individual number individual_map[k] becomes the k-th individual in the new tables.
-	// Discard unmapped individuals unless p_keep_unmapped is true, in which case put them at the end.
+	// Discard unmapped individuals unless p_keep_unmapped is true, in which case put them at the end (of p_individual_map too).
+	// This is O(N) in the size of the individuals table, so it is done only when reading and writing, never while running.
 	size_t num_individuals = p_tables->individuals.num_rows;
 	std::vector<tsk_id_t> inverse_map(num_individuals, TSK_NULL);
 	
@@ -4731,6 +4739,25 @@ void SLiMSim::ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vect
 	}
 }
 
+void SLiMSim::RebuildRememberedIndividualsLookup(void)
+{
+	// Rebuild remembered_individuals_lookup_ from remembered_genomes_ and the node table; this is O(N) in the number of
+	// remembered individuals, and is done only when the rows of the individuals table might have been renumbered
+	remembered_individuals_lookup_.clear();
+	remembered_individuals_lookup_.reserve(remembered_genomes_.size() / 2);
+	
+	for (tsk_id_t nid : remembered_genomes_)
+	{
+		tsk_id_t tsk_individual = tables_.nodes.individual[nid];
+		assert((tsk_individual >= 0) && ((tsk_size_t)tsk_individual < tables_.individuals.num_rows));
+		IndividualMetadataRec *metadata_rec = (IndividualMetadataRec *)(tables_.individuals.metadata + tables_.individuals.metadata_offset[tsk_individual]);
+		slim_pedigreeid_t pedigree_id = metadata_rec->pedigree_id_;		// copied out, since the record is packed
+		
+		// remembered_genomes_ has two entries per individual; emplace() ignores the second one
+		remembered_individuals_lookup_.emplace(pedigree_id, tsk_individual);
+	}
+}
+
 void SLiMSim::SimplifyTreeSequence(void)
 {
 #if DEBUG
@@ -4741,6 +4768,11 @@ void SLiMSim::SimplifyTreeSequence(void)
 	if (tables_.nodes.num_rows == 0)
 		return;
 	
+	std::chrono::steady_clock::time_point start_time;
+	
+	if (table_log_.is_open())
+		start_time = std::chrono::steady_clock::now();
+	
 	std::vector<tsk_id_t> samples;
 	
 	// BCH 7/27/2019: We now build a std::unordered_map containing all of the entries of remembered_genomes_,
@@ -4808,15 +4840,25 @@ void SLiMSim::SimplifyTreeSequence(void)
 	for (tsk_id_t i = 0; i < (tsk_id_t)remembered_genomes_.size(); i++)
 		remembered_genomes_[i] = i;
 	
+	// simplification may renumber the rows of the individuals table, so the remembered individuals lookup is rebuilt
+	RebuildRememberedIndividualsLookup();
+	
 	// reset current position, used to rewind individuals that are rejected by modifyChild()
 	RecordTablePosition();
 	
 	// and reset our elapsed time since last simplification, for auto-simplification
 	simplify_elapsed_ = 0;
 	
+	// and the baseline for the tableMemoryLimit growth prediction, however we came to be simplified
+	if (table_memory_limit_ > 0)
+		table_memory_last_ = InUseMemoryForTables(tables_);
+	
 	// as a side effect of simplification, update a "model has coalesced" flag that the user can consult, if requested
 	if (running_coalescence_checks_)
 		CheckCoalescenceAfterSimplification();
+	
+	if (table_log_.is_open())
+		table_simplify_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
 }
 
 void SLiMSim::CheckCoalescenceAfterSimplification(void)
@@ -4947,6 +4989,8 @@ void SLiMSim::AllocateTreeSequenceTables(void)
 	tables_.sequence_length = (double)chromosome_.last_position_ + 1;
 	
 	RecordTablePosition();
+	
+	table_memory_last_ = 0;
 }
 
 void SLiMSim::SetCurrentNewIndividual(__attribute__((unused))Individual *p_individual)
@@ -4986,10 +5030,28 @@ void SLiMSim::RetractNewIndividual()
 
 void SLiMSim::RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genome *p_new_genome, 
         const Genome *p_initial_parental_genome, const Genome *p_second_parental_genome)
+{
+	// when logging table statistics with initializeTreeSeq(tableLogFile=...), we time the recording work; otherwise we don't pay for that
+	if (table_log_.is_open())
+	{
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+		
+		_RecordNewGenome(p_breakpoints, p_new_genome, p_initial_parental_genome, p_second_parental_genome);
+		
+		table_recording_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	}
+	else
+	{
+		_RecordNewGenome(p_breakpoints, p_new_genome, p_initial_parental_genome, p_second_parental_genome);
+	}
+}
+
+void SLiMSim::_RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genome *p_new_genome, 
+        const Genome *p_initial_parental_genome, const Genome *p_second_parental_genome)
 {
 #if DEBUG
 	if (!recording_tree_)
-		EIDOS_TERMINATION << "ERROR (SLiMSim::RecordNewGenome): (internal error) tree sequence recording method called with recording off." << EidosTerminate();
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_RecordNewGenome): (internal error) tree sequence recording method called with recording off." << EidosTerminate();
 #endif
 	
     // This records information about an individual in both the Node and Edge tables.
@@ -5051,10 +5113,27 @@ void SLiMSim::RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genom
 }
 
 void SLiMSim::RecordNewDerivedState(const Genome *p_genome, slim_position_t p_position, const std::vector<Mutation *> &p_derived_mutations)
+{
+	// see RecordNewGenome() regarding timing
+	if (table_log_.is_open())
+	{
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+		
+		_RecordNewDerivedState(p_genome, p_position, p_derived_mutations);
+		
+		table_recording_seconds_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	}
+	else
+	{
+		_RecordNewDerivedState(p_genome, p_position, p_derived_mutations);
+	}
+}
+
+void SLiMSim::_RecordNewDerivedState(const Genome *p_genome, slim_position_t p_position, const std::vector<Mutation *> &p_derived_mutations)
 {
 #if DEBUG
 	if (!recording_mutations_)
-		EIDOS_TERMINATION << "ERROR (SLiMSim::RecordNewDerivedState): (internal error) tree sequence mutation recording method called with recording off." << EidosTerminate();
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_RecordNewDerivedState): (internal error) tree sequence mutation recording method called with recording off." << EidosTerminate();
 #endif
 	
     // This records information in the Site and Mutation tables.
@@ -5077,7 +5156,7 @@ void SLiMSim::RecordNewDerivedState(const Genome *p_genome, slim_position_t p_po
 	// including fixed mutations; the simplest thing is to just disallow derived
 	// states for them altogether.
 	if (p_genome->IsNull())
-		EIDOS_TERMINATION << "ERROR (SLiMSim::RecordNewDerivedState): new derived states cannot be recorded for null genomes." << EidosTerminate();
+		EIDOS_TERMINATION << "ERROR (SLiMSim::_RecordNewDerivedState): new derived states cannot be recorded for null genomes." << EidosTerminate();
 	
     tsk_id_t genomeTSKID = p_genome->tsk_node_id_;
 
@@ -5131,6 +5210,396 @@ void SLiMSim::RecordNewDerivedState(const Genome *p_genome, slim_position_t p_po
 	if (ret < 0) handle_error("add_mutation", ret);
 }
 
+void SLiMSim::TreeSequenceSampleSet(EidosValue *p_subpops_value, std::vector<tsk_id_t> &p_sample_set)
+{
+	// Collect the tskit node ids of the non-null genomes in the given subpopulations, or in all subpopulations if
+	// p_subpops_value is NULL.  Node ids change with simplification, so this must be called after SimplifyTreeSequence().
+	std::vector<Subpopulation *> subpops;
+	
+	if (p_subpops_value->Type() == EidosValueType::kValueNULL)
+	{
+		for (auto subpop_iter : population_.subpops_)
+			subpops.push_back(subpop_iter.second);
+	}
+	else
+	{
+		int subpops_count = p_subpops_value->Count();
+		
+		for (int subpop_index = 0; subpop_index < subpops_count; ++subpop_index)
+		{
+			Subpopulation *subpop = (Subpopulation *)p_subpops_value->ObjectElementAtIndex(subpop_index, nullptr);
+			
+			if (std::find(subpops.begin(), subpops.end(), subpop) != subpops.end())
+				EIDOS_TERMINATION << "ERROR (SLiMSim::TreeSequenceSampleSet): a subpopulation may not be included in a sample set more than once." << EidosTerminate();
+			
+			subpops.push_back(subpop);
+		}
+	}
+	
+	for (Subpopulation *subpop : subpops)
+	{
+		Genome **genome_ptr = subpop->parent_genomes_.data();
+		slim_popsize_t genome_count = subpop->parent_subpop_size_ * 2;
+		
+		for (slim_popsize_t genome_index = 0; genome_index < genome_count; ++genome_index)
+		{
+			Genome *genome = genome_ptr[genome_index];
+			
+			if (!genome->IsNull())
+				p_sample_set.push_back(genome->tsk_node_id_);
+		}
+	}
+}
+
+// The per-tree summary for branch-mode statistics: each branch, from node u up to its parent, is weighted by its length
+// times the value of the statistic for the sample counts below u.  Diversity and divergence are the fraction of sample
+// pairs separated by the branch, so that summing over all branches gives the mean pairwise branch distance.
+static inline void _TreeSeqStatBranchSummary(SLiMTreeSeqStat p_stat, bool p_polarised, const int32_t *p_counts, const int32_t *p_sizes, double p_weight, double *p_summary)
+{
+	switch (p_stat)
+	{
+		case SLiMTreeSeqStat::kDiversity:
+		{
+			double n = p_sizes[0], c = p_counts[0];
+			
+			p_summary[0] += p_weight * 2.0 * c * (n - c) / (n * (n - 1.0));
+			break;
+		}
+		case SLiMTreeSeqStat::kDivergence:
+		{
+			double n0 = p_sizes[0], c0 = p_counts[0], n1 = p_sizes[1], c1 = p_counts[1];
+			
+			p_summary[0] += p_weight * (c0 * (n1 - c1) + c1 * (n0 - c0)) / (n0 * n1);
+			break;
+		}
+		case SLiMTreeSeqStat::kFst:
+		{
+			double n0 = p_sizes[0], c0 = p_counts[0], n1 = p_sizes[1], c1 = p_counts[1];
+			
+			p_summary[0] += p_weight * 2.0 * c0 * (n0 - c0) / (n0 * (n0 - 1.0));
+			p_summary[1] += p_weight * 2.0 * c1 * (n1 - c1) / (n1 * (n1 - 1.0));
+			p_summary[2] += p_weight * (c0 * (n1 - c1) + c1 * (n0 - c0)) / (n0 * n1);
+			break;
+		}
+		case SLiMTreeSeqStat::kSFS:
+		{
+			int32_t c = p_counts[0];
+			
+			if (!p_polarised)
+				c = std::min(c, p_sizes[0] - c);
+			
+			p_summary[c] += p_weight;
+			break;
+		}
+	}
+}
+
+// The per-site summary for site-mode statistics, from the count of each allele (the ancestral allele first) in each
+// sample set; p_allele_counts is laid out allele-major, with p_set_count entries per allele.  Diversity and divergence
+// are the fraction of sample pairs that carry different alleles; the SFS tallies each derived allele by its count.
+static inline double _TreeSeqStatSiteDiversity(const int32_t *p_allele_counts, size_t p_allele_count, size_t p_set_count, size_t p_set_index, double p_size)
+{
+	double same = 0.0;
+	
+	for (size_t allele_index = 0; allele_index < p_allele_count; ++allele_index)
+	{
+		double c = p_allele_counts[allele_index * p_set_count + p_set_index];
+		
+		same += c * (c - 1.0);
+	}
+	
+	return 1.0 - same / (p_size * (p_size - 1.0));
+}
+
+static inline double _TreeSeqStatSiteDivergence(const int32_t *p_allele_counts, size_t p_allele_count, size_t p_set_count, double p_size0, double p_size1)
+{
+	double same = 0.0;
+	
+	for (size_t allele_index = 0; allele_index < p_allele_count; ++allele_index)
+		same += (double)p_allele_counts[allele_index * p_set_count] * (double)p_allele_counts[allele_index * p_set_count + 1];
+	
+	return 1.0 - same / (p_size0 * p_size1);
+}
+
+static inline void _TreeSeqStatSiteSummary(SLiMTreeSeqStat p_stat, bool p_polarised, const int32_t *p_allele_counts, size_t p_allele_count, size_t p_set_count, const int32_t *p_sizes, double *p_summary)
+{
+	switch (p_stat)
+	{
+		case SLiMTreeSeqStat::kDiversity:
+			p_summary[0] += _TreeSeqStatSiteDiversity(p_allele_counts, p_allele_count, p_set_count, 0, p_sizes[0]);
+			break;
+		case SLiMTreeSeqStat::kDivergence:
+			p_summary[0] += _TreeSeqStatSiteDivergence(p_allele_counts, p_allele_count, p_set_count, p_sizes[0], p_sizes[1]);
+			break;
+		case SLiMTreeSeqStat::kFst:
+			p_summary[0] += _TreeSeqStatSiteDiversity(p_allele_counts, p_allele_count, p_set_count, 0, p_sizes[0]);
+			p_summary[1] += _TreeSeqStatSiteDiversity(p_allele_counts, p_allele_count, p_set_count, 1, p_sizes[1]);
+			p_summary[2] += _TreeSeqStatSiteDivergence(p_allele_counts, p_allele_count, p_set_count, p_sizes[0], p_sizes[1]);
+			break;
+		case SLiMTreeSeqStat::kSFS:
+			for (size_t allele_index = 1; allele_index < p_allele_count; ++allele_index)
+			{
+				int32_t c = p_allele_counts[allele_index];
+				
+				if (!p_polarised)
+					c = std::min(c, p_sizes[0] - c);
+				
+				p_summary[c] += 1.0;
+			}
+			break;
+	}
+}
+
+void SLiMSim::TreeSequenceStatistic(SLiMTreeSeqStat p_stat, std::vector<std::vector<tsk_id_t>> &p_sample_sets, bool p_branch_mode, bool p_polarised, std::vector<double> &p_windows, size_t p_result_dim, std::vector<double> &p_result)
+{
+	// Compute a statistic over the current tables, which should have just been simplified, for the given sample sets of
+	// node ids; p_windows gives window breakpoints from 0 to the sequence length, and p_result receives p_result_dim values
+	// per window.  tskit's own statistics framework postdates the version we bundle, so we follow its approach here: we
+	// iterate over the trees with an edge-difference iterator, keeping the count of samples from each set below every
+	// node up to date as edges come and go.  In branch mode we also keep the current tree's summary up to date, adjusting
+	// it only for the nodes whose counts or parents change, and add it to each window in proportion to the overlap.  In
+	// site mode we summarize each site when we reach the tree containing it, finding the samples that carry each allele
+	// from the counts below the mutations at the site.  All results except the SFS are then normalized by window length.
+	tsk_table_collection_t tables_copy;
+	int ret;
+	
+	ret = tsk_table_collection_copy(&tables_, &tables_copy, 0);
+	if (ret < 0) handle_error("tsk_table_collection_copy", ret);
+	
+	// Our tables copy needs to have a population table now, since this is required to build a tree sequence
+	WritePopulationTable(&tables_copy);
+	
+	ret = tsk_table_collection_build_index(&tables_copy, 0);
+	if (ret < 0) handle_error("tsk_table_collection_build_index", ret);
+	
+	tsk_treeseq_t ts;
+	
+	ret = tsk_treeseq_init(&ts, &tables_copy, 0);
+	if (ret < 0) handle_error("tsk_treeseq_init", ret);
+	
+	tsk_node_table_t &nodes = tables_copy.nodes;
+	tsk_site_table_t &sites = tables_copy.sites;
+	tsk_mutation_table_t &mutations = tables_copy.mutations;
+	size_t node_count = nodes.num_rows;
+	size_t set_count = p_sample_sets.size();
+	size_t window_count = p_windows.size() - 1;
+	std::vector<int32_t> sizes(set_count);
+	std::vector<int32_t> counts(node_count * set_count, 0);		// node-major, the count of samples from each set below each node
+	std::vector<tsk_id_t> parent(node_count, TSK_NULL);
+	std::vector<double> summary(p_result_dim, 0.0);				// in branch mode, the summary of the current tree
+	
+	for (size_t set_index = 0; set_index < set_count; ++set_index)
+	{
+		std::vector<tsk_id_t> &sample_set = p_sample_sets[set_index];
+		
+		sizes[set_index] = (int32_t)sample_set.size();
+		
+		for (tsk_id_t node : sample_set)
+		{
+			if ((node < 0) || ((size_t)node >= node_count))
+				EIDOS_TERMINATION << "ERROR (SLiMSim::TreeSequenceStatistic): (internal error) sample node id out of range." << EidosTerminate();
+			
+			counts[node * set_count + set_index]++;
+		}
+	}
+	
+	p_result.assign(window_count * p_result_dim, 0.0);
+	
+	tsk_diff_iter_t diff_iter;
+	double left, right;
+	tsk_edge_list_t *edges_out, *edges_in;
+	size_t window_index = 0;
+	tsk_size_t site_index = 0, mutation_index = 0;
+	std::vector<int32_t> mutation_counts, allele_counts;
+	std::vector<const char *> allele_states;
+	std::vector<tsk_size_t> allele_lengths;
+	
+	ret = tsk_diff_iter_init(&diff_iter, &ts);
+	if (ret < 0) handle_error("tsk_diff_iter_init", ret);
+	
+	while ((ret = tsk_diff_iter_next(&diff_iter, &left, &right, &edges_out, &edges_in)) == 1)
+	{
+		// remove outgoing edges, subtracting the child's counts from all of its former ancestors; in branch mode, the
+		// summary loses each affected branch's old contribution and gains its new one
+		for (tsk_edge_list_t *record = edges_out; record != NULL; record = record->next)
+		{
+			tsk_id_t edge_parent = record->edge.parent, edge_child = record->edge.child;
+			int32_t *child_counts = counts.data() + edge_child * set_count;
+			
+			if (p_branch_mode)
+				_TreeSeqStatBranchSummary(p_stat, p_polarised, child_counts, sizes.data(), -(nodes.time[edge_parent] - nodes.time[edge_child]), summary.data());
+			
+			for (tsk_id_t node = edge_parent; node != TSK_NULL; node = parent[node])
+			{
+				int32_t *node_counts = counts.data() + node * set_count;
+				tsk_id_t node_parent = parent[node];
+				double branch_length = ((node_parent == TSK_NULL) ? 0.0 : nodes.time[node_parent] - nodes.time[node]);
+				
+				if (p_branch_mode && (branch_length != 0.0))
+					_TreeSeqStatBranchSummary(p_stat, p_polarised, node_counts, sizes.data(), -branch_length, summary.data());
+				
+				for (size_t set_index = 0; set_index < set_count; ++set_index)
+					node_counts[set_index] -= child_counts[set_index];
+				
+				if (p_branch_mode && (branch_length != 0.0))
+					_TreeSeqStatBranchSummary(p_stat, p_polarised, node_counts, sizes.data(), branch_length, summary.data());
+			}
+			
+			parent[edge_child] = TSK_NULL;
+		}
+		
+		// insert incoming edges, adding the child's counts to all of its new ancestors
+		for (tsk_edge_list_t *record = edges_in; record != NULL; record = record->next)
+		{
+			tsk_id_t edge_parent = record->edge.parent, edge_child = record->edge.child;
+			int32_t *child_counts = counts.data() + edge_child * set_count;
+			
+			parent[edge_child] = edge_parent;
+			
+			if (p_branch_mode)
+				_TreeSeqStatBranchSummary(p_stat, p_polarised, child_counts, sizes.data(), nodes.time[edge_parent] - nodes.time[edge_child], summary.data());
+			
+			for (tsk_id_t node = edge_parent; node != TSK_NULL; node = parent[node])
+			{
+				int32_t *node_counts = counts.data() + node * set_count;
+				tsk_id_t node_parent = parent[node];
+				double branch_length = ((node_parent == TSK_NULL) ? 0.0 : nodes.time[node_parent] - nodes.time[node]);
+				
+				if (p_branch_mode && (branch_length != 0.0))
+					_TreeSeqStatBranchSummary(p_stat, p_polarised, node_counts, sizes.data(), -branch_length, summary.data());
+				
+				for (size_t set_index = 0; set_index < set_count; ++set_index)
+					node_counts[set_index] += child_counts[set_index];
+				
+				if (p_branch_mode && (branch_length != 0.0))
+					_TreeSeqStatBranchSummary(p_stat, p_polarised, node_counts, sizes.data(), branch_length, summary.data());
+			}
+		}
+		
+		if (p_branch_mode)
+		{
+			// add the summary of this tree, covering [left, right), to each window it overlaps, weighted by the overlap
+			while (p_windows[window_index + 1] <= left)
+				window_index++;
+			
+			for (size_t overlap_index = window_index; (overlap_index < window_count) && (p_windows[overlap_index] < right); ++overlap_index)
+			{
+				double overlap = std::min(right, p_windows[overlap_index + 1]) - std::max(left, p_windows[overlap_index]);
+				double *window_result = p_result.data() + overlap_index * p_result_dim;
+				
+				for (size_t dim_index = 0; dim_index < p_result_dim; ++dim_index)
+					window_result[dim_index] += summary[dim_index] * overlap;
+			}
+		}
+		else
+		{
+			// summarize each site in [left, right); sites are sorted by position, and mutations are sorted by site, with
+			// the mutations at a given site in the order they occurred
+			for ( ; (site_index < sites.num_rows) && (sites.position[site_index] < right); ++site_index)
+			{
+				tsk_size_t mutation_start = mutation_index;
+				
+				while ((mutation_index < mutations.num_rows) && (mutations.site[mutation_index] == (tsk_id_t)site_index))
+					mutation_index++;
+				
+				size_t mutation_count = mutation_index - mutation_start;
+				const tsk_id_t *mutation_nodes = mutations.node + mutation_start;
+				
+				while (p_windows[window_index + 1] <= sites.position[site_index])
+					window_index++;
+				
+				// each mutation is carried by the samples below its node, except those below a later mutation at the site;
+				// we find each mutation's closest predecessor (on the same node, or on the nearest ancestor that has one),
+				// and take away the samples below the mutation from that predecessor, or from the ancestral allele
+				std::vector<int32_t> ancestral_counts(sizes);
+				
+				mutation_counts.resize(mutation_count * set_count);
+				
+				for (size_t mut_index = 0; mut_index < mutation_count; ++mut_index)
+				{
+					tsk_id_t mut_node = mutation_nodes[mut_index];
+					int32_t *node_counts = counts.data() + mut_node * set_count;
+					int64_t predecessor = -1;
+					
+					std::copy(node_counts, node_counts + set_count, mutation_counts.data() + mut_index * set_count);
+					
+					for (size_t earlier_index = mut_index; earlier_index-- > 0; )
+						if (mutation_nodes[earlier_index] == mut_node)
+						{
+							predecessor = (int64_t)earlier_index;
+							break;
+						}
+					
+					for (tsk_id_t node = parent[mut_node]; (node != TSK_NULL) && (predecessor == -1); node = parent[node])
+						for (size_t other_index = mutation_count; other_index-- > 0; )
+							if (mutation_nodes[other_index] == node)
+							{
+								predecessor = (int64_t)other_index;
+								break;
+							}
+					
+					int32_t *predecessor_counts = ((predecessor == -1) ? ancestral_counts.data() : mutation_counts.data() + predecessor * set_count);
+					
+					for (size_t set_index = 0; set_index < set_count; ++set_index)
+						predecessor_counts[set_index] -= node_counts[set_index];
+				}
+				
+				// tally the samples carrying each distinct state; SLiM's derived states are the full stack of mutation ids at
+				// the site, so different mutations can lead to the same state, including back to the ancestral state
+				allele_states.assign(1, sites.ancestral_state + sites.ancestral_state_offset[site_index]);
+				allele_lengths.assign(1, sites.ancestral_state_offset[site_index + 1] - sites.ancestral_state_offset[site_index]);
+				allele_counts.assign(ancestral_counts.begin(), ancestral_counts.end());
+				
+				for (size_t mut_index = 0; mut_index < mutation_count; ++mut_index)
+				{
+					tsk_size_t state_offset = mutations.derived_state_offset[mutation_start + mut_index];
+					tsk_size_t state_length = mutations.derived_state_offset[mutation_start + mut_index + 1] - state_offset;
+					const char *state = mutations.derived_state + state_offset;
+					size_t allele_index;
+					
+					for (allele_index = 0; allele_index < allele_states.size(); ++allele_index)
+						if ((allele_lengths[allele_index] == state_length) && (memcmp(allele_states[allele_index], state, state_length) == 0))
+							break;
+					
+					if (allele_index == allele_states.size())
+					{
+						allele_states.push_back(state);
+						allele_lengths.push_back(state_length);
+						allele_counts.resize(allele_counts.size() + set_count, 0);
+					}
+					
+					for (size_t set_index = 0; set_index < set_count; ++set_index)
+						allele_counts[allele_index * set_count + set_index] += mutation_counts[mut_index * set_count + set_index];
+				}
+				
+				_TreeSeqStatSiteSummary(p_stat, p_polarised, allele_counts.data(), allele_states.size(), set_count, sizes.data(), p_result.data() + window_index * p_result_dim);
+			}
+		}
+	}
+	if (ret < 0) handle_error("tsk_diff_iter_next", ret);
+	
+	ret = tsk_diff_iter_free(&diff_iter);
+	if (ret < 0) handle_error("tsk_diff_iter_free", ret);
+	
+	ret = tsk_treeseq_free(&ts);
+	if (ret < 0) handle_error("tsk_treeseq_free", ret);
+	
+	ret = tsk_table_collection_free(&tables_copy);
+	if (ret < 0) handle_error("tsk_table_collection_free", ret);
+	
+	// normalize by window length, giving per-base values; the SFS is left as a tally (of sites, or of branch length times span)
+	if (p_stat != SLiMTreeSeqStat::kSFS)
+	{
+		for (size_t window = 0; window < window_count; ++window)
+		{
+			double window_length = p_windows[window + 1] - p_windows[window];
+			
+			for (size_t dim_index = 0; dim_index < p_result_dim; ++dim_index)
+				p_result[window * p_result_dim + dim_index] /= window_length;
+		}
+	}
+}
+
 void SLiMSim::CheckAutoSimplification(void)
 {
 #if DEBUG
@@ -5206,6 +5675,46 @@ void SLiMSim::CheckAutoSimplification(void)
 			//std::cout << simplify_interval_ << std::endl;
 		}
 	}
+	
+	// If a memory limit on the tables was set with initializeTreeSeq(tableMemoryLimit=...), simplify early when needed to
+	// stay under it.  We predict the in-use size at the next check by assuming that the tables grow next generation by as
+	// much as they grew this generation, and simplify now if that prediction would reach the limit.  This is a soft limit;
+	// the tables may not shrink enough upon simplification, in which case we warn (once) and keep simplifying as needed.
+	// We measure in-use size rather than allocated size, since tskit does not release table capacity when simplifying.
+	if (table_memory_limit_ > 0)
+	{
+		size_t in_use = InUseMemoryForTables(tables_);
+		size_t growth = (in_use > table_memory_last_) ? (in_use - table_memory_last_) : 0;
+		
+		if ((simplify_elapsed_ > 0) && (in_use + growth >= table_memory_limit_))
+		{
+			SimplifyTreeSequence();
+			
+			in_use = InUseMemoryForTables(tables_);
+			
+			if ((in_use + growth >= table_memory_limit_) && !table_memory_limit_warned_ && !gEidosSuppressWarnings)
+			{
+				SLIM_ERRSTREAM << "#WARNING (SLiMSim::CheckAutoSimplification): the tree-sequence tables use " << in_use << " bytes after simplification, which is too close to the tableMemoryLimit of " << table_memory_limit_ << " bytes to stay under it; simplification will occur every generation." << std::endl;
+				table_memory_limit_warned_ = true;
+			}
+		}
+		
+		table_memory_last_ = in_use;
+	}
+}
+
+void SLiMSim::LogTreeSequenceTables(void)
+{
+	// Write a row to the CSV log requested with initializeTreeSeq(tableLogFile=...); called at the end of each generation,
+	// after any simplification.  The header line is written by initializeTreeSeq().  Times are for this generation only.
+	table_log_ << generation_ << ","
+		<< tables_.nodes.num_rows << "," << tables_.edges.num_rows << "," << tables_.sites.num_rows << ","
+		<< tables_.mutations.num_rows << "," << tables_.individuals.num_rows << ","
+		<< InUseMemoryForTables(tables_) << "," << MemoryUsageForTables(tables_) << ","
+		<< table_recording_seconds_ << "," << table_simplify_seconds_ << std::endl;
+	
+	table_recording_seconds_ = 0.0;
+	table_simplify_seconds_ = 0.0;
 }
 
 void SLiMSim::TreeSequenceDataFromAscii(std::string NodeFileName,
@@ -5514,15 +6023,86 @@ void SLiMSim::TreeSequenceDataFromAscii(std::string NodeFileName,
 	tsk_table_collection_free(&tables_copy);
 }
 
+// The ASCII conversions below work on one ragged column at a time, in place: the offsets column is rewritten as the new
+// column is built, and the old column buffer is freed before the new one is installed.  This avoids copying the whole
+// table collection (edges and all) just to patch up a few metadata and derived state columns, which matters for peak
+// memory usage when writing out large tables.  The binary records are decoded only as each row is converted.
+static void _InstallRaggedColumn(char **p_column, tsk_size_t *p_column_length, tsk_size_t *p_max_column_length, char *p_new_column, tsk_size_t p_new_length)
+{
+	free(*p_column);
+	
+	*p_column = p_new_column;
+	*p_column_length = p_new_length;
+	*p_max_column_length = p_new_length;
+}
+
+static char *_AllocateRaggedColumn(tsk_size_t p_length)
+{
+	char *new_column = (char *)malloc(std::max(p_length, (tsk_size_t)1));	// tskit expects a non-NULL column even when empty
+	
+	if (!new_column)
+		EIDOS_TERMINATION << "ERROR (_AllocateRaggedColumn): allocation failed; you may need to raise the memory limit for SLiM." << EidosTerminate(nullptr);
+	
+	return new_column;
+}
+
+static void _InstallRaggedColumn(char **p_column, tsk_size_t *p_column_length, tsk_size_t *p_max_column_length, const std::string &p_text)
+{
+	// free the old column first, so that the old column and the new column don't need to coexist alongside p_text
+	free(*p_column);
+	*p_column = nullptr;
+	
+	tsk_size_t new_length = (tsk_size_t)p_text.size();
+	char *new_column = _AllocateRaggedColumn(new_length);
+	
+	memcpy(new_column, p_text.data(), new_length);
+	_InstallRaggedColumn(p_column, p_column_length, p_max_column_length, new_column, new_length);
+}
+
+// Mutation ids are formatted directly into the derived state column buffer, with no per-site std::string building
+static inline tsk_size_t _ASCIILengthForMutationID(slim_mutationid_t p_mut_id)
+{
+	tsk_size_t length = 1;
+	
+	if (p_mut_id < 0)
+	{
+		length++;
+		p_mut_id = -p_mut_id;
+	}
+	
+	while (p_mut_id >= 10)
+	{
+		p_mut_id /= 10;
+		length++;
+	}
+	
+	return length;
+}
+
+static inline char *_WriteASCIIForMutationID(char *p_buffer, slim_mutationid_t p_mut_id, tsk_size_t p_length)
+{
+	char *end = p_buffer + p_length;
+	char *digit = end;
+	
+	if (p_mut_id < 0)
+	{
+		*p_buffer = '-';
+		p_mut_id = -p_mut_id;
+	}
+	
+	do {
+		*(--digit) = (char)('0' + (p_mut_id % 10));
+		p_mut_id /= 10;
+	} while (p_mut_id);
+	
+	return end;
+}
+
 void SLiMSim::TreeSequenceDataToAscii(tsk_table_collection_t *p_tables)
 {
 	// This modifies p_tables in place, replacing the metadata and derived_state columns of p_tables with ASCII versions.
-	// We make a copy of the table collection here, as a source for column data, because you can't pass existing
-	// columns in to tsk_mutation_table_set_columns() and tsk_node_table_set_columns(); there is no way to just patch up the
-	// columns in p_tables, we have to copy a new set of information into p_tables wholesale.
-	tsk_table_collection_t tables_copy;
-	int ret = tsk_table_collection_copy(p_tables, &tables_copy, 0);
-	if (ret < 0) handle_error("convert_to_ascii", ret);
+	// Each column is converted separately, in place; see _InstallRaggedColumn() above.  Within each loop, old_row_start
+	// and old_row_end are the binary row's bounds, which we read before overwriting the offset with the text row's end.
 	
     /********************************************************
      * Make the data stored in the tables readable as ASCII.
@@ -5541,38 +6121,20 @@ void SLiMSim::TreeSequenceDataToAscii(tsk_table_collection_t *p_tables)
 		static_assert(sizeof(MutationMetadataRec) == 17, "MutationMetadataRec has changed size; this code probably needs to be updated");
 		
 		// Mutation derived state
-		const char *derived_state = p_tables->mutations.derived_state;
-		tsk_size_t *derived_state_offset = p_tables->mutations.derived_state_offset;
-		std::string text_derived_state;
-		std::vector<tsk_size_t> text_derived_state_offset;
-		
-		// Mutation metadata
-		const char *mutation_metadata = p_tables->mutations.metadata;
-		tsk_size_t *mutation_metadata_offset = p_tables->mutations.metadata_offset;
-		std::string text_mutation_metadata;
-		std::vector<tsk_size_t> text_mutation_metadata_offset;
-		
-		text_derived_state_offset.push_back(0);
-		text_mutation_metadata_offset.push_back(0);
+		DerivedStatesToAscii(p_tables);
 		
-		for (size_t j = 0; j < p_tables->mutations.num_rows; j++)
-		{
-			// Mutation derived state
-			slim_mutationid_t *int_derived_state = (slim_mutationid_t *)(derived_state + derived_state_offset[j]);
-			size_t cur_derived_state_length = (derived_state_offset[j+1] - derived_state_offset[j])/sizeof(slim_mutationid_t);
-			
-			for (size_t i = 0; i < cur_derived_state_length; i++)
-			{
-				if (i != 0) text_derived_state.append(",");
-				text_derived_state.append(std::to_string(int_derived_state[i]));
-			}
-			text_derived_state_offset.push_back((tsk_size_t)text_derived_state.size());
-			
-			// Mutation metadata
-			MutationMetadataRec *struct_mutation_metadata = (MutationMetadataRec *)(mutation_metadata + mutation_metadata_offset[j]);
-			size_t cur_mutation_metadata_length = (mutation_metadata_offset[j+1] - mutation_metadata_offset[j])/sizeof(MutationMetadataRec);
-			
-			assert(cur_mutation_metadata_length == cur_derived_state_length);
+		// Mutation metadata
+		tsk_mutation_table_t &mutations = p_tables->mutations;
+		const char *mutation_metadata = mutations.metadata;
+		tsk_size_t *mutation_metadata_offset = mutations.metadata_offset;
+		tsk_size_t old_row_start = mutation_metadata_offset[0];
+		std::string text_mutation_metadata;
+		
+		for (size_t j = 0; j < mutations.num_rows; j++)
+		{
+			tsk_size_t old_row_end = mutation_metadata_offset[j+1];
+			MutationMetadataRec *struct_mutation_metadata = (MutationMetadataRec *)(mutation_metadata + old_row_start);
+			size_t cur_mutation_metadata_length = (old_row_end - old_row_start)/sizeof(MutationMetadataRec);
 			
 			for (size_t i = 0; i < cur_mutation_metadata_length; i++)
 			{
@@ -5592,69 +6154,56 @@ void SLiMSim::TreeSequenceDataToAscii(tsk_table_collection_t *p_tables)
 				text_mutation_metadata.append(std::to_string(struct_mutation_metadata->nucleotide_));	// new in SLiM 3.3, file format 0.3 and later; -1 if no nucleotide
 				struct_mutation_metadata++;
 			}
-			text_mutation_metadata_offset.push_back((tsk_size_t)text_mutation_metadata.size());
+			
+			mutation_metadata_offset[j+1] = (tsk_size_t)text_mutation_metadata.size();
+			old_row_start = old_row_end;
 		}
 		
-		ret = tsk_mutation_table_set_columns(&p_tables->mutations,
-										tables_copy.mutations.num_rows,
-										tables_copy.mutations.site,
-										tables_copy.mutations.node,
-										tables_copy.mutations.parent,
-										text_derived_state.c_str(),
-										text_derived_state_offset.data(),
-										text_mutation_metadata.c_str(),
-										text_mutation_metadata_offset.data());
-		if (ret < 0) handle_error("convert_to_ascii", ret);
+		_InstallRaggedColumn(&mutations.metadata, &mutations.metadata_length, &mutations.max_metadata_length, text_mutation_metadata);
 	}
 	
 	/***** Ascii-ify Node Table *****/
 	{
 		static_assert(sizeof(GenomeMetadataRec) == 10, "GenomeMetadataRec has changed size; this code probably needs to be updated");
 		
-		const char *metadata = p_tables->nodes.metadata;
-		tsk_size_t *metadata_offset = p_tables->nodes.metadata_offset;
+		tsk_node_table_t &nodes = p_tables->nodes;
+		const char *metadata = nodes.metadata;
+		tsk_size_t *metadata_offset = nodes.metadata_offset;
+		tsk_size_t old_row_start = metadata_offset[0];
 		std::string text_metadata;
-		std::vector<tsk_size_t> text_metadata_offset;
-		
-		text_metadata_offset.push_back(0);
 		
-		for (size_t j = 0; j < p_tables->nodes.num_rows; j++)
+		for (size_t j = 0; j < nodes.num_rows; j++)
 		{
-			GenomeMetadataRec *struct_genome_metadata = (GenomeMetadataRec *)(metadata + metadata_offset[j]);
+			tsk_size_t old_row_end = metadata_offset[j+1];
+			GenomeMetadataRec *struct_genome_metadata = (GenomeMetadataRec *)(metadata + old_row_start);
 			
 			text_metadata.append(std::to_string(struct_genome_metadata->genome_id_));
 			text_metadata.append(",");
 			text_metadata.append(struct_genome_metadata->is_null_ ? "T" : "F");
 			text_metadata.append(",");
 			text_metadata.append(StringForGenomeType(struct_genome_metadata->type_));
-			text_metadata_offset.push_back((tsk_size_t)text_metadata.size());
+			
+			metadata_offset[j+1] = (tsk_size_t)text_metadata.size();
+			old_row_start = old_row_end;
 		}
 		
-		ret = tsk_node_table_set_columns(&p_tables->nodes,
-									 tables_copy.nodes.num_rows,
-									 tables_copy.nodes.flags,
-									 tables_copy.nodes.time,
-									 tables_copy.nodes.population,
-									 tables_copy.nodes.individual,
-									 text_metadata.c_str(),
-									 text_metadata_offset.data());
-		if (ret < 0) handle_error("convert_to_ascii", ret);
+		_InstallRaggedColumn(&nodes.metadata, &nodes.metadata_length, &nodes.max_metadata_length, text_metadata);
 	}
 	
 	/***** Ascii-ify Individuals Table *****/
 	{
 		static_assert(sizeof(IndividualMetadataRec) == 24, "IndividualMetadataRec has changed size; this code probably needs to be updated");
 		
-		const char *metadata = p_tables->individuals.metadata;
-		tsk_size_t *metadata_offset = p_tables->individuals.metadata_offset;
+		tsk_individual_table_t &individuals = p_tables->individuals;
+		const char *metadata = individuals.metadata;
+		tsk_size_t *metadata_offset = individuals.metadata_offset;
+		tsk_size_t old_row_start = metadata_offset[0];
 		std::string text_metadata;
-		std::vector<tsk_size_t> text_metadata_offset;
 		
-		text_metadata_offset.push_back(0);
-		
-		for (size_t j = 0; j < p_tables->individuals.num_rows; j++)
+		for (size_t j = 0; j < individuals.num_rows; j++)
 		{
-			IndividualMetadataRec *struct_individual_metadata = (IndividualMetadataRec *)(metadata + metadata_offset[j]);
+			tsk_size_t old_row_end = metadata_offset[j+1];
+			IndividualMetadataRec *struct_individual_metadata = (IndividualMetadataRec *)(metadata + old_row_start);
 			
 			text_metadata.append(std::to_string(struct_individual_metadata->pedigree_id_));
 			text_metadata.append(",");
@@ -5665,17 +6214,12 @@ void SLiMSim::TreeSequenceDataToAscii(tsk_table_collection_t *p_tables)
 			text_metadata.append(std::to_string((int32_t)struct_individual_metadata->sex_));
 			text_metadata.append(",");
 			text_metadata.append(std::to_string(struct_individual_metadata->flags_));
-			text_metadata_offset.push_back((tsk_size_t)text_metadata.size());
+			
+			metadata_offset[j+1] = (tsk_size_t)text_metadata.size();
+			old_row_start = old_row_end;
 		}
 		
-		ret = tsk_individual_table_set_columns(&p_tables->individuals,
-										   tables_copy.individuals.num_rows,
-										   tables_copy.individuals.flags,
-										   tables_copy.individuals.location,
-										   tables_copy.individuals.location_offset,
-										   text_metadata.c_str(),
-										   text_metadata_offset.data());
-		if (ret < 0) handle_error("convert_to_ascii", ret);
+		_InstallRaggedColumn(&individuals.metadata, &individuals.metadata_length, &individuals.max_metadata_length, text_metadata);
 	}
 	
 	/***** Ascii-ify Population Table *****/
@@ -5683,25 +6227,26 @@ void SLiMSim::TreeSequenceDataToAscii(tsk_table_collection_t *p_tables)
 		static_assert(sizeof(SubpopulationMetadataRec) == 88, "SubpopulationMetadataRec has changed size; this code probably needs to be updated");
 		static_assert(sizeof(SubpopulationMigrationMetadataRec) == 12, "SubpopulationMigrationMetadataRec has changed size; this code probably needs to be updated");
 		
-		const char *metadata = p_tables->populations.metadata;
-		tsk_size_t *metadata_offset = p_tables->populations.metadata_offset;
+		tsk_population_table_t &populations = p_tables->populations;
+		const char *metadata = populations.metadata;
+		tsk_size_t *metadata_offset = populations.metadata_offset;
+		tsk_size_t old_row_start = metadata_offset[0];
 		std::string text_metadata;
-		std::vector<tsk_size_t> text_metadata_offset;
 		
-		text_metadata_offset.push_back(0);
-		
-		for (size_t j = 0; j < p_tables->populations.num_rows; j++)
+		for (size_t j = 0; j < populations.num_rows; j++)
 		{
-			tsk_size_t metadata_binary_length = metadata_offset[j+1] - metadata_offset[j];
+			tsk_size_t old_row_end = metadata_offset[j+1];
+			tsk_size_t metadata_binary_length = old_row_end - old_row_start;
 			
 			if (metadata_binary_length == 0)
 			{
 				// empty population table entries just get preserved verbatim; these are unused subpop IDs
-				text_metadata_offset.push_back((tsk_size_t)text_metadata.size());
+				metadata_offset[j+1] = (tsk_size_t)text_metadata.size();
+				old_row_start = old_row_end;
 				continue;
 			}
 			
-			SubpopulationMetadataRec *struct_population_metadata = (SubpopulationMetadataRec *)(metadata + metadata_offset[j]);
+			SubpopulationMetadataRec *struct_population_metadata = (SubpopulationMetadataRec *)(metadata + old_row_start);
 			SubpopulationMigrationMetadataRec *struct_migration_metadata = (SubpopulationMigrationMetadataRec *)(struct_population_metadata + 1);
 			
 			text_metadata.append(std::to_string(struct_population_metadata->subpopulation_id_));
@@ -5751,125 +6296,142 @@ void SLiMSim::TreeSequenceDataToAscii(tsk_table_collection_t *p_tables)
 				text_metadata.append(double_buf);
 			}
 			
-			text_metadata_offset.push_back((tsk_size_t)text_metadata.size());
+			metadata_offset[j+1] = (tsk_size_t)text_metadata.size();
+			old_row_start = old_row_end;
 		}
 		
-		ret = tsk_population_table_set_columns(&p_tables->populations,
-										   tables_copy.populations.num_rows,
-										   text_metadata.c_str(),
-										   text_metadata_offset.data());
-		if (ret < 0) handle_error("convert_to_ascii", ret);
+		_InstallRaggedColumn(&populations.metadata, &populations.metadata_length, &populations.max_metadata_length, text_metadata);
 	}
-	
-	// We are done with our private copy of the table collection
-	tsk_table_collection_free(&tables_copy);
 }
 
 void SLiMSim::DerivedStatesFromAscii(tsk_table_collection_t *p_tables)
 {
 	// This modifies p_tables in place, replacing the derived_state column of p_tables with a binary version.
-	// See TreeSequenceDataFromAscii() for comments; this is basically just a pruned version of that method.
-	tsk_mutation_table_t mutations_copy;
-	int ret = tsk_mutation_table_copy(&p_tables->mutations, &mutations_copy, 0);
-	if (ret < 0) handle_error("derived_to_ascii", ret);
+	// This is the inverse of DerivedStatesToAscii(); the text is parsed directly out of the column buffer, and the
+	// binary column is sized exactly in a first pass, so no per-site strings or vectors are built along the way.
+	tsk_mutation_table_t &mutations = p_tables->mutations;
+	const char *derived_state = mutations.derived_state;
+	tsk_size_t *derived_state_offset = mutations.derived_state_offset;
+	size_t derived_state_total_part_count = 0;
 	
+	// count the mutation ids; each non-empty derived state has one more id than it has commas
+	for (size_t j = 0; j < mutations.num_rows; j++)
 	{
-		const char *derived_state = p_tables->mutations.derived_state;
-		tsk_size_t *derived_state_offset = p_tables->mutations.derived_state_offset;
-		std::vector<slim_mutationid_t> binary_derived_state;
-		std::vector<tsk_size_t> binary_derived_state_offset;
-		size_t derived_state_total_part_count = 0;
+		const char *row_start = derived_state + derived_state_offset[j];
+		const char *row_end = derived_state + derived_state_offset[j+1];
 		
-		binary_derived_state_offset.push_back(0);
+		if (row_start != row_end)
+			derived_state_total_part_count += 1 + std::count(row_start, row_end, ',');
+	}
+	
+	size_t binary_length = derived_state_total_part_count * sizeof(slim_mutationid_t);
+	
+	if (binary_length > UINT32_MAX)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::DerivedStatesFromAscii): derived state column too large; this file cannot be read." << EidosTerminate();
+	
+	char *binary_column = _AllocateRaggedColumn((tsk_size_t)binary_length);
+	slim_mutationid_t *binary_derived_state = (slim_mutationid_t *)binary_column;
+	tsk_size_t old_row_start = derived_state_offset[0];
+	size_t binary_part_index = 0;
+	
+	for (size_t j = 0; j < mutations.num_rows; j++)
+	{
+		tsk_size_t old_row_end = derived_state_offset[j+1];
+		const char *text_pos = derived_state + old_row_start;
+		const char *row_end = derived_state + old_row_end;
 		
-		for (size_t j = 0; j < p_tables->mutations.num_rows; j++)
+		while (text_pos < row_end)
 		{
-			std::string string_derived_state(derived_state + derived_state_offset[j], derived_state_offset[j+1] - derived_state_offset[j]);
+			// the column is not NUL-terminated, so we parse by hand rather than with strtoll()
+			bool negative = false;
+			bool saw_digit = false;
+			slim_mutationid_t mut_id = 0;
 			
-			if (string_derived_state.size() == 0)
+			if (*text_pos == '-')
 			{
-				// nothing to do for an empty derived state
+				negative = true;
+				text_pos++;
 			}
-			else if (string_derived_state.find(",") == std::string::npos)
+			
+			while ((text_pos < row_end) && (*text_pos >= '0') && (*text_pos <= '9'))
 			{
-				// a single mutation can be handled more efficiently, and this is the common case so it's worth optimizing
-				binary_derived_state.emplace_back((slim_mutationid_t)std::stoll(string_derived_state));
-				derived_state_total_part_count++;
+				mut_id = mut_id * 10 + (*text_pos - '0');
+				saw_digit = true;
+				text_pos++;
 			}
-			else
+			
+			if (!saw_digit || ((text_pos < row_end) && (*text_pos != ',')))
 			{
-				// stacked mutations require that the derived state be separated to parse it
-				std::vector<std::string> derived_state_parts = Eidos_string_split(string_derived_state, ",");
-				
-				for (std::string &derived_state_part : derived_state_parts)
-					binary_derived_state.emplace_back((slim_mutationid_t)std::stoll(derived_state_part));
-				
-				derived_state_total_part_count += derived_state_parts.size();
+				free(binary_column);
+				EIDOS_TERMINATION << "ERROR (SLiMSim::DerivedStatesFromAscii): malformed mutation derived state; this file cannot be read." << EidosTerminate();
 			}
 			
-			binary_derived_state_offset.push_back((tsk_size_t)(derived_state_total_part_count * sizeof(slim_mutationid_t)));
+			binary_derived_state[binary_part_index++] = (negative ? -mut_id : mut_id);
+			
+			if (text_pos < row_end)
+			{
+				text_pos++;		// skip the comma
+				
+				if (text_pos == row_end)
+				{
+					free(binary_column);
+					EIDOS_TERMINATION << "ERROR (SLiMSim::DerivedStatesFromAscii): malformed mutation derived state; this file cannot be read." << EidosTerminate();
+				}
+			}
 		}
 		
-		if (binary_derived_state.size() == 0)
-			binary_derived_state.resize(1);
-		
-		ret = tsk_mutation_table_set_columns(&p_tables->mutations,
-										 mutations_copy.num_rows,
-										 mutations_copy.site,
-										 mutations_copy.node,
-										 mutations_copy.parent,
-										 (char *)binary_derived_state.data(),
-										 binary_derived_state_offset.data(),
-										 mutations_copy.metadata,
-										 mutations_copy.metadata_offset);
-		if (ret < 0) handle_error("convert_from_ascii", ret);
+		derived_state_offset[j+1] = (tsk_size_t)(binary_part_index * sizeof(slim_mutationid_t));
+		old_row_start = old_row_end;
 	}
 	
-	tsk_mutation_table_free(&mutations_copy);
+	_InstallRaggedColumn(&mutations.derived_state, &mutations.derived_state_length, &mutations.max_derived_state_length, binary_column, (tsk_size_t)binary_length);
 }
 
 void SLiMSim::DerivedStatesToAscii(tsk_table_collection_t *p_tables)
 {
 	// This modifies p_tables in place, replacing the derived_state column of p_tables with an ASCII version.
-	// See TreeSequenceDataToAscii() for comments; this is basically just a pruned version of that method.
-	tsk_mutation_table_t mutations_copy;
-	int ret = tsk_mutation_table_copy(&p_tables->mutations, &mutations_copy, 0);
-	if (ret < 0) handle_error("derived_to_ascii", ret);
+	// The integer mutation id lists are formatted straight into an exactly sized column buffer; the first pass
+	// computes the text length of each row, the second pass writes the text and rewrites the offsets.
+	tsk_mutation_table_t &mutations = p_tables->mutations;
+	const char *derived_state = mutations.derived_state;
+	tsk_size_t *derived_state_offset = mutations.derived_state_offset;
+	size_t text_length = 0;
 	
+	for (size_t j = 0; j < mutations.num_rows; j++)
 	{
-		const char *derived_state = p_tables->mutations.derived_state;
-		tsk_size_t *derived_state_offset = p_tables->mutations.derived_state_offset;
-		std::string text_derived_state;
-		std::vector<tsk_size_t> text_derived_state_offset;
+		const slim_mutationid_t *int_derived_state = (const slim_mutationid_t *)(derived_state + derived_state_offset[j]);
+		size_t cur_derived_state_length = (derived_state_offset[j+1] - derived_state_offset[j])/sizeof(slim_mutationid_t);
 		
-		text_derived_state_offset.push_back(0);
+		for (size_t i = 0; i < cur_derived_state_length; i++)
+			text_length += (i != 0) + _ASCIILengthForMutationID(int_derived_state[i]);
+	}
+	
+	if (text_length > UINT32_MAX)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::DerivedStatesToAscii): derived state column too large to be written." << EidosTerminate();
+	
+	char *text_column = _AllocateRaggedColumn((tsk_size_t)text_length);
+	char *text_pos = text_column;
+	tsk_size_t old_row_start = derived_state_offset[0];
+	
+	for (size_t j = 0; j < mutations.num_rows; j++)
+	{
+		tsk_size_t old_row_end = derived_state_offset[j+1];
+		const slim_mutationid_t *int_derived_state = (const slim_mutationid_t *)(derived_state + old_row_start);
+		size_t cur_derived_state_length = (old_row_end - old_row_start)/sizeof(slim_mutationid_t);
 		
-		for (size_t j = 0; j < p_tables->mutations.num_rows; j++)
+		for (size_t i = 0; i < cur_derived_state_length; i++)
 		{
-			slim_mutationid_t *int_derived_state = (slim_mutationid_t *)(derived_state + derived_state_offset[j]);
-			size_t cur_derived_state_length = (derived_state_offset[j+1] - derived_state_offset[j])/sizeof(slim_mutationid_t);
+			slim_mutationid_t mut_id = int_derived_state[i];
 			
-			for (size_t i = 0; i < cur_derived_state_length; i++)
-			{
-				if (i != 0) text_derived_state.append(",");
-				text_derived_state.append(std::to_string(int_derived_state[i]));
-			}
-			text_derived_state_offset.push_back((tsk_size_t)text_derived_state.size());
+			if (i != 0) *(text_pos++) = ',';
+			text_pos = _WriteASCIIForMutationID(text_pos, mut_id, _ASCIILengthForMutationID(mut_id));
 		}
 		
-		ret = tsk_mutation_table_set_columns(&p_tables->mutations,
-										 mutations_copy.num_rows,
-										 mutations_copy.site,
-										 mutations_copy.node,
-										 mutations_copy.parent,
-										 text_derived_state.c_str(),
-										 text_derived_state_offset.data(),
-										 mutations_copy.metadata,
-										 mutations_copy.metadata_offset);
-		if (ret < 0) handle_error("derived_to_ascii", ret);
+		derived_state_offset[j+1] = (tsk_size_t)(text_pos - text_column);
+		old_row_start = old_row_end;
 	}
 	
-	tsk_mutation_table_free(&mutations_copy);
+	_InstallRaggedColumn(&mutations.derived_state, &mutations.derived_state_length, &mutations.max_derived_state_length, text_column, (tsk_size_t)text_length);
 }
 
 void SLiMSim::AddIndividualsToTable(Individual * const *p_individual, size_t p_num_individuals, tsk_table_collection_t *p_tables, uint32_t p_flags)
@@ -5890,69 +6452,16 @@ void SLiMSim::AddIndividualsToTable(Individual * const *p_individual, size_t p_n
 	if (p_tables == nullptr)
 		p_tables = &tables_;
 	
-	// construct the map of currently remembered individuals first; these are not really just those
-	// that are "remembered", but all individuals that are currently in the tables
-	// BCH 16 Nov. 2019: Making this into an unordered_map for faster lookup; this can end up
-	// being accessed for a large number of individuals, making for an O(N*M) bottleneck.
-	// The key is the pedigree ID, so we can look up remembered individuals quickly; the value
-	// is the index of that pedigree ID in the list of remembered individuals, so we can
-	// look up the metadata for the remembered individual and patch it with new information.
-	// Also making it so we don't use this map at all if we're adding first-gen individuals,
-	// since we know they are not already remembered.
-	// BCH 28 Jan. 2020: My previous optimization turns out to be quite slow in one case: when
-	// p_num_individuals == 1, because the user is adding just a single remembered individual
-	// to the list.  When this is done many times (as in my #116 test case!), the overhead of
-	// building a whole std::unordered_map for a single lookup proves to be a big problem --
-	// a large percentage of total runtime, which it used to be negligible.  This seems like
-	// a case that might well arise in real-world use, so I'm optimizing it by re-introducing
-	// the old std::vector code, used only when p_num_individuals < 5 (a wild guess at a
-	// heuristic).  This makes the code a bit messy, but it's simple really: we just use one
-	// of two data structures, std::vector or std::unordered_map, to do our lookups based on
-	// how many lookups we anticipate doing.
-	bool using_std_vector = (p_num_individuals < 5);
-    std::vector<slim_pedigreeid_t> remembered_individuals;									// used when using_std_vector==true
-	std::unordered_map<slim_pedigreeid_t, slim_popsize_t> remembered_individuals_lookup;	// used when using_std_vector==false
-	
-	if (using_std_vector)
-	{
-		slim_pedigreeid_t last_added_id = -1;
-		
-		for (tsk_id_t nid : remembered_genomes_) 
-		{
-			tsk_id_t tsk_individual = p_tables->nodes.individual[nid];
-			assert((tsk_individual >= 0) && ((tsk_size_t)tsk_individual < p_tables->individuals.num_rows));
-			IndividualMetadataRec *metadata_rec = (IndividualMetadataRec *)(p_tables->individuals.metadata + p_tables->individuals.metadata_offset[tsk_individual]);
-			slim_pedigreeid_t metadata_id = metadata_rec->pedigree_id_;
-			
-			// remembered_genomes_ has two entries per individual; we want to work with individuals, so we filter
-			if (metadata_id != last_added_id)
-			{
-				remembered_individuals.push_back(metadata_rec->pedigree_id_);
-				last_added_id = metadata_id;
-			}
-		}
-	}
-	else
-	{
-		slim_pedigreeid_t last_added_id = -1;
-		slim_popsize_t added_count = 0;
-		
-		for (tsk_id_t nid : remembered_genomes_) 
-		{
-			tsk_id_t tsk_individual = p_tables->nodes.individual[nid];
-			assert((tsk_individual >= 0) && ((tsk_size_t)tsk_individual < p_tables->individuals.num_rows));
-			IndividualMetadataRec *metadata_rec = (IndividualMetadataRec *)(p_tables->individuals.metadata + p_tables->individuals.metadata_offset[tsk_individual]);
-			slim_pedigreeid_t metadata_id = metadata_rec->pedigree_id_;
-			
-			// remembered_genomes_ has two entries per individual; we want to work with individuals, so we filter
-			if (metadata_id != last_added_id)
-			{
-				remembered_individuals_lookup.emplace(std::pair<slim_pedigreeid_t, slim_popsize_t>(metadata_id, added_count));
-				last_added_id = metadata_id;
-				added_count++;
-			}
-		}
-	}
+	// Remembered (and first-generation) individuals are found through remembered_individuals_lookup_, which maps
+	// pedigree IDs to individuals table rows.  This used to be a std::vector or std::unordered_map rebuilt from
+	// remembered_genomes_ on every call, which made remembering individuals O(N) in the number already remembered;
+	// models that remember individuals every generation paid that cost over and over.  The lookup is now persistent,
+	// and is updated incrementally below as rows are added, so each call is O(k) in the number of individuals passed
+	// in.  Rows for remembered individuals are stable until simplification, which may renumber them; the lookup is
+	// rebuilt from remembered_genomes_ at that point (and after loading), in RebuildRememberedIndividualsLookup().
+	// Note that the lookup always refers to rows in tables_; if p_tables is a copy of tables_ (as when writing
+	// output), the rows for remembered individuals are the same, and we do not add new entries to the lookup.
+	bool updating_lookup = ((p_tables == &tables_) && (p_flags & (SLIM_TSK_INDIVIDUAL_REMEMBERED | SLIM_TSK_INDIVIDUAL_FIRST_GEN)));
 	
 	// loop over individuals and add entries to the individual table; if they are already
 	// there, we just need to update their metadata, location, etc.
@@ -5961,10 +6470,7 @@ void SLiMSim::AddIndividualsToTable(Individual * const *p_individual, size_t p_n
         Individual *ind = p_individual[j];
         slim_pedigreeid_t ped_id = ind->PedigreeID();
 
-        std::vector<double> location;
-        location.push_back(ind->spatial_x_);
-        location.push_back(ind->spatial_y_);
-        location.push_back(ind->spatial_z_);
+        double location[3] = {ind->spatial_x_, ind->spatial_y_, ind->spatial_z_};
         
         IndividualMetadataRec metadata_rec;
         MetadataForIndividual(ind, &metadata_rec);
@@ -5977,32 +6483,18 @@ void SLiMSim::AddIndividualsToTable(Individual * const *p_individual, size_t p_n
 		}
 		else
 		{
-			if (using_std_vector)
-			{
-				// this case has a slow lookup (linear search), but the vector is fast to build
-				auto ind_pos = std::find(remembered_individuals.begin(), remembered_individuals.end(), ped_id);
-				
-				if (ind_pos == remembered_individuals.end())
-					tsk_individual = TSK_NULL;	// not in the table already
-				else
-					tsk_individual = (tsk_id_t)std::distance(remembered_individuals.begin(), ind_pos);
-			}
+			auto ind_pos = remembered_individuals_lookup_.find(ped_id);
+			
+			if (ind_pos == remembered_individuals_lookup_.end())
+				tsk_individual = TSK_NULL;	// not in the table already
 			else
-			{
-				// this case has a fash search (hash table), but the unordered_map is slow to build
-				auto ind_pos = remembered_individuals_lookup.find(ped_id);
-				
-				if (ind_pos == remembered_individuals_lookup.end())
-					tsk_individual = TSK_NULL;	// not in the table already
-				else
-					tsk_individual = ind_pos->second;
-			}
+				tsk_individual = ind_pos->second;
 		}
 		
         if (tsk_individual == TSK_NULL) {
             // This individual is not already in the tables.
             tsk_individual = tsk_individual_table_add_row(&p_tables->individuals,
-                    p_flags, location.data(), (uint32_t)location.size(), 
+                    p_flags, location, 3,
                     (char *)&metadata_rec, (uint32_t)sizeof(IndividualMetadataRec));
             if (tsk_individual < 0) handle_error("tsk_individual_table_add_row", tsk_individual);
             
@@ -6017,11 +6509,14 @@ void SLiMSim::AddIndividualsToTable(Individual * const *p_individual, size_t p_n
             {
                 remembered_genomes_.push_back(ind->genome1_->tsk_node_id_);
                 remembered_genomes_.push_back(ind->genome2_->tsk_node_id_);
+				
+				if (updating_lookup)
+					remembered_individuals_lookup_.emplace(ped_id, tsk_individual);
             }
         } else {
             // This individual is already there; we need to update the information.
             assert(((size_t)tsk_individual < p_tables->individuals.num_rows)
-                   && (location.size()
+                   && (3
                        == (p_tables->individuals.location_offset[tsk_individual + 1]
                            - p_tables->individuals.location_offset[tsk_individual]))
                    && (sizeof(IndividualMetadataRec)
@@ -6038,7 +6533,7 @@ void SLiMSim::AddIndividualsToTable(Individual * const *p_individual, size_t p_n
 			
 			memcpy(p_tables->individuals.location
 				   + p_tables->individuals.location_offset[tsk_individual],
-				   location.data(), location.size() * sizeof(double));
+				   location, 3 * sizeof(double));
             memcpy(p_tables->individuals.metadata
                     + p_tables->individuals.metadata_offset[tsk_individual],
                     &metadata_rec, sizeof(IndividualMetadataRec));
@@ -6692,6 +7187,7 @@ void SLiMSim::FreeTreeSequence(void)
 	tsk_table_collection_free(&tables_);
 	
 	remembered_genomes_.clear();
+	remembered_individuals_lookup_.clear();
 }
 
 void SLiMSim::RecordAllDerivedStatesFromSLiM(void)
@@ -7307,7 +7803,7 @@ void SLiMSim::__TabulateSubpopulationsFromTreeSequence(std::unordered_map<slim_o
 	}
 }
 
-void SLiMSim::__CreateSubpopulationsFromTabulation(std::unordered_map<slim_objectid_t, ts_subpop_info> &p_subpopInfoMap, EidosInterpreter *p_interpreter, std::unordered_map<tsk_id_t, Genome *> &p_nodeToGenomeMap)
+void SLiMSim::__CreateSubpopulationsFromTabulation(std::unordered_map<slim_objectid_t, ts_subpop_info> &p_subpopInfoMap, EidosInterpreter *p_interpreter, std::vector<Genome *> &p_nodeToGenomeMap)
 {
 	gSLiM_next_pedigree_id = 0;
 	
@@ -7368,8 +7864,11 @@ void SLiMSim::__CreateSubpopulationsFromTabulation(std::unordered_map<slim_objec
 				individual->genome1_->tsk_node_id_ = node_id_0;
 				individual->genome2_->tsk_node_id_ = node_id_1;
 				
-				p_nodeToGenomeMap.insert(std::pair<tsk_id_t, Genome *>(node_id_0, individual->genome1_));
-				p_nodeToGenomeMap.insert(std::pair<tsk_id_t, Genome *>(node_id_1, individual->genome2_));
+				if ((node_id_0 < 0) || ((size_t)node_id_0 >= p_nodeToGenomeMap.size()) || (node_id_1 < 0) || ((size_t)node_id_1 >= p_nodeToGenomeMap.size()))
+					EIDOS_TERMINATION << "ERROR (SLiMSim::__CreateSubpopulationsFromTabulation): node id out of range; this file cannot be read." << EidosTerminate();
+				
+				p_nodeToGenomeMap[node_id_0] = individual->genome1_;
+				p_nodeToGenomeMap[node_id_1] = individual->genome2_;
 				
 				slim_pedigreeid_t pedigree_id = subpop_info.pedigreeID_[tabulation_index];
 				individual->SetPedigreeID(pedigree_id);
@@ -7535,11 +8034,43 @@ void SLiMSim::__ConfigureSubpopulationsFromTables(EidosInterpreter *p_interprete
 
 typedef struct ts_mut_info {
 	slim_position_t position;
-	MutationMetadataRec *metadata;
+	MutationMetadataRec metadata;
 	slim_refcount_t ref_count;
+	MutationIndex mut_index;			// -1 if the mutation became a Substitution, or was not instantiated
 } ts_mut_info;
 
-void SLiMSim::__TabulateMutationsFromTables(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutMap, int p_file_version)
+// ts_mut_index is a flat index from mutation id to tabulated mutation info, used while loading a .trees file.  It replaces
+// a std::unordered_map keyed by mutation id; the ids are collected from the mutation table, sorted, and uniqued, and then
+// looked up by binary search.  Mutation ids are handed out sequentially, so the id range is often dense, and in that
+// case we can skip the binary search and just subtract the base id.  This matters for large .trees files.
+typedef struct ts_mut_index {
+	std::vector<slim_mutationid_t> ids_;	// sorted, unique
+	std::vector<ts_mut_info> infos_;		// parallel to ids_
+	bool dense_ = false;					// true if ids_ contains every id from ids_.front() to ids_.back()
+	
+	inline ts_mut_info *Lookup(slim_mutationid_t p_mut_id)
+	{
+		if (ids_.size() == 0)
+			return nullptr;
+		
+		if (dense_)
+		{
+			slim_mutationid_t offset = p_mut_id - ids_.front();
+			
+			if ((offset < 0) || (offset >= (slim_mutationid_t)ids_.size()))
+				return nullptr;
+			return &infos_[(size_t)offset];
+		}
+		
+		auto id_iter = std::lower_bound(ids_.begin(), ids_.end(), p_mut_id);
+		
+		if ((id_iter == ids_.end()) || (*id_iter != p_mut_id))
+			return nullptr;
+		return &infos_[id_iter - ids_.begin()];
+	}
+} ts_mut_index;
+
+void SLiMSim::__TabulateMutationsFromTables(ts_mut_index &p_mutIndex, int p_file_version)
 {
 	std::size_t metadata_rec_size = ((p_file_version < 3) ? sizeof(MutationMetadataRec_PRENUC) : sizeof(MutationMetadataRec));
 	tsk_mutation_table_t &mut_table = tables_.mutations;
@@ -7548,6 +8079,24 @@ void SLiMSim::__TabulateMutationsFromTables(std::unordered_map<slim_mutationid_t
 	if ((mut_count > 0) && !recording_mutations_)
 		EIDOS_TERMINATION << "ERROR (SLiMSim::__TabulateMutationsFromTables): cannot load mutations when mutation recording is disabled." << EidosTerminate();
 	
+	// first, collect all of the mutation ids referenced by the derived states, and build the flat index from them
+	// the derived state column is just a packed array of mutation ids, so this is a simple scan
+	if (mut_table.derived_state_length % sizeof(slim_mutationid_t) != 0)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::__TabulateMutationsFromTables): unexpected mutation derived state length; this file cannot be read." << EidosTerminate();
+	
+	{
+		slim_mutationid_t *all_ids = (slim_mutationid_t *)mut_table.derived_state;
+		size_t all_ids_count = mut_table.derived_state_length / sizeof(slim_mutationid_t);
+		std::vector<slim_mutationid_t> &ids = p_mutIndex.ids_;
+		
+		ids.assign(all_ids, all_ids + all_ids_count);
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+		
+		p_mutIndex.infos_.resize(ids.size(), ts_mut_info{0, MutationMetadataRec(), 0, -1});
+		p_mutIndex.dense_ = (ids.size() > 0) && ((size_t)(ids.back() - ids.front()) == ids.size() - 1);
+	}
+	
 	for (tsk_size_t mut_index = 0; mut_index < mut_count; ++mut_index)
 	{
 		const char *derived_state_bytes = mut_table.derived_state + mut_table.derived_state_offset[mut_index];
@@ -7578,33 +8127,38 @@ void SLiMSim::__TabulateMutationsFromTables(std::unordered_map<slim_mutationid_t
 		for (int stack_index = 0; stack_index < stack_count; ++stack_index)
 		{
 			slim_mutationid_t mut_id = derived_state_vec[stack_index];
-			auto mut_info_insert = p_mutMap.insert(std::pair<slim_mutationid_t, ts_mut_info>(mut_id, ts_mut_info()));
-			ts_mut_info &mut_info = (mut_info_insert.first)->second;
+			ts_mut_info *mut_info = p_mutIndex.Lookup(mut_id);
+			
+			if (!mut_info)
+				EIDOS_TERMINATION << "ERROR (SLiMSim::__TabulateMutationsFromTables): (internal error) mutation id " << mut_id << " missing from the mutation index." << EidosTerminate();
 			
-			mut_info.position = position;
+			mut_info->position = position;
 			
 			// This method handles the fact that a file version of 2 or below will not contain a nucleotide field for its mutation metadata.
 			// We hide this fact from the rest of the initialization code; ts_mut_info uses MutationMetadataRec, and we fill in a value of
-			// -1 for the nucleotide_ field if we are using MutationMetadataRec_PRENUC due to the file version.
+			// -1 for the nucleotide_ field if we are using MutationMetadataRec_PRENUC due to the file version.  The metadata is copied
+			// with memcpy(), since the packed records in the metadata column may be misaligned.
 			if (p_file_version < 3)
 			{
-				MutationMetadataRec_PRENUC *prenuc_metadata = (MutationMetadataRec_PRENUC *)metadata_vec + stack_index;
+				MutationMetadataRec_PRENUC prenuc_metadata;
 				
-				mut_info.metadata->mutation_type_id_ = prenuc_metadata->mutation_type_id_;
-				mut_info.metadata->selection_coeff_ = prenuc_metadata->selection_coeff_;
-				mut_info.metadata->subpop_index_ = prenuc_metadata->subpop_index_;
-				mut_info.metadata->origin_generation_ = prenuc_metadata->origin_generation_;
-				mut_info.metadata->nucleotide_ = -1;
+				memcpy(&prenuc_metadata, (MutationMetadataRec_PRENUC *)metadata_vec + stack_index, sizeof(MutationMetadataRec_PRENUC));
+				
+				mut_info->metadata.mutation_type_id_ = prenuc_metadata.mutation_type_id_;
+				mut_info->metadata.selection_coeff_ = prenuc_metadata.selection_coeff_;
+				mut_info->metadata.subpop_index_ = prenuc_metadata.subpop_index_;
+				mut_info->metadata.origin_generation_ = prenuc_metadata.origin_generation_;
+				mut_info->metadata.nucleotide_ = -1;
 			}
 			else
 			{
-				mut_info.metadata = (MutationMetadataRec *)metadata_vec + stack_index;
+				memcpy(&mut_info->metadata, (MutationMetadataRec *)metadata_vec + stack_index, sizeof(MutationMetadataRec));
 			}
 		}
 	}
 }
 
-void SLiMSim::__TallyMutationReferencesWithTreeSequence(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutMap, std::unordered_map<tsk_id_t, Genome *> p_nodeToGenomeMap, tsk_treeseq_t *p_ts)
+void SLiMSim::__TallyMutationReferencesWithTreeSequence(ts_mut_index &p_mutIndex, std::vector<Genome *> &p_nodeToGenomeMap, tsk_treeseq_t *p_ts)
 {
 	// allocate and set up the vargen object we'll use to walk through variants
 	tsk_vargen_t *vg;
@@ -7621,14 +8175,13 @@ void SLiMSim::__TallyMutationReferencesWithTreeSequence(std::unordered_map<slim_
 	for (size_t sample_index = 0; sample_index < sample_count; ++sample_index)
 	{
 		tsk_id_t sample_node_id = vg->samples[sample_index];
-		auto sample_nodeToGenome_iter = p_nodeToGenomeMap.find(sample_node_id);
 		
-		if (sample_nodeToGenome_iter != p_nodeToGenomeMap.end())
-			indexToGenomeMap.push_back(sample_nodeToGenome_iter->second);
-		else
-			indexToGenomeMap.push_back(nullptr);	// this sample is not extant; no corresponding genome
+		indexToGenomeMap.push_back(p_nodeToGenomeMap[sample_node_id]);	// nullptr if this sample is not extant
 	}
 	
+	// per-allele reference counts, reused across variants
+	std::vector<int32_t> allele_refs;
+	
 	// add mutations to genomes by looping through variants
 	do
 	{
@@ -7642,41 +8195,36 @@ void SLiMSim::__TallyMutationReferencesWithTreeSequence(std::unordered_map<slim_
 			// We have a new variant; set it into SLiM.  A variant represents a site at which a tracked mutation exists.
 			// The tsk_variant_t will tell us all the allelic states involved at that site, what the alleles are, and which genomes
 			// in the sample are using them.  We want to find any mutations that are shared across all non-null genomes.
+			// We calculate the number of extant genomes that reference each allele in a single pass across the samples.
+			allele_refs.assign(variant->num_alleles, 0);
+			
+			for (size_t sample_index = 0; sample_index < sample_count; sample_index++)
+				if (indexToGenomeMap[sample_index] != nullptr)
+					allele_refs[variant->genotypes.u16[sample_index]]++;
+			
 			for (tsk_size_t allele_index = 0; allele_index < variant->num_alleles; ++allele_index)
 			{
 				tsk_size_t allele_length = variant->allele_lengths[allele_index];
 				
-				if (allele_length > 0)
+				// If the count is greater than zero (might be zero if only non-extant nodes reference the allele), tally it
+				if ((allele_length > 0) && allele_refs[allele_index])
 				{
-					// Calculate the number of extant genomes that reference this allele
-					int32_t allele_refs = 0;
+					if (allele_length % sizeof(slim_mutationid_t) != 0)
+						EIDOS_TERMINATION << "ERROR (SLiMSim::__TallyMutationReferencesWithTreeSequence): (internal error) variant allele had length that was not a multiple of sizeof(slim_mutationid_t)." << EidosTerminate();
+					allele_length /= sizeof(slim_mutationid_t);
 					
-					for (size_t sample_index = 0; sample_index < sample_count; sample_index++)
-						if ((variant->genotypes.u16[sample_index] == allele_index) && (indexToGenomeMap[sample_index] != nullptr))
-							allele_refs++;
+					slim_mutationid_t *allele = (slim_mutationid_t *)variant->alleles[allele_index];
 					
-					// If that count is greater than zero (might be zero if only non-extant nodes reference the allele), tally it
-					if (allele_refs)
+					for (tsk_size_t mutid_index = 0; mutid_index < allele_length; ++mutid_index)
 					{
-						if (allele_length % sizeof(slim_mutationid_t) != 0)
-							EIDOS_TERMINATION << "ERROR (SLiMSim::__TallyMutationReferencesWithTreeSequence): (internal error) variant allele had length that was not a multiple of sizeof(slim_mutationid_t)." << EidosTerminate();
-						allele_length /= sizeof(slim_mutationid_t);
+						slim_mutationid_t mut_id = allele[mutid_index];
+						ts_mut_info *mut_info = p_mutIndex.Lookup(mut_id);
 						
-						slim_mutationid_t *allele = (slim_mutationid_t *)variant->alleles[allele_index];
+						if (!mut_info)
+							EIDOS_TERMINATION << "ERROR (SLiMSim::__TallyMutationReferencesWithTreeSequence): mutation id " << mut_id << " was referenced but does not exist." << EidosTerminate();
 						
-						for (tsk_size_t mutid_index = 0; mutid_index < allele_length; ++mutid_index)
-						{
-							slim_mutationid_t mut_id = allele[mutid_index];
-							auto mut_info_iter = p_mutMap.find(mut_id);
-							
-							if (mut_info_iter == p_mutMap.end())
-								EIDOS_TERMINATION << "ERROR (SLiMSim::__TallyMutationReferencesWithTreeSequence): mutation id " << mut_id << " was referenced but does not exist." << EidosTerminate();
-							
-							// Add allele_refs to the refcount for this mutation
-							ts_mut_info &mut_info = mut_info_iter->second;
-							
-							mut_info.ref_count += allele_refs;
-						}
+						// Add allele_refs to the refcount for this mutation
+						mut_info->ref_count += allele_refs[allele_index];
 					}
 				}
 			}
@@ -7690,7 +8238,7 @@ void SLiMSim::__TallyMutationReferencesWithTreeSequence(std::unordered_map<slim_
 	free(vg);
 }
 
-void SLiMSim::__CreateMutationsFromTabulation(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutInfoMap, std::unordered_map<slim_mutationid_t, MutationIndex> &p_mutIndexMap)
+void SLiMSim::__CreateMutationsFromTabulation(ts_mut_index &p_mutIndex)
 {
 	// count the number of non-null genomes there are; this is the count that would represent fixation
 	slim_refcount_t fixation_count = 0;
@@ -7700,13 +8248,14 @@ void SLiMSim::__CreateMutationsFromTabulation(std::unordered_map<slim_mutationid
 			if (!genome->IsNull())
 				fixation_count++;
 	
-	// instantiate mutations
-	for (auto mut_info_iter : p_mutInfoMap)
+	// instantiate mutations; note that we go in sorted id order, so the mutation registry is in id order too
+	size_t mut_info_count = p_mutIndex.ids_.size();
+	
+	for (size_t mut_info_index = 0; mut_info_index < mut_info_count; ++mut_info_index)
 	{
-		slim_mutationid_t mutation_id = mut_info_iter.first;
-		ts_mut_info &mut_info = mut_info_iter.second;
-		MutationMetadataRec *metadata_ptr = mut_info.metadata;
-		MutationMetadataRec metadata;
+		slim_mutationid_t mutation_id = p_mutIndex.ids_[mut_info_index];
+		ts_mut_info &mut_info = p_mutIndex.infos_[mut_info_index];
+		MutationMetadataRec &metadata = mut_info.metadata;
 		slim_position_t position = mut_info.position;
 		
 		// BCH 4 Feb 2020: bump the next mutation ID counter as needed here, so that this happens in all cases – even if
@@ -7720,12 +8269,6 @@ void SLiMSim::__CreateMutationsFromTabulation(std::unordered_map<slim_mutationid
 		if (mut_info.ref_count == 0)
 			continue;
 		
-		// BCH 4/25/2019: copy the metadata with memcpy(), avoiding a misaligned pointer access; this is needed because
-		// sizeof(MutationMetadataRec) is odd, according to Xcode.  Actually I think this might be a bug in Xcode's runtime
-		// checking, because MutationMetadataRec is defined as packed so the compiler should not use aligned reads for it...?
-		// Anyway, it's a safe fix and will probably get optimized away by the compiler, so whatever...
-		memcpy(&metadata, metadata_ptr, sizeof(MutationMetadataRec));
-		
 		// look up the mutation type from its index
 		auto found_muttype_pair = mutation_types_.find(metadata.mutation_type_id_);
 		
@@ -7742,8 +8285,7 @@ void SLiMSim::__CreateMutationsFromTabulation(std::unordered_map<slim_mutationid
 			population_.treeseq_substitutions_map_.insert(std::pair<slim_position_t, Substitution *>(position, sub));
 			population_.substitutions_.emplace_back(sub);
 			
-			// add -1 to our local map, so we know there's an entry but we also know it's a substitution
-			p_mutIndexMap[mutation_id] = -1;
+			// leave mut_index as -1, so we know it's a substitution when making genomes
 		}
 		else
 		{
@@ -7752,8 +8294,8 @@ void SLiMSim::__CreateMutationsFromTabulation(std::unordered_map<slim_mutationid
 			
 			new (gSLiM_Mutation_Block + new_mut_index) Mutation(mutation_id, mutation_type_ptr, position, metadata.selection_coeff_, metadata.subpop_index_, metadata.origin_generation_, metadata.nucleotide_);
 			
-			// add it to our local map, so we can find it when making genomes, and to the population's mutation registry
-			p_mutIndexMap[mutation_id] = new_mut_index;
+			// record it in our index, so we can find it when making genomes, and add it to the population's mutation registry
+			mut_info.mut_index = new_mut_index;
 			population_.mutation_registry_.emplace_back(new_mut_index);
 			
 #ifdef SLIM_KEEP_MUTTYPE_REGISTRIES
@@ -7771,7 +8313,7 @@ void SLiMSim::__CreateMutationsFromTabulation(std::unordered_map<slim_mutationid
 	}
 }
 
-void SLiMSim::__AddMutationsFromTreeSequenceToGenomes(std::unordered_map<slim_mutationid_t, MutationIndex> &p_mutIndexMap, std::unordered_map<tsk_id_t, Genome *> p_nodeToGenomeMap, tsk_treeseq_t *p_ts)
+void SLiMSim::__AddMutationsFromTreeSequenceToGenomes(ts_mut_index &p_mutIndex, std::vector<Genome *> &p_nodeToGenomeMap, tsk_treeseq_t *p_ts)
 {
 	// This code is based on SLiMSim::CrosscheckTreeSeqIntegrity(), but it can be much simpler.
 	// We also don't need to sort/deduplicate/simplify; the tables read in should be simplified already.
@@ -7793,20 +8335,16 @@ void SLiMSim::__AddMutationsFromTreeSequenceToGenomes(std::unordered_map<slim_mu
 	for (size_t sample_index = 0; sample_index < sample_count; ++sample_index)
 	{
 		tsk_id_t sample_node_id = vg->samples[sample_index];
-		auto sample_nodeToGenome_iter = p_nodeToGenomeMap.find(sample_node_id);
 		
-		if (sample_nodeToGenome_iter != p_nodeToGenomeMap.end())
-		{
-			// we found a genome for this sample, so record it
-			indexToGenomeMap.push_back(sample_nodeToGenome_iter->second);
-		}
-		else
-		{
-			// this sample is not extant; no corresponding genome, so record nullptr
-			indexToGenomeMap.push_back(nullptr);
-		}
+		indexToGenomeMap.push_back(p_nodeToGenomeMap[sample_node_id]);	// nullptr if this sample is not extant
 	}
 	
+	// Each allele at a site is resolved to its MutationIndex values once per variant, rather than once per genome; the
+	// resolved mutations for allele i are allele_muts[allele_offsets[i]] up to allele_muts[allele_offsets[i + 1]].
+	// Fixed mutations (mut_index == -1) are dropped at this stage, since they are not added to genomes.
+	std::vector<MutationIndex> allele_muts;
+	std::vector<size_t> allele_offsets;
+	
 	// add mutations to genomes by looping through variants
 	do
 	{
@@ -7824,6 +8362,38 @@ void SLiMSim::__AddMutationsFromTreeSequenceToGenomes(std::unordered_map<slim_mu
 			// always add new mutations to the ends of genomes.
 			slim_position_t variant_pos_int = (slim_position_t)variant->site->position;
 			
+			allele_muts.clear();
+			allele_offsets.clear();
+			
+			for (tsk_size_t allele_index = 0; allele_index < variant->num_alleles; ++allele_index)
+			{
+				tsk_size_t allele_length = variant->allele_lengths[allele_index];
+				
+				allele_offsets.push_back(allele_muts.size());
+				
+				if (allele_length % sizeof(slim_mutationid_t) != 0)
+					EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): (internal error) variant allele had length that was not a multiple of sizeof(slim_mutationid_t)." << EidosTerminate();
+				allele_length /= sizeof(slim_mutationid_t);
+				
+				slim_mutationid_t *allele = (slim_mutationid_t *)variant->alleles[allele_index];
+				
+				for (tsk_size_t mutid_index = 0; mutid_index < allele_length; ++mutid_index)
+				{
+					slim_mutationid_t mut_id = allele[mutid_index];
+					ts_mut_info *mut_info = p_mutIndex.Lookup(mut_id);
+					
+					if (!mut_info)
+						EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): mutation id " << mut_id << " was referenced but does not exist." << EidosTerminate();
+					
+					// Add the mutation to the genome unless it is fixed (mut_index == -1); note that a mutation that was
+					// not instantiated because no extant genome references it cannot be referenced by any genome here
+					if (mut_info->mut_index != -1)
+						allele_muts.push_back(mut_info->mut_index);
+				}
+			}
+			
+			allele_offsets.push_back(allele_muts.size());
+			
 			for (size_t sample_index = 0; sample_index < sample_count; sample_index++)
 			{
 				Genome *genome = indexToGenomeMap[sample_index];
@@ -7831,38 +8401,26 @@ void SLiMSim::__AddMutationsFromTreeSequenceToGenomes(std::unordered_map<slim_mu
 				if (genome)
 				{
 					uint16_t genome_variant = variant->genotypes.u16[sample_index];
-					tsk_size_t genome_allele_length = variant->allele_lengths[genome_variant];
-					
-					if (genome_allele_length % sizeof(slim_mutationid_t) != 0)
-						EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): (internal error) variant allele had length that was not a multiple of sizeof(slim_mutationid_t)." << EidosTerminate();
-					genome_allele_length /= sizeof(slim_mutationid_t);
 					
-					if (genome_allele_length > 0)
+					if (variant->allele_lengths[genome_variant] > 0)
 					{
 						if (genome->IsNull())
-							EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): (internal error) null genome has non-zero treeseq allele length " << genome_allele_length << "." << EidosTerminate();
+							EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): (internal error) null genome has non-zero treeseq allele length " << (variant->allele_lengths[genome_variant] / sizeof(slim_mutationid_t)) << "." << EidosTerminate();
+						
+						size_t muts_start = allele_offsets[genome_variant];
+						size_t muts_end = allele_offsets[genome_variant + 1];
+						
+						if (muts_start == muts_end)
+							continue;
 						
-						slim_mutationid_t *genome_allele = (slim_mutationid_t *)variant->alleles[genome_variant];
 						slim_mutrun_index_t run_index = (slim_mutrun_index_t)(variant_pos_int / genome->mutrun_length_);
 						
 						genome->WillModifyRun(run_index);
 						
 						MutationRun *mutrun = genome->mutruns_[run_index].get();
 						
-						for (tsk_size_t mutid_index = 0; mutid_index < genome_allele_length; ++mutid_index)
-						{
-							slim_mutationid_t mut_id = genome_allele[mutid_index];
-							auto mut_index_iter = p_mutIndexMap.find(mut_id);
-							
-							if (mut_index_iter == p_mutIndexMap.end())
-								EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): mutation id " << mut_id << " was referenced but does not exist." << EidosTerminate();
-							
-							// Add the mutation to the genome unless it is fixed (mut_index == -1)
-							MutationIndex mut_index = mut_index_iter->second;
-							
-							if (mut_index != -1)
-								mutrun->emplace_back(mut_index);
-						}
+						for (size_t muts_index = muts_start; muts_index < muts_end; ++muts_index)
+							mutrun->emplace_back(allele_muts[muts_index]);
 					}
 				}
 			}
@@ -7910,7 +8468,8 @@ slim_generation_t SLiMSim::_InstantiateSLiMObjectsFromTables(EidosInterpreter *p
 	ret = tsk_treeseq_init(ts, &tables_, TSK_BUILD_INDEXES);
 	if (ret != 0) handle_error("_InstantiateSLiMObjectsFromTables tsk_treeseq_init()", ret);
 	
-	std::unordered_map<tsk_id_t, Genome *> nodeToGenomeMap;
+	// nodeToGenomeMap is a flat map from node ids to genomes; nodes that are not extant map to nullptr
+	std::vector<Genome *> nodeToGenomeMap(tables_.nodes.num_rows, nullptr);
 	
 	{
 		std::unordered_map<slim_objectid_t, ts_subpop_info> subpopInfoMap;
@@ -7920,18 +8479,15 @@ slim_generation_t SLiMSim::_InstantiateSLiMObjectsFromTables(EidosInterpreter *p
 		__ConfigureSubpopulationsFromTables(p_interpreter);
 	}
 	
-	std::unordered_map<slim_mutationid_t, MutationIndex> mutIndexMap;
-	
 	{
-		std::unordered_map<slim_mutationid_t, ts_mut_info> mutInfoMap;
+		ts_mut_index mutIndex;
 		
-		__TabulateMutationsFromTables(mutInfoMap, file_version);
-		__TallyMutationReferencesWithTreeSequence(mutInfoMap, nodeToGenomeMap, ts);
-		__CreateMutationsFromTabulation(mutInfoMap, mutIndexMap);
+		__TabulateMutationsFromTables(mutIndex, file_version);
+		__TallyMutationReferencesWithTreeSequence(mutIndex, nodeToGenomeMap, ts);
+		__CreateMutationsFromTabulation(mutIndex);
+		__AddMutationsFromTreeSequenceToGenomes(mutIndex, nodeToGenomeMap, ts);
 	}
 	
-	__AddMutationsFromTreeSequenceToGenomes(mutIndexMap, nodeToGenomeMap, ts);
-	
 	ret = tsk_treeseq_free(ts);
 	if (ret != 0) handle_error("_InstantiateSLiMObjectsFromTables tsk_treeseq_free()", ret);
 	free(ts);
@@ -7993,6 +8549,9 @@ slim_generation_t SLiMSim::_InstantiateSLiMObjectsFromTables(EidosInterpreter *p
     }
     ReorderIndividualTable(&tables_, individual_map, false);
 	
+	// Now that the individuals table is in its final order, set up the lookup for remembered individuals
+	RebuildRememberedIndividualsLookup();
+	
 	// Re-tally mutation references so we have accurate frequency counts for our new mutations
 	population_.UniqueMutationRuns();
 	population_.TallyMutationReferences(nullptr, true);
@@ -8020,6 +8579,10 @@ slim_generation_t SLiMSim::_InstantiateSLiMObjectsFromTables(EidosInterpreter *p
 	// here, but if that is not true, no harm done really except that it might be a while before we simplify again)
 	simplify_elapsed_ = 0;
 	
+	// The loaded tables are the new baseline for the tableMemoryLimit growth prediction
+	if (table_memory_limit_ > 0)
+		table_memory_last_ = InUseMemoryForTables(tables_);
+	
 	// Reset our last coalescence state; we don't know whether we're coalesced now or not
 	last_coalescence_state_ = false;
 	
@@ -8131,6 +8694,33 @@ slim_generation_t SLiMSim::_InitializePopulationFromTskitBinaryFile(const char *
 	return _InstantiateSLiMObjectsFromTables(p_interpreter);
 }
 
+size_t SLiMSim::InUseMemoryForTables(tsk_table_collection_t &p_tables)
+{
+	// Unlike MemoryUsageForTables(), which reports allocated capacity, this reports the memory occupied by the rows actually
+	// in use, for the tables that grow as the model runs; it is used to enforce initializeTreeSeq(tableMemoryLimit=...)
+	tsk_table_collection_t &t = p_tables;
+	size_t usage = 0;
+	
+	usage += t.individuals.num_rows * (sizeof(uint32_t) + 2 * sizeof(tsk_size_t));
+	usage += t.individuals.location_length * sizeof(double);
+	usage += t.individuals.metadata_length * sizeof(char);
+	
+	usage += t.nodes.num_rows * (sizeof(uint32_t) + sizeof(double) + 2 * sizeof(tsk_id_t) + sizeof(tsk_size_t));
+	usage += t.nodes.metadata_length * sizeof(char);
+	
+	usage += t.edges.num_rows * (2 * sizeof(double) + 2 * sizeof(tsk_id_t));
+	
+	usage += t.sites.num_rows * (sizeof(double) + 2 * sizeof(tsk_size_t));
+	usage += t.sites.ancestral_state_length * sizeof(char);
+	usage += t.sites.metadata_length * sizeof(char);
+	
+	usage += t.mutations.num_rows * (3 * sizeof(tsk_id_t) + 2 * sizeof(tsk_size_t));
+	usage += t.mutations.derived_state_length * sizeof(char);
+	usage += t.mutations.metadata_length * sizeof(char);
+	
+	return usage;
+}
+
 size_t SLiMSim::MemoryUsageForTables(tsk_table_collection_t &p_tables)
 {
 	tsk_table_collection_t &t = p_tables;
@@ -8245,6 +8835,8 @@ size_t SLiMSim::MemoryUsageForTables(tsk_table_collection_t &p_tables)
 		usage += t.provenances.max_record_length * sizeof(char);
 	
 	usage += remembered_genomes_.size() * sizeof(tsk_id_t);
+	usage += remembered_individuals_lookup_.size() * (sizeof(slim_pedigreeid_t) + sizeof(tsk_id_t) + sizeof(void *));
+	usage += remembered_individuals_lookup_.bucket_count() * sizeof(void *);
 	
 	return usage;
 }
@@ -9512,7 +10104,7 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeSLiMOptions(const std::s
 }
 
 // TREE SEQUENCE RECORDING
-//	*********************	(void)initializeTreeSeq([logical$ recordMutations = T], [Nif$ simplificationRatio = NULL], [Ni$ simplificationInterval = NULL], [logical$ checkCoalescence = F], [logical$ runCrosschecks = F])
+//	*********************	(void)initializeTreeSeq([logical$ recordMutations = T], [Nif$ simplificationRatio = NULL], [Ni$ simplificationInterval = NULL], [logical$ checkCoalescence = F], [logical$ runCrosschecks = F], [Nif$ tableMemoryLimit = NULL], [Ns$ tableLogFile = NULL])
 //
 EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::string &p_function_name, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
 {
@@ -9522,6 +10114,8 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::strin
 	EidosValue *arg_simplificationInterval_value = p_arguments[2].get();
 	EidosValue *arg_checkCoalescence_value = p_arguments[3].get();
 	EidosValue *arg_runCrosschecks_value = p_arguments[4].get();
+	EidosValue *arg_tableMemoryLimit_value = p_arguments[5].get();
+	EidosValue *arg_tableLogFile_value = p_arguments[6].get();
 	std::ostream &output_stream = p_interpreter.ExecutionOutputStream();
 	
 	if (num_treeseq_declarations_ > 0)
@@ -9585,6 +10179,28 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::strin
 	pedigrees_enabled_ = true;
 	pedigrees_enabled_by_tree_seq_ = true;
 	
+	if (arg_tableMemoryLimit_value->Type() != EidosValueType::kValueNULL)
+	{
+		double table_memory_limit = arg_tableMemoryLimit_value->FloatAtIndex(0, nullptr);
+		
+		if (std::isnan(table_memory_limit) || (table_memory_limit <= 0))
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires tableMemoryLimit to be > 0." << EidosTerminate();
+		
+		table_memory_limit_ = (std::isinf(table_memory_limit) ? 0 : (size_t)table_memory_limit);	// INF means no limit
+	}
+	
+	if (arg_tableLogFile_value->Type() != EidosValueType::kValueNULL)
+	{
+		std::string table_log_path = Eidos_ResolvedPath(arg_tableLogFile_value->StringAtIndex(0, nullptr));
+		
+		table_log_.open(table_log_path.c_str(), std::ofstream::out);
+		
+		if (!table_log_.is_open())
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() could not open tableLogFile " << table_log_path << "." << EidosTerminate();
+		
+		table_log_ << "generation,nodes,edges,sites,mutations,individuals,bytes_in_use,bytes_allocated,recording_seconds,simplify_seconds" << std::endl;
+	}
+	
 	if (SLiM_verbosity_level >= 1)
 	{
 		output_stream << "initializeTreeSeq(";
@@ -9624,6 +10240,20 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::strin
 			if (previous_params) output_stream << ", ";
 			output_stream << "runCrosschecks = " << (running_treeseq_crosschecks_ ? "T" : "F");
 			previous_params = true;
+		}
+		
+		if (table_memory_limit_ > 0)
+		{
+			if (previous_params) output_stream << ", ";
+			output_stream << "tableMemoryLimit = " << table_memory_limit_;
+			previous_params = true;
+		}
+		
+		if (table_log_.is_open())
+		{
+			if (previous_params) output_stream << ", ";
+			output_stream << "tableLogFile = '" << arg_tableLogFile_value->StringAtIndex(0, nullptr) << "'";
+			previous_params = true;
 			(void)previous_params;	// dead store above is deliberate
 		}
 		
@@ -9712,7 +10342,7 @@ const std::vector<EidosFunctionSignature_CSP> *SLiMSim::ZeroGenerationFunctionSi
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeSLiMOptions, nullptr, kEidosValueMaskVOID, "SLiM"))
 									   ->AddLogical_OS("keepPedigrees", gStaticEidosValue_LogicalF)->AddString_OS("dimensionality", gStaticEidosValue_StringEmpty)->AddString_OS("periodicity", gStaticEidosValue_StringEmpty)->AddInt_OS("mutationRuns", gStaticEidosValue_Integer0)->AddLogical_OS("preventIncidentalSelfing", gStaticEidosValue_LogicalF)->AddLogical_OS("nucleotideBased", gStaticEidosValue_LogicalF));
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeTreeSeq, nullptr, kEidosValueMaskVOID, "SLiM"))
-									   ->AddLogical_OS("recordMutations", gStaticEidosValue_LogicalT)->AddNumeric_OSN("simplificationRatio", gStaticEidosValueNULL)->AddInt_OSN("simplificationInterval", gStaticEidosValueNULL)->AddLogical_OS("checkCoalescence", gStaticEidosValue_LogicalF)->AddLogical_OS("runCrosschecks", gStaticEidosValue_LogicalF));
+									   ->AddLogical_OS("recordMutations", gStaticEidosValue_LogicalT)->AddNumeric_OSN("simplificationRatio", gStaticEidosValueNULL)->AddInt_OSN("simplificationInterval", gStaticEidosValueNULL)->AddLogical_OS("checkCoalescence", gStaticEidosValue_LogicalF)->AddLogical_OS("runCrosschecks", gStaticEidosValue_LogicalF)->AddNumeric_OSN("tableMemoryLimit", gStaticEidosValueNULL)->AddString_OSN("tableLogFile", gStaticEidosValueNULL));
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeSLiMModelType, nullptr, kEidosValueMaskVOID, "SLiM"))
 									   ->AddString_S("modelType"));
 	}
@@ -9727,7 +10357,7 @@ void SLiMSim::AddZeroGenerationFunctionsToMap(EidosFunctionMap &p_map)
 	if (signatures)
 	{
 		for (const EidosFunctionSignature_CSP &signature : *signatures)
-			p_map.insert(EidosFunctionMapPair(signature->call_name_, signature));
+			p_map.insert(EidosFunctionMapPair(signature->call_id_, signature));
 	}
 }
 
@@ -9738,7 +10368,7 @@ void SLiMSim::RemoveZeroGenerationFunctionsFromMap(EidosFunctionMap &p_map)
 	if (signatures)
 	{
 		for (const EidosFunctionSignature_CSP &signature : *signatures)
-			p_map.erase(signature->call_name_);
+			p_map.erase(signature->call_id_);
 	}
 }
 
@@ -9749,7 +10379,7 @@ void SLiMSim::AddSLiMFunctionsToMap(EidosFunctionMap &p_map)
 	if (signatures)
 	{
 		for (const EidosFunctionSignature_CSP &signature : *signatures)
-			p_map.insert(EidosFunctionMapPair(signature->call_name_, signature));
+			p_map.insert(EidosFunctionMapPair(signature->call_id_, signature));
 	}
 }
 
@@ -10228,6 +10858,10 @@ EidosValue_SP SLiMSim::ExecuteInstanceMethod(EidosGlobalStringID p_method_id, co
 		case gID_treeSeqSimplify:				return ExecuteMethod_treeSeqSimplify(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_treeSeqRememberIndividuals:	return ExecuteMethod_treeSeqRememberIndividuals(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_treeSeqOutput:					return ExecuteMethod_treeSeqOutput(p_method_id, p_arguments, p_argument_count, p_interpreter);
+		case gID_treeSeqDiversity:
+		case gID_treeSeqDivergence:
+		case gID_treeSeqFst:					return ExecuteMethod_treeSeqPairwiseStats(p_method_id, p_arguments, p_argument_count, p_interpreter);
+		case gID_treeSeqSFS:					return ExecuteMethod_treeSeqSFS(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		default:								return SLiMEidosDictionary::ExecuteInstanceMethod(p_method_id, p_arguments, p_argument_count, p_interpreter);
 	}
 }
@@ -11752,6 +12386,162 @@ EidosValue_SP SLiMSim::ExecuteMethod_treeSeqOutput(EidosGlobalStringID p_method_
 }
 
 
+// TREE SEQUENCE RECORDING
+//	*********************	- (float)treeSeqDiversity([No<Subpopulation> subpops = NULL], [string$ mode = "site"], [Nif windows = NULL])
+//	*********************	- (float)treeSeqDivergence(object<Subpopulation> subpops1, object<Subpopulation> subpops2, [string$ mode = "site"], [Nif windows = NULL])
+//	*********************	- (float)treeSeqFst(object<Subpopulation> subpops1, object<Subpopulation> subpops2, [string$ mode = "site"], [Nif windows = NULL])
+//
+EidosValue_SP SLiMSim::ExecuteMethod_treeSeqPairwiseStats(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
+{
+#pragma unused (p_method_id, p_arguments, p_argument_count, p_interpreter)
+	const std::string &method_name = Eidos_StringForGlobalStringID(p_method_id);
+	bool two_sets = (p_method_id != gID_treeSeqDiversity);
+	EidosValue *subpops1_value = p_arguments[0].get();
+	EidosValue *subpops2_value = (two_sets ? p_arguments[1].get() : nullptr);
+	EidosValue *mode_value = p_arguments[two_sets ? 2 : 1].get();
+	EidosValue *windows_value = p_arguments[two_sets ? 3 : 2].get();
+	
+	if (!recording_tree_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqPairwiseStats): " << method_name << "() may only be called when tree recording is enabled." << EidosTerminate();
+	
+	SLiMGenerationStage gen_stage = GenerationStage();
+	
+	if ((gen_stage != SLiMGenerationStage::kWFStage1ExecuteEarlyScripts) && (gen_stage != SLiMGenerationStage::kWFStage5ExecuteLateScripts) &&
+		(gen_stage != SLiMGenerationStage::kNonWFStage2ExecuteEarlyScripts) && (gen_stage != SLiMGenerationStage::kNonWFStage6ExecuteLateScripts))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqPairwiseStats): " << method_name << "() may only be called from an early() or late() event." << EidosTerminate();
+	if ((executing_block_type_ != SLiMEidosBlockType::SLiMEidosEventEarly) && (executing_block_type_ != SLiMEidosBlockType::SLiMEidosEventLate))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqPairwiseStats): " << method_name << "() may not be called from inside a callback." << EidosTerminate();
+	
+	std::string mode = mode_value->StringAtIndex(0, nullptr);
+	
+	if ((mode != "site") && (mode != "branch"))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqPairwiseStats): " << method_name << "() requires mode to be 'site' or 'branch'." << EidosTerminate();
+	if ((mode == "site") && !recording_mutations_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqPairwiseStats): " << method_name << "() requires mutation recording for mode 'site'; mutations are not being recorded (initializeTreeSeq(recordMutations=F))." << EidosTerminate();
+	
+	// the windows are breakpoints from 0 to the end of the chromosome; NULL means one window covering the whole chromosome
+	double sequence_length = (double)chromosome_.last_position_ + 1;
+	std::vector<double> windows;
+	
+	if (windows_value->Type() == EidosValueType::kValueNULL)
+	{
+		windows.push_back(0.0);
+		windows.push_back(sequence_length);
+	}
+	else
+	{
+		int windows_count = windows_value->Count();
+		
+		for (int window_index = 0; window_index < windows_count; ++window_index)
+			windows.push_back(windows_value->FloatAtIndex(window_index, nullptr));
+		
+		if ((windows_count < 2) || (windows.front() != 0.0) || (windows.back() != sequence_length))
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqPairwiseStats): " << method_name << "() requires windows to begin at 0 and end at the last chromosome position plus one." << EidosTerminate();
+		
+		for (int window_index = 1; window_index < windows_count; ++window_index)
+			if (!(windows[window_index] > windows[window_index - 1]))
+				EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqPairwiseStats): " << method_name << "() requires windows to be in strictly increasing order." << EidosTerminate();
+	}
+	
+	// simplify first so the statistic is computed over the smallest tables, and so the genomes' node ids are current
+	// note this is not undone afterwards; the simplified tables are what a later treeSeqOutput() writes, as documented
+	SimplifyTreeSequence();
+	
+	std::vector<std::vector<tsk_id_t>> sample_sets(two_sets ? 2 : 1);
+	
+	TreeSequenceSampleSet(subpops1_value, sample_sets[0]);
+	if (two_sets)
+		TreeSequenceSampleSet(subpops2_value, sample_sets[1]);
+	
+	for (std::vector<tsk_id_t> &sample_set : sample_sets)
+		if (sample_set.size() < ((p_method_id == gID_treeSeqDivergence) ? 1 : 2))
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqPairwiseStats): " << method_name << "() requires " << ((p_method_id == gID_treeSeqDivergence) ? "at least one genome" : "at least two genomes") << " in each sample set." << EidosTerminate();
+	
+	SLiMTreeSeqStat stat = ((p_method_id == gID_treeSeqDiversity) ? SLiMTreeSeqStat::kDiversity : ((p_method_id == gID_treeSeqDivergence) ? SLiMTreeSeqStat::kDivergence : SLiMTreeSeqStat::kFst));
+	size_t result_dim = ((stat == SLiMTreeSeqStat::kFst) ? 3 : 1);
+	size_t window_count = windows.size() - 1;
+	std::vector<double> result;
+	
+	TreeSequenceStatistic(stat, sample_sets, (mode == "branch"), true, windows, result_dim, result);
+	
+	EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(window_count);
+	
+	for (size_t window_index = 0; window_index < window_count; ++window_index)
+	{
+		if (stat == SLiMTreeSeqStat::kFst)
+		{
+			// Hudson's Fst, 1 - (mean within-set diversity) / (between-set divergence), which is undefined if divergence is zero
+			double *window_result = result.data() + window_index * 3;
+			double fst = ((window_result[2] > 0.0) ? 1.0 - ((window_result[0] + window_result[1]) / 2.0) / window_result[2] : NAN);
+			
+			float_result->set_float_no_check(fst, window_index);
+		}
+		else
+		{
+			float_result->set_float_no_check(result[window_index], window_index);
+		}
+	}
+	
+	return EidosValue_SP(float_result);
+}
+
+// TREE SEQUENCE RECORDING
+//	*********************	- (float)treeSeqSFS([No<Subpopulation> subpops = NULL], [string$ mode = "site"], [logical$ polarised = T])
+//
+EidosValue_SP SLiMSim::ExecuteMethod_treeSeqSFS(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
+{
+#pragma unused (p_method_id, p_arguments, p_argument_count, p_interpreter)
+	EidosValue *subpops_value = p_arguments[0].get();
+	EidosValue *mode_value = p_arguments[1].get();
+	EidosValue *polarised_value = p_arguments[2].get();
+	
+	if (!recording_tree_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqSFS): treeSeqSFS() may only be called when tree recording is enabled." << EidosTerminate();
+	
+	SLiMGenerationStage gen_stage = GenerationStage();
+	
+	if ((gen_stage != SLiMGenerationStage::kWFStage1ExecuteEarlyScripts) && (gen_stage != SLiMGenerationStage::kWFStage5ExecuteLateScripts) &&
+		(gen_stage != SLiMGenerationStage::kNonWFStage2ExecuteEarlyScripts) && (gen_stage != SLiMGenerationStage::kNonWFStage6ExecuteLateScripts))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqSFS): treeSeqSFS() may only be called from an early() or late() event." << EidosTerminate();
+	if ((executing_block_type_ != SLiMEidosBlockType::SLiMEidosEventEarly) && (executing_block_type_ != SLiMEidosBlockType::SLiMEidosEventLate))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqSFS): treeSeqSFS() may not be called from inside a callback." << EidosTerminate();
+	
+	std::string mode = mode_value->StringAtIndex(0, nullptr);
+	bool polarised = polarised_value->LogicalAtIndex(0, nullptr);
+	
+	if ((mode != "site") && (mode != "branch"))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqSFS): treeSeqSFS() requires mode to be 'site' or 'branch'." << EidosTerminate();
+	if ((mode == "site") && !recording_mutations_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqSFS): treeSeqSFS() requires mutation recording for mode 'site'; mutations are not being recorded (initializeTreeSeq(recordMutations=F))." << EidosTerminate();
+	
+	// simplify first so the statistic is computed over the smallest tables, and so the genomes' node ids are current
+	// note this is not undone afterwards; the simplified tables are what a later treeSeqOutput() writes, as documented
+	SimplifyTreeSequence();
+	
+	std::vector<std::vector<tsk_id_t>> sample_sets(1);
+	
+	TreeSequenceSampleSet(subpops_value, sample_sets[0]);
+	
+	size_t sample_count = sample_sets[0].size();
+	
+	if (sample_count < 1)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqSFS): treeSeqSFS() requires at least one genome in the sample set." << EidosTerminate();
+	
+	// the SFS has an entry for each count from 0 to the sample size; folding leaves entries up to half the sample size
+	std::vector<double> windows{0.0, (double)chromosome_.last_position_ + 1};
+	size_t result_dim = (polarised ? sample_count + 1 : sample_count / 2 + 1);
+	std::vector<double> result;
+	
+	TreeSequenceStatistic(SLiMTreeSeqStat::kSFS, sample_sets, (mode == "branch"), polarised, windows, result_dim, result);
+	
+	EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(result_dim);
+	
+	for (size_t count_index = 0; count_index < result_dim; ++count_index)
+		float_result->set_float_no_check(result[count_index], count_index);
+	
+	return EidosValue_SP(float_result);
+}
+
 //
 //	SLiMSim_Class
 //
@@ -11849,6 +12639,10 @@ const std::vector<EidosMethodSignature_CSP> *SLiMSim_Class::Methods(void) const
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqSimplify, kEidosValueMaskVOID)));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqRememberIndividuals, kEidosValueMaskVOID))->AddObject("individuals", gSLiM_Individual_Class));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqOutput, kEidosValueMaskVOID))->AddString_S("path")->AddLogical_OS("simplify", gStaticEidosValue_LogicalT)->AddLogical_OS("_binary", gStaticEidosValue_LogicalT));
+		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqDiversity, kEidosValueMaskFloat))->AddObject_ON("subpops", gSLiM_Subpopulation_Class, gStaticEidosValueNULL)->AddString_OS("mode", EidosValue_String_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton("site")))->AddNumeric_ON("windows", gStaticEidosValueNULL));
+		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqDivergence, kEidosValueMaskFloat))->AddObject("subpops1", gSLiM_Subpopulation_Class)->AddObject("subpops2", gSLiM_Subpopulation_Class)->AddString_OS("mode", EidosValue_String_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton("site")))->AddNumeric_ON("windows", gStaticEidosValueNULL));
+		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqFst, kEidosValueMaskFloat))->AddObject("subpops1", gSLiM_Subpopulation_Class)->AddObject("subpops2", gSLiM_Subpopulation_Class)->AddString_OS("mode", EidosValue_String_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton("site")))->AddNumeric_ON("windows", gStaticEidosValueNULL));
+		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqSFS, kEidosValueMaskFloat))->AddObject_ON("subpops", gSLiM_Subpopulation_Class, gStaticEidosValueNULL)->AddString_OS("mode", EidosValue_String_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton("site")))->AddLogical_OS("polarised", gStaticEidosValue_LogicalT));
 							  
 		std::sort(methods->begin(), methods->end(), CompareEidosCallSignatures);
 	}
@@ -30,7 +30,9 @@
 #include <stdio.h>
 #include <map>
 #include <vector>
+#include <unordered_map>
 #include <iostream>
+#include <fstream>
 
 #include "slim_globals.h"
 #include "mutation.h"
@@ -61,6 +63,7 @@ class EidosInterpreter;
 class Individual;
 struct ts_subpop_info;
 struct ts_mut_info;
+struct ts_mut_index;
 
 extern EidosObjectClass *gSLiM_SLiMSim_Class;
 
@@ -104,6 +107,14 @@ enum class SLiMFileFormat
 	kFormatTskitBinary_kastore,	// as saved by treeSeqOutput(path, binary=T)
 };
 
+enum class SLiMTreeSeqStat
+{
+	kDiversity = 0,					// mean pairwise difference within one sample set; treeSeqDiversity()
+	kDivergence,					// mean pairwise difference between two sample sets; treeSeqDivergence()
+	kFst,							// the diversity of each of two sample sets and their divergence, from which treeSeqFst() computes Fst
+	kSFS,							// the site frequency spectrum of one sample set; treeSeqSFS()
+};
+
 
 // TREE SEQUENCE RECORDING
 #pragma mark -
@@ -430,6 +441,7 @@ private:
 	tsk_bookmark_t table_position_;
 	
     std::vector<tsk_id_t> remembered_genomes_;
+	std::unordered_map<slim_pedigreeid_t, tsk_id_t> remembered_individuals_lookup_;	// pedigree id -> individuals table row, for remembered/first-gen individuals
 	//Individual *current_new_individual_;
 	
 	bool running_coalescence_checks_ = false;	// true if we check for coalescence after each simplification
@@ -443,6 +455,14 @@ private:
 	int64_t simplify_elapsed_ = 0;				// the number of generations elapsed since a simplification was done (automatic or otherwise)
 	double simplify_interval_;					// the current number of generations between automatic simplifications when using simplification_ratio_
 	
+	size_t table_memory_limit_ = 0;				// a soft limit, in bytes, on the in-use size of the tables, enforced by early simplification; 0 if none
+	size_t table_memory_last_ = 0;				// the in-use size of the tables at the previous check, used to predict growth over the next generation
+	bool table_memory_limit_warned_ = false;	// true if we have warned that simplification could not bring the tables under table_memory_limit_
+	
+	std::ofstream table_log_;					// if open, a CSV log of table sizes and recording times, written each generation
+	double table_recording_seconds_ = 0.0;		// time spent recording genomes and derived states this generation, if table_log_ is open
+	double table_simplify_seconds_ = 0.0;		// time spent simplifying this generation, if table_log_ is open
+	
 	slim_generation_t tree_seq_generation_ = 0;	// the generation for the tree sequence code, incremented after offspring generation
 												// this is needed since addSubpop() in an early() event makes one gen, and then the offspring
 												// arrive in the same generation according to SLiM, which confuses the tree-seq code
@@ -601,7 +621,9 @@ public:
 	void AllocateTreeSequenceTables(void);
 	void SetCurrentNewIndividual(Individual *p_individual);
 	void RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genome *p_new_genome, const Genome *p_initial_parental_genome, const Genome *p_second_parental_genome);
+	void _RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genome *p_new_genome, const Genome *p_initial_parental_genome, const Genome *p_second_parental_genome);
 	void RecordNewDerivedState(const Genome *p_genome, slim_position_t p_position, const std::vector<Mutation *> &p_derived_mutations);
+	void _RecordNewDerivedState(const Genome *p_genome, slim_position_t p_position, const std::vector<Mutation *> &p_derived_mutations);
 	void RetractNewIndividual(void);
     void AddIndividualsToTable(Individual * const *p_individual, size_t p_num_individuals, tsk_table_collection_t *p_tables, uint32_t p_flags);
 	void AddCurrentGenerationToIndividuals(tsk_table_collection_t *p_tables);
@@ -612,10 +634,14 @@ public:
 	void WriteProvenanceTable(tsk_table_collection_t *p_tables, bool p_use_newlines);
 	void ReadProvenanceTable(tsk_table_collection_t *p_tables, slim_generation_t *p_generation, SLiMModelType *p_model_type, int *p_file_version);
 	void WriteTreeSequence(std::string &p_recording_tree_path, bool p_binary, bool p_simplify);
-    void ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vector<int> p_individual_map, bool p_keep_unmapped);
+    void ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vector<int> &p_individual_map, bool p_keep_unmapped);
+	void RebuildRememberedIndividualsLookup(void);
 	void SimplifyTreeSequence(void);
 	void CheckCoalescenceAfterSimplification(void);
 	void CheckAutoSimplification(void);
+	void LogTreeSequenceTables(void);
+	void TreeSequenceSampleSet(EidosValue *p_subpops_value, std::vector<tsk_id_t> &p_sample_set);
+	void TreeSequenceStatistic(SLiMTreeSeqStat p_stat, std::vector<std::vector<tsk_id_t>> &p_sample_sets, bool p_branch_mode, bool p_polarised, std::vector<double> &p_windows, size_t p_result_dim, std::vector<double> &p_result);
     void TreeSequenceDataFromAscii(std::string NodeFileName, 
             std::string EdgeFileName, std::string SiteFileName, std::string MutationFileName, 
             std::string IndividualsFileName, std::string PopulationFileName, std::string ProvenanceFileName);
@@ -626,16 +652,17 @@ public:
 	void TSXC_Enable(void);
 	
 	void __TabulateSubpopulationsFromTreeSequence(std::unordered_map<slim_objectid_t, ts_subpop_info> &p_subpopInfoMap, tsk_treeseq_t *p_ts, SLiMModelType p_file_model_type);
-	void __CreateSubpopulationsFromTabulation(std::unordered_map<slim_objectid_t, ts_subpop_info> &p_subpopInfoMap, EidosInterpreter *p_interpreter, std::unordered_map<tsk_id_t, Genome *> &p_nodeToGenomeMap);
+	void __CreateSubpopulationsFromTabulation(std::unordered_map<slim_objectid_t, ts_subpop_info> &p_subpopInfoMap, EidosInterpreter *p_interpreter, std::vector<Genome *> &p_nodeToGenomeMap);
 	void __ConfigureSubpopulationsFromTables(EidosInterpreter *p_interpreter);
-	void __TabulateMutationsFromTables(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutMap, int p_file_version);
-	void __TallyMutationReferencesWithTreeSequence(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutMap, std::unordered_map<tsk_id_t, Genome *> p_nodeToGenomeMap, tsk_treeseq_t *p_ts);
-	void __CreateMutationsFromTabulation(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutInfoMap, std::unordered_map<slim_mutationid_t, MutationIndex> &p_mutIndexMap);
-	void __AddMutationsFromTreeSequenceToGenomes(std::unordered_map<slim_mutationid_t, MutationIndex> &p_mutIndexMap, std::unordered_map<tsk_id_t, Genome *> p_nodeToGenomeMap, tsk_treeseq_t *p_ts);
+	void __TabulateMutationsFromTables(ts_mut_index &p_mutIndex, int p_file_version);
+	void __TallyMutationReferencesWithTreeSequence(ts_mut_index &p_mutIndex, std::vector<Genome *> &p_nodeToGenomeMap, tsk_treeseq_t *p_ts);
+	void __CreateMutationsFromTabulation(ts_mut_index &p_mutIndex);
+	void __AddMutationsFromTreeSequenceToGenomes(ts_mut_index &p_mutIndex, std::vector<Genome *> &p_nodeToGenomeMap, tsk_treeseq_t *p_ts);
 	slim_generation_t _InstantiateSLiMObjectsFromTables(EidosInterpreter *p_interpreter);								// given tree-seq tables, makes individuals, genomes, and mutations
 	slim_generation_t _InitializePopulationFromTskitTextFile(const char *p_file, EidosInterpreter *p_interpreter);	// initialize the population from an tskit text file
 	slim_generation_t _InitializePopulationFromTskitBinaryFile(const char *p_file, EidosInterpreter *p_interpreter);	// initialize the population from an tskit binary file
 	size_t MemoryUsageForTables(tsk_table_collection_t &p_tables);
+	size_t InUseMemoryForTables(tsk_table_collection_t &p_tables);
 	
 	//
 	// Eidos support
@@ -706,6 +733,8 @@ public:
 	EidosValue_SP ExecuteMethod_treeSeqSimplify(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_treeSeqRememberIndividuals(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_treeSeqOutput(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
+	EidosValue_SP ExecuteMethod_treeSeqPairwiseStats(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
+	EidosValue_SP ExecuteMethod_treeSeqSFS(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 };
 
 
@@ -19,6 +19,7 @@
 #include <map>
 #include <utility>
 #include <ctime>
+#include <algorithm>
 
 
 // Helper functions for testing
@@ -289,6 +290,7 @@ static std::string gen1_setup_i1xyz("initialize() { initializeSLiMOptions(dimens
 static std::string gen1_setup_i1xyzPxz("initialize() { initializeSLiMOptions(dimensionality='xyz', periodicity='xz'); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); initializeInteractionType('i1', 'xyz'); } 1 { sim.addSubpop('p1', 10); } 1:10 late() { p1.individuals.x = runif(10); p1.individuals.y = runif(10); p1.individuals.z = runif(10); i1.evaluate(); i1.strength(p1.individuals[0]); } ");
 static std::string gen1_setup_p1(gen1_setup + "1 { sim.addSubpop('p1', 10); } ");
 static std::string gen1_setup_sex_p1(gen1_setup_sex + "1 { sim.addSubpop('p1', 10); } ");
+static std::string gen1_setup_spatial_genetics("initializeMutationRate(0); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99); initializeRecombinationRate(1e-8);");
 static std::string gen1_setup_p1p2p3(gen1_setup + "1 { sim.addSubpop('p1', 10); sim.addSubpop('p2', 10); sim.addSubpop('p3', 10); } ");
 
 static std::string WF_prefix("initialize() { initializeSLiMModelType('WF'); } ");
@@ -1626,6 +1628,8 @@ void _RunMutationTests(void)
 	SLiMAssertScriptRaise(gen1_setup_highmut_p1 + "10 { mut = sim.mutations[0]; mut.setSelectionCoeff(1); if (mut.selectionCoeff == 1) stop(); }", 1, 276, "cannot be type integer", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_highmut_p1 + "10 { mut = sim.mutations[0]; mut.setSelectionCoeff(-500.0); if (mut.selectionCoeff == -500.0) stop(); }", __LINE__);	// legal; no lower bound
 	SLiMAssertScriptStop(gen1_setup_highmut_p1 + "10 { mut = sim.mutations[0]; mut.setSelectionCoeff(500.0); if (mut.selectionCoeff == 500.0) stop(); }", __LINE__);		// legal; no upper bound
+	SLiMAssertScriptStop(gen1_setup_highmut_p1 + "10 { muts = sim.mutations; muts.setSelectionCoeff(0.5); if (all(muts.selectionCoeff == 0.5) & (size(muts) > 1)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_highmut_p1 + "10 { muts = sim.mutations; muts.setSelectionCoeff(0.5); muts.setSelectionCoeff(0.0); sim.recalculateFitness(); if (all(muts.selectionCoeff == 0.0) & all(p1.cachedFitness(NULL) == 1.0)) stop(); }", __LINE__);
 }
 
 #pragma mark Genome tests
@@ -1646,6 +1650,9 @@ void _RunGenomeTests(std::string temp_path)
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { gen = p1.genomes[0]; gen.genomeType = 'A'; stop(); }", 1, 283, "read-only property", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { gen = p1.genomes[0]; gen.isNullGenome = F; stop(); }", 1, 285, "read-only property", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_highmut_p1 + "10 { gen = p1.genomes[0]; gen.mutations[0].mutationType = m1; stop(); }", 1, 299, "read-only property", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_sex_p1 + "1 { g = p1.genomes; if (identical(g.genomeType, sapply(g, 'applyValue.genomeType;'))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1 + "1 { g = p1.genomes; if (identical(g.individual, repEach(p1.individuals, 2))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_highmut_p1 + "10 { g = p1.genomes; if (identical(g.mutations, sapply(g, 'applyValue.mutations;')) & (size(g.mutations) > 0)) stop(); }", __LINE__);
 	
 	// Test Genome + (void)addMutations(object<Mutation> mutations)
 	SLiMAssertScriptStop(gen1_setup_p1 + "1 { gen = p1.genomes[0]; gen.addMutations(object()); stop(); }", __LINE__);
@@ -1898,6 +1905,24 @@ void _RunSubpopulationTests(void)
 	SLiMAssertScriptStop(gen1_setup_p1 + "1 { if (p1.selfingRate == 0.0) stop(); }", __LINE__);									// legal but always 0.0 in non-sexual sims
 	SLiMAssertScriptStop(gen1_setup_p1 + "1 { if (p1.sexRatio == 0.0) stop(); }", __LINE__);										// legal but always 0.0 in non-sexual sims
 	SLiMAssertScriptStop(gen1_setup_p1 + "1 { if (p1.individualCount == 10) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "1 { s = sim.subpopulations; if (identical(s.individuals, c(p1.individuals, p2.individuals, p3.individuals))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "1 late() { s = sim.subpopulations; if (identical(s.individuals, c(p1.individuals, p2.individuals, p3.individuals))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "2 { s = sim.subpopulations; if (identical(s.genomes, c(p1.genomes, p2.genomes, p3.genomes))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "2 late() { s = sim.subpopulations; if (identical(s.genomes, s.individuals.genomes)) stop(); }", __LINE__);
+	
+	// Test property chains, which are evaluated in a single traversal; see EidosInterpreter::_Evaluate_PropertyChain()
+	SLiMAssertScriptStop(gen1_setup_p1 + "1 { if (identical(p1.individuals.genomes.individual, repEach(p1.individuals, 2))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1 + "1 { if (identical(p1.genomes.individual.genomes.individual.genome2, repEach(p1.individuals.genome2, 4))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1 + "1 { i = p1.individuals[0]; if (identical(i.genomes.individual, c(i, i)) & identical(i.genome1.individual, i)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1 + "1 { i = p1.individuals[integer(0)]; if (identical(i.genomes.individual.index, integer(0))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1 + "1 { i = matrix(p1.individuals, nrow=2); x = i.genome1.individual; y = i.genome2.individual.index; if (identical(x, i) & identical(dim(y), c(2, 5)) & isNULL(dim(i.genomes.individual))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "1 { if (identical(sim.subpopulations.individuals.genomes.individual.subpopulation.id, repEach(c(1, 2, 3), 20))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_highmut_p1 + "10 { g = p1.genomes; if (identical(p1.individuals.genomes.mutations, g.mutations) & identical(g.mutations.mutationType.id, sapply(g.mutations, 'applyValue.mutationType.id;')) & (size(g.mutations) > 0)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1 + "1 { x = p1.genomes.individual.genome1.individual.genome1.individual.genome1.individual.genome1.individual.genome1.individual.genome1.individual.genome1.individual.genome1.individual.genome1.individual; if (identical(x, repEach(p1.individuals, 2))) stop(); }", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { p1.individuals.genomes.foo; }", 1, 270, "not defined for object element type Genome", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { p1.individuals.genome1.foo.individual; }", 1, 270, "not defined for object element type Genome", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { p1.genomes.individual.tag; }", 1, 269, "before being set", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { p1.genomes.individual.spatialPosition; }", 1, 269, "non-spatial simulations", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { p1.tag; }", 1, 250, "before being set", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { c(p1,p1).tag; }", 1, 256, "before being set", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_p1 + "1 { p1.tag = 135; if (p1.tag == 135) stop(); }", __LINE__);
@@ -2407,6 +2432,17 @@ void _RunSubpopulationTests(void)
 	SLiMAssertScriptStop(gen1_setup_i1xyz_bounds + "if (size(p1.pointUniform(1)) == 3) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1xyz_bounds + "if (size(p1.pointUniform(5)) == 15) stop(); }", __LINE__);
 	
+	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { p1.deviatePositions(NULL, 'reflecting', 0.1); stop(); }", 1, 250, "non-spatial simulations", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_i1xyz_bounds + "p1.deviatePositions(NULL, 'foo', 0.1); stop(); }", 1, 550, "requires boundary to be", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_i1xyz_bounds + "p1.deviatePositions(NULL, 'reflecting', -0.1); stop(); }", 1, 550, "requires sigma to be finite", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_i1xyz_bounds + "p1.deviatePositions(NULL, 'periodic', 0.1); stop(); }", 1, 550, "all spatial dimensions be periodic", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_i1xyz_bounds + "p1.individuals.x = 5.0; p1.deviatePositions(NULL, 'reprising', 0.1); stop(); }", 1, 574, "within the spatial bounds", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1xyz_bounds + "p1.deviatePositions(p1.individuals[integer(0)], 'reflecting', 0.1); stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1xyz_bounds + "inds = p1.individuals; inds.setSpatialPosition(p1.pointUniform(10)); setSeed(3); p1.deviatePositions(NULL, 'reflecting', 2.0); p = inds.spatialPosition; inds.setSpatialPosition(p1.pointUniform(10)); x = inds.spatialPosition; setSeed(3); p1.deviatePositions(NULL, 'reflecting', 2.0); a = inds.spatialPosition; inds.setSpatialPosition(x); setSeed(3); inds.setSpatialPosition(p1.pointReflected(inds.spatialPosition + rnorm(30, 0, 2.0))); if (identical(a, inds.spatialPosition) & all(p1.pointInBounds(p))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1xyz_bounds + "inds = p1.individuals; inds.setSpatialPosition(p1.pointUniform(10)); x = inds.spatialPosition; setSeed(3); p1.deviatePositions(inds[c(0,2,4)], 'stopping', 2.0); a = inds.spatialPosition; inds.setSpatialPosition(x); setSeed(3); inds[c(0,2,4)].setSpatialPosition(p1.pointStopped(inds[c(0,2,4)].spatialPosition + rnorm(9, 0, 2.0))); if (identical(a, inds.spatialPosition)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1xyz_bounds + "inds = p1.individuals; inds.setSpatialPosition(p1.pointUniform(10)); x = inds.spatialPosition; setSeed(3); p1.deviatePositions(NULL, 'reprising', 5.0); if (all(p1.pointInBounds(inds.spatialPosition)) & !identical(x, inds.spatialPosition)) stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xy', periodicity='xy'); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); } 1 { sim.addSubpop('p1', 10); p1.setSpatialBounds(c(0.0, 0.0, 3.0, 5.0)); inds = p1.individuals; inds.setSpatialPosition(p1.pointUniform(10)); x = inds.spatialPosition; setSeed(3); p1.deviatePositions(NULL, 'periodic', 4.0); a = inds.spatialPosition; inds.setSpatialPosition(x); setSeed(3); inds.setSpatialPosition(p1.pointPeriodic(inds.spatialPosition + rnorm(20, 0, 4.0))); if (identical(a, inds.spatialPosition)) stop(); }", __LINE__);
+	
 	SLiMAssertScriptStop(gen1_setup_i1xyzPxz_bounds + "if (identical(p1.pointPeriodic(c(-10.5, 1.0, 11.0)), c(7.5, 1.0, 11.0))) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1xyzPxz_bounds + "if (identical(p1.pointPeriodic(c(-9.5, 1.0, 11.0)), c(8.5, 1.0, 11.0))) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1xyzPxz_bounds + "if (identical(p1.pointPeriodic(c(-8.0, 1.0, 11.0)), c(1.0, 1.0, 11.0))) stop(); }", __LINE__);
@@ -2732,6 +2768,11 @@ void _RunSubpopulationTests(void)
 	SLiMAssertScriptStop(gen1_setup_i1xyz_mapIxyz + "if (p1.spatialMapColor('map', 0.0001) == '#007F00') stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1xyz_mapIxyz + "if (p1.spatialMapColor('map', 2.5) == '#00BF80') stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1xyz_mapIxyz + "if (p1.spatialMapColor('map', 5.0) == '#00FFFF') stop(); }", __LINE__);
+	
+	// batch lookups of many points at once should match one-point lookups exactly, with non-unit bounds and out-of-bounds points
+	SLiMAssertScriptStop(gen1_setup_i1xyz_bounds + "p1.defineSpatialMap('map', 'yz', c(4,3), runif(12), interpolate=T); p = runif(200, -1.0, 14.0); v = p1.spatialMapValue('map', p); if (identical(v, sapply(0:99, 'p1.spatialMapValue(\\'map\\', p[c(applyValue*2, applyValue*2+1)]);'))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1xyz_bounds + "p1.defineSpatialMap('map', 'xyz', c(3,4,2), runif(24), interpolate=T); p = runif(300, -11.0, 14.0); v = p1.spatialMapValue('map', p); if (identical(v, sapply(0:99, 'p1.spatialMapValue(\\'map\\', p[applyValue*3 + 0:2]);'))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1xyz_bounds + "p1.defineSpatialMap('map', 'xz', c(3,4), runif(12), interpolate=F); p = runif(200, -11.0, 14.0); v = p1.spatialMapValue('map', p); if (identical(v, sapply(0:99, 'p1.spatialMapValue(\\'map\\', p[c(applyValue*2, applyValue*2+1)]);'))) stop(); }", __LINE__);
 }
 
 #pragma mark Individual tests
@@ -2769,6 +2810,8 @@ void _RunIndividualTests(void)
 	SLiMAssertScriptStop(gen1_setup_p1 + "1 { i = p1.individuals; i.y = 135.0; if (all(i.y == 135.0)) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_p1 + "1 { i = p1.individuals; i.z = 135.0; if (all(i.z == 135.0)) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_p1 + "10 { i = p1.individuals; i.uniqueMutations; stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_sex_p1 + "1 { i = p1.individuals; if (identical(i.sex, sapply(i, 'applyValue.sex;'))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_sex_p1 + "1 { i = p1.individuals; if (identical(i.genomes, sapply(i, 'applyValue.genomes;'))) stop(); }", __LINE__);
 	
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { i = p1.individuals; i.genome1 = i[0].genomes[0]; stop(); }", 1, 277, "read-only property", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { i = p1.individuals; i.genome2 = i[0].genomes[0]; stop(); }", 1, 277, "read-only property", __LINE__);
@@ -2816,6 +2859,7 @@ void _RunIndividualTests(void)
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { i = p1.individuals; i.x = 0.5; if (identical(i.spatialPosition, rep(0.5, 10))) stop(); }", 1, 294, "position cannot be accessed", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1x + "1 { i = p1.individuals; i.x = 0.5; if (identical(i.spatialPosition, rep(0.5, 10))) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1xyz + "1 { i = p1.individuals; i.x = 0.5; i.y = 0.6; i.z = 0.7; if (identical(i.spatialPosition, rep(c(0.5, 0.6, 0.7), 10))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1xyz + "1 { i = p1.individuals; i.x = runif(10); i.y = runif(10); i.z = runif(10); if (identical(i.spatialPosition, sapply(i, 'applyValue.spatialPosition;'))) stop(); }", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { i = p1.individuals; i.spatialPosition = 0.5; stop(); }", 1, 285, "read-only property", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_i1x + "1 { i = p1.individuals; i.spatialPosition = 0.5; stop(); }", 1, 459, "read-only property", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_i1xyz + "1 { i = p1.individuals; i.spatialPosition = 0.5; stop(); }", 1, 523, "read-only property", __LINE__);
@@ -2891,6 +2935,8 @@ void _RunIndividualTests(void)
 	SLiMAssertScriptStop(gen1_setup_rel + "5 { if (all(p1.individuals.pedigreeID != -1)) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_rel + "5 { if (all(p1.individuals.pedigreeParentIDs != -1)) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_rel + "5 { if (all(p1.individuals.pedigreeGrandparentIDs != -1)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_rel + "5 { i = p1.individuals; if (identical(i.pedigreeParentIDs, sapply(i, 'applyValue.pedigreeParentIDs;'))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_rel + "5 { i = p1.individuals; if (identical(i.pedigreeGrandparentIDs, sapply(i, 'applyValue.pedigreeGrandparentIDs;'))) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_rel + "5 { if (all(p1.individuals.genomes.genomePedigreeID != -1)) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_rel + "5 { if (p1.individuals[0].relatedness(p1.individuals[0]) == 1.0) stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_rel + "5 { if (p1.individuals[0].relatedness(p1.individuals[1]) <= 0.5) stop(); }", __LINE__);
@@ -2932,6 +2978,27 @@ void _RunInteractionTypeTests(void)
 	SLiMAssertScriptRaise(gen1_setup_i1x + "1 { i1.tag; }", 1, 424, "before being set", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_i1x + "1 { c(i1,i1).tag; }", 1, 430, "before being set", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1x + "1 { i1.tag = 17; } 2 { if (i1.tag == 17) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1x + "1 { if (i1.fastMath == F) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1x + "1 { i1.fastMath = T; if (i1.fastMath == T) stop(); }", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_i1x + "2 { i1.fastMath = T; }", 1, 433, "while the interaction is being evaluated", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1x + "1 { i1.maxDistance = 0.5; i1.setInteractionFunction('e', 2.0, 5.0); } 2 { ind = p1.individuals; exact = i1.totalOfNeighborStrengths(ind); i1.unevaluate(); i1.fastMath = T; i1.evaluate(); fast = i1.totalOfNeighborStrengths(ind); if (all(abs(fast - exact) <= 1e-6 * exact)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1x + "1 { i1.maxDistance = 0.5; i1.setInteractionFunction('n', 2.0, 0.1); } 2 { ind = p1.individuals; exact = i1.totalOfNeighborStrengths(ind); i1.unevaluate(); i1.fastMath = T; i1.evaluate(); fast = i1.totalOfNeighborStrengths(ind); if (all(abs(fast - exact) <= 1e-6 * exact)) stop(); }", __LINE__);
+	
+	// Test re-evaluation after a few individuals have moved, which patches the k-d tree or grid rather than rebuilding it, against brute force
+	for (std::string maxDistance : {"0.05", "0.3"})
+		SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xy'); " + gen1_setup_spatial_genetics + " initializeInteractionType('i1', 'xy', maxDistance=" + maxDistance + "); } 1 { sim.addSubpop('p1', 500); inds = p1.individuals; inds.setSpatialPosition(p1.pointUniform(500)); ok = T; for (rep in 1:5) { i1.evaluate(); for (ind in inds[0:49]) { near = which(i1.distance(ind, inds) <= " + maxDistance + "); near = near[near != ind.index]; ok = ok & identical(sort(i1.nearestNeighbors(ind, 500).index), near); ok = ok & (i1.interactingNeighborCount(ind) == size(near)); } moving = inds[sample(0:499, 10)]; moving.setSpatialPosition(p1.pointReflected(moving.spatialPosition + rnorm(20, 0, 0.02))); if (rep == 3) i1.unevaluate(); } if (ok) stop(); }", __LINE__);
+	
+	// Test sparse array building, which visits receivers in spatial order, with periodic boundaries and sex-segregation, against brute force
+	for (std::string maxDistance : {"0.05", "0.3"})
+		SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xy', periodicity='xy'); initializeSex('A'); " + gen1_setup_spatial_genetics + " initializeInteractionType('i1', 'xy', maxDistance=" + maxDistance + ", sexSegregation='MF'); } 1 { sim.addSubpop('p1', 500); inds = p1.individuals; inds.setSpatialPosition(p1.pointUniform(500)); i1.evaluate(); counts = i1.interactingNeighborCount(inds); ok = T; for (ind in inds) { expected = (ind.sex == 'M') ? sum((i1.distance(ind, inds) <= " + maxDistance + ") & (inds.sex == 'F')) else 0; ok = ok & (counts[ind.index] == expected); } if (ok) stop(); }", __LINE__);
+	
+	// Test that totals streamed without building the sparse array match those from the sparse array, which strength() forces to be built
+	for (std::string sexSegregation : {"**", "MF", "*M"})
+		SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xy'); initializeSex('A'); " + gen1_setup_spatial_genetics + " initializeInteractionType('i1', 'xy', maxDistance=0.1, sexSegregation='" + sexSegregation + "'); i1.setInteractionFunction('n', 1.0, 0.05); } 1 { sim.addSubpop('p1', 3000); inds = p1.individuals; inds.setSpatialPosition(p1.pointUniform(3000)); subset = inds[sample(0:2999, 500)]; i1.evaluate(); a = i1.totalOfNeighborStrengths(inds); b = i1.interactingNeighborCount(subset); i1.strength(inds[0]); if (identical(a, i1.totalOfNeighborStrengths(inds))) if (identical(b, i1.interactingNeighborCount(subset))) stop(); }", __LINE__);
+	
+	// Test the uniform grid used instead of the k-d tree for small maxDistance, with and without periodic boundaries, against brute force
+	for (std::string periodicity : {"", "xy"})
+		SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xy', periodicity='" + periodicity + "'); " + gen1_setup_spatial_genetics + " initializeInteractionType('i1', 'xy', maxDistance=0.05); } 1 { sim.addSubpop('p1', 500); inds = p1.individuals; inds.setSpatialPosition(p1.pointUniform(500)); i1.evaluate(); ok = T; for (ind in inds[0:49]) { near = which(i1.distance(ind, inds) <= 0.05); near = near[near != ind.index]; ok = ok & identical(sort(i1.nearestNeighbors(ind, 500).index), near); ok = ok & (i1.interactingNeighborCount(ind) == size(near)); if (size(near)) ok = ok & (i1.nearestNeighbors(ind, 1).index == near[whichMax(-i1.distance(ind, inds[near]))]); ok = ok & identical(sort(i1.nearestNeighborsOfPoint(p1, ind.spatialPosition, 500).index), sort(c(near, ind.index))); } if (ok) stop(); }", __LINE__);
 	
 	// Run tests in a variety of combinations
 	_RunInteractionTypeTests_Nonspatial(false, false, false, "**");
@@ -3001,6 +3068,8 @@ void _RunInteractionTypeTests_Nonspatial(bool p_reciprocal, bool p_immediate, bo
 	SLiMAssertScriptStop(gen1_setup_i1_pop + "i1.drawByStrength(ind[0]); stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1_pop + "i1.drawByStrength(ind[0]); stop(); } interaction(i1) { return 2.0; }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1_pop + "i1.drawByStrength(ind[0]); stop(); } interaction(i1) { return strength * 2.0; }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1_pop + "setSeed(5); a = i1.drawByStrength(ind[0], 10); setSeed(5); b = sapply(1:10, 'i1.drawByStrength(ind[0]);'); if (identical(a, b)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_i1_pop + "b = integer(0); setSeed(5); for (i in ind) { a = i1.drawByStrength(i); b = c(b, size(a) ? a.index else -1); } setSeed(5); if (identical(i1.drawIndexByStrength(ind), b)) stop(); } interaction(i1) { return 2.0; }", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_i1_pop + "i1.nearestNeighbors(ind[8], 1); stop(); }", 1, 445, "interaction be spatial", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_i1_pop + "i1.nearestNeighborsOfPoint(p1, 19.0, 1); stop(); }", 1, 445, "interaction be spatial", __LINE__);
 	if (!sex_seg_on)
@@ -3062,6 +3131,9 @@ void _RunInteractionTypeTests_Spatial(std::string p_max_distance, bool p_recipro
 		SLiMAssertScriptStop(gen1_setup_i1x_pop + "i1.drawByStrength(ind[0], 50); stop(); }", __LINE__);
 		SLiMAssertScriptStop(gen1_setup_i1x_pop + "if (identical(i1.drawByStrength(ind[0], 0), ind[integer(0)])) stop(); }", __LINE__);
 		SLiMAssertScriptRaise(gen1_setup_i1x_pop + "i1.drawByStrength(ind[0], -1); stop(); }", 1, 567, "requires count >= 0", __LINE__);
+		SLiMAssertScriptStop(gen1_setup_i1x_pop + "setSeed(5); a = i1.drawByStrength(ind[0], 10); setSeed(5); b = sapply(1:10, 'i1.drawByStrength(ind[0]);'); if (identical(a, b)) stop(); }", __LINE__);
+		SLiMAssertScriptStop(gen1_setup_i1x_pop + "if (identical(i1.drawIndexByStrength(ind[integer(0)]), integer(0))) stop(); }", __LINE__);
+		SLiMAssertScriptStop(gen1_setup_i1x_pop + "b = integer(0); setSeed(5); for (i in ind) { a = i1.drawByStrength(i); b = c(b, size(a) ? a.index else -1); } setSeed(5); if (identical(i1.drawIndexByStrength(ind), b)) stop(); }", __LINE__);
 		
 		SLiMAssertScriptStop(gen1_setup_i1x_pop + "i1.drawByStrength(ind[0]); stop(); } interaction(i1) { return 2.0; }", __LINE__);
 		SLiMAssertScriptStop(gen1_setup_i1x_pop + "i1.drawByStrength(ind[0], 1); stop(); } interaction(i1) { return 2.0; }", __LINE__);
@@ -3678,6 +3750,26 @@ void _RunSLiMEidosBlockTests(void)
 	
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "fitness(m1) { mut; homozygous; individual; genome1; genome2; subpop; return relFitness; } 100 { stop(); }", __LINE__);
 	
+	// fitnessVector() callbacks
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "fitnessVector() { return rep(1.0, size(individuals)); } 100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "fitnessVector() { stop(); } 100 { ; }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "fitnessVector(p1) { return rep(1.0, size(individuals)); } 100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "fitnessVector(p1) { stop(); } 100 { ; }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "s1 fitnessVector(p1) { return rep(1.0, size(individuals)); } 1 { if (s1.type == 'fitnessVector') stop(); }", __LINE__);
+	
+	SLiMAssertScriptSuccess(gen1_setup_p1p2p3 + "fitnessVector(p4) { stop(); } 100 { ; }", __LINE__);
+	SLiMAssertScriptSuccess(gen1_setup_p1p2p3 + "early() { s1.active = 0; } s1 fitnessVector(p1) { stop(); } 100 { ; }", __LINE__);
+	
+	SLiMAssertScriptRaise(gen1_setup_p1p2p3 + "fitnessVector(m1) { stop(); } 100 { ; }", 1, 307, "identifier prefix \"p\" was expected", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1p2p3 + "fitnessVector(p1, p2) { stop(); } 100 { ; }", 1, 309, "unexpected token", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1p2p3 + "fitnessVector() { return 1.0; } 100 { ; }", 1, 293, "return value", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1p2p3 + "fitnessVector() { return rep(1, size(individuals)); } 100 { ; }", 1, 293, "return value", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_p1p2p3 + "fitnessVector() { return relFitness; } 100 { ; }", 1, 318, "undefined identifier relFitness", __LINE__);
+	
+	// fitnessVector() results are combined with those of fitness(NULL) callbacks, giving the same fitness values as an equivalent fitness(NULL) callback
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "1 late() { sim.subpopulations.individuals.tagF = runif(30, 0.5, 1.5); } fitnessVector() { subpop; return individuals.tagF; } fitness(NULL) { return 2.0; } 2 { if (identical(p2.cachedFitness(NULL), p2.individuals.tagF * 2.0)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "1 late() { sim.subpopulations.individuals.tagF = runif(30, 0.5, 1.5); } fitnessVector() { return individuals.tagF; } fitnessVector() { return 1.0 - individuals.tagF; } 2 { if (identical(p2.cachedFitness(NULL), pmax(0.0, p2.individuals.tagF * (1.0 - p2.individuals.tagF)))) stop(); }", __LINE__);
+	
 	// mateChoice() callbacks
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "mateChoice() { return weights; } 10 { stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "mateChoice() { stop(); } 10 { ; }", __LINE__);
@@ -3980,6 +4072,12 @@ void _RunTreeSeqTests(std::string temp_path)
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(recordMutations=T, simplificationRatio=INF, checkCoalescence=T, runCrosschecks=T); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(recordMutations=F, simplificationRatio=0.0, checkCoalescence=T, runCrosschecks=T); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(recordMutations=T, simplificationRatio=0.0, checkCoalescence=T, runCrosschecks=T); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(tableMemoryLimit=1e4); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(simplificationRatio=INF, runCrosschecks=T, tableMemoryLimit=1e4); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(simplificationRatio=INF, runCrosschecks=T, tableMemoryLimit=1e4); } " + gen1_setup_p1 + "50 { sim.treeSeqSimplify(); } 100 { stop(); }", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(tableMemoryLimit=0); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "tableMemoryLimit to be > 0", __LINE__);
+	if (Eidos_SlashTmpExists())
+		SLiMAssertScriptStop("initialize() { initializeTreeSeq(tableLogFile='" + temp_path + "/SLiM_treeSeqLog.csv'); } " + gen1_setup_p1 + "50 late() { if (size(readFile('" + temp_path + "/SLiM_treeSeqLog.csv')) == 50) stop(); }", __LINE__);
 	
 	// treeSeqCoalesced()
 	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "1: { sim.treeSeqCoalesced(); } 100 { stop(); }", 1, 290, "coalescence checking is enabled", __LINE__);
@@ -3993,6 +4091,23 @@ void _RunTreeSeqTests(std::string temp_path)
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "50 { sim.treeSeqRememberIndividuals(p1.individuals); } 100 { sim.treeSeqSimplify(); stop(); }", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "1: { sim.treeSeqRememberIndividuals(p1.individuals); } 100 { sim.treeSeqSimplify(); stop(); }", __LINE__);
 	
+	// treeSeqDiversity(), treeSeqDivergence(), treeSeqFst(), treeSeqSFS()
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 late() { c = sim.mutationCounts(p1); pi = sum(c * (20 - c) * 2 / (20 * 19)) / 1e5; if (abs(sim.treeSeqDiversity(p1) - pi) < 1e-15) stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 late() { if (abs(sim.treeSeqDivergence(p1, p1, 'branch') - sim.treeSeqDiversity(p1, 'branch') * 19 / 20) < 1e-6) stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 late() { w = sim.treeSeqDiversity(NULL, 'branch', c(0, 3e4, 1e5)); if (abs(sum(w * c(3e4, 7e4)) / 1e5 - sim.treeSeqDiversity(NULL, 'branch')) < 1e-6) stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 late() { c = sim.mutationCounts(p1); sfs = sim.treeSeqSFS(p1); if ((size(sfs) == 21) & (sum(sfs[1:19]) == sum(c < 20))) stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 late() { if (size(sim.treeSeqSFS(p1, 'branch', polarised=F)) == 11) stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "50 late() { sim.addSubpop('p2', 10); } 100 late() { fst = sim.treeSeqFst(p1, p2, 'branch'); if ((fst > 0) & (fst <= 1)) stop(); }", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 late() { sim.treeSeqDiversity(p1, 'foo'); }", 1, 298, "mode to be 'site' or 'branch'", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 late() { sim.treeSeqDiversity(p1, 'site', c(0, 5e4)); }", 1, 298, "windows to begin at 0", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 late() { sim.treeSeqDiversity(p1, 'site', c(0, 5e4, 5e4, 1e5)); }", 1, 298, "strictly increasing", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 late() { sim.treeSeqDivergence(p1, c(p1, p1)); }", 1, 298, "more than once", __LINE__);
+	SLiMAssertScriptRaise("initialize() { } " + gen1_setup_p1 + "100 late() { sim.treeSeqSFS(); }", 1, 277, "tree recording is enabled", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(recordMutations=F); } " + gen1_setup_p1 + "100 late() { sim.treeSeqDiversity(p1); }", 1, 315, "requires mutation recording", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(recordMutations=F); } " + gen1_setup_p1 + "100 late() { sim.treeSeqDivergence(p1, p1); }", 1, 315, "requires mutation recording", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(recordMutations=F); } " + gen1_setup_p1 + "100 late() { sim.treeSeqFst(p1, p1); }", 1, 315, "requires mutation recording", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(recordMutations=F); } " + gen1_setup_p1 + "100 late() { sim.treeSeqSFS(p1); }", 1, 315, "requires mutation recording", __LINE__);
+	
 	// treeSeqOutput()
 	if (Eidos_SlashTmpExists())
 	{
@@ -4000,6 +4115,12 @@ void _RunTreeSeqTests(std::string temp_path)
 		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_2.trees', simplify=T, _binary=F); stop(); }", __LINE__);
 		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_3.trees', simplify=F, _binary=T); stop(); }", __LINE__);
 		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_4.trees', simplify=T, _binary=T); stop(); }", __LINE__);
+
+		// round-trip through readFromPopulationFile(); the loaded mutations and their frequencies should be unchanged
+		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_highmut_p1 + "100 late() { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_5.trees'); ids = sort(sim.mutations.id); counts = sim.mutationCounts(NULL)[order(sim.mutations.id)]; sim.readFromPopulationFile('" + temp_path + "/SLiM_treeSeq_5.trees'); if (identical(sort(sim.mutations.id), ids) & identical(sim.mutationCounts(NULL)[order(sim.mutations.id)], counts)) stop(); }", __LINE__);
+		
+		// round-trip through the text format, with non-empty mutation and node metadata; this exercises the in-place conversion of the metadata columns to and from text
+		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'n', 0.0, 0.1); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); } 1 { sim.addSubpop('p1', 10); } 20 late() { m = sim.mutations[order(sim.mutations.id)]; ids = m.id; s = m.selectionCoeff; o = m.originGeneration; counts = sim.mutationCounts(NULL, m); gids = p1.genomes.genomePedigreeID; sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_6.trees', simplify=F, _binary=F); sim.readFromPopulationFile('" + temp_path + "/SLiM_treeSeq_6.trees'); m = sim.mutations[order(sim.mutations.id)]; if ((size(ids) > 0) & identical(m.id, ids) & identical(m.selectionCoeff, s) & identical(m.originGeneration, o) & identical(sim.mutationCounts(NULL, m), counts) & identical(p1.genomes.genomePedigreeID, gids)) stop(); }", __LINE__);
 	}
 }
 
@@ -4825,6 +4946,60 @@ void _RunSLiMTimingTests(void)
 		}
 	}
 #endif
+#if 0
+	// Throughput of vectorized property access and method calls on large object vectors, in elements per second; each
+	// script accesses the property on 100000 elements 1000 times, and the time to set up the model is measured and
+	// subtracted.  The variables are reassigned in each iteration so that the accesses are not hoisted out of the loop.
+	// Properties with an accelerated getter or setter fill their result in a single pass over the elements; the others
+	// make a virtual call and allocate a result EidosValue for each element, and then concatenate the results.
+	//
+	// Property chains are evaluated in a single traversal, without an EidosValue for each intermediate step.
+	{
+		std::string setup_script("initialize() { initializeSLiMOptions(keepPedigrees=T, dimensionality='xyz'); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); } 1 { sim.addSubpop('p1', 50000); sim.addSubpop('p2', 50000); } 2 { s = sim.subpopulations; i = s.individuals; g = i.genome1; m = sim.mutations; m = m[0:(min(size(m), 100000) - 1)]; ");
+		std::vector<std::pair<std::string, std::string>> timed_expressions = {
+			{"(none)", ""},
+			{"Subpopulation.individuals", "x = s.individuals;"},
+			{"Individual.index", "x = i.index;"},
+			{"Individual.tagF", "i.tagF = 0.5; x = i.tagF;"},
+			{"Individual.genomes", "x = i.genomes;"},
+			{"Individual.sex", "x = i.sex;"},
+			{"Individual.spatialPosition", "x = i.spatialPosition;"},
+			{"Individual.pedigreeParentIDs", "x = i.pedigreeParentIDs;"},
+			{"Genome.individual", "x = g.individual;"},
+			{"Genome.genomeType", "x = g.genomeType;"},
+			{"Genome.mutations", "x = g.mutations;"},
+			{"Mutation.selectionCoeff", "x = m.selectionCoeff;"},
+			{"Mutation.setSelectionCoeff()", "m.setSelectionCoeff(0.0);"},
+			{"Individual.genomes.individual.tagF", "i.tagF = 0.5; x = i.genomes.individual.tagF;"},
+			{"Genome.individual.genome2.individual.index", "x = g.individual.genome2.individual.index;"}
+		};
+		double setup_time = 0.0;
+		
+		for (auto &timed_expression : timed_expressions)
+		{
+			std::string script = setup_script + "for (iter in 1:1000) { s = s; i = i; g = g; m = m; " + timed_expression.second + " } stop(); }";
+			
+			std::clock_t begin = std::clock();
+			
+			SLiMAssertScriptStop(script);
+			
+			std::clock_t end = std::clock();
+			double time_spent = static_cast<double>(end - begin) / CLOCKS_PER_SEC;
+			
+			if (timed_expression.second.length() == 0)
+			{
+				setup_time = time_spent;
+				std::cout << "Time for model setup: " << setup_time << std::endl;
+			}
+			else
+			{
+				std::cout << "Elements per second for " << timed_expression.first << ": " << (1000 * 100000) / std::max(time_spent - setup_time, 1e-6) << std::endl;
+			}
+		}
+		
+		std::cout << std::endl;
+	}
+#endif
 }
 
 
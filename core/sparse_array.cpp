@@ -39,12 +39,16 @@ SparseArray::SparseArray(unsigned int p_nrows, unsigned int p_ncols)
 	nnz_ = 0;
 	nnz_capacity_ = 1024;
 	
-	row_offsets_ = (uint32_t *)malloc((nrows_ + 1) * sizeof(uint32_t));
+	row_offsets_ = (uint32_t *)calloc(nrows_, sizeof(uint32_t));
+	row_ends_ = (uint32_t *)calloc(nrows_, sizeof(uint32_t));
 	columns_ = (uint32_t *)malloc(nnz_capacity_ * sizeof(uint32_t));
 	distances_ = (sa_distance_t *)malloc(nnz_capacity_ * sizeof(sa_distance_t));
 	strengths_ = (sa_strength_t *)malloc(nnz_capacity_ * sizeof(sa_strength_t));
 	
-	row_offsets_[nrows_set_] = 0;
+	if (!row_offsets_ || !row_ends_ || !columns_ || !distances_ || !strengths_)
+		EIDOS_TERMINATION << "ERROR (SparseArray::SparseArray): allocation failed; you may need to raise the memory limit for SLiM." << EidosTerminate(nullptr);
+	
+	building_row_ = UINT32_MAX;
 	finished_ = false;
 }
 
@@ -60,6 +64,9 @@ SparseArray::~SparseArray(void)
 	free(row_offsets_);
 	row_offsets_ = nullptr;
 	
+	free(row_ends_);
+	row_ends_ = nullptr;
+	
 	free(columns_);
 	columns_ = nullptr;
 	
@@ -76,6 +83,7 @@ void SparseArray::Reset(void)
 	ncols_ = 0;
 	nrows_set_ = 0;
 	nnz_ = 0;
+	building_row_ = UINT32_MAX;
 	finished_ = false;
 }
 
@@ -89,9 +97,35 @@ void SparseArray::Reset(unsigned int p_nrows, unsigned int p_ncols)
 	nrows_set_ = 0;
 	nnz_ = 0;
 	
-	row_offsets_ = (uint32_t *)realloc(row_offsets_, (nrows_ + 1) * sizeof(uint32_t));
+	row_offsets_ = (uint32_t *)realloc(row_offsets_, nrows_ * sizeof(uint32_t));
+	row_ends_ = (uint32_t *)realloc(row_ends_, nrows_ * sizeof(uint32_t));
+	
+	if (!row_offsets_ || !row_ends_)
+		EIDOS_TERMINATION << "ERROR (SparseArray::Reset): allocation failed; you may need to raise the memory limit for SLiM." << EidosTerminate(nullptr);
+	
+	// rows that are never added during the build are empty
+	memset(row_offsets_, 0, nrows_ * sizeof(uint32_t));
+	memset(row_ends_, 0, nrows_ * sizeof(uint32_t));
+	
+	building_row_ = UINT32_MAX;
+	finished_ = false;
+}
+
+void SparseArray::ResetRows(const slim_popsize_t *p_rows, size_t p_row_count)
+{
+	// This is equivalent to Reset() with the same dimensions, but it empties only the given rows, which must include every row
+	// that has been added since the array was last reset; that makes it cheap to reuse a large array for a few rows at a time
+	for (size_t row_index = 0; row_index < p_row_count; ++row_index)
+	{
+		uint32_t row = (uint32_t)p_rows[row_index];
+		
+		row_offsets_[row] = 0;
+		row_ends_[row] = 0;
+	}
 	
-	row_offsets_[nrows_set_] = 0;
+	nrows_set_ = 0;
+	nnz_ = 0;
+	building_row_ = UINT32_MAX;
 	finished_ = false;
 }
 
@@ -106,53 +140,81 @@ void SparseArray::_ResizeToFitNNZ(void)
 		columns_ = (uint32_t *)realloc(columns_, nnz_capacity_ * sizeof(uint32_t));
 		distances_ = (sa_distance_t *)realloc(distances_, nnz_capacity_ * sizeof(sa_distance_t));
 		strengths_ = (sa_strength_t *)realloc(strengths_, nnz_capacity_ * sizeof(sa_strength_t));
+		
+		if (!columns_ || !distances_ || !strengths_)
+			EIDOS_TERMINATION << "ERROR (SparseArray::_ResizeToFitNNZ): allocation failed; you may need to raise the memory limit for SLiM." << EidosTerminate(nullptr);
 	}
 }
 
+void SparseArray::StartRow(uint32_t p_row)
+{
+	// ensure that we are visiting each row at most once; a row that has been added has a non-zero end offset, since
+	// AddEntryDistance() / AddEntryInteraction() always add an entry to the row after starting it
+	if (finished_)
+		EIDOS_TERMINATION << "ERROR (SparseArray::StartRow): adding entry to sparse array that is finished." << EidosTerminate(nullptr);
+	if (p_row >= nrows_)
+		EIDOS_TERMINATION << "ERROR (SparseArray::StartRow): adding row beyond the end of the sparse array." << EidosTerminate(nullptr);
+	if (row_ends_[p_row] != 0)
+		EIDOS_TERMINATION << "ERROR (SparseArray::StartRow): adding row that has already been added." << EidosTerminate(nullptr);
+	
+	row_offsets_[p_row] = nnz_;
+	row_ends_[p_row] = nnz_;
+	building_row_ = p_row;
+	nrows_set_++;
+}
+
 void SparseArray::AddRowDistances(uint32_t p_row, const uint32_t *p_columns, const sa_distance_t *p_distances, uint32_t p_row_nnz)
 {
-	// ensure that we are building sequentially, visiting each row exactly once
+	// ensure that we are visiting each row at most once
 	if (finished_)
 		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowDistances): adding row to sparse array that is finished." << EidosTerminate(nullptr);
-	if (nrows_set_ >= nrows_)
-		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowDistances): adding row to sparse array that is already full." << EidosTerminate(nullptr);
-	if (p_row != nrows_set_)
-		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowDistances): adding row out of order." << EidosTerminate(nullptr);
+	if (p_row >= nrows_)
+		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowDistances): adding row beyond the end of the sparse array." << EidosTerminate(nullptr);
+	if (row_ends_[p_row] != 0)
+		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowDistances): adding row that has already been added." << EidosTerminate(nullptr);
 	if ((p_row_nnz != 0) && (!p_columns || !p_distances))
 		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowDistances): null pointer supplied for non-empty row." << EidosTerminate(nullptr);
 	
 	// make room for the new entries
+	uint32_t offset = nnz_;
+	
 	nnz_ += p_row_nnz;
 	ResizeToFitNNZ();
 	
 	// copy over the new entries; no bounds check on columns, for speed
-	uint32_t offset = row_offsets_[nrows_set_];
+	row_offsets_[p_row] = offset;
+	row_ends_[p_row] = offset + p_row_nnz;
+	building_row_ = p_row;
+	nrows_set_++;
 	
-	row_offsets_[++nrows_set_] = offset + p_row_nnz;
 	memcpy(columns_ + offset, p_columns, p_row_nnz * sizeof(uint32_t));
 	memcpy(distances_ + offset, p_distances, p_row_nnz * sizeof(sa_distance_t));
 }
 
 void SparseArray::AddRowInteractions(uint32_t p_row, const uint32_t *p_columns, const sa_distance_t *p_distances, const sa_strength_t *p_strengths, uint32_t p_row_nnz)
 {
-	// ensure that we are building sequentially, visiting each row exactly once
+	// ensure that we are visiting each row at most once
 	if (finished_)
 		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowInteractions): adding row to sparse array that is finished." << EidosTerminate(nullptr);
-	if (nrows_set_ >= nrows_)
-		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowInteractions): adding row to sparse array that is already full." << EidosTerminate(nullptr);
-	if (p_row != nrows_set_)
-		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowInteractions): adding row out of order." << EidosTerminate(nullptr);
+	if (p_row >= nrows_)
+		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowInteractions): adding row beyond the end of the sparse array." << EidosTerminate(nullptr);
+	if (row_ends_[p_row] != 0)
+		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowInteractions): adding row that has already been added." << EidosTerminate(nullptr);
 	if ((p_row_nnz != 0) && (!p_columns || !p_distances || !p_strengths))
 		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowInteractions): null pointer supplied for non-empty row." << EidosTerminate(nullptr);
 	
 	// make room for the new entries
+	uint32_t offset = nnz_;
+	
 	nnz_ += p_row_nnz;
 	ResizeToFitNNZ();
 	
 	// copy over the new entries; no bounds check on columns, for speed
-	uint32_t offset = row_offsets_[nrows_set_];
+	row_offsets_[p_row] = offset;
+	row_ends_[p_row] = offset + p_row_nnz;
+	building_row_ = p_row;
+	nrows_set_++;
 	
-	row_offsets_[++nrows_set_] = offset + p_row_nnz;
 	memcpy(columns_ + offset, p_columns, p_row_nnz * sizeof(uint32_t));
 	memcpy(distances_ + offset, p_distances, p_row_nnz * sizeof(sa_distance_t));
 	memcpy(strengths_ + offset, p_strengths, p_row_nnz * sizeof(sa_strength_t));
@@ -160,37 +222,18 @@ void SparseArray::AddRowInteractions(uint32_t p_row, const uint32_t *p_columns,
 
 void SparseArray::AddEntryInteraction(uint32_t p_row, uint32_t p_column, sa_distance_t p_distance, sa_strength_t p_strength)
 {
-	if (finished_)
-		EIDOS_TERMINATION << "ERROR (SparseArray::AddEntryInteraction): adding entry to sparse array that is finished." << EidosTerminate(nullptr);
-	
-	// ensure that we are building sequentially, visiting rows in order but potentially skipping empty rows
-	if (p_row + 1 < nrows_set_)
-	{
-		EIDOS_TERMINATION << "ERROR (SparseArray::AddEntryInteraction): adding entry out of order." << EidosTerminate(nullptr);
-	}
-	else if (p_row + 1 > nrows_set_)
-	{
-		// starting a new row
-		if (p_row >= nrows_)
-			EIDOS_TERMINATION << "ERROR (SparseArray::AddEntryInteraction): adding row beyond the end of the sparse array." << EidosTerminate(nullptr);
-	}
-	// else, adding another entry to the current row
+	if (p_row != building_row_)
+		StartRow(p_row);
 	
 	if (p_column >= ncols_)
 		EIDOS_TERMINATION << "ERROR (SparseArray::AddEntryInteraction): adding column beyond the end of the sparse array." << EidosTerminate(nullptr);
 	
 	// make room for the new entries
-	nnz_++;
+	uint32_t offset = nnz_++;
 	ResizeToFitNNZ();
 	
-	// add intervening empty rows
-	uint32_t offset = row_offsets_[nrows_set_];
-	
-	while (p_row + 1 > nrows_set_)
-		row_offsets_[++nrows_set_] = offset;
-	
 	// insert the new entry
-	row_offsets_[nrows_set_] = offset + 1;
+	row_ends_[p_row] = offset + 1;
 	columns_[offset] = p_column;
 	distances_[offset] = p_distance;
 	strengths_[offset] = p_strength;
@@ -201,11 +244,9 @@ void SparseArray::Finished(void)
 	if (finished_)
 		EIDOS_TERMINATION << "ERROR (SparseArray::Finished): finishing sparse array that is already finished." << EidosTerminate(nullptr);
 	
-	uint32_t offset = row_offsets_[nrows_set_];
-	
-	while (nrows_set_ < nrows_)
-		row_offsets_[++nrows_set_] = offset;
-	
+	// rows that were never added are already empty, since Reset() zeroes their offsets
+	nrows_set_ = nrows_;
+	building_row_ = UINT32_MAX;
 	finished_ = true;
 }
 
@@ -225,7 +266,7 @@ sa_distance_t SparseArray::Distance(uint32_t p_row, uint32_t p_column) const
 	
 	// get the offset into columns/values for p_row, and the number of entries for this row
 	uint32_t offset = row_offsets_[p_row];
-	uint32_t offset_next = row_offsets_[p_row + 1];
+	uint32_t offset_next = row_ends_[p_row];
 	
 	// scan for the requested column
 	for (uint32_t index = offset; index < offset_next; ++index)
@@ -254,7 +295,7 @@ sa_strength_t SparseArray::Strength(uint32_t p_row, uint32_t p_column) const
 	
 	// get the offset into columns/values for p_row, and the number of entries for this row
 	uint32_t offset = row_offsets_[p_row];
-	uint32_t offset_next = row_offsets_[p_row + 1];
+	uint32_t offset_next = row_ends_[p_row];
 	
 	// scan for the requested column
 	for (uint32_t index = offset; index < offset_next; ++index)
@@ -283,7 +324,7 @@ void SparseArray::PatchStrength(uint32_t p_row, uint32_t p_column, sa_strength_t
 	
 	// get the offset into columns/values for p_row, and the number of entries for this row
 	uint32_t offset = row_offsets_[p_row];
-	uint32_t offset_next = row_offsets_[p_row + 1];
+	uint32_t offset_next = row_ends_[p_row];
 	
 	// scan for the requested column
 	for (uint32_t index = offset; index < offset_next; ++index)
@@ -313,7 +354,7 @@ const sa_distance_t *SparseArray::DistancesForRow(uint32_t p_row, uint32_t *p_ro
 	
 	// get the offset into columns/values for p_row, and the number of entries for this row
 	uint32_t offset = row_offsets_[p_row];
-	uint32_t count = row_offsets_[p_row + 1] - offset;
+	uint32_t count = row_ends_[p_row] - offset;
 	
 	// return info; note that a non-null pointer is returned even if count==0
 	*p_row_nnz = count;
@@ -336,7 +377,7 @@ const sa_strength_t *SparseArray::StrengthsForRow(uint32_t p_row, uint32_t *p_ro
 	
 	// get the offset into columns/values for p_row, and the number of entries for this row
 	uint32_t offset = row_offsets_[p_row];
-	uint32_t count = row_offsets_[p_row + 1] - offset;
+	uint32_t count = row_ends_[p_row] - offset;
 	
 	// return info; note that a non-null pointer is returned even if count==0
 	*p_row_nnz = count;
@@ -359,7 +400,7 @@ void SparseArray::InteractionsForRow(uint32_t p_row, uint32_t *p_row_nnz, uint32
 	
 	// get the offset into columns/values for p_row, and the number of entries for this row
 	uint32_t offset = row_offsets_[p_row];
-	uint32_t count = row_offsets_[p_row + 1] - offset;
+	uint32_t count = row_ends_[p_row] - offset;
 	
 	// return info; note that a non-null pointer is returned even if count==0
 	*p_row_nnz = count;
@@ -371,11 +412,25 @@ void SparseArray::InteractionsForRow(uint32_t p_row, uint32_t *p_row_nnz, uint32
 		*p_row_strengths = strengths_ + offset;
 }
 
+void SparseArray::AllInteractions(uint32_t *p_nnz, sa_distance_t **p_distances, sa_strength_t **p_strengths)
+{
+	// should be done building the array
+	if (!finished_)
+		EIDOS_TERMINATION << "ERROR (SparseArray::AllInteractions): sparse array is not finished being built." << EidosTerminate(nullptr);
+	
+	// since each row's entries are stored contiguously, the entries for all rows form a single buffer, in the order the rows were added
+	*p_nnz = nnz_;
+	if (p_distances)
+		*p_distances = distances_;
+	if (p_strengths)
+		*p_strengths = strengths_;
+}
+
 size_t SparseArray::MemoryUsage(void)
 {
 	size_t usage = 0;
 	
-	usage += sizeof(uint32_t) * (nrows_ + 1);
+	usage += sizeof(uint32_t) * nrows_ * 2;
 	usage += (sizeof(uint32_t) + sizeof(sa_distance_t) + sizeof(sa_strength_t)) * (nnz_capacity_);
 	
 	return usage;
@@ -395,11 +450,11 @@ std::ostream &operator<<(std::ostream &p_outstream, const SparseArray &p_array)
 	p_outstream << "   nnz_capacity == " << p_array.nnz_capacity_ << std::endl;
 	
 	p_outstream << "   row_offsets == {";
-	for (uint32_t row = 0; row < p_array.nrows_set_; ++row)
+	for (uint32_t row = 0; row < p_array.nrows_; ++row)
 	{
 		if (row > 0)
 			p_outstream << ", ";
-		p_outstream << p_array.row_offsets_[row];
+		p_outstream << p_array.row_offsets_[row] << "-" << p_array.row_ends_[row];
 	}
 	p_outstream << "}" << std::endl;
 	
@@ -424,7 +479,7 @@ std::ostream &operator<<(std::ostream &p_outstream, const SparseArray &p_array)
 	if (!p_array.finished_)
 		return p_outstream;
 	
-	for (uint32_t row = 0; row < p_array.nrows_set_; ++row)
+	for (uint32_t row = 0; row < p_array.nrows_; ++row)
 	{
 		for (uint32_t col = 0; col < p_array.ncols_; ++col)
 		{
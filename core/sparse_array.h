@@ -47,22 +47,27 @@ class SparseArray
 	//	This class has its copy constructor and assignment operator disabled, to prevent accidental copying.
 
 private:
-	// we store the spare array in CSR format, with an offset for each row
+	// we store the spare array in a CSR-like format, with a start offset and an end offset for each row
 	// see https://medium.com/@jmaxg3/101-ways-to-store-a-sparse-matrix-c7f2bf15a229
 	// we do not sort by column within a row; we do a linear search for the column
-	uint32_t *row_offsets_;			// offsets into columns/values for each row; for N rows, N+1 entries (extra end entry)
+	// rows may be added in any order, so that InteractionType can build the array visiting receivers in a
+	// spatially coherent order; the entries for each row are contiguous, but the rows are stored in the order they were added
+	uint32_t *row_offsets_;			// offsets into columns/values for the start of each row; for N rows, N entries
+	uint32_t *row_ends_;			// offsets into columns/values for the end of each row; for N rows, N entries
+	uint32_t building_row_;			// the row most recently added to, during building; UINT32_MAX if none
 	uint32_t *columns_;				// the column indices for the non-empty values in each row
 	sa_distance_t *distances_;		// a distance value for each non-empty entry
 	sa_strength_t *strengths_;		// a strength value for each non-empty entry
 	
 	uint32_t nrows_, ncols_;		// the number of rows and columns; determined at construction time
 	uint32_t nrows_set_;			// the number of rows that have been configured (at least partially, during building)
-	uint32_t nnz_;					// the number of non-zero entries in the sparse array (also at row_offsets[nrows_set])
+	uint32_t nnz_;					// the number of non-zero entries in the sparse array
 	uint32_t nnz_capacity_;			// the number of non-zero entries allocated for at present
 	
 	bool finished_;					// if true, Finished() has been called and the sparse array is ready to use
 	
 	void _ResizeToFitNNZ(void);
+	void StartRow(uint32_t p_row);		// begin adding entries for a new row, during building
 	inline __attribute__((always_inline)) void ResizeToFitNNZ(void) { if (nnz_ > nnz_capacity_) _ResizeToFitNNZ(); };
 	
 public:
@@ -74,8 +79,10 @@ public:
 	
 	void Reset(void);											// reset to a dimensionless state, keeping buffers
 	void Reset(unsigned int p_nrows, unsigned int p_ncols);		// reset to new dimensions, keeping buffers
+	void ResetRows(const slim_popsize_t *p_rows, size_t p_row_count);	// reset, keeping dimensions and buffers, when only p_rows have been added
 	
-	// Building a sparse array; has to be done in row order, and then has to be Finished().  SparseArray supports building
+	// Building a sparse array; each row may be added only once, with all of its entries added consecutively, and then it
+	// has to be Finished().  Rows may be added in any order, and rows that are never added are empty.  SparseArray supports building
 	// a row at a time, or one entry at a time, but one or the other method must be chosen and used throughout the build.
 	// Similarly, you can supply just distances and then add strengths later (using InteractionsForRow() to modify the data),
 	// or you can build supplying strengths during the build, but you should choose one method or the other and stick with
@@ -87,39 +94,20 @@ public:
 	
 	inline void AddEntryDistance(uint32_t p_row, const uint32_t p_column, sa_distance_t p_distance)
 	{
-#if DEBUG
-		if (finished_)
-			EIDOS_TERMINATION << "ERROR (SparseArray::AddEntryDistance): (internal error) adding entry to sparse array that is finished." << EidosTerminate(nullptr);
-		
-		// ensure that we are building sequentially, visiting rows in order but potentially skipping empty rows
-		if (p_row + 1 < nrows_set_)
-		{
-			EIDOS_TERMINATION << "ERROR (SparseArray::AddEntryDistance): (internal error) adding entry out of order." << EidosTerminate(nullptr);
-		}
-		else if (p_row + 1 > nrows_set_)
-		{
-			// starting a new row
-			if (p_row >= nrows_)
-				EIDOS_TERMINATION << "ERROR (SparseArray::AddEntryDistance): (internal error) adding row beyond the end of the sparse array." << EidosTerminate(nullptr);
-		}
-		// else, adding another entry to the current row
+		if (p_row != building_row_)
+			StartRow(p_row);
 		
+#if DEBUG
 		if (p_column >= ncols_)
 			EIDOS_TERMINATION << "ERROR (SparseArray::AddEntryDistance): (internal error) adding column beyond the end of the sparse array." << EidosTerminate(nullptr);
 #endif
 		
 		// make room for the new entries
-		nnz_++;
+		uint32_t offset = nnz_++;
 		ResizeToFitNNZ();
 		
-		// add intervening empty rows
-		uint32_t offset = row_offsets_[nrows_set_];
-		
-		while (p_row + 1 > nrows_set_)
-			row_offsets_[++nrows_set_] = offset;
-		
 		// insert the new entry
-		row_offsets_[nrows_set_] = offset + 1;
+		row_ends_[p_row] = offset + 1;
 		columns_[offset] = p_column;
 		distances_[offset] = p_distance;
 	}
@@ -147,6 +135,7 @@ public:
 	
 	// Non-const access, for filling in strength values after the fact (among other uses)
 	void InteractionsForRow(uint32_t p_row, uint32_t *p_row_nnz, uint32_t **p_row_columns, sa_distance_t **p_row_distances, sa_strength_t **p_row_strengths);
+	void AllInteractions(uint32_t *p_nnz, sa_distance_t **p_distances, sa_strength_t **p_strengths);	// all rows at once, for row-independent passes
 	
 	friend std::ostream &operator<<(std::ostream &p_outstream, const SparseArray &p_array);
 };
@@ -108,120 +108,207 @@ _SpatialMap::~_SpatialMap(void)
 double _SpatialMap::ValueAtPoint(double *p_point)
 {
 	// This looks up the value at point, which is in coordinates that have been normalized and clamped to [0,1]
+	static const double unit_origin[3] = {0.0, 0.0, 0.0};
+	static const double unit_extent[3] = {1.0, 1.0, 1.0};
+	double value;
+	
+	ValuesAtPoints(p_point, 1, unit_origin, unit_extent, &value);
+	
+	return value;
+}
+
+#define SLiMClampCoordinate(x) ((x < 0.0) ? 0.0 : ((x > 1.0) ? 1.0 : x))
+
+void _SpatialMap::ValuesAtPoints(const double *p_points, int64_t p_count, const double *p_origin, const double *p_extent, double *p_values)
+{
+	// This looks up the values at p_count points, which are given in p_points as spatiality_ coordinates per point.
+	// Each coordinate is normalized to [0,1] with (coordinate - p_origin[d]) / p_extent[d], for the dimension d of the map that
+	// it corresponds to, and then clamped.  Doing a whole vector of points at once lets us hoist the dispatch on spatiality and
+	// interpolation, and the grid strides, out of the loop; the arithmetic for each point is exactly that done formerly for a
+	// single point, so the results are unchanged.
 	switch (spatiality_)
 	{
 		case 1:
 		{
-			double x_fraction = p_point[0];
-			int64_t xsize = grid_size_[0];
+			const double x_origin = p_origin[0], x_extent = p_extent[0];
+			const double x_scale = (double)(grid_size_[0] - 1);
 			
 			if (interpolate_)
 			{
-				double x_map = x_fraction * (xsize - 1);
-				int x1_map = (int)floor(x_map);
-				int x2_map = (int)ceil(x_map);
-				double fraction_x2 = x_map - x1_map;
-				double fraction_x1 = 1.0 - fraction_x2;
-				double value_x1 = values_[x1_map] * fraction_x1;
-				double value_x2 = values_[x2_map] * fraction_x2;
-				
-				return value_x1 + value_x2;
+				for (int64_t point_index = 0; point_index < p_count; ++point_index)
+				{
+					double x_fraction = (p_points[point_index] - x_origin) / x_extent;
+					
+					x_fraction = SLiMClampCoordinate(x_fraction);
+					
+					double x_map = x_fraction * x_scale;
+					int x1_map = (int)floor(x_map);
+					int x2_map = (int)ceil(x_map);
+					double fraction_x2 = x_map - x1_map;
+					double fraction_x1 = 1.0 - fraction_x2;
+					double value_x1 = values_[x1_map] * fraction_x1;
+					double value_x2 = values_[x2_map] * fraction_x2;
+					
+					p_values[point_index] = value_x1 + value_x2;
+				}
 			}
 			else
 			{
-				int x_map = (int)round(x_fraction * (xsize - 1));
-				
-				return values_[x_map];
+				for (int64_t point_index = 0; point_index < p_count; ++point_index)
+				{
+					double x_fraction = (p_points[point_index] - x_origin) / x_extent;
+					
+					x_fraction = SLiMClampCoordinate(x_fraction);
+					
+					int x_map = (int)round(x_fraction * x_scale);
+					
+					p_values[point_index] = values_[x_map];
+				}
 			}
 			break;
 		}
 		case 2:
 		{
-			double x_fraction = p_point[0];
-			double y_fraction = p_point[1];
-			int64_t xsize = grid_size_[0];
-			int64_t ysize = grid_size_[1];
+			const double x_origin = p_origin[0], x_extent = p_extent[0];
+			const double y_origin = p_origin[1], y_extent = p_extent[1];
+			const double x_scale = (double)(grid_size_[0] - 1);
+			const double y_scale = (double)(grid_size_[1] - 1);
+			const int64_t y_stride = grid_size_[0];
 			
 			if (interpolate_)
 			{
-				double x_map = x_fraction * (xsize - 1);
-				double y_map = y_fraction * (ysize - 1);
-				int x1_map = (int)floor(x_map);
-				int y1_map = (int)floor(y_map);
-				int x2_map = (int)ceil(x_map);
-				int y2_map = (int)ceil(y_map);
-				double fraction_x2 = x_map - x1_map;
-				double fraction_x1 = 1.0 - fraction_x2;
-				double fraction_y2 = y_map - y1_map;
-				double fraction_y1 = 1.0 - fraction_y2;
-				double value_x1_y1 = values_[x1_map + y1_map * xsize] * fraction_x1 * fraction_y1;
-				double value_x2_y1 = values_[x2_map + y1_map * xsize] * fraction_x2 * fraction_y1;
-				double value_x1_y2 = values_[x1_map + y2_map * xsize] * fraction_x1 * fraction_y2;
-				double value_x2_y2 = values_[x2_map + y2_map * xsize] * fraction_x2 * fraction_y2;
-				
-				return value_x1_y1 + value_x2_y1 + value_x1_y2 + value_x2_y2;
+				for (int64_t point_index = 0; point_index < p_count; ++point_index)
+				{
+					const double *point = p_points + point_index * 2;
+					double x_fraction = (point[0] - x_origin) / x_extent;
+					double y_fraction = (point[1] - y_origin) / y_extent;
+					
+					x_fraction = SLiMClampCoordinate(x_fraction);
+					y_fraction = SLiMClampCoordinate(y_fraction);
+					
+					double x_map = x_fraction * x_scale;
+					double y_map = y_fraction * y_scale;
+					int x1_map = (int)floor(x_map);
+					int y1_map = (int)floor(y_map);
+					int x2_map = (int)ceil(x_map);
+					int y2_map = (int)ceil(y_map);
+					double fraction_x2 = x_map - x1_map;
+					double fraction_x1 = 1.0 - fraction_x2;
+					double fraction_y2 = y_map - y1_map;
+					double fraction_y1 = 1.0 - fraction_y2;
+					const double *row_y1 = values_ + y1_map * y_stride;
+					const double *row_y2 = values_ + y2_map * y_stride;
+					double value_x1_y1 = row_y1[x1_map] * fraction_x1 * fraction_y1;
+					double value_x2_y1 = row_y1[x2_map] * fraction_x2 * fraction_y1;
+					double value_x1_y2 = row_y2[x1_map] * fraction_x1 * fraction_y2;
+					double value_x2_y2 = row_y2[x2_map] * fraction_x2 * fraction_y2;
+					
+					p_values[point_index] = value_x1_y1 + value_x2_y1 + value_x1_y2 + value_x2_y2;
+				}
 			}
 			else
 			{
-				int x_map = (int)round(x_fraction * (xsize - 1));
-				int y_map = (int)round(y_fraction * (ysize - 1));
-				
-				return values_[x_map + y_map * xsize];
+				for (int64_t point_index = 0; point_index < p_count; ++point_index)
+				{
+					const double *point = p_points + point_index * 2;
+					double x_fraction = (point[0] - x_origin) / x_extent;
+					double y_fraction = (point[1] - y_origin) / y_extent;
+					
+					x_fraction = SLiMClampCoordinate(x_fraction);
+					y_fraction = SLiMClampCoordinate(y_fraction);
+					
+					int x_map = (int)round(x_fraction * x_scale);
+					int y_map = (int)round(y_fraction * y_scale);
+					
+					p_values[point_index] = values_[x_map + y_map * y_stride];
+				}
 			}
 			break;
 		}
 		case 3:
 		{
-			double x_fraction = p_point[0];
-			double y_fraction = p_point[1];
-			double z_fraction = p_point[2];
-			int64_t xsize = grid_size_[0];
-			int64_t ysize = grid_size_[1];
-			int64_t zsize = grid_size_[2];
+			const double x_origin = p_origin[0], x_extent = p_extent[0];
+			const double y_origin = p_origin[1], y_extent = p_extent[1];
+			const double z_origin = p_origin[2], z_extent = p_extent[2];
+			const double x_scale = (double)(grid_size_[0] - 1);
+			const double y_scale = (double)(grid_size_[1] - 1);
+			const double z_scale = (double)(grid_size_[2] - 1);
+			const int64_t y_stride = grid_size_[0];
+			const int64_t z_stride = grid_size_[0] * grid_size_[1];
 			
 			if (interpolate_)
 			{
-				double x_map = x_fraction * (xsize - 1);
-				double y_map = y_fraction * (ysize - 1);
-				double z_map = z_fraction * (zsize - 1);
-				int x1_map = (int)floor(x_map);
-				int y1_map = (int)floor(y_map);
-				int z1_map = (int)floor(z_map);
-				int x2_map = (int)ceil(x_map);
-				int y2_map = (int)ceil(y_map);
-				int z2_map = (int)ceil(z_map);
-				double fraction_x2 = x_map - x1_map;
-				double fraction_x1 = 1.0 - fraction_x2;
-				double fraction_y2 = y_map - y1_map;
-				double fraction_y1 = 1.0 - fraction_y2;
-				double fraction_z2 = z_map - z1_map;
-				double fraction_z1 = 1.0 - fraction_z2;
-				double value_x1_y1_z1 = values_[x1_map + y1_map * xsize + z1_map * xsize * ysize] * fraction_x1 * fraction_y1 * fraction_z1;
-				double value_x2_y1_z1 = values_[x2_map + y1_map * xsize + z1_map * xsize * ysize] * fraction_x2 * fraction_y1 * fraction_z1;
-				double value_x1_y2_z1 = values_[x1_map + y2_map * xsize + z1_map * xsize * ysize] * fraction_x1 * fraction_y2 * fraction_z1;
-				double value_x2_y2_z1 = values_[x2_map + y2_map * xsize + z1_map * xsize * ysize] * fraction_x2 * fraction_y2 * fraction_z1;
-				double value_x1_y1_z2 = values_[x1_map + y1_map * xsize + z2_map * xsize * ysize] * fraction_x1 * fraction_y1 * fraction_z2;
-				double value_x2_y1_z2 = values_[x2_map + y1_map * xsize + z2_map * xsize * ysize] * fraction_x2 * fraction_y1 * fraction_z2;
-				double value_x1_y2_z2 = values_[x1_map + y2_map * xsize + z2_map * xsize * ysize] * fraction_x1 * fraction_y2 * fraction_z2;
-				double value_x2_y2_z2 = values_[x2_map + y2_map * xsize + z2_map * xsize * ysize] * fraction_x2 * fraction_y2 * fraction_z2;
-				
-				return value_x1_y1_z1 + value_x2_y1_z1 + value_x1_y2_z1 + value_x2_y2_z1 + value_x1_y1_z2 + value_x2_y1_z2 + value_x1_y2_z2 + value_x2_y2_z2;
+				for (int64_t point_index = 0; point_index < p_count; ++point_index)
+				{
+					const double *point = p_points + point_index * 3;
+					double x_fraction = (point[0] - x_origin) / x_extent;
+					double y_fraction = (point[1] - y_origin) / y_extent;
+					double z_fraction = (point[2] - z_origin) / z_extent;
+					
+					x_fraction = SLiMClampCoordinate(x_fraction);
+					y_fraction = SLiMClampCoordinate(y_fraction);
+					z_fraction = SLiMClampCoordinate(z_fraction);
+					
+					double x_map = x_fraction * x_scale;
+					double y_map = y_fraction * y_scale;
+					double z_map = z_fraction * z_scale;
+					int x1_map = (int)floor(x_map);
+					int y1_map = (int)floor(y_map);
+					int z1_map = (int)floor(z_map);
+					int x2_map = (int)ceil(x_map);
+					int y2_map = (int)ceil(y_map);
+					int z2_map = (int)ceil(z_map);
+					double fraction_x2 = x_map - x1_map;
+					double fraction_x1 = 1.0 - fraction_x2;
+					double fraction_y2 = y_map - y1_map;
+					double fraction_y1 = 1.0 - fraction_y2;
+					double fraction_z2 = z_map - z1_map;
+					double fraction_z1 = 1.0 - fraction_z2;
+					const double *row_y1_z1 = values_ + y1_map * y_stride + z1_map * z_stride;
+					const double *row_y2_z1 = values_ + y2_map * y_stride + z1_map * z_stride;
+					const double *row_y1_z2 = values_ + y1_map * y_stride + z2_map * z_stride;
+					const double *row_y2_z2 = values_ + y2_map * y_stride + z2_map * z_stride;
+					double value_x1_y1_z1 = row_y1_z1[x1_map] * fraction_x1 * fraction_y1 * fraction_z1;
+					double value_x2_y1_z1 = row_y1_z1[x2_map] * fraction_x2 * fraction_y1 * fraction_z1;
+					double value_x1_y2_z1 = row_y2_z1[x1_map] * fraction_x1 * fraction_y2 * fraction_z1;
+					double value_x2_y2_z1 = row_y2_z1[x2_map] * fraction_x2 * fraction_y2 * fraction_z1;
+					double value_x1_y1_z2 = row_y1_z2[x1_map] * fraction_x1 * fraction_y1 * fraction_z2;
+					double value_x2_y1_z2 = row_y1_z2[x2_map] * fraction_x2 * fraction_y1 * fraction_z2;
+					double value_x1_y2_z2 = row_y2_z2[x1_map] * fraction_x1 * fraction_y2 * fraction_z2;
+					double value_x2_y2_z2 = row_y2_z2[x2_map] * fraction_x2 * fraction_y2 * fraction_z2;
+					
+					p_values[point_index] = value_x1_y1_z1 + value_x2_y1_z1 + value_x1_y2_z1 + value_x2_y2_z1 + value_x1_y1_z2 + value_x2_y1_z2 + value_x1_y2_z2 + value_x2_y2_z2;
+				}
 			}
 			else
 			{
-				int x_map = (int)round(x_fraction * (xsize - 1));
-				int y_map = (int)round(y_fraction * (ysize - 1));
-				int z_map = (int)round(z_fraction * (zsize - 1));
-				
-				return values_[x_map + y_map * xsize + z_map * xsize * ysize];
+				for (int64_t point_index = 0; point_index < p_count; ++point_index)
+				{
+					const double *point = p_points + point_index * 3;
+					double x_fraction = (point[0] - x_origin) / x_extent;
+					double y_fraction = (point[1] - y_origin) / y_extent;
+					double z_fraction = (point[2] - z_origin) / z_extent;
+					
+					x_fraction = SLiMClampCoordinate(x_fraction);
+					y_fraction = SLiMClampCoordinate(y_fraction);
+					z_fraction = SLiMClampCoordinate(z_fraction);
+					
+					int x_map = (int)round(x_fraction * x_scale);
+					int y_map = (int)round(y_fraction * y_scale);
+					int z_map = (int)round(z_fraction * z_scale);
+					
+					p_values[point_index] = values_[x_map + y_map * y_stride + z_map * z_stride];
+				}
 			}
 			break;
 		}
+		default:
+			EIDOS_TERMINATION << "ERROR (_SpatialMap::ValuesAtPoints): (internal error) unsupported spatiality." << EidosTerminate();
 	}
-	
-	return 0.0;
 }
 
+#undef SLiMClampCoordinate
+
 void _SpatialMap::ColorForValue(double p_value, double *p_rgb_ptr)
 {
 	if (n_colors_ == 0)
@@ -1400,6 +1487,11 @@ void Subpopulation::UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callba
 	bool pure_neutral = (!fitness_callbacks_exist && !global_fitness_callbacks_exist && population_.sim_.pure_neutral_);
 	double subpop_fitness_scaling = fitness_scaling_;
 	
+	// fitnessVector() callbacks are run here, once for the whole subpopulation; their results are then folded into each
+	// individual's fitness by ApplyGlobalFitnessCallbacks(), below, along with the results of other global callbacks.  They
+	// therefore all run before any fitness(NULL) callback, whatever the declaration order; SLiMHelpCallbacks.rtf says so.
+	vectorized_fitness_valid_ = (global_fitness_callbacks_exist && ApplyVectorizedGlobalFitnessCallbacks(p_global_fitness_callbacks));
+	
 #if (!defined(SLIMGUI) && defined(SLIM_WF_ONLY))
 	// Reset our override of individual cached fitness values; we make this decision afresh with each UpdateFitness() call.  See
 	// the header for further comments on this mechanism.
@@ -1927,7 +2019,8 @@ double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &
 	SLIM_PROFILE_BLOCK_START();
 #endif
 	
-	double computed_fitness = 1.0;
+	// fitnessVector() callbacks have already been run for the whole subpopulation; we start from their result
+	double computed_fitness = (vectorized_fitness_valid_ ? vectorized_fitness_[p_individual_index] : 1.0);
 	Individual *individual = parent_individuals_[p_individual_index];
 	Genome *genome1 = parent_genomes_[p_individual_index * 2];
 	Genome *genome2 = parent_genomes_[p_individual_index * 2 + 1];
@@ -1935,7 +2028,11 @@ double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &
 	
 	for (SLiMEidosBlock *fitness_callback : p_fitness_callbacks)
 	{
-		if (fitness_callback->active_)
+		// If the fitnessVector() callbacks put us at zero, we can short-circuit the rest, as below
+		if (computed_fitness <= 0.0)
+			break;
+		
+		if (fitness_callback->active_ && !fitness_callback->vectorized_)
 		{
 			// The callback is active, so we need to execute it
 			// This code is similar to Population::ExecuteScript, but we set up an additional symbol table, and we use the return value
@@ -2049,6 +2146,108 @@ double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &
 	return computed_fitness;
 }
 
+// This runs the fitnessVector() callbacks among the global fitness callbacks.  Each is called just once for the subpopulation, with
+// "individuals" defined as the vector of all parental individuals, and must return a float vector with one fitness value for each of
+// them.  The product of their results is left in vectorized_fitness_ for ApplyGlobalFitnessCallbacks(); returns false if none ran.
+bool Subpopulation::ApplyVectorizedGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &p_fitness_callbacks)
+{
+#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+	// PROFILING
+	SLIM_PROFILE_BLOCK_START();
+#endif
+	
+	bool any_callbacks_run = false;
+	SLiMSim &sim = population_.sim_;
+	
+	for (SLiMEidosBlock *fitness_callback : p_fitness_callbacks)
+	{
+		if (fitness_callback->active_ && fitness_callback->vectorized_)
+		{
+			if (!any_callbacks_run)
+			{
+				vectorized_fitness_.assign(parent_subpop_size_, 1.0);
+				any_callbacks_run = true;
+			}
+			
+			// Build an EidosValue_Object_vector with the parental individuals, or use the one cached by the individuals property
+			if (!cached_parent_individuals_value_ || (cached_parent_individuals_value_->Count() != parent_subpop_size_))
+			{
+				EidosValue_Object_vector *vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class))->reserve(parent_subpop_size_);
+				cached_parent_individuals_value_ = EidosValue_SP(vec);
+				
+				for (slim_popsize_t individual_index = 0; individual_index < parent_subpop_size_; individual_index++)
+					vec->push_object_element(parent_individuals_[individual_index]);
+			}
+			
+			EidosValue_SP individuals_value = cached_parent_individuals_value_;
+			
+			// We need to actually execute the script; we start a block here to manage the lifetime of the symbol table
+			{
+				EidosSymbolTable callback_symbols(EidosSymbolTableType::kContextConstantsTable, &sim.SymbolTable());
+				EidosSymbolTable client_symbols(EidosSymbolTableType::kVariablesTable, &callback_symbols);
+				EidosFunctionMap &function_map = sim.FunctionMap();
+				EidosInterpreter interpreter(fitness_callback->compound_statement_node_, client_symbols, function_map, &sim);
+				
+				if (fitness_callback->contains_self_)
+					callback_symbols.InitializeConstantSymbolEntry(fitness_callback->SelfSymbolTableEntry());		// define "self"
+				
+				// Set all of the callback's parameters; see ApplyGlobalFitnessCallbacks() regarding InitializeConstantSymbolEntry()
+				callback_symbols.InitializeConstantSymbolEntry(gID_individuals, individuals_value);
+				if (fitness_callback->contains_subpop_)
+					callback_symbols.InitializeConstantSymbolEntry(gID_subpop, SymbolTableEntry().second);
+				
+				try
+				{
+					// Interpret the script; the result must be a float vector with one fitness value per individual
+					EidosValue_SP result_SP = interpreter.EvaluateInternalBlock(fitness_callback->script_);
+					EidosValue *result = result_SP.get();
+					
+					if ((result->Type() != EidosValueType::kValueFloat) || (result->Count() != parent_subpop_size_))
+						EIDOS_TERMINATION << "ERROR (Subpopulation::ApplyVectorizedGlobalFitnessCallbacks): fitnessVector() callbacks must provide a float vector return value containing one fitness value for each individual." << EidosTerminate(fitness_callback->identifier_token_);
+					
+					// As in ApplyGlobalFitnessCallbacks(), a fitness at or below zero is clamped to zero and short-circuits later callbacks
+					double *fitness_data = vectorized_fitness_.data();
+					
+					if (parent_subpop_size_ == 1)
+					{
+						double fitness = fitness_data[0] * result->FloatAtIndex(0, nullptr);
+						
+						fitness_data[0] = ((fitness <= 0.0) ? 0.0 : fitness);
+					}
+					else
+					{
+						const double *result_data = result->FloatVector()->data();
+						
+						for (slim_popsize_t individual_index = 0; individual_index < parent_subpop_size_; individual_index++)
+						{
+							double fitness = fitness_data[individual_index] * result_data[individual_index];
+							
+							fitness_data[individual_index] = ((fitness <= 0.0) ? 0.0 : fitness);
+						}
+					}
+					
+					// Output generated by the interpreter goes to our output stream
+					interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+				}
+				catch (...)
+				{
+					// Emit final output even on a throw, so that stop() messages and such get printed
+					interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+					
+					throw;
+				}
+			}
+		}
+	}
+	
+#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+	// PROFILING
+	SLIM_PROFILE_BLOCK_END(population_.sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback)]);
+#endif
+	
+	return any_callbacks_run;
+}
+
 // FitnessOfParentWithGenomeIndices has three versions, for no callbacks, a single callback, and multiple callbacks.  This is for two reasons.  First,
 // it allows the case without fitness() callbacks to run at full speed.  Second, the non-callback case short-circuits when the selection coefficient
 // is exactly 0.0f, as an optimization; but that optimization would be invalid in the callback case, since callbacks can change the relative fitness
@@ -3284,7 +3483,7 @@ EidosValue_SP Subpopulation::GetProperty(EidosGlobalStringID p_property_id)
 		}
 		case gID_firstMaleIndex:	// ACCELERATED
 			return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(CurrentFirstMaleIndex()));
-		case gID_genomes:
+		case gID_genomes:			// ACCELERATED
 		{
 #ifdef SLIM_WF_ONLY
 			if (child_generation_valid_)
@@ -3351,7 +3550,7 @@ EidosValue_SP Subpopulation::GetProperty(EidosGlobalStringID p_property_id)
 				return cached_parent_genomes_value_;
 			}
 		}
-		case gID_individuals:
+		case gID_individuals:		// ACCELERATED
 		{
 #ifdef SLIM_WF_ONLY
 			if (child_generation_valid_)
@@ -3558,6 +3757,54 @@ EidosValue *Subpopulation::GetProperty_Accelerated_fitnessScaling(EidosObjectEle
 	return float_result;
 }
 
+EidosValue *Subpopulation::GetProperty_Accelerated_genomes(EidosObjectElement **p_values, size_t p_values_size)
+{
+	// this concatenates the current genomes of all of the subpopulations directly, without building their cached genomes values
+	size_t total_genome_count = 0;
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+		total_genome_count += ((Subpopulation *)(p_values[value_index]))->CurrentGenomeCount();
+	
+	EidosValue_Object_vector *object_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Genome_Class))->resize_no_initialize(total_genome_count);
+	size_t set_index = 0;
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Subpopulation *value = (Subpopulation *)(p_values[value_index]);
+		std::vector<Genome *> &genomes = value->CurrentGenomes();
+		slim_popsize_t genome_count = value->CurrentGenomeCount();
+		
+		for (slim_popsize_t genome_index = 0; genome_index < genome_count; genome_index++)
+			object_result->set_object_element_no_check(genomes[genome_index], set_index++);
+	}
+	
+	return object_result;
+}
+
+EidosValue *Subpopulation::GetProperty_Accelerated_individuals(EidosObjectElement **p_values, size_t p_values_size)
+{
+	// this concatenates the current individuals of all of the subpopulations directly, without building their cached individuals values
+	size_t total_individual_count = 0;
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+		total_individual_count += ((Subpopulation *)(p_values[value_index]))->CurrentSubpopSize();
+	
+	EidosValue_Object_vector *object_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class))->resize_no_initialize(total_individual_count);
+	size_t set_index = 0;
+	
+	for (size_t value_index = 0; value_index < p_values_size; ++value_index)
+	{
+		Subpopulation *value = (Subpopulation *)(p_values[value_index]);
+		std::vector<Individual *> &individuals = value->CurrentIndividuals();
+		slim_popsize_t subpop_size = value->CurrentSubpopSize();
+		
+		for (slim_popsize_t individual_index = 0; individual_index < subpop_size; individual_index++)
+			object_result->set_object_element_no_check(individuals[individual_index], set_index++);
+	}
+	
+	return object_result;
+}
+
 void Subpopulation::SetProperty(EidosGlobalStringID p_property_id, const EidosValue &p_value)
 {
 	switch (p_property_id)
@@ -3660,6 +3907,7 @@ EidosValue_SP Subpopulation::ExecuteInstanceMethod(EidosGlobalStringID p_method_
 		case gID_pointStopped:			return ExecuteMethod_pointStopped(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_pointPeriodic:			return ExecuteMethod_pointPeriodic(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_pointUniform:			return ExecuteMethod_pointUniform(p_method_id, p_arguments, p_argument_count, p_interpreter);
+		case gID_deviatePositions:		return ExecuteMethod_deviatePositions(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_setSpatialBounds:		return ExecuteMethod_setSpatialBounds(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_cachedFitness:			return ExecuteMethod_cachedFitness(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_sampleIndividuals:		return ExecuteMethod_sampleIndividuals(p_method_id, p_arguments, p_argument_count, p_interpreter);
@@ -5436,6 +5684,145 @@ EidosValue_SP Subpopulation::ExecuteMethod_pointUniform(EidosGlobalStringID p_me
 	return result_SP;
 }			
 
+//	*********************	– (void)deviatePositions(No<Individual> individuals, string$ boundary, numeric$ sigma)
+//
+EidosValue_SP Subpopulation::ExecuteMethod_deviatePositions(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
+{
+#pragma unused (p_method_id, p_arguments, p_argument_count, p_interpreter)
+	EidosValue *individuals_value = p_arguments[0].get();
+	EidosValue *boundary_value = p_arguments[1].get();
+	EidosValue *sigma_value = p_arguments[2].get();
+	
+	SLiMSim &sim = population_.sim_;
+	int dimensionality = sim.SpatialDimensionality();
+	
+	if (dimensionality == 0)
+		EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_deviatePositions): deviatePositions() cannot be called in non-spatial simulations." << EidosTerminate();
+	
+	// This fuses the common dispersal idiom setSpatialPosition(pointReflected(spatialPosition + rnorm(...))) into a single pass over
+	// the individuals, modifying their positions in place with no intermediate vectors.  The deviations are drawn in the same order as
+	// that idiom would draw them (individual by individual, and x before y before z), and the boundary conditions are applied with the
+	// same arithmetic as pointReflected(), pointStopped(), and pointPeriodic(), so results are identical to the corresponding script.
+	const std::string &boundary = boundary_value->StringAtIndex(0, nullptr);
+	enum class BoundaryCondition { kReflecting = 0, kStopping, kPeriodic, kReprising } boundary_condition;
+	
+	if (boundary == "reflecting")		boundary_condition = BoundaryCondition::kReflecting;
+	else if (boundary == "stopping")	boundary_condition = BoundaryCondition::kStopping;
+	else if (boundary == "periodic")	boundary_condition = BoundaryCondition::kPeriodic;
+	else if (boundary == "reprising")	boundary_condition = BoundaryCondition::kReprising;
+	else
+		EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_deviatePositions): deviatePositions() requires boundary to be 'reflecting', 'stopping', 'periodic', or 'reprising'." << EidosTerminate();
+	
+	if (boundary_condition == BoundaryCondition::kPeriodic)
+	{
+		bool periodic_x, periodic_y, periodic_z;
+		
+		sim.SpatialPeriodicity(&periodic_x, &periodic_y, &periodic_z);
+		
+		if (!periodic_x || ((dimensionality >= 2) && !periodic_y) || ((dimensionality >= 3) && !periodic_z))
+			EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_deviatePositions): deviatePositions() requires that all spatial dimensions be periodic when boundary is 'periodic'." << EidosTerminate();
+	}
+	
+	double sigma = sigma_value->FloatAtIndex(0, nullptr);
+	
+	if (!std::isfinite(sigma) || (sigma < 0.0))
+		EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_deviatePositions): deviatePositions() requires sigma to be finite and >= 0.0 (" << EidosStringForFloat(sigma) << " supplied)." << EidosTerminate();
+	
+	// If individuals is NULL, we deviate all of the individuals in the subpopulation, taken directly from CurrentIndividuals()
+	// rather than through the individuals property, which would build an object vector just for us to walk over
+	Individual * const *current_individuals_data = nullptr;
+	EidosObjectElement *singleton_individual = nullptr;
+	EidosObjectElement * const *individuals_data = nullptr;
+	int individuals_count;
+	
+	if (individuals_value->Type() == EidosValueType::kValueNULL)
+	{
+		std::vector<Individual *> &current_individuals = CurrentIndividuals();
+		
+		current_individuals_data = current_individuals.data();
+		individuals_count = (int)current_individuals.size();
+	}
+	else
+	{
+		individuals_count = individuals_value->Count();
+		
+		if (individuals_count == 1)
+		{
+			singleton_individual = individuals_value->ObjectElementAtIndex(0, nullptr);
+			individuals_data = &singleton_individual;
+		}
+		else if (individuals_count > 1)
+		{
+			individuals_data = individuals_value->ObjectElementVector()->data();
+		}
+	}
+	
+	if (individuals_count == 0)
+		return gStaticEidosValueVOID;
+	
+	const double bounds_lo[3] = {bounds_x0_, bounds_y0_, bounds_z0_};
+	const double bounds_hi[3] = {bounds_x1_, bounds_y1_, bounds_z1_};
+	gsl_rng *rng = EIDOS_GSL_RNG;
+	
+	for (int individual_index = 0; individual_index < individuals_count; ++individual_index)
+	{
+		Individual *ind = (current_individuals_data ? current_individuals_data[individual_index] : (Individual *)individuals_data[individual_index]);
+		
+		if (&ind->subpopulation_ != this)
+			EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_deviatePositions): deviatePositions() requires that all individuals belong to the target subpopulation." << EidosTerminate();
+		
+		double *coordinates[3] = {&ind->spatial_x_, &ind->spatial_y_, &ind->spatial_z_};
+		
+		for (int dimension = 0; dimension < dimensionality; ++dimension)
+		{
+			double lo = bounds_lo[dimension], hi = bounds_hi[dimension];
+			double x = *coordinates[dimension];
+			
+			switch (boundary_condition)
+			{
+				case BoundaryCondition::kReflecting:
+					x += gsl_ran_gaussian(rng, sigma);
+					while (true)
+					{
+						if (x < lo) x = lo + (lo - x);
+						else if (x > hi) x = hi - (x - hi);
+						else break;
+					}
+					break;
+				case BoundaryCondition::kStopping:
+					x += gsl_ran_gaussian(rng, sigma);
+					x = std::max(lo, std::min(hi, x));
+					break;
+				case BoundaryCondition::kPeriodic:
+					// as in pointPeriodic(), lo is 0.0 for periodic dimensions
+					x += gsl_ran_gaussian(rng, sigma);
+					while (x < 0.0)	x += hi;
+					while (x > hi)	x -= hi;
+					break;
+				case BoundaryCondition::kReprising:
+				{
+					// redraw the deviation until it lands in bounds; this requires a starting position in bounds, or it might never end
+					if ((x < lo) || (x > hi))
+						EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_deviatePositions): deviatePositions() requires that all individuals be within the spatial bounds of the subpopulation when boundary is 'reprising'." << EidosTerminate();
+					
+					double deviated;
+					
+					do
+						deviated = x + gsl_ran_gaussian(rng, sigma);
+					while ((deviated < lo) || (deviated > hi));
+					
+					x = deviated;
+					break;
+				}
+			}
+			
+			*coordinates[dimension] = x;
+		}
+	}
+	
+	return gStaticEidosValueVOID;
+}			
+
 #ifdef SLIM_WF_ONLY
 //	*********************	- (void)setCloningRate(numeric rate)
 //
@@ -6354,8 +6741,6 @@ EidosValue_SP Subpopulation::ExecuteMethod_spatialMapColor(EidosGlobalStringID p
 
 //	*********************	– (float)spatialMapValue(string$ name, float point)
 //
-#define SLiMClampCoordinate(x) ((x < 0.0) ? 0.0 : ((x > 1.0) ? 1.0 : x))
-
 EidosValue_SP Subpopulation::ExecuteMethod_spatialMapValue(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
 {
 #pragma unused (p_method_id, p_arguments, p_argument_count, p_interpreter)
@@ -6374,122 +6759,53 @@ EidosValue_SP Subpopulation::ExecuteMethod_spatialMapValue(EidosGlobalStringID p
 	if (map_iter != spatial_maps_.end())
 	{
 		SpatialMap *map = map_iter->second;
-		EidosValue_Float_vector *float_result;
-		int x_count;
+		int spatiality = map->spatiality_;
+		int point_count = point->Count();
 		
-		if (point->Count() == map->spatiality_)
-		{
-			x_count = 1;
-			float_result = nullptr;
-		}
-		else if (point->Count() % map->spatiality_ == 0)
-		{
-			x_count = point->Count() / map->spatiality_;
-			float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
-		}
-		else
+		if (point_count % spatiality != 0)
 			EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_spatialMapValue): spatialMapValue() length of point must match spatiality of map " << map_name << ", or be a multiple thereof." << EidosTerminate();
 		
-		for (int value_index = 0; value_index < x_count; ++value_index)
+		// We need to use the correct spatial bounds for each coordinate, which depends upon our exact spatiality; we work out
+		// the origin and extent for each dimension of the map once, and then look up all of the points in one batch
+		const std::string &map_spatiality = map->spatiality_string_;
+		double origin[3], extent[3];
+		
+		for (int dimension = 0; dimension < spatiality; ++dimension)
 		{
-			// We need to use the correct spatial bounds for each coordinate, which depends upon our exact spatiality
-			// There is doubtless a way to make this code smarter, but brute force is sometimes best...
-			double point_vec[3];
-			
-			switch (map->spatiality_)
+			switch (map_spatiality[dimension])
 			{
-				case 1:
-				{
-					int value_offset = value_index;
-					
-					if (map->spatiality_string_ == "x")
-					{
-						double x = (point->FloatAtIndex(0 + value_offset, nullptr) - bounds_x0_) / (bounds_x1_ - bounds_x0_);
-						point_vec[0] = SLiMClampCoordinate(x);
-					}
-					else if (map->spatiality_string_ == "y")
-					{
-						double y = (point->FloatAtIndex(0 + value_offset, nullptr) - bounds_y0_) / (bounds_y1_ - bounds_y0_);
-						point_vec[0] = SLiMClampCoordinate(y);
-					}
-					else if (map->spatiality_string_ == "z")
-					{
-						double z = (point->FloatAtIndex(0 + value_offset, nullptr) - bounds_z0_) / (bounds_z1_ - bounds_z0_);
-						point_vec[0] = SLiMClampCoordinate(z);
-					}
-					else
-						EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_spatialMapValue): (internal error) unrecognized spatiality." << EidosTerminate();
-					break;
-				}
-				case 2:
-				{
-					int value_offset = value_index * 2;
-					
-					if (map->spatiality_string_ == "xy")
-					{
-						double x = (point->FloatAtIndex(0 + value_offset, nullptr) - bounds_x0_) / (bounds_x1_ - bounds_x0_);
-						point_vec[0] = SLiMClampCoordinate(x);
-						
-						double y = (point->FloatAtIndex(1 + value_offset, nullptr) - bounds_y0_) / (bounds_y1_ - bounds_y0_);
-						point_vec[1] = SLiMClampCoordinate(y);
-					}
-					else if (map->spatiality_string_ == "yz")
-					{
-						double y = (point->FloatAtIndex(0 + value_offset, nullptr) - bounds_y0_) / (bounds_y1_ - bounds_y0_);
-						point_vec[0] = SLiMClampCoordinate(y);
-						
-						double z = (point->FloatAtIndex(1 + value_offset, nullptr) - bounds_z0_) / (bounds_z1_ - bounds_z0_);
-						point_vec[1] = SLiMClampCoordinate(z);
-					}
-					else if (map->spatiality_string_ == "xz")
-					{
-						double x = (point->FloatAtIndex(0 + value_offset, nullptr) - bounds_x0_) / (bounds_x1_ - bounds_x0_);
-						point_vec[0] = SLiMClampCoordinate(x);
-						
-						double z = (point->FloatAtIndex(1 + value_offset, nullptr) - bounds_z0_) / (bounds_z1_ - bounds_z0_);
-						point_vec[1] = SLiMClampCoordinate(z);
-					}
-					else
-						EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_spatialMapValue): (internal error) unrecognized spatiality." << EidosTerminate();
-					break;
-				}
-				case 3:
-				{
-					int value_offset = value_index * 3;
-					
-					if (map->spatiality_string_ == "xyz")
-					{
-						double x = (point->FloatAtIndex(0 + value_offset, nullptr) - bounds_x0_) / (bounds_x1_ - bounds_x0_);
-						point_vec[0] = SLiMClampCoordinate(x);
-						
-						double y = (point->FloatAtIndex(1 + value_offset, nullptr) - bounds_y0_) / (bounds_y1_ - bounds_y0_);
-						point_vec[1] = SLiMClampCoordinate(y);
-						
-						double z = (point->FloatAtIndex(2 + value_offset, nullptr) - bounds_z0_) / (bounds_z1_ - bounds_z0_);
-						point_vec[2] = SLiMClampCoordinate(z);
-					}
-					else
-						EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_spatialMapValue): (internal error) unrecognized spatiality." << EidosTerminate();
-					break;
-				}
+				case 'x':	origin[dimension] = bounds_x0_; extent[dimension] = bounds_x1_ - bounds_x0_; break;
+				case 'y':	origin[dimension] = bounds_y0_; extent[dimension] = bounds_y1_ - bounds_y0_; break;
+				case 'z':	origin[dimension] = bounds_z0_; extent[dimension] = bounds_z1_ - bounds_z0_; break;
+				default:
+					EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_spatialMapValue): (internal error) unrecognized spatiality." << EidosTerminate();
 			}
+		}
+		
+		if (point_count == spatiality)
+		{
+			double point_vec[3], map_value;
 			
-			double map_value = map->ValueAtPoint(point_vec);
+			for (int dimension = 0; dimension < spatiality; ++dimension)
+				point_vec[dimension] = point->FloatAtIndex(dimension, nullptr);
 			
-			if (float_result)
-				float_result->set_float_no_check(map_value, value_index);
-			else
-				return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(map_value));
+			map->ValuesAtPoints(point_vec, 1, origin, extent, &map_value);
+			
+			return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(map_value));
 		}
 		
+		int x_count = point_count / spatiality;
+		EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
+		
+		if (x_count > 0)
+			map->ValuesAtPoints(point->FloatVector()->data(), x_count, origin, extent, float_result->data());
+		
 		return EidosValue_SP(float_result);
 	}
 	else
 		EIDOS_TERMINATION << "ERROR (Subpopulation::ExecuteMethod_spatialMapValue): spatialMapValue() could not find map with name " << map_name << "." << EidosTerminate();
 }
 
-#undef SLiMClampCoordinate
-
 //	*********************	– (void)outputMSSample(integer$ sampleSize, [logical$ replace = T], [string$ requestedSex = "*"], [Ns$ filePath = NULL], [logical$ append=F], [logical$ filterMonomorphic = F])
 //	*********************	– (void)outputSample(integer$ sampleSize, [logical$ replace = T], [string$ requestedSex = "*"], [Ns$ filePath = NULL], [logical$ append=F])
 //	*********************	– (void)outputVCFSample(integer$ sampleSize, [logical$ replace = T], [string$ requestedSex = "*"], [logical$ outputMultiallelics = T], [Ns$ filePath = NULL], [logical$ append=F], [logical$ simplifyNucleotides = F], [logical$ outputNonnucleotides = T])
@@ -6748,8 +7064,8 @@ const std::vector<EidosPropertySignature_CSP> *Subpopulation_Class::Properties(v
 		
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_id,							true,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Subpopulation::GetProperty_Accelerated_id));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_firstMaleIndex,				true,	kEidosValueMaskInt | kEidosValueMaskSingleton))->DeclareAcceleratedGet(Subpopulation::GetProperty_Accelerated_firstMaleIndex));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genomes,					true,	kEidosValueMaskObject, gSLiM_Genome_Class)));
-		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_individuals,				true,	kEidosValueMaskObject, gSLiM_Individual_Class)));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_genomes,					true,	kEidosValueMaskObject, gSLiM_Genome_Class))->DeclareAcceleratedGet(Subpopulation::GetProperty_Accelerated_genomes));
+		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_individuals,				true,	kEidosValueMaskObject, gSLiM_Individual_Class))->DeclareAcceleratedGet(Subpopulation::GetProperty_Accelerated_individuals));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_immigrantSubpopIDs,			true,	kEidosValueMaskInt)));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_immigrantSubpopFractions,	true,	kEidosValueMaskFloat)));
 		properties->emplace_back((EidosPropertySignature *)(new EidosPropertySignature(gStr_selfingRate,				true,	kEidosValueMaskFloat | kEidosValueMaskSingleton)));
@@ -6780,6 +7096,7 @@ const std::vector<EidosMethodSignature_CSP> *Subpopulation_Class::Methods(void)
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_pointStopped, kEidosValueMaskFloat))->AddFloat("point"));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_pointPeriodic, kEidosValueMaskFloat))->AddFloat("point"));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_pointUniform, kEidosValueMaskFloat))->AddInt_OS(gEidosStr_n, gStaticEidosValue_Integer1));
+		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_deviatePositions, kEidosValueMaskVOID))->AddObject_N("individuals", gSLiM_Individual_Class)->AddString_S("boundary")->AddNumeric_S("sigma"));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_setCloningRate, kEidosValueMaskVOID))->AddNumeric("rate"));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_setSelfingRate, kEidosValueMaskVOID))->AddNumeric_S("rate"));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_setSexRatio, kEidosValueMaskVOID))->AddFloat_S("sexRatio"));
@@ -101,6 +101,7 @@ struct _SpatialMap
 	~_SpatialMap(void);
 	
 	double ValueAtPoint(double *p_point);
+	void ValuesAtPoints(const double *p_points, int64_t p_count, const double *p_origin, const double *p_extent, double *p_values);
 	void ColorForValue(double p_value, double *p_rgb_ptr);
 	void ColorForValue(double p_value, float *p_rgb_ptr);
 };
@@ -154,6 +155,10 @@ public:
 	slim_popsize_t parent_first_male_index_ = INT_MAX;	// the index of the first male in the parental Genome vector (NOT premultiplied by 2!); equal to the number of females
 	std::vector<Individual *> parent_individuals_;	// OWNED: objects representing simulated individuals, each of which has two genomes
 	EidosValue_SP cached_parent_individuals_value_;	// cached for the individuals property; self-maintains
+	
+	std::vector<double> vectorized_fitness_;		// per-parent fitness from fitnessVector() callbacks; used only inside UpdateFitness()
+	bool vectorized_fitness_valid_ = false;			// true if vectorized_fitness_ should be used by ApplyGlobalFitnessCallbacks()
+	
 #ifdef SLIM_WF_ONLY
 	double parent_sex_ratio_ = 0.0;					// what sex ratio the parental genomes approximate (M:M+F)
 #endif	// SLIM_WF_ONLY
@@ -363,6 +368,7 @@ public:
 	
 	double ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homozygous, double p_computed_fitness, std::vector<SLiMEidosBlock*> &p_fitness_callbacks, Individual *p_individual, Genome *p_genome1, Genome *p_genome2);
 	double ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &p_fitness_callbacks, slim_popsize_t p_individual_index);
+	bool ApplyVectorizedGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &p_fitness_callbacks);
 	
 #ifdef SLIM_WF_ONLY
 	void SwapChildAndParentGenomes(void);															// switch to the next generation by swapping; the children become the parents
@@ -496,6 +502,7 @@ public:
 	EidosValue_SP ExecuteMethod_pointStopped(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_pointPeriodic(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_pointUniform(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
+	EidosValue_SP ExecuteMethod_deviatePositions(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_setSpatialBounds(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_cachedFitness(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_defineSpatialMap(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
@@ -512,6 +519,8 @@ public:
 	static EidosValue *GetProperty_Accelerated_individualCount(EidosObjectElement **p_values, size_t p_values_size);
 	static EidosValue *GetProperty_Accelerated_tag(EidosObjectElement **p_values, size_t p_values_size);
 	static EidosValue *GetProperty_Accelerated_fitnessScaling(EidosObjectElement **p_values, size_t p_values_size);
+	static EidosValue *GetProperty_Accelerated_genomes(EidosObjectElement **p_values, size_t p_values_size);
+	static EidosValue *GetProperty_Accelerated_individuals(EidosObjectElement **p_values, size_t p_values_size);
 	
 	static void SetProperty_Accelerated_fitnessScaling(EidosObjectElement **p_values, size_t p_values_size, const EidosValue &p_source, size_t p_source_size);
 	static void SetProperty_Accelerated_tag(EidosObjectElement **p_values, size_t p_values_size, const EidosValue &p_source, size_t p_source_size);
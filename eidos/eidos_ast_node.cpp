@@ -20,10 +20,13 @@
 
 #include "eidos_ast_node.h"
 #include "eidos_interpreter.h"
+#include "eidos_bytecode.h"
+#include "eidos_script.h"
 
 #include "errno.h"
 #include <string>
 #include <algorithm>
+#include <unordered_set>
 
 
 // The global object pool for EidosASTNode, initialized in Eidos_WarmUp()
@@ -44,6 +47,18 @@ EidosASTNode::~EidosASTNode(void)
 		delete token_;
 		token_ = nullptr;
 	}
+	
+	if (cached_bytecode_)
+	{
+		delete cached_bytecode_;
+		cached_bytecode_ = nullptr;
+	}
+	
+	if (cached_fold_)
+	{
+		delete cached_fold_;
+		cached_fold_ = nullptr;
+	}
 }
 
 void EidosASTNode::AddChild(EidosASTNode *p_child_node)
@@ -71,6 +86,8 @@ void EidosASTNode::OptimizeTree(void) const
 	_OptimizeConstants();		// cache values for numeric and string constants, and for return statements and constant compound statements
 	_OptimizeIdentifiers();		// cache unique IDs for identifiers using Eidos_GlobalStringIDForString()
 	_OptimizeEvaluators();		// cache evaluator functions in cached_evaluator_ for fast node evaluation
+	(void)_OptimizeFolding(nullptr, nullptr);	// fold pure expressions, replacing cached_evaluator_ with Evaluate_Folded()
+	_OptimizeBytecode();		// compile scalar expressions to bytecode, replacing cached_evaluator_ with Evaluate_Bytecode()
 	_OptimizeFor();				// cache information about for loops that allows them to be accelerated at runtime
 	_OptimizeAssignments();		// cache information about assignments that allows simple increment/decrement assignments to be accelerated
 }
@@ -160,19 +177,19 @@ void EidosASTNode::_OptimizeIdentifiers(void) const
 	{
 		const std::string &token_string = token_->token_string_;
 		
+		// cache a uniqued ID for the identifier, allowing fast matching
+		cached_stringID_ = Eidos_GlobalStringIDForString(token_string);
+		
 		// if the identifier's name matches that of a global function, cache the function signature
 		const EidosFunctionMap *function_map = EidosInterpreter::BuiltInFunctionMap();
 		
 		if (function_map)
 		{
-			auto signature_iter = function_map->find(token_string);
+			auto signature_iter = function_map->find(cached_stringID_);
 			
 			if (signature_iter != function_map->end())
 				cached_signature_ = signature_iter->second;
 		}
-		
-		// cache a uniqued ID for the identifier, allowing fast matching
-		cached_stringID_ = Eidos_GlobalStringIDForString(token_string);
 	}
 }
 
@@ -227,6 +244,346 @@ void EidosASTNode::_OptimizeEvaluators(void) const
 	}
 }
 
+bool EidosASTNode::_OptimizeFoldingLiveBranch(int *p_live_child) const
+{
+	// If we are an if statement or a ternary conditional whose condition folded to T or F, only one branch can ever be
+	// executed; we return true, with the index of the live child in p_live_child, or -1 for an if with no else.
+	EidosTokenType token_type = token_->token_type_;
+	
+	if (((token_type == EidosTokenType::kTokenIf) || (token_type == EidosTokenType::kTokenConditional)) && (children_.size() >= 2))
+	{
+		const EidosValue_SP &condition = children_[0]->cached_literal_value_;
+		
+		if (condition == gStaticEidosValue_LogicalT)
+		{
+			*p_live_child = 1;
+			return true;
+		}
+		if (condition == gStaticEidosValue_LogicalF)
+		{
+			*p_live_child = ((children_.size() == 3) ? 2 : -1);
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+void EidosASTNode::_OptimizeFoldingIdentifiers(std::vector<EidosGlobalStringID> &p_identifiers) const
+{
+	// collect the identifiers referenced in this subtree, except those with literal values, the names of called functions,
+	// and those in branches that are never executed
+	if (cached_literal_value_)
+		return;
+	
+	EidosTokenType token_type = token_->token_type_;
+	
+	if ((token_type == EidosTokenType::kTokenIdentifier) && (children_.size() == 0))
+	{
+		if (std::find(p_identifiers.begin(), p_identifiers.end(), cached_stringID_) == p_identifiers.end())
+			p_identifiers.emplace_back(cached_stringID_);
+		return;
+	}
+	
+	int live_child;
+	bool has_live_branch = _OptimizeFoldingLiveBranch(&live_child);
+	
+	for (size_t child_index = ((token_type == EidosTokenType::kTokenLParen) ? 1 : 0); child_index < children_.size(); ++child_index)
+		if (!has_live_branch || (child_index == 0) || ((int)child_index == live_child))
+			children_[child_index]->_OptimizeFoldingIdentifiers(p_identifiers);
+}
+
+void EidosASTNode::_OptimizeFoldingScan(std::vector<EidosGlobalStringID> &p_assigned, bool *p_wildcard) const
+{
+	// collect the identifiers that might be assigned to in this subtree; like _OptimizeForScan(), this is overbroad
+	for (auto child : children_)
+		child->_OptimizeFoldingScan(p_assigned, p_wildcard);
+	
+	EidosTokenType token_type = token_->token_type_;
+	
+	if (children_.size() >= 1)
+	{
+		if (token_type == EidosTokenType::kTokenAssign)
+		{
+			// any identifier anywhere on the left-hand side of an assignment might be assigned to
+			children_[0]->_OptimizeFoldingIdentifiers(p_assigned);
+		}
+		else if (token_type == EidosTokenType::kTokenFor)
+		{
+			// for loops assign into their index variable
+			if (children_[0]->token_->token_type_ == EidosTokenType::kTokenIdentifier)
+				p_assigned.emplace_back(children_[0]->cached_stringID_);
+		}
+		else if (token_type == EidosTokenType::kTokenLParen)
+		{
+			// certain functions are unpredictable and must be assumed to assign to anything
+			EidosASTNode *function_name_node = children_[0];
+			
+			if (function_name_node->token_->token_type_ == EidosTokenType::kTokenIdentifier)	// is it a function call, not a method call?
+			{
+				const std::string &function_name = function_name_node->token_->token_string_;
+				
+				if ((function_name.compare(gEidosStr_apply) == 0) || (function_name.compare(gEidosStr_sapply) == 0) || (function_name.compare(gEidosStr_executeLambda) == 0) || (function_name.compare(gEidosStr__executeLambda_OUTER) == 0) || (function_name.compare(gEidosStr_doCall) == 0) || (function_name.compare(gEidosStr_rm) == 0) || (function_name.compare(gEidosStr_source) == 0))
+					*p_wildcard = true;
+			}
+		}
+	}
+}
+
+bool EidosASTNode::_OptimizeFolding(const EidosASTNode *p_loop_node, const std::vector<EidosGlobalStringID> *p_loop_assigned) const
+{
+	// This pass finds pure expressions – built only from literals, identifiers, operators, and built-in functions whose
+	// result depends only on their arguments – and folds them, so that their value can be reused instead of recomputed;
+	// see EidosFold.  It returns true if this node is pure.  p_loop_node is the innermost for loop whose body contains
+	// us, if any, and p_loop_assigned holds the identifiers that might be assigned to in its body.
+	
+	// discard any fold from a previous optimization pass; _OptimizeEvaluators() has just reset our evaluator
+	if (cached_fold_)
+	{
+		delete cached_fold_;
+		cached_fold_ = nullptr;
+	}
+	
+	EidosTokenType token_type = token_->token_type_;
+	
+	// recurse down the tree; determine our children, then ourselves.  A for loop's body is folded with respect to the loop,
+	// unless it calls a function that might assign to anything.  A function declaration's body, its last child, is outside
+	// any loop; its other children are type specifiers and parameters, which are not expressions and must be left alone.
+	if ((token_type == EidosTokenType::kTokenFor) && (children_.size() == 3))
+	{
+		std::vector<EidosGlobalStringID> body_assigned;
+		bool body_wildcard = false;
+		
+		_OptimizeFoldingScan(body_assigned, &body_wildcard);
+		
+		children_[0]->_OptimizeFolding(p_loop_node, p_loop_assigned);
+		children_[1]->_OptimizeFolding(p_loop_node, p_loop_assigned);
+		
+		if (body_wildcard)
+			children_[2]->_OptimizeFolding(nullptr, nullptr);
+		else
+			children_[2]->_OptimizeFolding(this, &body_assigned);
+		
+		return false;
+	}
+	
+	if (token_type == EidosTokenType::kTokenFunction)
+	{
+		if (children_.size())
+			children_.back()->_OptimizeFolding(nullptr, nullptr);
+		
+		return false;
+	}
+	
+	// a branch of an if or ?else that can never be executed is left alone; the condition, child 0, is folded before we check
+	bool children_pure = true;
+	
+	for (size_t child_index = 0; child_index < children_.size(); ++child_index)
+	{
+		int live_child;
+		
+		if ((child_index > 0) && _OptimizeFoldingLiveBranch(&live_child) && ((int)child_index != live_child))
+			continue;
+		
+		if (!children_[child_index]->_OptimizeFolding(p_loop_node, p_loop_assigned))
+			children_pure = false;
+	}
+	
+	// return statements and blocks propagate folded values upward, as in _OptimizeConstants()
+	if (token_type == EidosTokenType::kTokenReturn)
+	{
+		if ((children_.size() == 1) && children_[0]->cached_literal_value_)
+			cached_return_value_ = children_[0]->cached_literal_value_;
+		
+		return false;
+	}
+	if (token_type == EidosTokenType::kTokenLBrace)
+	{
+		if ((children_.size() == 1) && children_[0]->cached_return_value_ && (children_[0]->token_->token_type_ == EidosTokenType::kTokenReturn))
+			cached_return_value_ = children_[0]->cached_return_value_;
+		
+		return false;
+	}
+	
+	// literals and identifiers are pure; a literal might be an operation folded by a previous pass, which we fold again
+	bool is_literal = !!cached_literal_value_;
+	
+	if (token_type == EidosTokenType::kTokenIdentifier)
+		return (is_literal || (children_.size() == 0));
+	if ((token_type == EidosTokenType::kTokenNumber) || (token_type == EidosTokenType::kTokenString))
+		return is_literal;
+	
+	if (!children_pure || !cached_evaluator_)
+		return false;
+	
+	// an expression that can build a large value from small literals, or that contains one, is not computed at parse time, where
+	// it might be in a branch that never runs; it is computed lazily instead, when first evaluated, and then cached (see below)
+	bool is_lazy = false;
+	
+	for (const EidosASTNode *child : children_)
+		if (child->cached_fold_ && !child->cached_fold_->is_static_ && (child->cached_fold_->identifiers_.size() == 0))
+			is_lazy = true;
+	
+	switch (token_type)
+	{
+		case EidosTokenType::kTokenPlus:
+		case EidosTokenType::kTokenMinus:
+		case EidosTokenType::kTokenMod:
+		case EidosTokenType::kTokenMult:
+		case EidosTokenType::kTokenExp:
+		case EidosTokenType::kTokenAnd:
+		case EidosTokenType::kTokenOr:
+		case EidosTokenType::kTokenDiv:
+		case EidosTokenType::kTokenConditional:
+		case EidosTokenType::kTokenEq:
+		case EidosTokenType::kTokenLt:
+		case EidosTokenType::kTokenLtEq:
+		case EidosTokenType::kTokenGt:
+		case EidosTokenType::kTokenGtEq:
+		case EidosTokenType::kTokenNot:
+		case EidosTokenType::kTokenNotEq:
+			break;
+		case EidosTokenType::kTokenLParen:
+		{
+			// Calls to these built-in functions are pure; named arguments are assignment nodes, and so are not pure
+			static const std::unordered_set<std::string> pure_functions = {"abs", "acos", "asin", "atan", "atan2", "ceil", "cos", "exp", "floor", "log", "log10", "log2", "round", "sin", "sqrt", "tan", "trunc", "max", "min", "pmax", "pmin", "mean", "product", "sum", "asFloat", "asInteger", "asLogical", "c", "rep", "repEach", "seqLen", "size", "length"};
+			
+			if (children_.size() == 0)
+				return false;
+			
+			const EidosASTNode *function_name_node = children_[0];
+			
+			if ((function_name_node->token_->token_type_ != EidosTokenType::kTokenIdentifier) || !function_name_node->cached_signature_)
+				return false;
+			if (pure_functions.find(function_name_node->token_->token_string_) == pure_functions.end())
+				return false;
+			
+			static const std::unordered_set<std::string> expanding_functions = {"rep", "repEach", "seqLen"};
+			
+			if (expanding_functions.find(function_name_node->token_->token_string_) != expanding_functions.end())
+				is_lazy = true;
+			break;
+		}
+		default:
+			return false;
+	}
+	
+	EidosFold *fold = new EidosFold();
+	
+	fold->fallback_evaluator_ = cached_evaluator_;
+	
+	if (!is_literal)
+		_OptimizeFoldingIdentifiers(fold->identifiers_);
+	
+	if ((fold->identifiers_.size() == 0) && is_lazy)
+	{
+		// With no identifiers, Evaluate_Folded() will cache the value when the expression is first evaluated, as for constants
+	}
+	else if (fold->identifiers_.size() == 0)
+	{
+		// With no identifiers, we can evaluate the expression now, with a scratch interpreter that has only the intrinsic
+		// constants.  If that raises, we don't fold, so that the error occurs at runtime as usual, with the usual position.
+		if (!is_literal)
+		{
+			const EidosFunctionMap *function_map = EidosInterpreter::BuiltInFunctionMap();
+			
+			if (function_map && gEidosConstantsSymbolTable)
+			{
+				bool save_throws = gEidosTerminateThrows;
+				EidosErrorPosition error_pos_save = EidosScript::PushErrorPositionFromToken(token_);
+				
+				gEidosTerminateThrows = true;
+				
+				try {
+					EidosInterpreter interpreter(this, *gEidosConstantsSymbolTable, *const_cast<EidosFunctionMap *>(function_map), nullptr);
+					
+					cached_literal_value_ = interpreter.FastEvaluateNode(this);
+				}
+				catch (...) {
+					gEidosTermination.clear();
+					gEidosTermination.str(gEidosStr_empty_string);
+					cached_literal_value_.reset();
+				}
+				
+				gEidosTerminateThrows = save_throws;
+				EidosScript::RestoreErrorPosition(error_pos_save);
+			}
+			
+			if (!cached_literal_value_ || cached_literal_value_->Invisible())
+			{
+				cached_literal_value_.reset();
+				delete fold;
+				return false;
+			}
+			
+			// use the static T and F for logical results, so that if and ?else recognize them
+			if ((cached_literal_value_->Type() == EidosValueType::kValueLogical) && (cached_literal_value_->Count() == 1) && !cached_literal_value_->IsArray())
+				cached_literal_value_ = (cached_literal_value_->LogicalAtIndex(0, nullptr) ? gStaticEidosValue_LogicalT : gStaticEidosValue_LogicalF);
+		}
+		
+		fold->folded_value_ = cached_literal_value_;
+		fold->is_static_ = true;
+	}
+	else if (p_loop_node)
+	{
+		// if none of our identifiers is assigned to in the loop body, we are invariant across an execution of the loop
+		bool loop_invariant = true;
+		
+		for (EidosGlobalStringID identifier : fold->identifiers_)
+			if (std::find(p_loop_assigned->begin(), p_loop_assigned->end(), identifier) != p_loop_assigned->end())
+				loop_invariant = false;
+		
+		if (loop_invariant)
+			fold->loop_node_ = p_loop_node;
+	}
+	
+	cached_fold_ = fold;
+	cached_evaluator_ = &EidosInterpreter::Evaluate_Folded;
+	
+	return true;
+}
+
+void EidosASTNode::_OptimizeBytecode(void) const
+{
+	// discard any bytecode from a previous optimization pass; _OptimizeEvaluators() has just reset our evaluator
+	if (cached_bytecode_)
+	{
+		delete cached_bytecode_;
+		cached_bytecode_ = nullptr;
+	}
+	
+	if (!gEidosBytecodeEnabled)
+		return;
+	
+	// a static fold is never evaluated, except when logging execution, so there is no point in compiling it
+	if (cached_fold_ && cached_fold_->is_static_)
+		return;
+	
+	// Here we work top-down, unlike the other passes: if we compile, our whole subtree is covered by our bytecode and our
+	// children keep their tree-walking evaluators, which are used if our bytecode gives up; if not, our children try
+	if (cached_evaluator_)
+		cached_bytecode_ = EidosBytecode::CompileNode(this);
+	
+	if (cached_bytecode_)
+	{
+		if (cached_fold_)
+		{
+			// a folded node computes its value with the bytecode when the fold's value is not cached
+			cached_bytecode_->fallback_evaluator_ = cached_fold_->fallback_evaluator_;
+			cached_fold_->fallback_evaluator_ = &EidosInterpreter::Evaluate_Bytecode;
+		}
+		else
+		{
+			cached_bytecode_->fallback_evaluator_ = cached_evaluator_;
+			cached_evaluator_ = &EidosInterpreter::Evaluate_Bytecode;
+		}
+		return;
+	}
+	
+	for (auto child : children_)
+		child->_OptimizeBytecode();
+}
+
 void EidosASTNode::_OptimizeForScan(const std::string &p_for_index_identifier, uint8_t *p_references, uint8_t *p_assigns) const
 {
 	// recurse down the tree; determine our children, then ourselves
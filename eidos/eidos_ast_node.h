@@ -31,6 +31,7 @@
 
 class EidosASTNode;
 class EidosInterpreter;
+class EidosBytecode;
 
 
 // EidosASTNodes must be allocated out of the global pool, for speed.  See eidos_object_pool.h.  When Eidos disposes of a node,
@@ -42,6 +43,29 @@ extern EidosObjectPool *gEidosASTNodePool;
 typedef EidosValue_SP (EidosInterpreter::*EidosEvaluationMethod)(const EidosASTNode *p_node);
 
 
+// The state for a folded node, kept by EidosASTNode::_OptimizeFolding() for a pure expression – one built only from literals,
+// identifiers, operators, and side-effect-free built-in functions – and used by EidosInterpreter::Evaluate_Folded().  A static
+// fold has no identifiers, and its value was computed at parse time.  Otherwise, the value is cached when the node is evaluated,
+// and remains valid while the identifiers it depends upon are all defined constants with the same values they had then, or,
+// if none of those identifiers is assigned to in the body of the enclosing for loop, until that execution of the loop ends.
+// A fold with no identifiers that can build a large value, such as rep(1.0, 1e8), is cached in this way too, rather than being
+// computed at parse time.  Values with more than EIDOS_FOLD_MAX_VALUE_COUNT elements are never cached.
+#define EIDOS_FOLD_MAX_VALUE_COUNT	100000
+
+class EidosFold
+{
+public:
+	EidosEvaluationMethod fallback_evaluator_ = nullptr;		// the node's evaluator, used to compute the value when it is not cached
+	std::vector<EidosGlobalStringID> identifiers_;				// the identifiers the expression depends upon
+	std::vector<EidosValue_SP> identifier_values_;				// for a constant fold, the values of identifiers_ when cached
+	const EidosASTNode *loop_node_ = nullptr;					// the for loop the expression is invariant across, or nullptr
+	int64_t loop_serial_ = 0;									// the execution of loop_node_ in which the value was cached
+	EidosValue_SP folded_value_;								// the cached value, or nullptr
+	bool is_static_ = false;									// if true, folded_value_ was computed at parse time and never changes
+	bool is_constant_ = false;									// if true, folded_value_ depends only on defined constants
+};
+
+
 // A class representing a node in a parse tree for a script
 class EidosASTNode
 {
@@ -58,6 +82,9 @@ public:
 	mutable EidosFunctionSignature_CSP cached_signature_ = nullptr;		// a cached pointer to the function signature corresponding to the token
 	mutable EidosEvaluationMethod cached_evaluator_ = nullptr;			// a pre-cached pointer to method to evaluate this node; shorthand for EvaluateNode()
 	mutable EidosGlobalStringID cached_stringID_ = gEidosID_none;		// a pre-cached identifier for the token string, for fast property/method lookup
+	mutable EidosBytecode *cached_bytecode_ = nullptr;					// OWNED: an optional compiled form of this node's expression; see eidos_bytecode.h
+	mutable EidosFold *cached_fold_ = nullptr;							// OWNED: an optional folded value for this node's expression; see EidosFold
+	mutable int64_t cached_for_serial_ = 0;								// only valid for for-loop nodes; identifies the current execution of the loop
 	
 	uint8_t token_is_owned_ = false;									// if T, we own token_ because it is a virtual token that replaced a real token
 	mutable uint8_t cached_for_references_index_ = true;				// pre-cached as true if the index variable is referenced at all in the loop
@@ -93,6 +120,11 @@ public:
 	void _OptimizeConstants(void) const;								// cache EidosValues for constants and propagate constants upward
 	void _OptimizeIdentifiers(void) const;								// cache function signatures, global strings for methods and properties, etc.
 	void _OptimizeEvaluators(void) const;								// cache pointers to method for evaluation
+	bool _OptimizeFolding(const EidosASTNode *p_loop_node, const std::vector<EidosGlobalStringID> *p_loop_assigned) const;	// fold pure expressions
+	void _OptimizeFoldingScan(std::vector<EidosGlobalStringID> &p_assigned, bool *p_wildcard) const;						// internal method
+	void _OptimizeFoldingIdentifiers(std::vector<EidosGlobalStringID> &p_identifiers) const;								// internal method
+	bool _OptimizeFoldingLiveBranch(int *p_live_child) const;															// internal method
+	void _OptimizeBytecode(void) const;									// compile scalar expressions to bytecode, replacing their cached evaluator
 	void _OptimizeFor(void) const;										// determine whether/how for-loop index variables need to be set up
 	void _OptimizeForScan(const std::string &p_for_index_identifier, uint8_t *p_references, uint8_t *p_assigns) const;	// internal method
 	void _OptimizeAssignments(void) const;								// detect and mark simple increment/decrement assignments on a variable
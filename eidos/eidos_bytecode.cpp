@@ -0,0 +1,576 @@
+//
+//  eidos_bytecode.cpp
+//  Eidos
+//
+//  Created by agent on 10/18/2026.
+//  Copyright (c) 2015-2020 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of Eidos.
+//
+//	Eidos is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	Eidos is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with Eidos.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "eidos_bytecode.h"
+#include "eidos_symbol_table.h"
+#include "eidos_functions.h"
+#include "eidos_script.h"
+
+#include <cmath>
+
+
+bool gEidosBytecodeEnabled = true;
+
+
+// Load a singleton logical, integer, or float value into a register; anything else makes the bytecode give up
+static inline __attribute__((always_inline)) bool Eidos_BytecodeLoadValue(const EidosValue *p_value, EidosBytecodeRegister &p_register)
+{
+	if ((p_value->Count() != 1) || (p_value->DimensionCount() != 1))
+		return false;
+	
+	EidosValueType value_type = p_value->Type();
+	
+	switch (value_type)
+	{
+		case EidosValueType::kValueLogical:	p_register.logical_ = p_value->LogicalAtIndex(0, nullptr);	break;
+		case EidosValueType::kValueInt:		p_register.int_ = p_value->IntAtIndex(0, nullptr);			break;
+		case EidosValueType::kValueFloat:	p_register.float_ = p_value->FloatAtIndex(0, nullptr);		break;
+		default:							return false;
+	}
+	
+	p_register.type_ = value_type;
+	return true;
+}
+
+static inline __attribute__((always_inline)) double Eidos_BytecodeFloat(const EidosBytecodeRegister &p_register)
+{
+	// the caller guarantees that the register is integer or float
+	return (p_register.type_ == EidosValueType::kValueFloat) ? p_register.float_ : (double)p_register.int_;
+}
+
+static inline __attribute__((always_inline)) bool Eidos_BytecodeIsNumeric(const EidosBytecodeRegister &p_register)
+{
+	return (p_register.type_ == EidosValueType::kValueInt) || (p_register.type_ == EidosValueType::kValueFloat);
+}
+
+// This follows Eidos_GetCompareFunctionForTypes() and the CompareEidosValues_X() functions exactly, for singletons
+static inline __attribute__((always_inline)) int Eidos_BytecodeCompare(const EidosBytecodeRegister &p_a, const EidosBytecodeRegister &p_b)
+{
+	if ((p_a.type_ == EidosValueType::kValueFloat) || (p_b.type_ == EidosValueType::kValueFloat))
+	{
+		double float1 = (p_a.type_ == EidosValueType::kValueFloat) ? p_a.float_ : ((p_a.type_ == EidosValueType::kValueInt) ? (double)p_a.int_ : (double)p_a.logical_);
+		double float2 = (p_b.type_ == EidosValueType::kValueFloat) ? p_b.float_ : ((p_b.type_ == EidosValueType::kValueInt) ? (double)p_b.int_ : (double)p_b.logical_);
+		
+		return (float1 < float2) ? -1 : ((float1 > float2) ? 1 : 0);
+	}
+	if ((p_a.type_ == EidosValueType::kValueInt) || (p_b.type_ == EidosValueType::kValueInt))
+	{
+		int64_t int1 = (p_a.type_ == EidosValueType::kValueInt) ? p_a.int_ : (int64_t)p_a.logical_;
+		int64_t int2 = (p_b.type_ == EidosValueType::kValueInt) ? p_b.int_ : (int64_t)p_b.logical_;
+		
+		return (int1 < int2) ? -1 : ((int1 > int2) ? 1 : 0);
+	}
+	
+	eidos_logical_t logical1 = p_a.logical_;
+	eidos_logical_t logical2 = p_b.logical_;
+	
+	return (logical1 < logical2) ? -1 : ((logical1 > logical2) ? 1 : 0);
+}
+
+EidosBytecode *EidosBytecode::CompileNode(const EidosASTNode *p_node)
+{
+	EidosBytecode *bytecode = new EidosBytecode();
+	uint8_t result_register;
+	
+	// A single operation gains little over the tree walker, which avoids allocation for constants and static logical results anyway
+	if (bytecode->_CompileNode(p_node, &result_register) && (bytecode->operation_count_ >= 2))
+	{
+		bytecode->result_register_ = result_register;
+		bytecode->instructions_.shrink_to_fit();
+		return bytecode;
+	}
+	
+	delete bytecode;
+	return nullptr;
+}
+
+bool EidosBytecode::_NewRegister(uint8_t *p_register)
+{
+	if (register_count_ >= EIDOS_BYTECODE_MAX_REGISTERS)
+		return false;
+	
+	*p_register = (uint8_t)register_count_++;
+	return true;
+}
+
+void EidosBytecode::_Emit(EidosBytecodeOp p_op, uint8_t p_dest, uint8_t p_a, uint8_t p_b)
+{
+	EidosBytecodeInstruction instruction;
+	
+	instruction.op_ = p_op;
+	instruction.dest_ = p_dest;
+	instruction.a_ = p_a;
+	instruction.b_ = p_b;
+	instruction.symbol_ = gEidosID_none;
+	instruction.property_ = gEidosID_none;
+	instruction.property_token_ = nullptr;
+	instruction.target_ = 0;
+	
+	instructions_.emplace_back(instruction);
+}
+
+bool EidosBytecode::_CompileNode(const EidosASTNode *p_node, uint8_t *p_result_register)
+{
+	// Instructions are emitted in the order in which the tree walker evaluates nodes, and type checks that the tree walker makes
+	// before evaluating later operands are emitted at the same point, so that the first failure matches the first tree-walker error
+	const std::vector<EidosASTNode *> &children = p_node->children_;
+	size_t child_count = children.size();
+	uint8_t dest, a, b;
+	
+	// constants cached by EidosASTNode::_OptimizeConstants(): numbers and built-in constants like T, F, PI, and INF
+	if (p_node->cached_literal_value_)
+	{
+		EidosBytecodeRegister constant;
+		
+		if (!Eidos_BytecodeLoadValue(p_node->cached_literal_value_.get(), constant) || !_NewRegister(&dest))
+			return false;
+		
+		_Emit(EidosBytecodeOp::kLoadConstant, dest, 0, 0);
+		instructions_.back().constant_ = constant;
+		*p_result_register = dest;
+		return true;
+	}
+	
+	switch (p_node->token_->token_type_)
+	{
+		case EidosTokenType::kTokenIdentifier:
+		{
+			if ((child_count != 0) || (p_node->cached_stringID_ == gEidosID_none) || !_NewRegister(&dest))
+				return false;
+			
+			_Emit(EidosBytecodeOp::kLoadVariable, dest, 0, 0);
+			instructions_.back().symbol_ = p_node->cached_stringID_;
+			*p_result_register = dest;
+			return true;
+		}
+		case EidosTokenType::kTokenDot:
+		{
+			// only <identifier>.<identifier> is compiled; the object is fetched from the symbol table at runtime
+			if (child_count != 2)
+				return false;
+			
+			const EidosASTNode *object_node = children[0];
+			const EidosASTNode *property_node = children[1];
+			
+			if ((object_node->token_->token_type_ != EidosTokenType::kTokenIdentifier) || object_node->cached_literal_value_ || (object_node->children_.size() != 0) || (object_node->cached_stringID_ == gEidosID_none))
+				return false;
+			if ((property_node->token_->token_type_ != EidosTokenType::kTokenIdentifier) || (property_node->cached_stringID_ == gEidosID_none))
+				return false;
+			if (!_NewRegister(&dest))
+				return false;
+			
+			_Emit(EidosBytecodeOp::kLoadProperty, dest, 0, 0);
+			instructions_.back().symbol_ = object_node->cached_stringID_;
+			instructions_.back().property_ = property_node->cached_stringID_;
+			instructions_.back().property_token_ = property_node->token_;
+			*p_result_register = dest;
+			return true;
+		}
+		case EidosTokenType::kTokenPlus:
+		case EidosTokenType::kTokenMinus:
+		{
+			bool is_plus = (p_node->token_->token_type_ == EidosTokenType::kTokenPlus);
+			
+			if (child_count == 1)
+			{
+				if (!_CompileNode(children[0], &a) || !_NewRegister(&dest))
+					return false;
+				
+				_Emit(is_plus ? EidosBytecodeOp::kPlus : EidosBytecodeOp::kNegate, dest, a, 0);
+			}
+			else if (child_count == 2)
+			{
+				if (!_CompileNode(children[0], &a))
+					return false;
+				
+				// Evaluate_Minus() checks the type of its first operand before evaluating its second operand
+				if (!is_plus)
+					_Emit(EidosBytecodeOp::kCheckNumeric, 0, a, 0);
+				
+				if (!_CompileNode(children[1], &b) || !_NewRegister(&dest))
+					return false;
+				
+				_Emit(is_plus ? EidosBytecodeOp::kAdd : EidosBytecodeOp::kSubtract, dest, a, b);
+			}
+			else
+				return false;
+			
+			operation_count_++;
+			*p_result_register = dest;
+			return true;
+		}
+		case EidosTokenType::kTokenMult:
+		case EidosTokenType::kTokenDiv:
+		case EidosTokenType::kTokenMod:
+		case EidosTokenType::kTokenExp:
+		case EidosTokenType::kTokenEq:
+		case EidosTokenType::kTokenNotEq:
+		case EidosTokenType::kTokenLt:
+		case EidosTokenType::kTokenLtEq:
+		case EidosTokenType::kTokenGt:
+		case EidosTokenType::kTokenGtEq:
+		{
+			if ((child_count != 2) || !_CompileNode(children[0], &a) || !_CompileNode(children[1], &b) || !_NewRegister(&dest))
+				return false;
+			
+			EidosBytecodeOp op;
+			
+			switch (p_node->token_->token_type_)
+			{
+				case EidosTokenType::kTokenMult:	op = EidosBytecodeOp::kMultiply;	break;
+				case EidosTokenType::kTokenDiv:		op = EidosBytecodeOp::kDivide;		break;
+				case EidosTokenType::kTokenMod:		op = EidosBytecodeOp::kMod;			break;
+				case EidosTokenType::kTokenExp:		op = EidosBytecodeOp::kPower;		break;
+				case EidosTokenType::kTokenEq:		op = EidosBytecodeOp::kEq;			break;
+				case EidosTokenType::kTokenNotEq:	op = EidosBytecodeOp::kNotEq;		break;
+				case EidosTokenType::kTokenLt:		op = EidosBytecodeOp::kLt;			break;
+				case EidosTokenType::kTokenLtEq:	op = EidosBytecodeOp::kLtEq;		break;
+				case EidosTokenType::kTokenGt:		op = EidosBytecodeOp::kGt;			break;
+				default:							op = EidosBytecodeOp::kGtEq;		break;
+			}
+			
+			_Emit(op, dest, a, b);
+			operation_count_++;
+			*p_result_register = dest;
+			return true;
+		}
+		case EidosTokenType::kTokenAnd:
+		case EidosTokenType::kTokenOr:
+		{
+			// Evaluate_And() and Evaluate_Or() evaluate all of their operands in order, converting each to logical as they go
+			if (child_count < 2)
+				return false;
+			
+			bool is_and = (p_node->token_->token_type_ == EidosTokenType::kTokenAnd);
+			
+			for (size_t child_index = 0; child_index < child_count; ++child_index)
+			{
+				if (!_CompileNode(children[child_index], &a) || !_NewRegister(&b))
+					return false;
+				
+				_Emit(EidosBytecodeOp::kToLogical, b, a, 0);
+				
+				if (child_index == 0)
+				{
+					dest = b;
+				}
+				else
+				{
+					uint8_t accumulated = dest;
+					
+					if (!_NewRegister(&dest))
+						return false;
+					
+					_Emit(is_and ? EidosBytecodeOp::kAnd : EidosBytecodeOp::kOr, dest, accumulated, b);
+				}
+			}
+			
+			operation_count_++;
+			*p_result_register = dest;
+			return true;
+		}
+		case EidosTokenType::kTokenNot:
+		{
+			if ((child_count != 1) || !_CompileNode(children[0], &a) || !_NewRegister(&b) || !_NewRegister(&dest))
+				return false;
+			
+			_Emit(EidosBytecodeOp::kToLogical, b, a, 0);
+			_Emit(EidosBytecodeOp::kNot, dest, b, 0);
+			operation_count_++;
+			*p_result_register = dest;
+			return true;
+		}
+		case EidosTokenType::kTokenConditional:
+		{
+			// only the selected branch is executed; each branch moves its result into a shared destination register
+			if ((child_count != 3) || !_CompileNode(children[0], &a) || !_NewRegister(&b) || !_NewRegister(&dest))
+				return false;
+			
+			_Emit(EidosBytecodeOp::kToLogical, b, a, 0);
+			
+			size_t jump_to_false_index = instructions_.size();
+			_Emit(EidosBytecodeOp::kJumpIfFalse, 0, b, 0);
+			
+			if (!_CompileNode(children[1], &a))
+				return false;
+			
+			_Emit(EidosBytecodeOp::kMove, dest, a, 0);
+			
+			size_t jump_to_end_index = instructions_.size();
+			_Emit(EidosBytecodeOp::kJump, 0, 0, 0);
+			
+			instructions_[jump_to_false_index].target_ = instructions_.size();
+			
+			if (!_CompileNode(children[2], &a))
+				return false;
+			
+			_Emit(EidosBytecodeOp::kMove, dest, a, 0);
+			
+			instructions_[jump_to_end_index].target_ = instructions_.size();
+			
+			operation_count_++;
+			*p_result_register = dest;
+			return true;
+		}
+		case EidosTokenType::kTokenLParen:
+		{
+			// only calls to a few built-in math functions with a single positional argument are compiled
+			if (child_count != 2)
+				return false;
+			
+			const EidosASTNode *call_name_node = children[0];
+			const EidosASTNode *argument_node = children[1];
+			
+			if ((call_name_node->token_->token_type_ != EidosTokenType::kTokenIdentifier) || !call_name_node->cached_signature_)
+				return false;
+			if (argument_node->token_->token_type_ == EidosTokenType::kTokenAssign)
+				return false;
+			
+			EidosInternalFunctionPtr internal_function = call_name_node->cached_signature_->internal_function_;
+			EidosBytecodeOp op;
+			
+			if (internal_function == &Eidos_ExecuteFunction_exp)
+				op = EidosBytecodeOp::kExpFunction;
+			else if (internal_function == &Eidos_ExecuteFunction_log)
+				op = EidosBytecodeOp::kLogFunction;
+			else if (internal_function == &Eidos_ExecuteFunction_sqrt)
+				op = EidosBytecodeOp::kSqrtFunction;
+			else
+				return false;
+			
+			if (!_CompileNode(argument_node, &a) || !_NewRegister(&dest))
+				return false;
+			
+			// these functions take a numeric argument, so a logical argument is a type-check error in the tree walker
+			_Emit(EidosBytecodeOp::kCheckNumeric, 0, a, 0);
+			_Emit(op, dest, a, 0);
+			operation_count_++;
+			*p_result_register = dest;
+			return true;
+		}
+		default:
+			return false;
+	}
+}
+
+bool EidosBytecode::Execute(const EidosSymbolTable &p_symbols, EidosValue_SP &p_result) const
+{
+	EidosBytecodeRegister registers[EIDOS_BYTECODE_MAX_REGISTERS];
+	const EidosBytecodeInstruction *instructions = instructions_.data();
+	size_t instruction_count = instructions_.size();
+	size_t pc = 0;
+	
+	while (pc < instruction_count)
+	{
+		const EidosBytecodeInstruction &instruction = instructions[pc++];
+		EidosBytecodeRegister &dest = registers[instruction.dest_];
+		const EidosBytecodeRegister &a = registers[instruction.a_];
+		const EidosBytecodeRegister &b = registers[instruction.b_];
+		
+		switch (instruction.op_)
+		{
+			case EidosBytecodeOp::kLoadConstant:
+				dest = instruction.constant_;
+				break;
+			case EidosBytecodeOp::kLoadVariable:
+			{
+				EidosValue *value = p_symbols.GetValueRawOrNullForSymbol(instruction.symbol_);
+				
+				if (!value || !Eidos_BytecodeLoadValue(value, dest))
+					return false;
+				break;
+			}
+			case EidosBytecodeOp::kLoadProperty:
+			{
+				EidosValue *object_value = p_symbols.GetValueRawOrNullForSymbol(instruction.symbol_);
+				
+				if (!object_value || (object_value->Type() != EidosValueType::kValueObject) || (object_value->Count() != 1))
+					return false;
+				
+				// This follows Evaluate_MemberRef(), including its error position handling, since the property getter can raise
+				EidosErrorPosition error_pos_save = EidosScript::PushErrorPositionFromToken(instruction.property_token_);
+				
+				EidosValue_SP property_value = static_cast<EidosValue_Object *>(object_value)->GetPropertyOfElements(instruction.property_);
+				
+				EidosScript::RestoreErrorPosition(error_pos_save);
+				
+				if (!Eidos_BytecodeLoadValue(property_value.get(), dest))
+					return false;
+				break;
+			}
+			case EidosBytecodeOp::kCheckNumeric:
+				if (!Eidos_BytecodeIsNumeric(a))
+					return false;
+				break;
+			case EidosBytecodeOp::kMove:
+				dest = a;
+				break;
+			case EidosBytecodeOp::kPlus:
+				if (!Eidos_BytecodeIsNumeric(a))
+					return false;
+				dest = a;
+				break;
+			case EidosBytecodeOp::kNegate:
+				if (a.type_ == EidosValueType::kValueInt)
+				{
+					int64_t negate_result;
+					
+					if (Eidos_sub_overflow((int64_t)0, a.int_, &negate_result))
+						return false;
+					dest.int_ = negate_result;
+					dest.type_ = EidosValueType::kValueInt;
+				}
+				else if (a.type_ == EidosValueType::kValueFloat)
+				{
+					dest.float_ = -a.float_;
+					dest.type_ = EidosValueType::kValueFloat;
+				}
+				else
+					return false;
+				break;
+			case EidosBytecodeOp::kAdd:
+			case EidosBytecodeOp::kSubtract:
+			case EidosBytecodeOp::kMultiply:
+			{
+				if (!Eidos_BytecodeIsNumeric(a) || !Eidos_BytecodeIsNumeric(b))
+					return false;
+				
+				if ((a.type_ == EidosValueType::kValueInt) && (b.type_ == EidosValueType::kValueInt))
+				{
+					int64_t int_result;
+					bool overflow;
+					
+					if (instruction.op_ == EidosBytecodeOp::kAdd)
+						overflow = Eidos_add_overflow(a.int_, b.int_, &int_result);
+					else if (instruction.op_ == EidosBytecodeOp::kSubtract)
+						overflow = Eidos_sub_overflow(a.int_, b.int_, &int_result);
+					else
+						overflow = Eidos_mul_overflow(a.int_, b.int_, &int_result);
+					
+					if (overflow)
+						return false;
+					
+					dest.int_ = int_result;
+					dest.type_ = EidosValueType::kValueInt;
+				}
+				else
+				{
+					double float1 = Eidos_BytecodeFloat(a), float2 = Eidos_BytecodeFloat(b);
+					
+					if (instruction.op_ == EidosBytecodeOp::kAdd)
+						dest.float_ = float1 + float2;
+					else if (instruction.op_ == EidosBytecodeOp::kSubtract)
+						dest.float_ = float1 - float2;
+					else
+						dest.float_ = float1 * float2;
+					
+					dest.type_ = EidosValueType::kValueFloat;
+				}
+				break;
+			}
+			case EidosBytecodeOp::kDivide:
+			case EidosBytecodeOp::kMod:
+			case EidosBytecodeOp::kPower:
+			{
+				// these operators always produce float results, following Evaluate_Div(), Evaluate_Mod(), and Evaluate_Exp()
+				if (!Eidos_BytecodeIsNumeric(a) || !Eidos_BytecodeIsNumeric(b))
+					return false;
+				
+				double float1 = Eidos_BytecodeFloat(a), float2 = Eidos_BytecodeFloat(b);
+				
+				if (instruction.op_ == EidosBytecodeOp::kDivide)
+					dest.float_ = float1 / float2;
+				else if (instruction.op_ == EidosBytecodeOp::kMod)
+					dest.float_ = fmod(float1, float2);
+				else
+					dest.float_ = pow(float1, float2);
+				
+				dest.type_ = EidosValueType::kValueFloat;
+				break;
+			}
+			case EidosBytecodeOp::kEq:		dest.logical_ = (Eidos_BytecodeCompare(a, b) == 0);		dest.type_ = EidosValueType::kValueLogical;		break;
+			case EidosBytecodeOp::kNotEq:	dest.logical_ = (Eidos_BytecodeCompare(a, b) != 0);		dest.type_ = EidosValueType::kValueLogical;		break;
+			case EidosBytecodeOp::kLt:		dest.logical_ = (Eidos_BytecodeCompare(a, b) == -1);	dest.type_ = EidosValueType::kValueLogical;		break;
+			case EidosBytecodeOp::kLtEq:	dest.logical_ = (Eidos_BytecodeCompare(a, b) != 1);		dest.type_ = EidosValueType::kValueLogical;		break;
+			case EidosBytecodeOp::kGt:		dest.logical_ = (Eidos_BytecodeCompare(a, b) == 1);		dest.type_ = EidosValueType::kValueLogical;		break;
+			case EidosBytecodeOp::kGtEq:	dest.logical_ = (Eidos_BytecodeCompare(a, b) != -1);	dest.type_ = EidosValueType::kValueLogical;		break;
+			case EidosBytecodeOp::kToLogical:
+				if (a.type_ == EidosValueType::kValueLogical)
+					dest.logical_ = a.logical_;
+				else if (a.type_ == EidosValueType::kValueInt)
+					dest.logical_ = (a.int_ != 0);
+				else if (std::isnan(a.float_))
+					return false;				// NAN cannot be converted to logical; let the tree walker raise
+				else
+					dest.logical_ = (a.float_ != 0);
+				dest.type_ = EidosValueType::kValueLogical;
+				break;
+			case EidosBytecodeOp::kNot:
+				dest.logical_ = !a.logical_;
+				dest.type_ = EidosValueType::kValueLogical;
+				break;
+			case EidosBytecodeOp::kAnd:
+				dest.logical_ = (a.logical_ && b.logical_);
+				dest.type_ = EidosValueType::kValueLogical;
+				break;
+			case EidosBytecodeOp::kOr:
+				dest.logical_ = (a.logical_ || b.logical_);
+				dest.type_ = EidosValueType::kValueLogical;
+				break;
+			case EidosBytecodeOp::kJumpIfFalse:
+				if (!a.logical_)
+					pc = instruction.target_;
+				break;
+			case EidosBytecodeOp::kJump:
+				pc = instruction.target_;
+				break;
+			case EidosBytecodeOp::kExpFunction:
+				dest.float_ = exp(Eidos_BytecodeFloat(a));
+				dest.type_ = EidosValueType::kValueFloat;
+				break;
+			case EidosBytecodeOp::kLogFunction:
+				dest.float_ = log(Eidos_BytecodeFloat(a));
+				dest.type_ = EidosValueType::kValueFloat;
+				break;
+			case EidosBytecodeOp::kSqrtFunction:
+				dest.float_ = sqrt(Eidos_BytecodeFloat(a));
+				dest.type_ = EidosValueType::kValueFloat;
+				break;
+		}
+	}
+	
+	// box the result; singleton logical results use the static values, as the tree walker's operators do
+	const EidosBytecodeRegister &result = registers[result_register_];
+	
+	switch (result.type_)
+	{
+		case EidosValueType::kValueLogical:
+			p_result = (result.logical_ ? gStaticEidosValue_LogicalT : gStaticEidosValue_LogicalF);
+			break;
+		case EidosValueType::kValueInt:
+			p_result = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(result.int_));
+			break;
+		default:
+			p_result = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(result.float_));
+			break;
+	}
+	
+	return true;
+}
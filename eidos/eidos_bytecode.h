@@ -0,0 +1,151 @@
+//
+//  eidos_bytecode.h
+//  Eidos
+//
+//  Created by agent on 10/18/2026.
+//  Copyright (c) 2015-2020 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of Eidos.
+//
+//	Eidos is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	Eidos is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with Eidos.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+
+ The class EidosBytecode is a compiled form of a scalar expression in the AST, executed by a small register machine
+ as an alternative to evaluating the expression's nodes with EidosInterpreter's tree walk.  Expressions like
+ "1.0 + individual.tagF * 0.5" or "x < 5 ? 0.5 else exp(-d^2)" are very common in callbacks; the tree walk allocates
+ an EidosValue for every intermediate result and dispatches through every node, whereas the bytecode keeps its
+ intermediate results as unboxed scalars in typed registers and boxes only the final result.
+
+ Only a subset of Eidos is compiled: numeric and logical constants, variables, properties of singleton objects held
+ in variables, the arithmetic, comparison, and logical operators, the ternary conditional, and calls to exp(), log(),
+ and sqrt().  None of these have side effects, so the bytecode can give up at any point during execution – when a
+ value turns out not to be a singleton logical, integer, or float, when an integer operation overflows, when a
+ variable is undefined, etc. – and the node is then simply evaluated by the tree walker instead, which produces the
+ correct result, or the correct error.  The bytecode therefore only needs to handle the common case correctly.  A node
+ whose bytecode keeps giving up (because a variable is usually a vector, say) is reverted to the tree walker, so that
+ it does not pay for the failed attempt every time.
+
+ */
+
+#ifndef __Eidos__eidos_bytecode__
+#define __Eidos__eidos_bytecode__
+
+#include <vector>
+
+#include "eidos_value.h"
+#include "eidos_ast_node.h"
+
+class EidosSymbolTable;
+
+
+// Set to false to disable compilation of expressions to bytecode, forcing evaluation of all nodes by the tree walker
+extern bool gEidosBytecodeEnabled;
+
+
+// The maximum number of registers used by a compiled expression; expressions needing more are not compiled
+#define EIDOS_BYTECODE_MAX_REGISTERS	32
+
+// The net number of times a node's bytecode may give up before the node reverts to the tree walker for good; each success
+// cancels out one earlier failure, so this is reached only by bytecode that gives up more often than not
+#define EIDOS_BYTECODE_MAX_FALLBACKS	32
+
+
+enum class EidosBytecodeOp : uint8_t {
+	kLoadConstant = 0,		// dest = constant_
+	kLoadVariable,			// dest = the value of variable symbol_
+	kLoadProperty,			// dest = property property_ of the singleton object in variable symbol_
+	kCheckNumeric,			// give up unless a is integer or float
+	kMove,					// dest = a
+	kPlus,					// dest = a (unary +)
+	kNegate,				// dest = -a
+	kAdd,					// dest = a + b
+	kSubtract,				// dest = a - b
+	kMultiply,				// dest = a * b
+	kDivide,				// dest = a / b
+	kMod,					// dest = a % b
+	kPower,					// dest = a ^ b
+	kEq,					// dest = a == b
+	kNotEq,					// dest = a != b
+	kLt,					// dest = a < b
+	kLtEq,					// dest = a <= b
+	kGt,					// dest = a > b
+	kGtEq,					// dest = a >= b
+	kToLogical,				// dest = asLogical(a)
+	kNot,					// dest = !a, for logical a
+	kAnd,					// dest = a & b, for logical a and b
+	kOr,					// dest = a | b, for logical a and b
+	kJumpIfFalse,			// jump to target_ if logical a is false
+	kJump,					// jump to target_
+	kExpFunction,			// dest = exp(a)
+	kLogFunction,			// dest = log(a)
+	kSqrtFunction,			// dest = sqrt(a)
+};
+
+// A register holds a single unboxed logical, integer, or float value, tagged with its type
+typedef struct {
+	EidosValueType type_;
+	union {
+		eidos_logical_t logical_;
+		int64_t int_;
+		double float_;
+	};
+} EidosBytecodeRegister;
+
+typedef struct {
+	EidosBytecodeOp op_;
+	uint8_t dest_;
+	uint8_t a_;
+	uint8_t b_;
+	EidosGlobalStringID symbol_;					// kLoadVariable, kLoadProperty
+	EidosGlobalStringID property_;					// kLoadProperty
+	const EidosToken *property_token_;				// kLoadProperty; used for error positions
+	union {
+		EidosBytecodeRegister constant_;			// kLoadConstant
+		size_t target_;								// kJumpIfFalse, kJump
+	};
+} EidosBytecodeInstruction;
+
+
+class EidosBytecode
+{
+	//	This class has its copy constructor and assignment operator disabled, to prevent accidental copying.
+
+private:
+	std::vector<EidosBytecodeInstruction> instructions_;
+	int register_count_ = 0;
+	int operation_count_ = 0;		// the number of operator/call nodes compiled, used to decide whether compiling is worthwhile
+	
+	EidosBytecode(void) { }
+	
+	bool _CompileNode(const EidosASTNode *p_node, uint8_t *p_result_register);
+	bool _NewRegister(uint8_t *p_register);
+	void _Emit(EidosBytecodeOp p_op, uint8_t p_dest, uint8_t p_a, uint8_t p_b);
+
+public:
+	
+	EidosEvaluationMethod fallback_evaluator_ = nullptr;	// the node's tree-walking evaluator, used when the bytecode gives up
+	uint8_t result_register_ = 0;
+	int fallback_count_ = 0;								// failures minus successes, floored at zero; see EIDOS_BYTECODE_MAX_FALLBACKS
+	
+	EidosBytecode(const EidosBytecode&) = delete;					// no copying
+	EidosBytecode& operator=(const EidosBytecode&) = delete;		// no copying
+	
+	// Returns a new EidosBytecode for the expression rooted at p_node, or nullptr if it cannot be compiled or is too trivial to be worthwhile
+	static EidosBytecode *CompileNode(const EidosASTNode *p_node);
+	
+	// Executes the bytecode, looking up variables in p_symbols; returns false if execution gave up, in which case p_result is unchanged
+	// Property accesses can raise, with the same errors the tree walker would produce; otherwise this never raises
+	bool Execute(const EidosSymbolTable &p_symbols, EidosValue_SP &p_result) const;
+};
+
+
+#endif /* defined(__Eidos__eidos_bytecode__) */
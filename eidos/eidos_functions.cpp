@@ -24,6 +24,7 @@
 #include "eidos_interpreter.h"
 #include "eidos_rng.h"
 #include "eidos_beep.h"
+#include "eidos_simd.h"
 
 #include <ctime>
 #include <chrono>
@@ -39,6 +40,8 @@
 #include <vector>
 #include <utility>
 #include <numeric>
+#include <unordered_map>
+#include <unordered_set>
 #include <sys/stat.h>
 #include <sys/param.h>
 
@@ -83,6 +86,16 @@ std::string EidosStringFormat(const std::string& format, Args ... args)
 }
 
 
+// match() and unique() use hash tables rather than scanning when their vectors are at least this long; below that, scanning is faster
+#define EIDOS_HASH_SCAN_THRESHOLD	32
+
+// Float values are hashed by a key that conflates -0.0 and 0.0, which are equal according to operator==; NAN is equal to nothing, and is never hashed
+static inline double Eidos_HashKeyForFloat(double p_value)
+{
+	return (p_value == 0.0) ? 0.0 : p_value;
+}
+
+
 //
 //	Construct our built-in function map
 //
@@ -368,7 +381,7 @@ void EidosInterpreter::CacheBuiltInFunctionMap(void)
 		s_built_in_function_map_ = new EidosFunctionMap;
 		
 		for (const EidosFunctionSignature_CSP &sig : built_in_functions)
-			s_built_in_function_map_->insert(EidosFunctionMapPair(sig->call_name_, sig));
+			s_built_in_function_map_->insert(EidosFunctionMapPair(sig->call_id_, sig));
 	}
 }
 
@@ -720,26 +733,45 @@ EidosValue_SP UniqueEidosValue(const EidosValue *p_x_value, bool p_force_new_vec
 		
 		if (p_preserve_order)
 		{
-			for (int value_index = 0; value_index < x_count; ++value_index)
+			if (x_count >= EIDOS_HASH_SCAN_THRESHOLD)
 			{
-				int64_t value = int_data[value_index];
-				int scan_index;
+				// for long vectors we keep a hash table of the values seen so far, rather than scanning back over
+				// all of the previous values for each value, which is O(n^2)
+				std::unordered_set<int64_t> seen_values;
 				
-				for (scan_index = 0; scan_index < value_index; ++scan_index)
+				seen_values.reserve(x_count);
+				
+				for (int value_index = 0; value_index < x_count; ++value_index)
 				{
-					if (value == int_data[scan_index])
-						break;
+					int64_t value = int_data[value_index];
+					
+					if (seen_values.insert(value).second)
+						int_result->push_int(value);
+				}
+			}
+			else
+			{
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					int64_t value = int_data[value_index];
+					int scan_index;
+					
+					for (scan_index = 0; scan_index < value_index; ++scan_index)
+					{
+						if (value == int_data[scan_index])
+							break;
+					}
+					
+					if (scan_index == value_index)
+						int_result->push_int(value);
 				}
-				
-				if (scan_index == value_index)
-					int_result->push_int(value);
 			}
 		}
 		else
 		{
 			std::vector<int64_t> dup_vec(int_data, int_data + x_count);
 			
-			std::sort(dup_vec.begin(), dup_vec.end());
+			EidosSortValues(dup_vec.data(), dup_vec.size());
 			
 			auto unique_iter = std::unique(dup_vec.begin(), dup_vec.end());
 			size_t unique_count = unique_iter - dup_vec.begin();
@@ -760,26 +792,44 @@ EidosValue_SP UniqueEidosValue(const EidosValue *p_x_value, bool p_force_new_vec
 		
 		if (p_preserve_order)
 		{
-			for (int value_index = 0; value_index < x_count; ++value_index)
+			if (x_count >= EIDOS_HASH_SCAN_THRESHOLD)
 			{
-				double value = float_data[value_index];
-				int scan_index;
+				std::unordered_set<double> seen_values;
 				
-				for (scan_index = 0; scan_index < value_index; ++scan_index)
+				seen_values.reserve(x_count);
+				
+				for (int value_index = 0; value_index < x_count; ++value_index)
 				{
-					if (value == float_data[scan_index])
-						break;
+					double value = float_data[value_index];
+					
+					// NAN is not equal to anything, including itself, so every NAN is unique
+					if (std::isnan(value) || seen_values.insert(Eidos_HashKeyForFloat(value)).second)
+						float_result->push_float(value);
+				}
+			}
+			else
+			{
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					double value = float_data[value_index];
+					int scan_index;
+					
+					for (scan_index = 0; scan_index < value_index; ++scan_index)
+					{
+						if (value == float_data[scan_index])
+							break;
+					}
+					
+					if (scan_index == value_index)
+						float_result->push_float(value);
 				}
-				
-				if (scan_index == value_index)
-					float_result->push_float(value);
 			}
 		}
 		else
 		{
 			std::vector<double> dup_vec(float_data, float_data + x_count);
 			
-			std::sort(dup_vec.begin(), dup_vec.end());
+			EidosSortValues(dup_vec.data(), dup_vec.size());
 			
 			auto unique_iter = std::unique(dup_vec.begin(), dup_vec.end());
 			size_t unique_count = unique_iter - dup_vec.begin();
@@ -800,19 +850,36 @@ EidosValue_SP UniqueEidosValue(const EidosValue *p_x_value, bool p_force_new_vec
 		
 		if (p_preserve_order)
 		{
-			for (int value_index = 0; value_index < x_count; ++value_index)
+			if (x_count >= EIDOS_HASH_SCAN_THRESHOLD)
 			{
-				std::string value = string_vec[value_index];
-				int scan_index;
+				std::unordered_set<std::string> seen_values;
 				
-				for (scan_index = 0; scan_index < value_index; ++scan_index)
+				seen_values.reserve(x_count);
+				
+				for (int value_index = 0; value_index < x_count; ++value_index)
 				{
-					if (value == string_vec[scan_index])
-						break;
+					const std::string &value = string_vec[value_index];
+					
+					if (seen_values.insert(value).second)
+						string_result->PushString(value);
+				}
+			}
+			else
+			{
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					std::string value = string_vec[value_index];
+					int scan_index;
+					
+					for (scan_index = 0; scan_index < value_index; ++scan_index)
+					{
+						if (value == string_vec[scan_index])
+							break;
+					}
+					
+					if (scan_index == value_index)
+						string_result->PushString(value);
 				}
-				
-				if (scan_index == value_index)
-					string_result->PushString(value);
 			}
 		}
 		else
@@ -836,19 +903,36 @@ EidosValue_SP UniqueEidosValue(const EidosValue *p_x_value, bool p_force_new_vec
 		
 		if (p_preserve_order)
 		{
-			for (int value_index = 0; value_index < x_count; ++value_index)
+			if (x_count >= EIDOS_HASH_SCAN_THRESHOLD)
 			{
-				EidosObjectElement *value = object_data[value_index];
-				int scan_index;
+				std::unordered_set<EidosObjectElement *> seen_values;
 				
-				for (scan_index = 0; scan_index < value_index; ++scan_index)
+				seen_values.reserve(x_count);
+				
+				for (int value_index = 0; value_index < x_count; ++value_index)
 				{
-					if (value == object_data[scan_index])
-						break;
+					EidosObjectElement *value = object_data[value_index];
+					
+					if (seen_values.insert(value).second)
+						object_result->push_object_element(value);
+				}
+			}
+			else
+			{
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					EidosObjectElement *value = object_data[value_index];
+					int scan_index;
+					
+					for (scan_index = 0; scan_index < value_index; ++scan_index)
+					{
+						if (value == object_data[scan_index])
+							break;
+					}
+					
+					if (scan_index == value_index)
+						object_result->push_object_element(value);
 				}
-				
-				if (scan_index == value_index)
-					object_result->push_object_element(value);
 			}
 		}
 		else
@@ -1268,10 +1352,24 @@ EidosValue_SP Eidos_ExecuteFunction_exp(const EidosValue_SP *const p_arguments,
 	else
 	{
 		EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
+		double *result_data = float_result->data();
 		result_SP = EidosValue_SP(float_result);
 		
-		for (int value_index = 0; value_index < x_count; ++value_index)
-			float_result->set_float_no_check(exp(x_value->FloatAtIndex(value_index, nullptr)), value_index);
+		// We have x_count != 1, so x_value is an EidosValue_Int_vector or EidosValue_Float_vector; we can use the fast API
+		if (x_value->Type() == EidosValueType::kValueInt)
+		{
+			const int64_t *int_data = x_value->IntVector()->data();
+			
+			for (int value_index = 0; value_index < x_count; ++value_index)
+				result_data[value_index] = exp(int_data[value_index]);
+		}
+		else
+		{
+			const double *float_data = x_value->FloatVector()->data();
+			
+			for (int value_index = 0; value_index < x_count; ++value_index)
+				result_data[value_index] = exp(float_data[value_index]);
+		}
 	}
 	
 	result_SP->CopyDimensionsFromValue(x_value);
@@ -1620,10 +1718,24 @@ EidosValue_SP Eidos_ExecuteFunction_log(const EidosValue_SP *const p_arguments,
 	else
 	{
 		EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
+		double *result_data = float_result->data();
 		result_SP = EidosValue_SP(float_result);
 		
-		for (int value_index = 0; value_index < x_count; ++value_index)
-			float_result->set_float_no_check(log(x_value->FloatAtIndex(value_index, nullptr)), value_index);
+		// We have x_count != 1, so x_value is an EidosValue_Int_vector or EidosValue_Float_vector; we can use the fast API
+		if (x_value->Type() == EidosValueType::kValueInt)
+		{
+			const int64_t *int_data = x_value->IntVector()->data();
+			
+			for (int value_index = 0; value_index < x_count; ++value_index)
+				result_data[value_index] = log(int_data[value_index]);
+		}
+		else
+		{
+			const double *float_data = x_value->FloatVector()->data();
+			
+			for (int value_index = 0; value_index < x_count; ++value_index)
+				result_data[value_index] = log(float_data[value_index]);
+		}
 	}
 	
 	result_SP->CopyDimensionsFromValue(x_value);
@@ -3259,10 +3371,24 @@ EidosValue_SP Eidos_ExecuteFunction_sqrt(const EidosValue_SP *const p_arguments,
 	else
 	{
 		EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
+		double *result_data = float_result->data();
 		result_SP = EidosValue_SP(float_result);
 		
-		for (int value_index = 0; value_index < x_count; ++value_index)
-			float_result->set_float_no_check(sqrt(x_value->FloatAtIndex(value_index, nullptr)), value_index);
+		// We have x_count != 1, so x_value is an EidosValue_Int_vector or EidosValue_Float_vector; we can use the fast API
+		if (x_value->Type() == EidosValueType::kValueInt)
+		{
+			// convert to float in the result buffer, then take the square root in place
+			const int64_t *int_data = x_value->IntVector()->data();
+			
+			for (int value_index = 0; value_index < x_count; ++value_index)
+				result_data[value_index] = int_data[value_index];
+			
+			Eidos_SIMD_SqrtFloat(result_data, result_data, x_count);
+		}
+		else
+		{
+			Eidos_SIMD_SqrtFloat(x_value->FloatVector()->data(), result_data, x_count);
+		}
 	}
 	
 	result_SP->CopyDimensionsFromValue(x_value);
@@ -3288,32 +3414,11 @@ EidosValue_SP Eidos_ExecuteFunction_sum(const EidosValue_SP *const p_arguments,
 		else
 		{
 			// We have x_count != 1, so the type of x_value must be EidosValue_Int_vector; we can use the fast API
+			// Eidos_SIMD_SumInt() computes in integer, but switches to float if the sum overflows; see eidos_simd.cpp
 			const int64_t *int_data = x_value->IntVector()->data();
-			int64_t sum = 0;
-			double sum_d = 0;
-			bool fits_in_integer = true;
-			
-			// We do a tricky thing here.  We want to try to compute in integer, but switch to float if we overflow.
-			// If we do overflow, we want to minimize numerical error by accumulating in integer for as long as we
-			// can, and then throwing the integer accumulator over into the float accumulator only when it is about
-			// to overflow.  We perform both computations in parallel, and use integer for the result if we can.
-			for (int value_index = 0; value_index < x_count; ++value_index)
-			{
-				int64_t old_sum = sum;
-				int64_t temp = int_data[value_index];
-				
-				bool overflow = Eidos_add_overflow(old_sum, temp, &sum);
-				
-				// switch to float computation on overflow, and accumulate in the float sum just before overflow
-				if (overflow)
-				{
-					fits_in_integer = false;
-					sum_d += old_sum;
-					sum = temp;		// start integer accumulation again from 0 until it overflows again
-				}
-			}
-			
-			sum_d += sum;			// add in whatever integer accumulation has not overflowed
+			int64_t sum;
+			double sum_d;
+			bool fits_in_integer = Eidos_SIMD_SumInt(int_data, x_count, &sum, &sum_d);
 			
 			if (fits_in_integer)
 				result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(sum));
@@ -3727,30 +3832,11 @@ EidosValue_SP Eidos_ExecuteFunction_mean(const EidosValue_SP *const p_arguments,
 #if EIDOS_HAS_OVERFLOW_BUILTINS
 		if (x_type == EidosValueType::kValueInt)
 		{
-			// Accelerated integer case
+			// Accelerated integer case; Eidos_SIMD_SumInt() accumulates in integer as long as it can, to minimize roundoff
 			const int64_t *int_data = x_value->IntVector()->data();
-			int64_t sum_i = 0;
+			int64_t sum_i;
 			
-			// We do a tricky thing here.  We want to try to compute in integer, but switch to float if we overflow.
-			// If we do overflow, we want to minimize numerical error by accumulating in integer for as long as we
-			// can, and then throwing the integer accumulator over into the float accumulator only when it is about
-			// to overflow.  We perform both computations in parallel, and use integer for the result if we can.
-			for (int value_index = 0; value_index < x_count; ++value_index)
-			{
-				int64_t old_sum = sum_i;
-				int64_t temp = int_data[value_index];
-				
-				bool overflow = Eidos_add_overflow(old_sum, temp, &sum_i);
-				
-				// switch to float computation on overflow, and accumulate in the float sum just before overflow
-				if (overflow)
-				{
-					sum += old_sum;
-					sum_i = temp;		// start integer accumulation again from 0 until it overflows again
-				}
-			}
-			
-			sum += sum_i;			// add in whatever integer accumulation has not overflowed
+			(void)Eidos_SIMD_SumInt(int_data, x_count, &sum_i, &sum);
 		}
 #else
 		if (x_type == EidosValueType::kValueInt)
@@ -4022,8 +4108,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmax(const EidosValue_SP *const p_arguments,
 			EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(int_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				int_result->set_int_no_check(std::max(int0_data[value_index], y_singleton_value), value_index);
+			Eidos_SIMD_MaxInt(int0_data, y_singleton_value, int_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueFloat)
 		{
@@ -4032,8 +4117,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmax(const EidosValue_SP *const p_arguments,
 			EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(float_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				float_result->set_float_no_check(std::max(float0_data[value_index], y_singleton_value), value_index);
+			Eidos_SIMD_MaxFloat(float0_data, y_singleton_value, float_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueString)
 		{
@@ -4066,8 +4150,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmax(const EidosValue_SP *const p_arguments,
 			EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(int_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				int_result->set_int_no_check(std::max(int0_data[value_index], int1_data[value_index]), value_index);
+			Eidos_SIMD_MaxInt(int0_data, int1_data, int_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueFloat)
 		{
@@ -4076,8 +4159,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmax(const EidosValue_SP *const p_arguments,
 			EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(float_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				float_result->set_float_no_check(std::max(float0_data[value_index], float1_data[value_index]), value_index);
+			Eidos_SIMD_MaxFloat(float0_data, float1_data, float_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueString)
 		{
@@ -4170,8 +4252,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmin(const EidosValue_SP *const p_arguments,
 			EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(int_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				int_result->set_int_no_check(std::min(int0_data[value_index], y_singleton_value), value_index);
+			Eidos_SIMD_MinInt(int0_data, y_singleton_value, int_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueFloat)
 		{
@@ -4180,8 +4261,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmin(const EidosValue_SP *const p_arguments,
 			EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(float_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				float_result->set_float_no_check(std::min(float0_data[value_index], y_singleton_value), value_index);
+			Eidos_SIMD_MinFloat(float0_data, y_singleton_value, float_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueString)
 		{
@@ -4214,8 +4294,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmin(const EidosValue_SP *const p_arguments,
 			EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(int_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				int_result->set_int_no_check(std::min(int0_data[value_index], int1_data[value_index]), value_index);
+			Eidos_SIMD_MinInt(int0_data, int1_data, int_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueFloat)
 		{
@@ -4224,8 +4303,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmin(const EidosValue_SP *const p_arguments,
 			EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(float_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				float_result->set_float_no_check(std::min(float0_data[value_index], float1_data[value_index]), value_index);
+			Eidos_SIMD_MinFloat(float0_data, float1_data, float_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueString)
 		{
@@ -7307,37 +7385,69 @@ EidosValue_SP Eidos_ExecuteFunction_match(const EidosValue_SP *const p_arguments
 	else						// ((x_count != 1) && (table_count != 1))
 	{
 		// We can use the fast vector API; we want match() to be very fast since it is a common bottleneck
+		// when x and table are both long, we look values up in a hash table mapping each value in table to its first
+		// index, rather than scanning table for every value in x, which is O(n*m); the hash table is filled from the end of table
+		// backward, so that the first index of each value is the one that remains
 		EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(x_count);
 		result_SP = EidosValue_SP(int_result);
 		
+		bool use_hash = ((x_count >= EIDOS_HASH_SCAN_THRESHOLD) && (table_count >= EIDOS_HASH_SCAN_THRESHOLD));
 		int table_index;
 		
 		if (x_type == EidosValueType::kValueLogical)
 		{
+			// There are only two possible values, so we just find the first index of each in table
 			const eidos_logical_t *logical_data0 = x_value->LogicalVector()->data();
 			const eidos_logical_t *logical_data1 = table_value->LogicalVector()->data();
+			int64_t first_index[2] = {-1, -1};
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
+			for (table_index = 0; table_index < table_count; ++table_index)
 			{
-				for (table_index = 0; table_index < table_count; ++table_index)
-					if (logical_data0[value_index] == logical_data1[table_index])
-						break;
+				int which = (logical_data1[table_index] ? 1 : 0);
 				
-				int_result->set_int_no_check(table_index == table_count ? -1 : table_index, value_index);
+				if (first_index[which] == -1)
+				{
+					first_index[which] = table_index;
+					
+					if (first_index[1 - which] != -1)
+						break;
+				}
 			}
+			
+			for (int value_index = 0; value_index < x_count; ++value_index)
+				int_result->set_int_no_check(first_index[logical_data0[value_index] ? 1 : 0], value_index);
 		}
 		else if (x_type == EidosValueType::kValueInt)
 		{
 			const int64_t *int_data0 = x_value->IntVector()->data();
 			const int64_t *int_data1 = table_value->IntVector()->data();
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
+			if (use_hash)
 			{
-				for (table_index = 0; table_index < table_count; ++table_index)
-					if (int_data0[value_index] == int_data1[table_index])
-						break;
+				std::unordered_map<int64_t, int64_t> table_map;
+				
+				table_map.reserve(table_count);
 				
-				int_result->set_int_no_check(table_index == table_count ? -1 : table_index, value_index);
+				for (table_index = table_count - 1; table_index >= 0; --table_index)
+					table_map[int_data1[table_index]] = table_index;
+				
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					auto found_iter = table_map.find(int_data0[value_index]);
+					
+					int_result->set_int_no_check((found_iter == table_map.end()) ? -1 : found_iter->second, value_index);
+				}
+			}
+			else
+			{
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					for (table_index = 0; table_index < table_count; ++table_index)
+						if (int_data0[value_index] == int_data1[table_index])
+							break;
+					
+					int_result->set_int_no_check(table_index == table_count ? -1 : table_index, value_index);
+				}
 			}
 		}
 		else if (x_type == EidosValueType::kValueFloat)
@@ -7345,13 +7455,46 @@ EidosValue_SP Eidos_ExecuteFunction_match(const EidosValue_SP *const p_arguments
 			const double *float_data0 = x_value->FloatVector()->data();
 			const double *float_data1 = table_value->FloatVector()->data();
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
+			if (use_hash)
 			{
-				for (table_index = 0; table_index < table_count; ++table_index)
-					if (float_data0[value_index] == float_data1[table_index])
-						break;
+				std::unordered_map<double, int64_t> table_map;
+				
+				table_map.reserve(table_count);
+				
+				for (table_index = table_count - 1; table_index >= 0; --table_index)
+				{
+					double value = float_data1[table_index];
+					
+					if (!std::isnan(value))
+						table_map[Eidos_HashKeyForFloat(value)] = table_index;
+				}
 				
-				int_result->set_int_no_check(table_index == table_count ? -1 : table_index, value_index);
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					double value = float_data0[value_index];
+					
+					if (std::isnan(value))
+					{
+						int_result->set_int_no_check(-1, value_index);
+					}
+					else
+					{
+						auto found_iter = table_map.find(Eidos_HashKeyForFloat(value));
+						
+						int_result->set_int_no_check((found_iter == table_map.end()) ? -1 : found_iter->second, value_index);
+					}
+				}
+			}
+			else
+			{
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					for (table_index = 0; table_index < table_count; ++table_index)
+						if (float_data0[value_index] == float_data1[table_index])
+							break;
+					
+					int_result->set_int_no_check(table_index == table_count ? -1 : table_index, value_index);
+				}
 			}
 		}
 		else if (x_type == EidosValueType::kValueString)
@@ -7359,13 +7502,32 @@ EidosValue_SP Eidos_ExecuteFunction_match(const EidosValue_SP *const p_arguments
 			const std::vector<std::string> &string_vec0 = *x_value->StringVector();
 			const std::vector<std::string> &string_vec1 = *table_value->StringVector();
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
+			if (use_hash)
 			{
-				for (table_index = 0; table_index < table_count; ++table_index)
-					if (string_vec0[value_index] == string_vec1[table_index])
-						break;
+				std::unordered_map<std::string, int64_t> table_map;
+				
+				table_map.reserve(table_count);
 				
-				int_result->set_int_no_check(table_index == table_count ? -1 : table_index, value_index);
+				for (table_index = table_count - 1; table_index >= 0; --table_index)
+					table_map[string_vec1[table_index]] = table_index;
+				
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					auto found_iter = table_map.find(string_vec0[value_index]);
+					
+					int_result->set_int_no_check((found_iter == table_map.end()) ? -1 : found_iter->second, value_index);
+				}
+			}
+			else
+			{
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					for (table_index = 0; table_index < table_count; ++table_index)
+						if (string_vec0[value_index] == string_vec1[table_index])
+							break;
+					
+					int_result->set_int_no_check(table_index == table_count ? -1 : table_index, value_index);
+				}
 			}
 		}
 		else if (x_type == EidosValueType::kValueObject)
@@ -7373,13 +7535,32 @@ EidosValue_SP Eidos_ExecuteFunction_match(const EidosValue_SP *const p_arguments
 			EidosObjectElement * const *objelement_vec0 = x_value->ObjectElementVector()->data();
 			EidosObjectElement * const *objelement_vec1 = table_value->ObjectElementVector()->data();
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
+			if (use_hash)
 			{
-				for (table_index = 0; table_index < table_count; ++table_index)
-					if (objelement_vec0[value_index] == objelement_vec1[table_index])
-						break;
+				std::unordered_map<EidosObjectElement *, int64_t> table_map;
 				
-				int_result->set_int_no_check(table_index == table_count ? -1 : table_index, value_index);
+				table_map.reserve(table_count);
+				
+				for (table_index = table_count - 1; table_index >= 0; --table_index)
+					table_map[objelement_vec1[table_index]] = table_index;
+				
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					auto found_iter = table_map.find(objelement_vec0[value_index]);
+					
+					int_result->set_int_no_check((found_iter == table_map.end()) ? -1 : found_iter->second, value_index);
+				}
+			}
+			else
+			{
+				for (int value_index = 0; value_index < x_count; ++value_index)
+				{
+					for (table_index = 0; table_index < table_count; ++table_index)
+						if (objelement_vec0[value_index] == objelement_vec1[table_index])
+							break;
+					
+					int_result->set_int_no_check(table_index == table_count ? -1 : table_index, value_index);
+				}
 			}
 		}
 	}
@@ -10111,7 +10292,7 @@ EidosValue_SP Eidos_ExecuteFunction_doCall(const EidosValue_SP *const p_argument
 	
 	// Look up the signature for this function dynamically
 	EidosFunctionMap &function_map = p_interpreter.FunctionMap();
-	auto signature_iter = function_map.find(function_name);
+	auto signature_iter = function_map.find(Eidos_GlobalStringIDForString(function_name));
 	
 	if (signature_iter == function_map.end())
 		EIDOS_TERMINATION << "ERROR (Eidos_ExecuteFunction_doCall): unrecognized function name " << function_name << " in function doCall()." << EidosTerminate(nullptr);
@@ -10137,7 +10318,10 @@ EidosValue_SP Eidos_ExecuteFunction_doCall(const EidosValue_SP *const p_argument
 	}
 	else if (function_signature->body_script_)
 	{
-		result_SP = p_interpreter.DispatchUserDefinedFunction(*function_signature, arguments, argument_count);
+		// DispatchUserDefinedFunction() moves from its arguments, which belong to our caller; we give it a buffer of our own
+		std::vector<EidosValue_SP> dispatch_arguments(arguments, arguments + argument_count);
+		
+		result_SP = p_interpreter.DispatchUserDefinedFunction(*function_signature, dispatch_arguments.data(), argument_count);
 	}
 	else
 		EIDOS_TERMINATION << "ERROR (Eidos_ExecuteFunction_doCall): (internal error) unbound function " << function_name << "." << EidosTerminate(nullptr);
@@ -10407,13 +10591,17 @@ EidosValue_SP Eidos_ExecuteFunction_functionSignature(const EidosValue_SP *const
 	std::string match_string = (function_name_specified ? functionName_value->StringAtIndex(0, nullptr) : gEidosStr_empty_string);
 	bool signature_found = false;
 	
-	// function_map_ is already alphabetized since maps keep sorted order
+	// function_map_ is a hash table, so we alphabetize the signatures before output
 	EidosFunctionMap &function_map = p_interpreter.FunctionMap();
+	std::vector<const EidosFunctionSignature *> signatures;
 	
 	for (auto functionPairIter = function_map.begin(); functionPairIter != function_map.end(); ++functionPairIter)
+		signatures.emplace_back(functionPairIter->second.get());
+	
+	std::sort(signatures.begin(), signatures.end(), [](const EidosFunctionSignature *l, const EidosFunctionSignature *r) { return l->call_name_ < r->call_name_; });
+	
+	for (const EidosFunctionSignature *iter_signature : signatures)
 	{
-		const EidosFunctionSignature *iter_signature = functionPairIter->second.get();
-		
 		if (function_name_specified && (iter_signature->call_name_.compare(match_string) != 0))
 			continue;
 		
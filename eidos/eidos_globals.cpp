@@ -25,6 +25,7 @@
 #include "eidos_object_pool.h"
 #include "eidos_ast_node.h"
 #include "eidos_test_element.h"
+#include "eidos_simd.h"
 
 #include <stdlib.h>
 #include <execinfo.h>
@@ -44,6 +45,7 @@
 #include <limits>
 #include <cmath>
 #include <utility>
+#include <functional>
 #include <sys/param.h>
 
 // added for Eidos_mkstemps() and Eidos_SlashTmpExists()
@@ -269,6 +271,9 @@ void Eidos_WarmUp(void)
 		// Set up the built-in function map, which is immutable
 		EidosInterpreter::CacheBuiltInFunctionMap();
 		
+		// Choose the SIMD kernels used by vectorized math functions, based on the CPU's capabilities
+		Eidos_SIMD_Initialize();
+		
 		// Set up the symbol table for Eidos constants
 		// BCH 1/18/2018: I looked into telling this table to use the external unordered_map from the start, but testing indicates
 		// that that is actually a bit slower.  If the number of intrinsic constants grows above 10 or so, this should be revisited.
@@ -1934,6 +1939,216 @@ std::string EidosStringForFloat(double p_value)
 	}
 }
 
+// Buffers shorter than this are sorted with std::sort() / std::stable_sort(), which beat the radix sort's fixed overhead
+#define EIDOS_RADIX_SORT_THRESHOLD	512
+
+// Radix sort keys are unsigned integers that order the same way as the values they are made from
+static inline uint64_t Eidos_RadixKeyForInt(int64_t p_value)
+{
+	return (uint64_t)p_value ^ 0x8000000000000000ULL;
+}
+
+static inline int64_t Eidos_IntForRadixKey(uint64_t p_key)
+{
+	return (int64_t)(p_key ^ 0x8000000000000000ULL);
+}
+
+static inline uint64_t Eidos_RadixKeyForFloat(double p_value)
+{
+	// -0.0 and 0.0 are equal according to operator<, so they get the same key; p_value must not be NAN
+	if (p_value == 0.0)
+		p_value = 0.0;
+	
+	uint64_t bits;
+	
+	memcpy(&bits, &p_value, sizeof(double));
+	
+	return (bits & 0x8000000000000000ULL) ? ~bits : (bits | 0x8000000000000000ULL);
+}
+
+static inline double Eidos_FloatForRadixKey(uint64_t p_key)
+{
+	uint64_t bits = (p_key & 0x8000000000000000ULL) ? (p_key & ~0x8000000000000000ULL) : ~p_key;
+	double value;
+	
+	memcpy(&value, &bits, sizeof(double));
+	
+	return value;
+}
+
+// A stable LSD radix sort of p_keys, eight bits per pass, carrying p_payloads (if non-null) along with the keys; passes in which
+// every key has the same byte are skipped, so small integers, for example, take only one or two passes
+template <typename P>
+static void Eidos_RadixSortKeys(uint64_t *p_keys, P *p_payloads, size_t p_count)
+{
+	std::vector<size_t> counts(8 * 256, 0);
+	
+	for (size_t index = 0; index < p_count; ++index)
+	{
+		uint64_t key = p_keys[index];
+		
+		for (int byte = 0; byte < 8; ++byte)
+			counts[byte * 256 + ((key >> (byte * 8)) & 0xFF)]++;
+	}
+	
+	std::vector<uint64_t> key_buffer(p_count);
+	std::vector<P> payload_buffer(p_payloads ? p_count : 0);
+	uint64_t *keys_from = p_keys, *keys_to = key_buffer.data();
+	P *payloads_from = p_payloads, *payloads_to = payload_buffer.data();
+	
+	for (int byte = 0; byte < 8; ++byte)
+	{
+		size_t *byte_counts = counts.data() + byte * 256;
+		int shift = byte * 8;
+		
+		if (byte_counts[(keys_from[0] >> shift) & 0xFF] == p_count)
+			continue;
+		
+		size_t offsets[256];
+		size_t offset = 0;
+		
+		for (int bucket = 0; bucket < 256; ++bucket)
+		{
+			offsets[bucket] = offset;
+			offset += byte_counts[bucket];
+		}
+		
+		if (p_payloads)
+		{
+			for (size_t index = 0; index < p_count; ++index)
+			{
+				uint64_t key = keys_from[index];
+				size_t destination = offsets[(key >> shift) & 0xFF]++;
+				
+				keys_to[destination] = key;
+				payloads_to[destination] = payloads_from[index];
+			}
+			
+			std::swap(payloads_from, payloads_to);
+		}
+		else
+		{
+			for (size_t index = 0; index < p_count; ++index)
+			{
+				uint64_t key = keys_from[index];
+				
+				keys_to[offsets[(key >> shift) & 0xFF]++] = key;
+			}
+		}
+		
+		std::swap(keys_from, keys_to);
+	}
+	
+	// after an odd number of passes the sorted data is in our buffers, and needs to be copied back
+	if (keys_from != p_keys)
+	{
+		std::copy(keys_from, keys_from + p_count, p_keys);
+		
+		if (p_payloads)
+			std::copy(payloads_from, payloads_from + p_count, p_payloads);
+	}
+}
+
+std::vector<int64_t> EidosSortIndexes(const int64_t *p_v, size_t p_size, bool p_ascending)
+{
+	if (p_size < EIDOS_RADIX_SORT_THRESHOLD)
+		return EidosSortIndexes<int64_t>(p_v, p_size, p_ascending);
+	
+	// inverting the keys for a descending sort keeps the sort stable, as it should be
+	std::vector<uint64_t> keys(p_size);
+	std::vector<int64_t> idx(p_size);
+	
+	for (size_t index = 0; index < p_size; ++index)
+		keys[index] = (p_ascending ? Eidos_RadixKeyForInt(p_v[index]) : ~Eidos_RadixKeyForInt(p_v[index]));
+	
+	std::iota(idx.begin(), idx.end(), 0);
+	Eidos_RadixSortKeys(keys.data(), idx.data(), p_size);
+	
+	return idx;
+}
+
+std::vector<int64_t> EidosSortIndexes(const double *p_v, size_t p_size, bool p_ascending)
+{
+	if (p_size < EIDOS_RADIX_SORT_THRESHOLD)
+		return EidosSortIndexes<double>(p_v, p_size, p_ascending);
+	
+	std::vector<uint64_t> keys(p_size);
+	std::vector<int64_t> idx(p_size);
+	
+	for (size_t index = 0; index < p_size; ++index)
+	{
+		double value = p_v[index];
+		
+		if (std::isnan(value))
+			return EidosSortIndexes<double>(p_v, p_size, p_ascending);
+		
+		keys[index] = (p_ascending ? Eidos_RadixKeyForFloat(value) : ~Eidos_RadixKeyForFloat(value));
+	}
+	
+	std::iota(idx.begin(), idx.end(), 0);
+	Eidos_RadixSortKeys(keys.data(), idx.data(), p_size);
+	
+	return idx;
+}
+
+void EidosSortValues(int64_t *p_v, size_t p_size, bool p_ascending)
+{
+	if (p_size < EIDOS_RADIX_SORT_THRESHOLD)
+	{
+		if (p_ascending)
+			std::sort(p_v, p_v + p_size);
+		else
+			std::sort(p_v, p_v + p_size, std::greater<int64_t>());
+		return;
+	}
+	
+	// the keys are a bijection of the values, so we can sort the keys alone and convert them back to values
+	std::vector<uint64_t> keys(p_size);
+	
+	for (size_t index = 0; index < p_size; ++index)
+		keys[index] = (p_ascending ? Eidos_RadixKeyForInt(p_v[index]) : ~Eidos_RadixKeyForInt(p_v[index]));
+	
+	Eidos_RadixSortKeys(keys.data(), (int64_t *)nullptr, p_size);
+	
+	for (size_t index = 0; index < p_size; ++index)
+		p_v[index] = (p_ascending ? Eidos_IntForRadixKey(keys[index]) : Eidos_IntForRadixKey(~keys[index]));
+}
+
+void EidosSortValues(double *p_v, size_t p_size, bool p_ascending)
+{
+	if (p_size >= EIDOS_RADIX_SORT_THRESHOLD)
+	{
+		// Without NAN and -0.0 the keys are a bijection of the values, as for integers; -0.0 also falls back to std::sort(), since
+		// the order in which it places -0.0 and 0.0, which are equal but distinguishable, is what sort() has always produced
+		std::vector<uint64_t> keys(p_size);
+		size_t index;
+		
+		for (index = 0; index < p_size; ++index)
+		{
+			double value = p_v[index];
+			
+			if (std::isnan(value) || ((value == 0.0) && std::signbit(value)))
+				break;
+			
+			keys[index] = (p_ascending ? Eidos_RadixKeyForFloat(value) : ~Eidos_RadixKeyForFloat(value));
+		}
+		
+		if (index == p_size)
+		{
+			Eidos_RadixSortKeys(keys.data(), (double *)nullptr, p_size);
+			
+			for (index = 0; index < p_size; ++index)
+				p_v[index] = (p_ascending ? Eidos_FloatForRadixKey(keys[index]) : Eidos_FloatForRadixKey(~keys[index]));
+			return;
+		}
+	}
+	
+	if (p_ascending)
+		std::sort(p_v, p_v + p_size);
+	else
+		std::sort(p_v, p_v + p_size, std::greater<double>());
+}
+
 
 #pragma mark -
 #pragma mark Global strings & IDs
@@ -365,6 +365,7 @@ bool Eidos_string_containsCaseInsensitive(const std::string &strHaystack, const
 //std::string Eidos_Exec(const char *p_cmd);
 
 // Get indexes that would result in sorted ordering of a vector.  This rather nice code is adapted from http://stackoverflow.com/a/12399290/2752221
+// the sort is now stable, so that indexes of equal values are kept in their original order; this makes order() well-defined
 template <typename T>
 std::vector<int64_t> EidosSortIndexes(const std::vector<T> &p_v, bool p_ascending = true)
 {
@@ -374,9 +375,9 @@ std::vector<int64_t> EidosSortIndexes(const std::vector<T> &p_v, bool p_ascendin
 	
 	// sort indexes based on comparing values in v
 	if (p_ascending)
-		std::sort(idx.begin(), idx.end(), [&p_v](int64_t i1, int64_t i2) {return p_v[i1] < p_v[i2];});
+		std::stable_sort(idx.begin(), idx.end(), [&p_v](int64_t i1, int64_t i2) {return p_v[i1] < p_v[i2];});
 	else
-		std::sort(idx.begin(), idx.end(), [&p_v](int64_t i1, int64_t i2) {return p_v[i1] > p_v[i2];});
+		std::stable_sort(idx.begin(), idx.end(), [&p_v](int64_t i1, int64_t i2) {return p_v[i1] > p_v[i2];});
 	
 	return idx;
 }
@@ -390,13 +391,23 @@ std::vector<int64_t> EidosSortIndexes(const T *p_v, size_t p_size, bool p_ascend
 	
 	// sort indexes based on comparing values in v
 	if (p_ascending)
-		std::sort(idx.begin(), idx.end(), [p_v](int64_t i1, int64_t i2) {return p_v[i1] < p_v[i2];});
+		std::stable_sort(idx.begin(), idx.end(), [p_v](int64_t i1, int64_t i2) {return p_v[i1] < p_v[i2];});
 	else
-		std::sort(idx.begin(), idx.end(), [p_v](int64_t i1, int64_t i2) {return p_v[i1] > p_v[i2];});
+		std::stable_sort(idx.begin(), idx.end(), [p_v](int64_t i1, int64_t i2) {return p_v[i1] > p_v[i2];});
 	
 	return idx;
 }
 
+// These overloads, for the common integer and float cases, give the same result as the templates above, using a radix sort for large vectors;
+// a float vector containing NAN, which is unordered, falls back to the template since a radix sort would impose an order on NAN
+std::vector<int64_t> EidosSortIndexes(const int64_t *p_v, size_t p_size, bool p_ascending = true);
+std::vector<int64_t> EidosSortIndexes(const double *p_v, size_t p_size, bool p_ascending = true);
+
+// Sort a buffer of values in place, with the same result as std::sort() with operator< (or operator> for descending), using a radix sort
+// for large buffers; a float buffer containing NAN or -0.0 falls back to std::sort(), so the result is always exactly what std::sort() gives
+void EidosSortValues(int64_t *p_v, size_t p_size, bool p_ascending = true);
+void EidosSortValues(double *p_v, size_t p_size, bool p_ascending = true);
+
 std::string EidosStringForFloat(double p_value);
 
 
@@ -23,6 +23,7 @@
 #include "eidos_ast_node.h"
 #include "eidos_rng.h"
 #include "eidos_call_signature.h"
+#include "eidos_bytecode.h"
 
 #include <sstream>
 #include <stdexcept>
@@ -61,6 +62,53 @@
 #endif
 
 
+// Singleton arithmetic results are usually temporaries, consumed by the next operator up the tree and then freed.
+// When an operand is such a temporary – a singleton of the result type, not a matrix/array, not invisible, and held only by the
+// caller – the arithmetic operators overwrite it with their result instead of allocating a new value, so a chain of operations
+// like "1.0 + individual.tagF * 0.1 - x" recycles one EidosValue for its intermediate results.  Values held by symbol tables,
+// AST constant caches, and static globals always have a use count above 1, so they are never modified by this.  Scalar chains
+// that EidosBytecode can compile avoid boxing altogether; this covers the rest, such as operands from subsets or calls.
+static inline __attribute__((always_inline)) bool Eidos_ReusableSingleton(const EidosValue *p_value, EidosValueType p_type)
+{
+	return p_value && (p_value->UseCount() == 1) && p_value->IsSingleton() && (p_value->Type() == p_type) && !p_value->IsArray() && !p_value->Invisible();
+}
+
+// The serial number of the most recent execution of any for loop; see Evaluate_For() and Evaluate_Folded()
+static int64_t gEidos_ForLoopSerial = 0;
+
+static inline __attribute__((always_inline)) EidosValue_SP Eidos_FloatSingletonResult(const EidosValue_SP &p_operand1, const EidosValue_SP &p_operand2, double p_result)
+{
+	if (Eidos_ReusableSingleton(p_operand1.get(), EidosValueType::kValueFloat))
+	{
+		static_cast<EidosValue_Float_singleton *>(p_operand1.get())->SetValue(p_result);
+		return p_operand1;
+	}
+	if (Eidos_ReusableSingleton(p_operand2.get(), EidosValueType::kValueFloat))
+	{
+		static_cast<EidosValue_Float_singleton *>(p_operand2.get())->SetValue(p_result);
+		return p_operand2;
+	}
+	
+	return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(p_result));
+}
+
+static inline __attribute__((always_inline)) EidosValue_SP Eidos_IntSingletonResult(const EidosValue_SP &p_operand1, const EidosValue_SP &p_operand2, int64_t p_result)
+{
+	if (Eidos_ReusableSingleton(p_operand1.get(), EidosValueType::kValueInt))
+	{
+		static_cast<EidosValue_Int_singleton *>(p_operand1.get())->SetValue(p_result);
+		return p_operand1;
+	}
+	if (Eidos_ReusableSingleton(p_operand2.get(), EidosValueType::kValueInt))
+	{
+		static_cast<EidosValue_Int_singleton *>(p_operand2.get())->SetValue(p_result);
+		return p_operand2;
+	}
+	
+	return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(p_result));
+}
+
+
 bool TypeCheckAssignmentOfEidosValueIntoEidosValue(const EidosValue &p_base_value, const EidosValue &p_dest_value)
 {
 	EidosValueType base_type = p_base_value.Type();
@@ -646,7 +694,8 @@ void EidosInterpreter::_ProcessSubsetAssignment(EidosValue_SP *p_base_value_ptr,
 		{
 			EIDOS_ASSERT_CHILD_COUNT_X(p_parent_node, "identifier", "EidosInterpreter::_ProcessSubsetAssignment", 0, parent_token);
 			
-			EidosValue_SP identifier_value_SP = global_symbols_->GetValueOrRaiseForASTNode(p_parent_node);
+			bool is_const;
+			EidosValue_SP identifier_value_SP = global_symbols_->GetValueOrRaiseForASTNode_IsConst(p_parent_node, &is_const);
 			EidosValue *identifier_value = identifier_value_SP.get();
 			
 			// OK, a little bit of trickiness here.  We've got the base value from the symbol table.  The problem is that it
@@ -655,7 +704,18 @@ void EidosInterpreter::_ProcessSubsetAssignment(EidosValue_SP *p_base_value_ptr,
 			// the only place, in fact, I think – where that can bite us, because we do in fact need to modify the original
 			// EidosValue.  The fix is to detect that we have a singleton value, and actually replace it in the symbol table
 			// with a vector-based copy that we can manipulate.  A little gross, but this is the price we pay for speed...
-			if (identifier_value->IsSingleton())
+			//
+			// Vectors are shared copy-on-write: assigning a vector to a variable, passing it to a user-defined function, or
+			// storing it with setValue() shares it rather than copying it (only singletons are copied, by SetValueForSymbol()
+			// and its relatives), and a slice such as x[a:b] shares its source's buffer, holding a reference to its source.
+			// So here, and in Evaluate_Assign() for compound assignment, a vector that somebody else also references must be
+			// copied before it is modified in place; the symbol table and identifier_value_SP account for two references.
+			// Modifying a constant vector would modify everything sharing its value, so it raises, as it already did for
+			// singleton constants; NULL is exempt since assigning into it, legally, does nothing.
+			if (is_const && (identifier_value->Type() != EidosValueType::kValueNULL))
+				EIDOS_TERMINATION << "ERROR (EidosInterpreter::_ProcessSubsetAssignment): identifier '" << p_parent_node->token_->token_string_ << "' cannot be redefined because it is a constant." << EidosTerminate(nullptr);
+			
+			if (identifier_value->IsSingleton() || ((identifier_value->UseCount() > 2) && !is_const))
 			{
 				identifier_value_SP = identifier_value->VectorBasedCopy();
 				identifier_value = identifier_value_SP.get();
@@ -1245,7 +1305,7 @@ int EidosInterpreter::_ProcessArgumentList(const EidosASTNode *p_node, const Eid
 	return processed_arg_count;
 }
 
-EidosValue_SP EidosInterpreter::DispatchUserDefinedFunction(const EidosFunctionSignature &p_function_signature, const EidosValue_SP *const p_arguments, int p_argument_count)
+EidosValue_SP EidosInterpreter::DispatchUserDefinedFunction(const EidosFunctionSignature &p_function_signature, EidosValue_SP *const p_arguments, int p_argument_count)
 {
 	EidosValue_SP result_SP(nullptr);
 	
@@ -1257,6 +1317,10 @@ EidosValue_SP EidosInterpreter::DispatchUserDefinedFunction(const EidosFunctionS
 	if ((int)p_function_signature.arg_name_IDs_.size() != p_argument_count)
 		EIDOS_TERMINATION << "ERROR (EidosInterpreter::DispatchUserDefinedFunction): (internal error) parameter count does not match argument count." << EidosTerminate(nullptr);
 	
+	// The arguments are moved out of the caller's argument buffer, not copied, so that the symbol table holds the only
+	// reference to an argument value that was a temporary (like the result of x+1), and can adopt it without copying it.
+	// Argument values that are also referenced elsewhere (such as by a variable in the caller, or a cached constant)
+	// still get copied by SetValueForSymbol(), since the function body could modify them in place.
 	for (int arg_index = 0; arg_index < p_argument_count; ++arg_index)
 		new_symbols.SetValueForSymbol(p_function_signature.arg_name_IDs_[arg_index], std::move(p_arguments[arg_index]));
 	
@@ -1351,8 +1415,8 @@ EidosValue_SP EidosInterpreter::Evaluate_Call(const EidosASTNode *p_node)
 		// If the function call is a built-in Eidos function, we might already have a pointer to its signature cached; if not, we'll have to look it up
 		if (!function_signature)
 		{
-			// Get the function signature and check our arguments against it
-			auto signature_iter = function_map_.find(*function_name);
+			// Get the function signature and check our arguments against it; the map is keyed by the ID cached in the identifier node
+			auto signature_iter = function_map_.find(call_name_node->cached_stringID_);
 			
 			if (signature_iter == function_map_.end())
 				EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Call): unrecognized function name " << *function_name << "." << EidosTerminate(call_identifier_token);
@@ -1574,6 +1638,30 @@ EidosValue_SP EidosInterpreter::Evaluate_Call(const EidosASTNode *p_node)
 	return result_SP;
 }
 
+// Slices shorter than this are copied instead, since copying them is about as fast as making a slice
+#define EIDOS_SLICE_MIN_COUNT	64
+
+// Returns true if p_indices are a run of consecutive ascending indices within [0, p_source_count) that is long enough to be worth taking
+// as a slice: at least EIDOS_SLICE_MIN_COUNT values, and at least a quarter of the source, so that a small slice does not keep a large
+// source buffer alive.  If so, the first index is placed in *p_start.  Returns false for out-of-range indices, leaving the error to the caller.
+static bool Eidos_SliceForIndices(const int64_t *p_indices, int p_index_count, int p_source_count, int64_t *p_start)
+{
+	if ((p_index_count < EIDOS_SLICE_MIN_COUNT) || (p_index_count < p_source_count / 4))
+		return false;
+	
+	int64_t start = p_indices[0];
+	
+	if ((start < 0) || (start + p_index_count > p_source_count))
+		return false;
+	
+	for (int index = 1; index < p_index_count; ++index)
+		if (p_indices[index] != start + index)
+			return false;
+	
+	*p_start = start;
+	return true;
+}
+
 EidosValue_SP EidosInterpreter::Evaluate_Subset(const EidosASTNode *p_node)
 {
 	// Note that the logic here is very parallel to that of EidosInterpreter::_ProcessSubsetAssignment()
@@ -1781,7 +1869,19 @@ EidosValue_SP EidosInterpreter::Evaluate_Subset(const EidosASTNode *p_node)
 			else
 			{
 				// Subsetting with a int/float vector can use a vector of any length; the specific indices referenced will be taken
-				if (first_child_type == EidosValueType::kValueFloat)
+				// A long run of consecutive integer indices into an integer or float vector, as from x[a:b], produces
+				// a slice that shares the buffer of first_child_value instead of a copy; see EidosValue_Int_vector::slice_source_
+				int64_t slice_start;
+				
+				if (((first_child_type == EidosValueType::kValueInt) || (first_child_type == EidosValueType::kValueFloat)) && (second_child_type == EidosValueType::kValueInt) &&
+					Eidos_SliceForIndices(second_child_value->IntVector()->data(), second_child_count, first_child_count, &slice_start))
+				{
+					if (first_child_type == EidosValueType::kValueInt)
+						result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector(first_child_value, (size_t)slice_start, (size_t)second_child_count));
+					else
+						result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector(first_child_value, (size_t)slice_start, (size_t)second_child_count));
+				}
+				else if (first_child_type == EidosValueType::kValueFloat)
 				{
 					// result type is float; optimize for that
 					const double *first_child_data = first_child_value->FloatVector()->data();
@@ -2135,6 +2235,11 @@ EidosValue_SP EidosInterpreter::Evaluate_MemberRef(const EidosASTNode *p_node)
 		// Forget the function token, since it is not responsible for any future errors
 		EidosScript::RestoreErrorPosition(error_pos_save);
 	}
+	else if ((first_child_node->token_->token_type_ == EidosTokenType::kTokenDot) && (first_child_node->cached_evaluator_ == &EidosInterpreter::Evaluate_MemberRef))
+	{
+		// <expression>.<identifier>.<identifier> is a property chain, which is evaluated in a single traversal
+		result_SP = _Evaluate_PropertyChain(p_node);
+	}
 	else
 	{
 		// the general <expression>.<identifier> case has to use EidosValue_SP
@@ -2163,6 +2268,178 @@ EidosValue_SP EidosInterpreter::Evaluate_MemberRef(const EidosASTNode *p_node)
 	return result_SP;
 }
 
+// A property chain like p1.individuals.genomes.mutations is evaluated by _Evaluate_PropertyChain() in a single traversal.
+// Steps of the chain whose property declares an accelerated element getter (see Eidos_AcceleratedElementGetter) are evaluated
+// into a scratch buffer of elements, presized using the fan-out of the property, without making an EidosValue for the
+// intermediate result; the following step is then evaluated from that buffer, and if it is the final step, its accelerated
+// getter writes straight into the result.  All other steps are evaluated just as Evaluate_MemberRef() would evaluate them, and
+// the result, including its dimensions and any error raised, is the same as evaluating the chain one step at a time.  Chains
+// longer than EIDOS_PROPERTY_CHAIN_MAX steps are split, with their innermost part evaluated as the base of the chain.  This is
+// done only on the fast path of Evaluate_MemberRef(); when logging execution, each step is evaluated as its own node, so that
+// the log shows every node of the chain.
+#define EIDOS_PROPERTY_CHAIN_MAX	16
+
+// The scratch buffers for _Evaluate_PropertyChain(), reused to avoid allocation; they are never used reentrantly, since they are
+// live only across calls to accelerated element getters and accelerated getters, which do not execute script.  A buffer that has
+// grown beyond EIDOS_PROPERTY_CHAIN_BUFFER_KEEP elements is freed after use, so that one huge chain does not pin its memory.
+#define EIDOS_PROPERTY_CHAIN_BUFFER_KEEP	1048576
+
+static std::vector<EidosObjectElement *> gEidos_PropertyChainBuffers[2];
+
+static inline void Eidos_TrimPropertyChainBuffers(void)
+{
+	for (std::vector<EidosObjectElement *> &buffer : gEidos_PropertyChainBuffers)
+		if (buffer.capacity() > EIDOS_PROPERTY_CHAIN_BUFFER_KEEP)
+			std::vector<EidosObjectElement *>().swap(buffer);
+}
+
+EidosValue_SP EidosInterpreter::_Evaluate_PropertyChain(const EidosASTNode *p_node)
+{
+	// Collect the '.' nodes of the chain, outermost first
+	const EidosASTNode *chain_nodes[EIDOS_PROPERTY_CHAIN_MAX];
+	int chain_length = 0;
+	const EidosASTNode *base_node = p_node;
+	
+	do
+	{
+		chain_nodes[chain_length++] = base_node;
+		base_node = base_node->children_[0];
+	}
+	while ((chain_length < EIDOS_PROPERTY_CHAIN_MAX) && (base_node->token_->token_type_ == EidosTokenType::kTokenDot) && (base_node->cached_evaluator_ == &EidosInterpreter::Evaluate_MemberRef));
+	
+	// The receiver of each step is either value, the result of the base node or of the most recent step evaluated to an EidosValue,
+	// or, if in_buffer is true, the elements in buffer_elements; value keeps the elements that those elements came from alive
+	EidosValue_SP value = FastEvaluateNode(base_node);
+	bool in_buffer = false;
+	EidosObjectElement **buffer_elements = nullptr;
+	size_t buffer_count = 0;
+	const EidosObjectClass *buffer_class = nullptr;
+	bool buffer_has_dims = false;		// if true, the elements in the buffer would have had the dimensions of value
+	int buffer_index = 0;
+	
+	for (int chain_index = chain_length - 1; chain_index >= 0; --chain_index)
+	{
+		const EidosASTNode *step_node = chain_nodes[chain_index];
+		EidosToken *operator_token = step_node->token_;
+		const EidosASTNode *property_node = step_node->children_[1];
+		EidosToken *property_token = property_node->token_;
+		EidosGlobalStringID property_id = property_node->cached_stringID_;
+		bool final_step = (chain_index == 0);
+		
+		if (property_token->token_type_ != EidosTokenType::kTokenIdentifier)
+			EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_MemberRef): (internal error) the '.' operator for x.y requires operand y to be an identifier." << EidosTerminate(operator_token);
+		
+		if (!in_buffer)
+		{
+			EidosValueType value_type = value->Type();
+			
+			if (value_type != EidosValueType::kValueObject)
+				EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_MemberRef): (internal error) operand type " << value_type << " is not supported by the '.' operator." << EidosTerminate(operator_token);
+			
+			EidosValue_Object *object_value = static_cast<EidosValue_Object *>(value.get());
+			int value_count = object_value->Count();
+			
+			if (!final_step && (value_count > 0))
+			{
+				const EidosPropertySignature *signature = object_value->Class()->SignatureForProperty(property_id);
+				
+				if (signature && signature->accelerated_get_elements_)
+				{
+					EidosObjectElement *singleton_element;
+					EidosObjectElement **elements;
+					
+					if (value_count == 1)
+					{
+						singleton_element = object_value->ObjectElementAtIndex(0, nullptr);
+						elements = &singleton_element;
+					}
+					else
+					{
+						elements = const_cast<EidosObjectElement **>(object_value->ObjectElementVector()->data());
+					}
+					
+					std::vector<EidosObjectElement *> &buffer = gEidos_PropertyChainBuffers[buffer_index];
+					
+					buffer_index ^= 1;
+					buffer_count = value_count * (size_t)signature->accelerated_fan_out_;
+					buffer.resize(buffer_count);
+					buffer_elements = buffer.data();
+					signature->accelerated_elements_getter(elements, value_count, buffer_elements);
+					buffer_class = signature->value_class_;
+					buffer_has_dims = !!(signature->value_mask_ & kEidosValueMaskSingleton);
+					in_buffer = true;
+					continue;
+				}
+			}
+			
+			// If an error occurs inside a function or method call, we want to highlight the call
+			EidosErrorPosition error_pos_save = EidosScript::PushErrorPositionFromToken(property_token);
+			
+			value = object_value->GetPropertyOfElements(property_id);
+			
+			// Forget the function token, since it is not responsible for any future errors
+			EidosScript::RestoreErrorPosition(error_pos_save);
+		}
+		else
+		{
+			const EidosPropertySignature *signature = buffer_class->SignatureForProperty(property_id);
+			
+			if (signature)
+			{
+				if (!final_step && signature->accelerated_get_elements_)
+				{
+					std::vector<EidosObjectElement *> &buffer = gEidos_PropertyChainBuffers[buffer_index];
+					size_t source_count = buffer_count;
+					
+					buffer_index ^= 1;
+					buffer_count = source_count * (size_t)signature->accelerated_fan_out_;
+					buffer.resize(buffer_count);
+					signature->accelerated_elements_getter(buffer_elements, source_count, buffer.data());
+					buffer_elements = buffer.data();
+					buffer_class = signature->value_class_;
+					buffer_has_dims = buffer_has_dims && (signature->value_mask_ & kEidosValueMaskSingleton);
+					continue;
+				}
+				
+				if (final_step && (buffer_count > 1) && signature->accelerated_get_)
+				{
+					// This follows EidosValue_Object_vector::GetPropertyOfElements(), which is not used for singletons
+					EidosErrorPosition error_pos_save = EidosScript::PushErrorPositionFromToken(property_token);
+					EidosValue_SP result_SP = EidosValue_SP(signature->accelerated_getter(buffer_elements, buffer_count));
+					
+					if (buffer_has_dims && (signature->value_mask_ & kEidosValueMaskSingleton))
+						result_SP->CopyDimensionsFromValue(value.get());
+					
+#if DEBUG
+					signature->CheckAggregateResultValue(*result_SP, buffer_count);
+#endif
+					EidosScript::RestoreErrorPosition(error_pos_save);
+					Eidos_TrimPropertyChainBuffers();
+					return result_SP;
+				}
+			}
+			
+			// Otherwise, the elements in the buffer are placed into an EidosValue, and the step is evaluated from that as usual
+			EidosValue_Object_vector *buffer_value = new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(buffer_elements, buffer_count, buffer_class);
+			EidosValue_SP buffer_value_SP = EidosValue_SP(buffer_value);
+			
+			if (buffer_has_dims)
+				buffer_value->CopyDimensionsFromValue(value.get());
+			
+			in_buffer = false;
+			
+			EidosErrorPosition error_pos_save = EidosScript::PushErrorPositionFromToken(property_token);
+			
+			value = buffer_value->GetPropertyOfElements(property_id);
+			
+			EidosScript::RestoreErrorPosition(error_pos_save);
+		}
+	}
+	
+	Eidos_TrimPropertyChainBuffers();
+	return value;
+}
+
 EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 {
 	EIDOS_ENTRY_EXECUTION_LOG("Evaluate_Plus()");
@@ -2286,7 +2563,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 					if (overflow)
 						EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Plus): integer addition overflow with the binary '+' operator." << EidosTerminate(operator_token);
 					
-					result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(add_result));
+					result_SP = Eidos_IntSingletonResult(first_child_value, second_child_value, add_result);
 				}
 				else
 				{
@@ -2377,7 +2654,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 			{
 				if (first_child_count == 1)
 				{
-					result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(first_child_value->FloatAtIndex(0, operator_token) + second_child_value->FloatAtIndex(0, operator_token)));
+					result_SP = Eidos_FloatSingletonResult(first_child_value, second_child_value, first_child_value->FloatAtIndex(0, operator_token) + second_child_value->FloatAtIndex(0, operator_token));
 				}
 				else
 				{
@@ -2505,7 +2782,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 				if (overflow)
 					EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Minus): integer negation overflow with the unary '-' operator." << EidosTerminate(operator_token);
 				
-				result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(subtract_result));
+				result_SP = Eidos_IntSingletonResult(first_child_value, EidosValue_SP(), subtract_result);
 			}
 			else
 			{
@@ -2535,7 +2812,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 		{
 			if (first_child_count == 1)
 			{
-				result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(-first_child_value->FloatAtIndex(0, operator_token)));
+				result_SP = Eidos_FloatSingletonResult(first_child_value, EidosValue_SP(), -first_child_value->FloatAtIndex(0, operator_token));
 			}
 			else
 			{
@@ -2589,7 +2866,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 					if (overflow)
 						EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Minus): integer subtraction overflow with the binary '-' operator." << EidosTerminate(operator_token);
 					
-					result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(subtract_result));
+					result_SP = Eidos_IntSingletonResult(first_child_value, second_child_value, subtract_result);
 				}
 				else
 				{
@@ -2677,7 +2954,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 			{
 				if (first_child_count == 1)
 				{
-					result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(first_child_value->FloatAtIndex(0, operator_token) - second_child_value->FloatAtIndex(0, operator_token)));
+					result_SP = Eidos_FloatSingletonResult(first_child_value, second_child_value, first_child_value->FloatAtIndex(0, operator_token) - second_child_value->FloatAtIndex(0, operator_token));
 				}
 				else
 				{
@@ -2811,7 +3088,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mod(const EidosASTNode *p_node)
 	{
 		if (first_child_count == 1)
 		{
-			result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(fmod(first_child_value->FloatAtIndex(0, operator_token), second_child_value->FloatAtIndex(0, operator_token))));
+			result_SP = Eidos_FloatSingletonResult(first_child_value, second_child_value, fmod(first_child_value->FloatAtIndex(0, operator_token), second_child_value->FloatAtIndex(0, operator_token)));
 		}
 		else
 		{
@@ -2961,7 +3238,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mult(const EidosASTNode *p_node)
 				if (overflow)
 					EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Mult): integer multiplication overflow with the '*' operator." << EidosTerminate(operator_token);
 				
-				result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(multiply_result));
+				result_SP = Eidos_IntSingletonResult(first_child_value, second_child_value, multiply_result);
 			}
 			else
 			{
@@ -2993,7 +3270,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mult(const EidosASTNode *p_node)
 		{
 			if (first_child_count == 1)
 			{
-				result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(first_child_value->FloatAtIndex(0, operator_token) * second_child_value->FloatAtIndex(0, operator_token)));
+				result_SP = Eidos_FloatSingletonResult(first_child_value, second_child_value, first_child_value->FloatAtIndex(0, operator_token) * second_child_value->FloatAtIndex(0, operator_token));
 			}
 			else
 			{
@@ -3152,7 +3429,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Div(const EidosASTNode *p_node)
 	{
 		if (first_child_count == 1)
 		{
-			result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(first_child_value->FloatAtIndex(0, operator_token) / second_child_value->FloatAtIndex(0, operator_token)));
+			result_SP = Eidos_FloatSingletonResult(first_child_value, second_child_value, first_child_value->FloatAtIndex(0, operator_token) / second_child_value->FloatAtIndex(0, operator_token));
 		}
 		else
 		{
@@ -3329,7 +3606,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Exp(const EidosASTNode *p_node)
 	{
 		if (first_child_count == 1)
 		{
-			result_SP = EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(pow(first_child_value->FloatAtIndex(0, operator_token), second_child_value->FloatAtIndex(0, operator_token))));
+			result_SP = Eidos_FloatSingletonResult(first_child_value, second_child_value, pow(first_child_value->FloatAtIndex(0, operator_token), second_child_value->FloatAtIndex(0, operator_token)));
 		}
 		else
 		{
@@ -3965,6 +4242,14 @@ EidosValue_SP EidosInterpreter::Evaluate_Assign(const EidosASTNode *p_node)
 		if (is_const)
 			EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Assign): identifier '" << lvalue_node->token_->token_string_ << "' cannot be redefined because it is a constant." << EidosTerminate(p_node->token_);
 		
+		// if the value is shared with anybody else (beyond the symbol table and lvalue_SP), copy it before modifying it in
+		// place; see the copy-on-write comment in _ProcessSubsetAssignment()
+		if (lvalue_SP->UseCount() > 2)
+		{
+			lvalue_SP = lvalue_SP->CopyValues();
+			global_symbols_->SetValueForSymbolNoCopy(lvalue_node->cached_stringID_, lvalue_SP);
+		}
+		
 		EidosValue *lvalue = lvalue_SP.get();
 		int lvalue_count = lvalue->Count();
 		
@@ -5442,6 +5727,12 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 	const EidosASTNode *range_node = p_node->children_[1];
 	EidosValue_SP result_SP;
 	
+	// each execution of the loop gets a new serial number, which validates loop-invariant folds in its body; see Evaluate_Folded().
+	// We restore the previous serial on exit, so that an execution of the loop that recursively contains another continues to use its own.
+	int64_t saved_for_serial = p_node->cached_for_serial_;
+	
+	p_node->cached_for_serial_ = ++gEidos_ForLoopSerial;
+	
 	// true if the for-loop statement references the index variable; if so, it needs to be set up
 	// each iteration, but that can be done very cheaply by replacing its internal value
 	uint8_t references_index = p_node->cached_for_references_index_;
@@ -5907,6 +6198,8 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 	
 for_exit:
 	
+	p_node->cached_for_serial_ = saved_for_serial;
+	
 	if (!result_SP)
 		result_SP = gStaticEidosValueVOID;
 	
@@ -6078,7 +6371,7 @@ EidosValue_SP EidosInterpreter::Evaluate_FunctionDecl(const EidosASTNode *p_node
 		//std::cout << *sig << std::endl;
 		
 		// Check that a built-in function is not already defined with this name; no replacing the built-ins.
-		auto signature_iter = function_map_.find(function_name);
+		auto signature_iter = function_map_.find(sig->call_id_);
 		
 		if (signature_iter != function_map_.end())
 		{
@@ -6092,12 +6385,10 @@ EidosValue_SP EidosInterpreter::Evaluate_FunctionDecl(const EidosASTNode *p_node
 		}
 		
 		// Add the user-defined function to our function map (possibly replacing a previous version)
-		auto found_iter = function_map_.find(sig->call_name_);
-		
-		if (found_iter != function_map_.end())
-			function_map_.erase(found_iter);
+		if (signature_iter != function_map_.end())
+			function_map_.erase(signature_iter);
 		
-		function_map_.insert(EidosFunctionMapPair(sig->call_name_, EidosFunctionSignature_CSP(sig)));
+		function_map_.insert(EidosFunctionMapPair(sig->call_id_, EidosFunctionSignature_CSP(sig)));
 		
 		// the signature is now under shared_ptr, or deleted, and so variable sig falls out of scope here
 	}
@@ -6167,3 +6458,132 @@ EidosValue_SP EidosInterpreter::Evaluate_FunctionDecl(const EidosASTNode *p_node
 
 
 
+
+EidosValue_SP EidosInterpreter::Evaluate_Bytecode(const EidosASTNode *p_node)
+{
+	// This evaluator is installed by EidosASTNode::_OptimizeBytecode() for nodes whose expression has been compiled to
+	// bytecode.  We run the bytecode, and if it gives up, we evaluate the node with its normal evaluator instead; that
+	// is also done when logging execution, so that the log shows every node.  If the bytecode gives up too often, we
+	// uninstall ourselves, as Evaluate_Folded() does, so that the node goes straight to its normal evaluator from then on.
+	EidosBytecode *bytecode = p_node->cached_bytecode_;
+	
+#if defined(DEBUG) || defined(EIDOS_GUI)
+	if (!logging_execution_)
+#endif
+	{
+		EidosValue_SP result_SP;
+		
+		if (bytecode->Execute(*global_symbols_, result_SP))
+		{
+			if (bytecode->fallback_count_)
+				bytecode->fallback_count_--;
+			
+			return result_SP;
+		}
+		
+		if (++bytecode->fallback_count_ >= EIDOS_BYTECODE_MAX_FALLBACKS)
+		{
+			// we might be the node's evaluator, or the evaluator of its fold (see EidosASTNode::_OptimizeBytecode())
+			if (p_node->cached_evaluator_ == &EidosInterpreter::Evaluate_Bytecode)
+				p_node->cached_evaluator_ = bytecode->fallback_evaluator_;
+			if (p_node->cached_fold_ && (p_node->cached_fold_->fallback_evaluator_ == &EidosInterpreter::Evaluate_Bytecode))
+				p_node->cached_fold_->fallback_evaluator_ = bytecode->fallback_evaluator_;
+		}
+	}
+	
+	return (this->*(bytecode->fallback_evaluator_))(p_node);
+}
+
+EidosValue_SP EidosInterpreter::Evaluate_Folded(const EidosASTNode *p_node)
+{
+	// This evaluator is installed by EidosASTNode::_OptimizeFolding() for pure expressions.  We return the fold's value if it
+	// is static, or if it is cached and still valid; otherwise we evaluate the node normally and decide whether to cache the
+	// result.  When logging execution, we always evaluate the node normally, so that the log shows every node.  See EidosFold.
+	EidosFold *fold = p_node->cached_fold_;
+	
+#if defined(DEBUG) || defined(EIDOS_GUI)
+	if (logging_execution_)
+		return (this->*(fold->fallback_evaluator_))(p_node);
+#endif
+	
+	if (fold->is_static_)
+		return fold->folded_value_;
+	
+	size_t identifier_count = fold->identifiers_.size();
+	
+	if (fold->folded_value_)
+	{
+		if (fold->is_constant_)
+		{
+			// a constant fold is valid if each identifier is still a defined constant with the same value; since we retain the
+			// values, a constant that has been removed and redefined cannot have the same address as before
+			size_t identifier_index;
+			
+			for (identifier_index = 0; identifier_index < identifier_count; ++identifier_index)
+			{
+				EidosSymbolTableType table_type;
+				EidosValue *value = global_symbols_->GetValueRawOrNullForSymbol_TableType(fold->identifiers_[identifier_index], &table_type);
+				
+				if ((value != fold->identifier_values_[identifier_index].get()) || ((table_type != EidosSymbolTableType::kEidosIntrinsicConstantsTable) && (table_type != EidosSymbolTableType::kEidosDefinedConstantsTable)))
+					break;
+			}
+			
+			if (identifier_index == identifier_count)
+				return fold->folded_value_;
+		}
+		else if (fold->loop_serial_ == fold->loop_node_->cached_for_serial_)
+		{
+			// a loop-invariant fold is valid for the execution of the loop in which it was cached
+			return fold->folded_value_;
+		}
+	}
+	
+	EidosValue_SP result_SP = (this->*(fold->fallback_evaluator_))(p_node);
+	
+	// Decide how to cache the result.  Context constants, such as the parameters of SLiM callbacks, can change value even
+	// within a loop, so we never cache values that depend on them; defined constants cannot, and variables can change only
+	// by assignment, which _OptimizeFolding() has checked for.  We also never cache large values, which would be kept alive
+	// for as long as the script is.
+	bool cacheable = (result_SP->Count() <= EIDOS_FOLD_MAX_VALUE_COUNT), all_constant = true;
+	
+	fold->identifier_values_.clear();
+	
+	for (size_t identifier_index = 0; cacheable && (identifier_index < identifier_count); ++identifier_index)
+	{
+		EidosSymbolTableType table_type;
+		EidosValue *value = global_symbols_->GetValueRawOrNullForSymbol_TableType(fold->identifiers_[identifier_index], &table_type);
+		
+		if (!value || (table_type == EidosSymbolTableType::kContextConstantsTable))
+		{
+			cacheable = false;
+			break;
+		}
+		
+		if (table_type == EidosSymbolTableType::kVariablesTable)
+			all_constant = false;
+		
+		fold->identifier_values_.emplace_back(EidosValue_SP(value));
+	}
+	
+	if (cacheable && all_constant)
+	{
+		fold->is_constant_ = true;
+		fold->folded_value_ = result_SP;
+	}
+	else if (cacheable && fold->loop_node_)
+	{
+		fold->is_constant_ = false;
+		fold->identifier_values_.clear();
+		fold->loop_serial_ = fold->loop_node_->cached_for_serial_;
+		fold->folded_value_ = result_SP;
+	}
+	else
+	{
+		// the value cannot be cached, and probably never will be, so we stop trying
+		fold->identifier_values_.clear();
+		fold->folded_value_.reset();
+		p_node->cached_evaluator_ = fold->fallback_evaluator_;
+	}
+	
+	return result_SP;
+}
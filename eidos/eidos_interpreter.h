@@ -30,6 +30,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 
 #include "eidos_script.h"
 #include "eidos_value.h"
@@ -48,10 +49,13 @@ class EidosCallSignature;
 // your object graph having a back pointer of some kind.  If you think this is gross, don't use it.  :->
 typedef EidosObjectElement EidosContext;
 
-// typedefs used to set up our map table of EidosFunctionSignature objects; std::map is used instead of
-// std::unordered_map mostly for convenience, speed should not matter much since signatures get cached anyway
-typedef std::pair<std::string, EidosFunctionSignature_CSP> EidosFunctionMapPair;
-typedef std::map<std::string, EidosFunctionSignature_CSP> EidosFunctionMap;
+// typedefs used to set up our map table of EidosFunctionSignature objects; the map is keyed by the uniqued global string ID
+// for the function name (the signature's call_id_), so calls can look up their function using the ID already cached in the
+// call's identifier node, with no string hashing or comparison.  Only built-in signatures get cached in the AST, so this
+// lookup is on the critical path for every call to a user-defined or Context-defined function.  Note that the map is not
+// in alphabetical order; code that presents functions to the user needs to sort them.
+typedef std::pair<EidosGlobalStringID, EidosFunctionSignature_CSP> EidosFunctionMapPair;
+typedef std::unordered_map<EidosGlobalStringID, EidosFunctionSignature_CSP> EidosFunctionMap;
 
 // utility functions
 bool TypeCheckAssignmentOfEidosValueIntoEidosValue(const EidosValue &p_base_value, const EidosValue &p_destination_value);	// codifies what promotions can occur in assignment
@@ -67,7 +71,7 @@ private:
 	const EidosASTNode *root_node_;				// not owned
 	EidosSymbolTable *global_symbols_;			// NOT OWNED: whoever creates us must give us a reference to a symbol table, which we use
 	
-	EidosFunctionMap &function_map_;			// a map table of EidosFunctionSignature objects, keyed by function name
+	EidosFunctionMap &function_map_;			// a map table of EidosFunctionSignature objects, keyed by function name ID
 	
 	// flags to handle next/break statements in do...while, while, and for loops
 	bool next_statement_hit_ = false;
@@ -124,9 +128,10 @@ public:
 	void _ProcessSubsetAssignment(EidosValue_SP *p_base_value_ptr, EidosGlobalStringID *p_property_string_id_ptr, std::vector<int> *p_indices_ptr, const EidosASTNode *p_parent_node);
 	void _AssignRValueToLValue(EidosValue_SP p_rvalue, const EidosASTNode *p_lvalue_node);
 	EidosValue_SP _Evaluate_RangeExpr_Internal(const EidosASTNode *p_node, const EidosValue &p_first_child_value, const EidosValue &p_second_child_value);
+	EidosValue_SP _Evaluate_PropertyChain(const EidosASTNode *p_node);
 	int _ProcessArgumentList(const EidosASTNode *p_node, const EidosCallSignature *p_call_signature, EidosValue_SP *p_arg_buffer);
 	
-	EidosValue_SP DispatchUserDefinedFunction(const EidosFunctionSignature &p_function_signature, const EidosValue_SP *const p_arguments, int p_argument_count);
+	EidosValue_SP DispatchUserDefinedFunction(const EidosFunctionSignature &p_function_signature, EidosValue_SP *const p_arguments, int p_argument_count);	// moves from p_arguments
 	
 	void NullReturnRaiseForNode(const EidosASTNode *p_node);
 	EidosValue_SP EvaluateNode(const EidosASTNode *p_node);
@@ -174,6 +179,8 @@ public:
 	EidosValue_SP Evaluate_Break(const EidosASTNode *p_node);
 	EidosValue_SP Evaluate_Return(const EidosASTNode *p_node);
 	EidosValue_SP Evaluate_FunctionDecl(const EidosASTNode *p_node);
+	EidosValue_SP Evaluate_Bytecode(const EidosASTNode *p_node);
+	EidosValue_SP Evaluate_Folded(const EidosASTNode *p_node);
 	
 	// Function dispatch/execution; these are implemented in eidos_functions.cpp
 	static const std::vector<EidosFunctionSignature_CSP> &BuiltInFunctions(void);
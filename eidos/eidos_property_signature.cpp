@@ -25,7 +25,7 @@
 
 
 EidosPropertySignature::EidosPropertySignature(const std::string &p_property_name, bool p_read_only, EidosValueMask p_value_mask)
-	: property_name_(p_property_name), property_id_(Eidos_GlobalStringIDForString(p_property_name)), read_only_(p_read_only), value_mask_(p_value_mask), value_class_(nullptr), accelerated_get_(false), accelerated_set_(false)
+	: property_name_(p_property_name), property_id_(Eidos_GlobalStringIDForString(p_property_name)), read_only_(p_read_only), value_mask_(p_value_mask), value_class_(nullptr), accelerated_get_(false), accelerated_get_elements_(false), accelerated_fan_out_(0), accelerated_set_(false)
 {
 	if (!read_only_ && !(value_mask_ & kEidosValueMaskSingleton))
 		EIDOS_TERMINATION << "ERROR (EidosPropertySignature::EidosPropertySignature): (internal error) read-write property " << property_name_ << " must produce a singleton value according to Eidos semantics." << EidosTerminate(nullptr);
@@ -36,7 +36,7 @@ EidosPropertySignature::EidosPropertySignature(const std::string &p_property_nam
 }
 
 EidosPropertySignature::EidosPropertySignature(const std::string &p_property_name, bool p_read_only, EidosValueMask p_value_mask, const EidosObjectClass *p_value_class)
-	: property_name_(p_property_name), property_id_(Eidos_GlobalStringIDForString(p_property_name)), read_only_(p_read_only), value_mask_(p_value_mask), value_class_(p_value_class), accelerated_get_(false), accelerated_set_(false)
+	: property_name_(p_property_name), property_id_(Eidos_GlobalStringIDForString(p_property_name)), read_only_(p_read_only), value_mask_(p_value_mask), value_class_(p_value_class), accelerated_get_(false), accelerated_get_elements_(false), accelerated_fan_out_(0), accelerated_set_(false)
 {
 	if (!read_only_ && !(value_mask_ & kEidosValueMaskSingleton))
 		EIDOS_TERMINATION << "ERROR (EidosPropertySignature::EidosPropertySignature): (internal error) read-write property " << property_name_ << " must produce a singleton value according to Eidos semantics." << EidosTerminate(nullptr);
@@ -233,6 +233,24 @@ EidosPropertySignature *EidosPropertySignature::DeclareAcceleratedGet(Eidos_Acce
 	return this;
 }
 
+EidosPropertySignature *EidosPropertySignature::DeclareAcceleratedGetElements(Eidos_AcceleratedElementGetter p_getter, int p_fan_out)
+{
+	if ((value_mask_ & kEidosValueMaskFlagStrip) != kEidosValueMaskObject)
+		EIDOS_TERMINATION << "ERROR (EidosPropertySignature::DeclareAcceleratedGetElements): (internal error) only properties returning object may be accelerated by element." << EidosTerminate(nullptr);
+	
+	if (value_class_ == nullptr)
+		EIDOS_TERMINATION << "ERROR (EidosPropertySignature::DeclareAcceleratedGetElements): (internal error) only object properties that declare their class may be accelerated by element." << EidosTerminate(nullptr);
+	
+	if ((p_fan_out < 1) || ((value_mask_ & kEidosValueMaskSingleton) && (p_fan_out != 1)))
+		EIDOS_TERMINATION << "ERROR (EidosPropertySignature::DeclareAcceleratedGetElements): (internal error) fan-out " << p_fan_out << " is not valid for property " << property_name_ << "." << EidosTerminate(nullptr);
+	
+	accelerated_get_elements_ = true;
+	accelerated_fan_out_ = p_fan_out;
+	accelerated_elements_getter = p_getter;
+	
+	return this;
+}
+
 EidosPropertySignature *EidosPropertySignature::DeclareAcceleratedSet(Eidos_AcceleratedPropertySetter p_setter)
 {
 	if (read_only_)
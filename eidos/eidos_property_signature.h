@@ -36,6 +36,13 @@ class EidosObjectClass;
 // do a cast of p_values directly to its own type without checking, according to the calling conventions used here.
 typedef EidosValue *(*Eidos_AcceleratedPropertyGetter)(EidosObjectElement **p_values, size_t p_values_size);
 
+// This typedef is for an "accelerated element getter".  These may be declared, in addition to an accelerated getter, for object
+// properties that always produce the same number of elements for each element they are accessed on – the "fan-out" of the
+// property, which is 2 for the genomes of an individual, for example.  The getter writes the p_values_size * fan-out resulting
+// elements into p_result, in order, without retaining them and without allocating anything.  This allows EidosInterpreter to
+// evaluate a property chain like x.genomes.mutations without making an EidosValue for each intermediate step of the chain.
+typedef void (*Eidos_AcceleratedElementGetter)(EidosObjectElement **p_values, size_t p_values_size, EidosObjectElement **p_result);
+
 // This typedef is for an "accelerated property setter".  These are static member functions on a class, designed to set a property
 // value across a buffer of EidosObjectElements.  This is more complex than the getter case, because there are two possibilities:
 // p_source could be a singleton, providing one value to be set across the whole buffer, OR it could be a vector of length equal
@@ -60,6 +67,10 @@ public:
 	bool accelerated_get_;									// if true, can be read using a fast-access GetProperty_Accelerated_X() method
 	Eidos_AcceleratedPropertyGetter accelerated_getter;		// a pointer to a (static member) function that handles the accelerated get
 	
+	bool accelerated_get_elements_;							// if true, can be read into a buffer of elements using a GetProperty_AcceleratedElements_X() method
+	int accelerated_fan_out_;								// the number of elements the accelerated element getter produces per element
+	Eidos_AcceleratedElementGetter accelerated_elements_getter;	// a pointer to a (static member) function that handles the accelerated element get
+	
 	bool accelerated_set_;									// if true, can be written using a fast-access SetProperty_Accelerated_X() method
 	Eidos_AcceleratedPropertySetter accelerated_setter;		// a pointer to a (static member) function that handles the accelerated set
 	
@@ -82,6 +93,7 @@ public:
 	
 	// property access acceleration
 	EidosPropertySignature *DeclareAcceleratedGet(Eidos_AcceleratedPropertyGetter p_getter);
+	EidosPropertySignature *DeclareAcceleratedGetElements(Eidos_AcceleratedElementGetter p_getter, int p_fan_out);
 	EidosPropertySignature *DeclareAcceleratedSet(Eidos_AcceleratedPropertySetter p_setter);
 };
 
@@ -0,0 +1,219 @@
+//
+//  eidos_simd.cpp
+//  Eidos
+//
+//  Created by agent on 10/18/2026.
+//  Copyright (c) 2015-2020 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of Eidos.
+//
+//	Eidos is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	Eidos is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with Eidos.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "eidos_simd.h"
+#include "eidos_globals.h"
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+// Runtime dispatch to AVX2 is done only on x86-64 with GCC or clang, which provide the target attribute and
+// __builtin_cpu_supports(); SSE2 is part of the x86-64 baseline, so the baseline kernels can use it unconditionally
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define EIDOS_SIMD_X86	1
+#include <immintrin.h>
+#define EIDOS_SIMD_AVX2		__attribute__((target("avx2")))
+#else
+#define EIDOS_SIMD_X86	0
+#endif
+
+
+// The integer sum works through its data in blocks of this many values; see Eidos_SIMD_SumIntBody()
+#define EIDOS_SIMD_SUM_INT_BLOCK	1024
+
+
+//
+//	Code shared by all sets of kernels; this is inlined into each kernel, which allows the compiler to vectorize it
+//	for the instruction set of that kernel
+//
+
+static inline __attribute__((always_inline)) bool Eidos_SIMD_SumIntBody(const int64_t *p_data, int64_t p_count, int64_t *p_int_sum, double *p_float_sum)
+{
+	int64_t sum = 0;
+	double sum_d = 0;
+	bool fits_in_integer = true;
+	
+	for (int64_t block_start = 0; block_start < p_count; block_start += EIDOS_SIMD_SUM_INT_BLOCK)
+	{
+		const int64_t *block_data = p_data + block_start;
+		int64_t block_count = std::min((int64_t)EIDOS_SIMD_SUM_INT_BLOCK, p_count - block_start);
+		uint64_t block_magnitude = 0;
+		uint64_t block_sum = 0;		// unsigned so that a sum that overflows (and is then discarded) is well-defined
+		
+		for (int64_t value_index = 0; value_index < block_count; ++value_index)
+		{
+			int64_t value = block_data[value_index];
+			
+			block_magnitude |= (uint64_t)(value ^ (value >> 63));		// value for value >= 0, -value - 1 for value < 0
+			block_sum += (uint64_t)value;
+		}
+		
+		// Every value in the block lies within [block_min, block_max], with block_min <= 0 <= block_max, so every partial sum within
+		// the block, in any order, lies within [sum + block_count * block_min, sum + block_count * block_max].  If that range cannot
+		// overflow, the sequential sum below would not overflow within this block either, so it would arrive at exactly block_sum;
+		// otherwise we do the sequential sum, with its overflow handling.
+		int64_t block_max = (int64_t)(block_magnitude & (uint64_t)std::numeric_limits<int64_t>::max());
+		int64_t block_min = ~block_max;
+		
+		if ((block_max <= (std::numeric_limits<int64_t>::max() - std::max(sum, (int64_t)0)) / block_count) &&
+			(block_min >= (std::numeric_limits<int64_t>::min() - std::min(sum, (int64_t)0)) / block_count))
+		{
+			sum += (int64_t)block_sum;
+		}
+		else
+		{
+			// We do a tricky thing here.  We want to try to compute in integer, but switch to float if we overflow.
+			// If we do overflow, we want to minimize numerical error by accumulating in integer for as long as we
+			// can, and then throwing the integer accumulator over into the float accumulator only when it is about
+			// to overflow.  We perform both computations in parallel, and use integer for the result if we can.
+			for (int64_t value_index = 0; value_index < block_count; ++value_index)
+			{
+				int64_t old_sum = sum;
+				int64_t temp = block_data[value_index];
+				
+				bool overflow = Eidos_add_overflow(old_sum, temp, &sum);
+				
+				// switch to float computation on overflow, and accumulate in the float sum just before overflow
+				if (overflow)
+				{
+					fits_in_integer = false;
+					sum_d += old_sum;
+					sum = temp;		// start integer accumulation again from 0 until it overflows again
+				}
+			}
+		}
+	}
+	
+	*p_int_sum = sum;
+	*p_float_sum = sum_d + sum;		// add in whatever integer accumulation has not overflowed
+	
+	return fits_in_integer;
+}
+
+// Defines the kernels whose bodies are simple loops, with the given suffix and function attributes; the compiler vectorizes these loops
+#define EIDOS_SIMD_LOOP_KERNELS(suffix, attributes)																										\
+attributes static void Eidos_SIMD_MaxInt_##suffix(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count)				\
+	{ for (int64_t i = 0; i < p_count; ++i) p_result[i] = std::max(p_x[i], p_y[i]); }													\
+attributes static void Eidos_SIMD_MinInt_##suffix(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count)				\
+	{ for (int64_t i = 0; i < p_count; ++i) p_result[i] = std::min(p_x[i], p_y[i]); }													\
+attributes static void Eidos_SIMD_MaxIntSingleton_##suffix(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count)			\
+	{ for (int64_t i = 0; i < p_count; ++i) p_result[i] = std::max(p_x[i], p_y); }														\
+attributes static void Eidos_SIMD_MinIntSingleton_##suffix(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count)			\
+	{ for (int64_t i = 0; i < p_count; ++i) p_result[i] = std::min(p_x[i], p_y); }														\
+attributes static void Eidos_SIMD_MaxFloat_##suffix(const double *p_x, const double *p_y, double *p_result, int64_t p_count)				\
+	{ for (int64_t i = 0; i < p_count; ++i) p_result[i] = std::max(p_x[i], p_y[i]); }													\
+attributes static void Eidos_SIMD_MinFloat_##suffix(const double *p_x, const double *p_y, double *p_result, int64_t p_count)				\
+	{ for (int64_t i = 0; i < p_count; ++i) p_result[i] = std::min(p_x[i], p_y[i]); }													\
+attributes static void Eidos_SIMD_MaxFloatSingleton_##suffix(const double *p_x, double p_y, double *p_result, int64_t p_count)			\
+	{ for (int64_t i = 0; i < p_count; ++i) p_result[i] = std::max(p_x[i], p_y); }														\
+attributes static void Eidos_SIMD_MinFloatSingleton_##suffix(const double *p_x, double p_y, double *p_result, int64_t p_count)			\
+	{ for (int64_t i = 0; i < p_count; ++i) p_result[i] = std::min(p_x[i], p_y); }														\
+attributes static bool Eidos_SIMD_SumInt_##suffix(const int64_t *p_data, int64_t p_count, int64_t *p_int_sum, double *p_float_sum)			\
+	{ return Eidos_SIMD_SumIntBody(p_data, p_count, p_int_sum, p_float_sum); }
+
+
+//
+//	Baseline kernels
+//
+
+EIDOS_SIMD_LOOP_KERNELS(baseline, )
+
+static void Eidos_SIMD_SqrtFloat_baseline(const double *p_x, double *p_result, int64_t p_count)
+{
+	int64_t value_index = 0;
+	
+#if EIDOS_SIMD_X86
+	// sqrtpd is correctly rounded, like sqrt(), so the results are identical; it just doesn't set errno, which Eidos doesn't use
+	for (; value_index + 2 <= p_count; value_index += 2)
+		_mm_storeu_pd(p_result + value_index, _mm_sqrt_pd(_mm_loadu_pd(p_x + value_index)));
+#endif
+	
+	for (; value_index < p_count; ++value_index)
+		p_result[value_index] = sqrt(p_x[value_index]);
+}
+
+
+//
+//	AVX2 kernels
+//
+
+#if EIDOS_SIMD_X86
+
+EIDOS_SIMD_LOOP_KERNELS(AVX2, EIDOS_SIMD_AVX2)
+
+EIDOS_SIMD_AVX2 static void Eidos_SIMD_SqrtFloat_AVX2(const double *p_x, double *p_result, int64_t p_count)
+{
+	int64_t value_index = 0;
+	
+	for (; value_index + 4 <= p_count; value_index += 4)
+		_mm256_storeu_pd(p_result + value_index, _mm256_sqrt_pd(_mm256_loadu_pd(p_x + value_index)));
+	
+	for (; value_index < p_count; ++value_index)
+		p_result[value_index] = sqrt(p_x[value_index]);
+}
+
+#endif
+
+
+//
+//	Kernel selection
+//
+
+static const EidosSIMDKernels gEidosSIMDKernels_baseline = {
+	"baseline",
+	Eidos_SIMD_SumInt_baseline, Eidos_SIMD_SqrtFloat_baseline,
+	Eidos_SIMD_MaxInt_baseline, Eidos_SIMD_MinInt_baseline, Eidos_SIMD_MaxIntSingleton_baseline, Eidos_SIMD_MinIntSingleton_baseline,
+	Eidos_SIMD_MaxFloat_baseline, Eidos_SIMD_MinFloat_baseline, Eidos_SIMD_MaxFloatSingleton_baseline, Eidos_SIMD_MinFloatSingleton_baseline
+};
+
+#if EIDOS_SIMD_X86
+static const EidosSIMDKernels gEidosSIMDKernels_AVX2 = {
+	"AVX2",
+	Eidos_SIMD_SumInt_AVX2, Eidos_SIMD_SqrtFloat_AVX2,
+	Eidos_SIMD_MaxInt_AVX2, Eidos_SIMD_MinInt_AVX2, Eidos_SIMD_MaxIntSingleton_AVX2, Eidos_SIMD_MinIntSingleton_AVX2,
+	Eidos_SIMD_MaxFloat_AVX2, Eidos_SIMD_MinFloat_AVX2, Eidos_SIMD_MaxFloatSingleton_AVX2, Eidos_SIMD_MinFloatSingleton_AVX2
+};
+#endif
+
+EidosSIMDKernels gEidosSIMDKernels = gEidosSIMDKernels_baseline;
+
+bool Eidos_SIMD_SelectKernels(bool p_use_best)
+{
+#if EIDOS_SIMD_X86
+	__builtin_cpu_init();
+	
+	if (p_use_best && __builtin_cpu_supports("avx2"))
+	{
+		gEidosSIMDKernels = gEidosSIMDKernels_AVX2;
+		return true;
+	}
+#else
+	(void)p_use_best;
+#endif
+	
+	gEidosSIMDKernels = gEidosSIMDKernels_baseline;
+	return false;
+}
+
+void Eidos_SIMD_Initialize(void)
+{
+	(void)Eidos_SIMD_SelectKernels(true);
+}
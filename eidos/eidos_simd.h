@@ -0,0 +1,89 @@
+//
+//  eidos_simd.h
+//  Eidos
+//
+//  Created by agent on 10/18/2026.
+//  Copyright (c) 2015-2020 Philipp Messer.  All rights reserved.
+//	A product of the Messer Lab, http://messerlab.org/slim/
+//
+
+//	This file is part of Eidos.
+//
+//	Eidos is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License as published by
+//	the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+//
+//	Eidos is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+//	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more details.
+//
+//	You should have received a copy of the GNU General Public License along with Eidos.  If not, see <http://www.gnu.org/licenses/>.
+
+/*
+
+ These are kernels for elementwise math and reductions over the raw buffers of integer and float vectors, used by
+ Eidos functions like sum(), mean(), sqrt(), pmax(), and pmin() when they are given long vectors.  On x86-64, each
+ kernel is built both for the baseline instruction set (SSE2) and for AVX2, and Eidos_SIMD_Initialize() selects the
+ AVX2 kernels at runtime if the CPU supports them.  On other platforms the baseline kernels are used; they are
+ written so that the compiler can vectorize them for the target (with NEON on ARM, for example).
+
+ Every kernel produces exactly the same results as the scalar code it replaces, whatever the instruction set, so
+ a model's output does not depend on the machine it runs on.  The integer sum has the overflow semantics of a
+ sequential sum done with Eidos_add_overflow(): each block of values is summed with vector instructions only when its
+ values are small enough that no partial sum within the block could overflow, and is otherwise summed sequentially
+ with overflow checks.  There is no float sum kernel, since summing in vector lanes changes the order of the
+ additions, and thus the roundoff; sum() and mean() on float vectors still sum sequentially, as they always have.
+
+ */
+
+#ifndef __Eidos__eidos_simd__
+#define __Eidos__eidos_simd__
+
+#include <cstdint>
+
+
+typedef struct {
+	const char *name_;
+	
+	bool (*sum_int_)(const int64_t *p_data, int64_t p_count, int64_t *p_int_sum, double *p_float_sum);
+	void (*sqrt_float_)(const double *p_x, double *p_result, int64_t p_count);
+	
+	void (*max_int_)(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count);
+	void (*min_int_)(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count);
+	void (*max_int_singleton_)(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count);
+	void (*min_int_singleton_)(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count);
+	void (*max_float_)(const double *p_x, const double *p_y, double *p_result, int64_t p_count);
+	void (*min_float_)(const double *p_x, const double *p_y, double *p_result, int64_t p_count);
+	void (*max_float_singleton_)(const double *p_x, double p_y, double *p_result, int64_t p_count);
+	void (*min_float_singleton_)(const double *p_x, double p_y, double *p_result, int64_t p_count);
+} EidosSIMDKernels;
+
+// The kernels in use; set up by Eidos_SIMD_Initialize(), which is called by Eidos_WarmUp()
+extern EidosSIMDKernels gEidosSIMDKernels;
+
+void Eidos_SIMD_Initialize(void);
+
+// Selects the baseline kernels (p_use_best == false) or the best kernels the CPU supports (p_use_best == true); the
+// results are the same either way, so this exists so that the self-tests can check that all kernels agree.  Returns
+// true if the selected kernels differ from the baseline kernels, false if the baseline kernels are the best available.
+bool Eidos_SIMD_SelectKernels(bool p_use_best);
+
+
+// Sums the values, returning true if the sum fits in an integer, in which case it is placed in *p_int_sum; in either case,
+// *p_float_sum receives the sum computed in float (with integer accumulation as long as possible, to minimize roundoff)
+inline __attribute__((always_inline)) bool Eidos_SIMD_SumInt(const int64_t *p_data, int64_t p_count, int64_t *p_int_sum, double *p_float_sum) { return gEidosSIMDKernels.sum_int_(p_data, p_count, p_int_sum, p_float_sum); }
+
+// Elementwise sqrt(); p_result may be the same buffer as p_x
+inline __attribute__((always_inline)) void Eidos_SIMD_SqrtFloat(const double *p_x, double *p_result, int64_t p_count) { gEidosSIMDKernels.sqrt_float_(p_x, p_result, p_count); }
+
+// Elementwise std::max() and std::min(), with the same semantics as those functions for NAN; the overloads taking a
+// single y value compare it against every x value
+inline __attribute__((always_inline)) void Eidos_SIMD_MaxInt(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count) { gEidosSIMDKernels.max_int_(p_x, p_y, p_result, p_count); }
+inline __attribute__((always_inline)) void Eidos_SIMD_MinInt(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count) { gEidosSIMDKernels.min_int_(p_x, p_y, p_result, p_count); }
+inline __attribute__((always_inline)) void Eidos_SIMD_MaxInt(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count) { gEidosSIMDKernels.max_int_singleton_(p_x, p_y, p_result, p_count); }
+inline __attribute__((always_inline)) void Eidos_SIMD_MinInt(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count) { gEidosSIMDKernels.min_int_singleton_(p_x, p_y, p_result, p_count); }
+inline __attribute__((always_inline)) void Eidos_SIMD_MaxFloat(const double *p_x, const double *p_y, double *p_result, int64_t p_count) { gEidosSIMDKernels.max_float_(p_x, p_y, p_result, p_count); }
+inline __attribute__((always_inline)) void Eidos_SIMD_MinFloat(const double *p_x, const double *p_y, double *p_result, int64_t p_count) { gEidosSIMDKernels.min_float_(p_x, p_y, p_result, p_count); }
+inline __attribute__((always_inline)) void Eidos_SIMD_MaxFloat(const double *p_x, double p_y, double *p_result, int64_t p_count) { gEidosSIMDKernels.max_float_singleton_(p_x, p_y, p_result, p_count); }
+inline __attribute__((always_inline)) void Eidos_SIMD_MinFloat(const double *p_x, double p_y, double *p_result, int64_t p_count) { gEidosSIMDKernels.min_float_singleton_(p_x, p_y, p_result, p_count); }
+
+
+#endif /* defined(__Eidos__eidos_simd__) */
@@ -342,6 +342,57 @@ EidosValue *EidosSymbolTable::_GetValue_RAW(EidosGlobalStringID p_symbol_name, c
 	EIDOS_TERMINATION << "ERROR (EidosSymbolTable::_GetValue_RAW): undefined identifier " << Eidos_StringForGlobalStringID(p_symbol_name) << "." << EidosTerminate(p_symbol_token);
 }
 
+EidosValue *EidosSymbolTable::GetValueRawOrNullForSymbol(EidosGlobalStringID p_symbol_name) const
+{
+	// This follows _GetValue_RAW() but returns nullptr instead of raising for an undefined symbol
+	const EidosSymbolTable *current_table = this;
+	
+	do
+	{
+		// try the current table, if the symbol is within its capacity
+		if (p_symbol_name < current_table->capacity_)
+		{
+			EidosValue *slot_value = current_table->slots_[p_symbol_name].symbol_value_SP_.get();
+			
+			if (slot_value)
+				return slot_value;
+		}
+		
+		// We didn't get a hit, so try our chained table
+		current_table = current_table->chain_symbol_table_;
+	}
+	while (current_table);
+	
+	return nullptr;
+}
+
+EidosValue *EidosSymbolTable::GetValueRawOrNullForSymbol_TableType(EidosGlobalStringID p_symbol_name, EidosSymbolTableType *p_table_type) const
+{
+	// This follows GetValueRawOrNullForSymbol() but provides the type of the table defining the symbol
+	const EidosSymbolTable *current_table = this;
+	
+	do
+	{
+		// try the current table, if the symbol is within its capacity
+		if (p_symbol_name < current_table->capacity_)
+		{
+			EidosValue *slot_value = current_table->slots_[p_symbol_name].symbol_value_SP_.get();
+			
+			if (slot_value)
+			{
+				*p_table_type = current_table->table_type_;
+				return slot_value;
+			}
+		}
+		
+		// We didn't get a hit, so try our chained table
+		current_table = current_table->chain_symbol_table_;
+	}
+	while (current_table);
+	
+	return nullptr;
+}
+
 EidosValue_SP EidosSymbolTable::_GetValue_IsConst(EidosGlobalStringID p_symbol_name, const EidosToken *p_symbol_token, bool *p_is_const) const
 {
 	// This follows _GetValue() but provides the p_is_const flag
@@ -388,10 +439,10 @@ void EidosSymbolTable::_ResizeToFitSymbol(EidosGlobalStringID p_symbol_name)
 
 void EidosSymbolTable::SetValueForSymbol(EidosGlobalStringID p_symbol_name, EidosValue_SP p_value)
 {
-	// If we have the only reference to the value, we don't need to copy it; otherwise we copy, since we don't want to hold
-	// onto a reference that somebody else might modify under us (or that we might modify under them, with syntaxes like
-	// x[2]=...; and x=x+1;). If the value is invisible then we copy it, since the symbol table never stores invisible values.
-	if ((p_value->UseCount() != 1) || p_value->Invisible())
+	// A singleton that somebody else references is copied, since singletons are cheap to copy and are modified in place by
+	// code such as for loops.  Vectors are shared copy-on-write instead; see EidosInterpreter::_ProcessSubsetAssignment().
+	// If the value is invisible then we copy it, since the symbol table never stores invisible values.
+	if (p_value->Invisible() || ((p_value->UseCount() != 1) && p_value->IsSingleton()))
 		p_value = p_value->CopyValues();
 	
 	// Make sure we have capacity
@@ -498,10 +549,8 @@ void EidosSymbolTable::DefineConstantForSymbol(EidosGlobalStringID p_symbol_name
 				patchTable->chain_symbol_table_ = definedConstantsTable;
 	}
 	
-	// If we have the only reference to the value, we don't need to copy it; otherwise we copy, since we don't want to hold
-	// onto a reference that somebody else might modify under us (or that we might modify under them, with syntaxes like
-	// x[2]=...; and x=x+1;). If the value is invisible then we copy it, since the symbol table never stores invisible values.
-	if ((p_value->UseCount() != 1) || p_value->Invisible())
+	// Copy shared singletons and invisible values, as SetValueForSymbol() does
+	if (p_value->Invisible() || ((p_value->UseCount() != 1) && p_value->IsSingleton()))
 		p_value = p_value->CopyValues();
 	
 	// Then ask the defined constants table to add the constant
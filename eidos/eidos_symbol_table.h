@@ -174,6 +174,10 @@ public:
 	inline __attribute__((always_inline)) EidosValue *GetValueRawOrRaiseForASTNode(const EidosASTNode *p_symbol_node) const { return _GetValue_RAW(p_symbol_node->cached_stringID_, p_symbol_node->token_); }
 	inline __attribute__((always_inline)) EidosValue *GetValueRawOrRaiseForSymbol(EidosGlobalStringID p_symbol_name) const { return _GetValue_RAW(p_symbol_name, nullptr); }
 	
+	// Get a raw EidosValue * as above, but return nullptr for an undefined symbol rather than raising; used by EidosBytecode
+	EidosValue *GetValueRawOrNullForSymbol(EidosGlobalStringID p_symbol_name) const;
+	EidosValue *GetValueRawOrNullForSymbol_TableType(EidosGlobalStringID p_symbol_name, EidosSymbolTableType *p_table_type) const;	// also returns the type of the defining table
+	
 	// Special getters that return a boolean flag, true if the fetched symbol is a constant
 	inline __attribute__((always_inline)) EidosValue_SP GetValueOrRaiseForASTNode_IsConst(const EidosASTNode *p_symbol_node, bool *p_is_const) const { return _GetValue_IsConst(p_symbol_node->cached_stringID_, p_symbol_node->token_, p_is_const); }
 	inline __attribute__((always_inline)) EidosValue_SP GetValueOrRaiseForSymbol_IsConst(EidosGlobalStringID p_symbol_name, bool *p_is_const) const { return _GetValue_IsConst(p_symbol_name, nullptr, p_is_const); }
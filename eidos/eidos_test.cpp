@@ -25,6 +25,7 @@
 #include "eidos_globals.h"
 #include "eidos_rng.h"
 #include "eidos_test_element.h"
+#include "eidos_simd.h"
 
 #include <iostream>
 #include <string>
@@ -248,6 +249,7 @@ static void _RunOperatorLogicalAndTests(void);
 static void _RunOperatorLogicalOrTests(void);
 static void _RunOperatorLogicalNotTests(void);
 static void _RunOperatorTernaryConditionalTests(void);
+static void _RunCompiledExpressionTests(void);
 static void _RunKeywordIfTests(void);
 static void _RunKeywordDoTests(void);
 static void _RunKeywordWhileTests(void);
@@ -260,6 +262,7 @@ static void _RunFunctionMathTests_g_through_r(void);
 static void _RunFunctionMathTests_setUnionIntersection(void);
 static void _RunFunctionMathTests_setDifferenceSymmetricDifference(void);
 static void _RunFunctionMathTests_s_through_z(void);
+static void _RunFunctionMathTests_SIMD(void);
 static void _RunFunctionMatrixArrayTests(void);
 static void _RunFunctionStatisticsTests(void);
 static void _RunFunctionDistributionTests(void);
@@ -336,6 +339,7 @@ int RunEidosTests(void)
 	_RunOperatorLogicalOrTests();
 	_RunOperatorLogicalNotTests();
 	_RunOperatorTernaryConditionalTests();
+	_RunCompiledExpressionTests();
 	_RunKeywordIfTests();
 	_RunKeywordDoTests();
 	_RunKeywordWhileTests();
@@ -348,6 +352,7 @@ int RunEidosTests(void)
 	_RunFunctionMathTests_setUnionIntersection();
 	_RunFunctionMathTests_setDifferenceSymmetricDifference();
 	_RunFunctionMathTests_s_through_z();
+	_RunFunctionMathTests_SIMD();
 	_RunFunctionMatrixArrayTests();
 	_RunFunctionStatisticsTests();
 	_RunFunctionDistributionTests();
@@ -1374,6 +1379,9 @@ void _RunLiteralsIdentifiersAndTokenizationTests(void)
 	EidosAssertScriptRaise("defineConstant('Q', 7); Q = Q / 2.0;", 26, "is a constant");
 	EidosAssertScriptRaise("defineConstant('Q', 7); for (Q in c(3, 4)) 5;", 29, "is a constant");
 	EidosAssertScriptRaise("defineConstant('Q', 7); for (Q in c(3.0, 4.0)) 5;", 29, "is a constant");
+	EidosAssertScriptRaise("defineConstant('Q', 1:3); Q[0] = 3;", 31, "is a constant");
+	EidosAssertScriptRaise("x = 1:3; defineConstant('Q', x); Q[0] = 3;", 38, "is a constant");
+	EidosAssertScriptSuccess("x = 1:3; defineConstant('Q', x); x[0] = 5; c(x, Q);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{5, 2, 3, 1, 2, 3}));
 }
 
 #pragma mark symbol table
@@ -1403,6 +1411,21 @@ void _RunSymbolsAndVariablesTests(void)
 	EidosAssertScriptSuccess("x = 1:5; y = x; y[1] = 0; x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 2, 3, 4, 5}));
 	EidosAssertScriptSuccess("x = 1:5; y = x; y[1] = 0; y;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 0, 3, 4, 5}));
 	EidosAssertScriptSuccess("for (i in 1:3) { x = 1:5; x[1] = x[1] + 1; } x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 3, 3, 4, 5}));
+	
+	// vectors are shared between variables copy-on-write; check that modifying one never modifies another
+	EidosAssertScriptSuccess("x = 1.0:5; y = x; y[1] = 0.5; c(x, y);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{1, 2, 3, 4, 5, 1, 0.5, 3, 4, 5}));
+	EidosAssertScriptSuccess("x = 1:5; y = x; z = y; z[0] = 0; y[4] = 0; c(x, y, z);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 2, 3, 4, 5, 1, 2, 3, 4, 0, 0, 2, 3, 4, 5}));
+	EidosAssertScriptSuccess("x = 1:5; y = x; y = y * 2; c(x, y);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 2, 3, 4, 5, 2, 4, 6, 8, 10}));
+	EidosAssertScriptSuccess("x = 1.0:5; y = x; x = x - 1.0; c(x, y);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{0, 1, 2, 3, 4, 1, 2, 3, 4, 5}));
+	EidosAssertScriptSuccess("function (i)f(i x) { x[0] = 0; x = x + 1; return x; } x = 1:5; c(f(x), x);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 3, 4, 5, 6, 1, 2, 3, 4, 5}));
+	
+	// long runs of consecutive indices produce slices that share their source's buffer; check that neither can modify the other
+	EidosAssertScriptSuccess("x = 1:100; s = x[10:89]; s[0] = 0; c(size(s), s[0:1], x[10:11]);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{80, 0, 12, 11, 12}));
+	EidosAssertScriptSuccess("x = 1:100; s = x[10:89]; x[10] = 0; x = x + 1; c(s[0:1], x[10:11]);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{11, 12, 1, 13}));
+	EidosAssertScriptSuccess("x = 1.0:100; s = x[10:89]; s = s + 0.5; t = s[0:69]; t[1] = 0.0; c(s[0:1], t[0:1], x[10:11]);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{11.5, 12.5, 11.5, 0, 11, 12}));
+	EidosAssertScriptSuccess("x = 1:100; s = x[99:0]; t = x[20:99]; t = sort(t, F); c(s[0], t[0], x[20]);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{100, 100, 21}));
+	EidosAssertScriptSuccess("x = matrix(1:100, nrow=10); s = x[0:79]; c(size(dim(s)), size(s), sum(s));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{0, 80, 3240}));
+	EidosAssertScriptRaise("x = 1:100; x[50:100];", 12, "out-of-range index");
 }
 
 #pragma mark parsing
@@ -1958,7 +1981,7 @@ void _RunOperatorPlusTests2(void)
 	EidosAssertScriptRaise("identical(array(1:6,c(1,2,3)) + array(1:6,c(3,2,1)), array(2:7, c(1,2,3)));", 30, "non-conformable");
 }
 
-#pragma mark operator −
+#pragma mark operator -
 void _RunOperatorMinusTests(void)
 {
 	// operator -
@@ -3582,6 +3605,51 @@ void _RunOperatorTernaryConditionalTests(void)
 	// test right-associativity; this produces 2 if ? else is left-associative since the left half would then evaluate to 1, which is T
 	EidosAssertScriptSuccess("a = 0; a == 0 ? 1 else a == 1 ? 2 else 4;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(1)));
 }
+
+#pragma mark compiled expressions
+void _RunCompiledExpressionTests(void)
+{
+	// scalar expressions are compiled to bytecode (see eidos_bytecode.h), falling back to the tree walker for anything it can't handle
+	EidosAssertScriptSuccess("x = 3; y = 2.5; x * y + 1.0;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(8.5)));
+	EidosAssertScriptSuccess("x = 3; y = 4; x * y - 2;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(10)));
+	EidosAssertScriptSuccess("x = 7; y = 2; x / y + x % y;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(4.5)));
+	EidosAssertScriptSuccess("x = 3; y = 2; -x ^ y + 1;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(10)));
+	EidosAssertScriptSuccess("x = 3; y = 2.5; (x > y) & !(x == 3.0) | (y <= 2);", gStaticEidosValue_LogicalF);
+	EidosAssertScriptSuccess("x = 3; y = 2.5; (x > y) & (x != y) & (T == 1);", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = 0.25; x < 0.5 ? 1.0 + exp(-x) else sqrt(x) * 2;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(1.0 + exp(-0.25))));
+	EidosAssertScriptSuccess("x = 4; x < 0.5 ? 1.0 + exp(-x) else sqrt(x) * 2;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(4.0)));
+	EidosAssertScriptSuccess("x = 4; y = x < 5 ? 1 else 2.0; y + log(1) * 2;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(1.0)));
+	EidosAssertScriptSuccess("x = 1:3; y = 2; x * y + 1;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{3, 5, 7}));
+	EidosAssertScriptSuccess("x = matrix(2); y = 3; identical(x * y + 1, matrix(7));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = 'a'; y = 2; x + y + 1;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton("a21")));
+	EidosAssertScriptRaise("x = 9223372036854775807; y = 1; x + y * 1;", 34, "addition overflow");
+	EidosAssertScriptRaise("x = 1; x * y + 1;", 11, "undefined identifier");
+	EidosAssertScriptRaise("x = T; x * 2 + 1;", 9, "operand type logical is not supported");
+	EidosAssertScriptRaise("x = T; x - z - 1;", 9, "operand type logical is not supported");
+	EidosAssertScriptRaise("x = T; exp(x) + 1 * 2;", 7, "cannot be type logical");
+	EidosAssertScriptRaise("x = NAN; y = 1; (y + 1 > 0) & x;", 28, "cannot be converted");
+	
+	// singleton temporaries are reused for results by the tree walker's arithmetic operators; variables and constants must never be modified
+	EidosAssertScriptSuccess("x = c(2.0, 3.0); y = x[0] * 3.0 + x[1] * 4.0 - x[0] / 2; c(x, y);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{2.0, 3.0, 17.0}));
+	EidosAssertScriptSuccess("x = c(2, 3); y = -x[0] * 3 + x[1] * 4 - x[0]; c(x, y);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{2, 3, 4}));
+	EidosAssertScriptSuccess("function (f)f(f x) { return x * 2.0; } a = 1.5; b = f(a) + f(a) * 2.0; c(a, b);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{1.5, 9.0}));
+	EidosAssertScriptSuccess("x = 0; for (i in 1:3) x = x + abs(i) * 2 - sum(i); x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(6)));
+	EidosAssertScriptSuccess("x = matrix(2.0); y = c(1.5)[0] * x + 1; identical(y, matrix(4.0));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("s = 0; for (i in 1:100) { x = (i <= 50) ? c(i, i) else i; s = s + sum(x * 2 + 1); } s;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(12800)));
+	
+	// pure expressions are folded (see EidosFold); values over literals are computed at parse time, values over defined constants are
+	// cached while those constants are unchanged, and loop-invariant values are cached for one execution of their for loop
+	EidosAssertScriptSuccess("x = 2 * 3 + sqrt(16.0); y = 2 * 3 + sqrt(16.0); x[0] = 1.0; c(x, y);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{1.0, 10.0}));
+	EidosAssertScriptSuccess("x = T ? 5 else undefinedIdentifier; y = F ? undefinedIdentifier else 6; if (1 > 2) z = undefinedIdentifier; else z = 7; c(x, y, z);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{5, 6, 7}));
+	EidosAssertScriptSuccess("function (i)g(void) { return K * 2 + size(c(K, K)); } defineConstant('K', 5); a = g(); b = g(); rm('K', T); defineConstant('K', 7); c(a, b, g());", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{12, 12, 16}));
+	EidosAssertScriptSuccess("s = 0; for (j in 1:3) { a = j; for (i in 1:2) s = s + a * 10 + i; } s;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(129)));
+	EidosAssertScriptSuccess("a = 1; s = 0; for (i in 1:3) { s = s + a * 2; a = a + 1; } s;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(12)));
+	EidosAssertScriptSuccess("a = 1; s = 0; for (i in 1:3) { s = s + a * 2; executeLambda('a = a + 1;'); } s;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(12)));
+	EidosAssertScriptSuccess("function (i)f(i n) { s = 0; for (i in 1:2) { s = s + n * 2; if ((n > 0) & (i == 1)) s = s + f(n - 1); } return s; } f(2);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(12)));
+	EidosAssertScriptSuccess("x = 0; if (x == 1) y = sum(rep(1.0, 1e12)); s = 0; for (i in 1:3) s = s + sum(repEach(2, 5)) + size(rep(1, 200000)); s;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(600030)));
+	EidosAssertScriptRaise("x = 9223372036854775807 + 1;", 24, "addition overflow");
+	EidosAssertScriptRaise("x = 5; for (i in 1:2) y = 9223372036854775807 + x;", 46, "addition overflow");
+}
 	
 	// ************************************************************************************
 	//
@@ -4880,6 +4948,41 @@ void _RunFunctionMathTests_s_through_z(void)
 	EidosAssertScriptSuccess("identical(trunc(matrix(c(0.1, 5.7, -0.3))), matrix(trunc(c(0.1, 5.7, -0.3))));", gStaticEidosValue_LogicalT);
 }
 
+void _RunFunctionMathTests_SIMD(void)
+{
+	// These tests run with each set of SIMD kernels available, since all of them must produce the same results as the scalar code
+	for (int kernel_set = 0; kernel_set < 2; ++kernel_set)
+	{
+		if (!Eidos_SIMD_SelectKernels(kernel_set == 1) && (kernel_set == 1))
+			break;
+		
+		// sum() and mean() with integer overflow, with enough values to be summed in multiple blocks
+		EidosAssertScriptSuccess("sum(rep(3, 5000));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(15000)));
+		EidosAssertScriptSuccess("sum(c(asInteger(2^62), rep(1, 5000)));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(4611686018427392904LL)));
+		EidosAssertScriptSuccess("sum(c(asInteger(2^62), rep(-1, 5000)));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(4611686018427382904LL)));
+		EidosAssertScriptSuccess("sum(c(rep(1, 2048), rep(asInteger(2^62), 3), rep(-asInteger(2^62), 3)));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(2048.0)));
+		EidosAssertScriptSuccess("sum(c(rep(-asInteger(2^62), 2), rep(-1, 3000)));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(-9223372036854778808.0)));
+		EidosAssertScriptSuccess("mean(c(rep(1, 2048), rep(asInteger(2^62), 3), rep(-asInteger(2^62), 3)));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(2048.0 / 2054)));
+		EidosAssertScriptSuccess("mean(c(rep(2, 3000), rep(4, 3000)));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(3.0)));
+		
+		// sqrt() is correctly rounded, so vectorized results must match singleton results exactly
+		EidosAssertScriptSuccess("x = runif(1001, 0, 100); identical(sqrt(x), sapply(x, 'sqrt(applyValue);'));", gStaticEidosValue_LogicalT);
+		EidosAssertScriptSuccess("x = 0:1000; identical(sqrt(x), sapply(x, 'sqrt(applyValue);'));", gStaticEidosValue_LogicalT);
+		EidosAssertScriptSuccess("x = sqrt(c(0.0, 4.0, -1.0, INF, NAN)); identical(x[c(0,1,3)], c(0.0, 2.0, INF)) & all(isNAN(x[c(2,4)]));", gStaticEidosValue_LogicalT);
+		
+		// pmax() and pmin() must follow std::max() and std::min() in their handling of NAN
+		EidosAssertScriptSuccess("x = 1:2001; y = 2001:1; identical(pmax(x, y), sapply(0:2000, 'max(x[applyValue], y[applyValue]);'));", gStaticEidosValue_LogicalT);
+		EidosAssertScriptSuccess("x = 1:2001; y = 2001:1; identical(pmin(x, y), sapply(0:2000, 'min(x[applyValue], y[applyValue]);'));", gStaticEidosValue_LogicalT);
+		EidosAssertScriptSuccess("x = 1:2001; identical(pmax(x, 1000), c(rep(1000, 999), 1000:2001)) & identical(pmin(1000, x), c(1:999, rep(1000, 1002)));", gStaticEidosValue_LogicalT);
+		EidosAssertScriptSuccess("x = runif(1001); y = runif(1001); identical(pmax(x, y), ifelse(x < y, y, x)) & identical(pmin(x, y), ifelse(y < x, y, x));", gStaticEidosValue_LogicalT);
+		EidosAssertScriptSuccess("x = pmax(c(1.0, NAN, 3.0, NAN), c(NAN, 2.0, 1.0, NAN)); x[0] == 1.0 & x[2] == 3.0 & all(isNAN(x[c(1,3)]));", gStaticEidosValue_LogicalT);
+		EidosAssertScriptSuccess("x = pmin(c(1.0, NAN, 3.0, NAN), c(NAN, 2.0, 1.0, NAN)); x[0] == 1.0 & x[2] == 1.0 & all(isNAN(x[c(1,3)]));", gStaticEidosValue_LogicalT);
+		EidosAssertScriptSuccess("x = pmax(c(1.0, NAN, 3.0), 2.0); x[0] == 2.0 & isNAN(x[1]) & x[2] == 3.0;", gStaticEidosValue_LogicalT);
+	}
+	
+	Eidos_SIMD_Initialize();
+}
+
 #pragma mark statistics
 void _RunFunctionStatisticsTests(void)
 {
@@ -6267,6 +6370,15 @@ void _RunFunctionValueInspectionManipulationTests_m_through_r(void)
 	EidosAssertScriptSuccess("match(c(_Test(0), _Test(1)), c(_Test(0), _Test(1)));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{-1, -1}));	// different elements
 	EidosAssertScriptSuccess("x1 = _Test(1); x2 = _Test(2); x9 = _Test(9); x5 = _Test(5); match(c(x1,x2,x2,x9,x5,x1), c(x5,x1,x9));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, -1, -1, 2, 0, 1}));
 	
+	// large vectors are matched with a hash table, which must give the same results as scanning, including for duplicates, NAN, and -0.0
+	EidosAssertScriptSuccess("x = rdunif(2000, -100, 100); t = rdunif(500, -100, 100); identical(match(x, t), sapply(x, 'w = which(t == applyValue); size(w) ? w[0] else -1;'));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rdunif(2000, -100, 100); t = rdunif(500, -100, 100); identical(match(x / 2, t / 2), match(x, t));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rdunif(2000, -100, 100); t = rdunif(500, -100, 100); identical(match(asString(x), asString(t)), match(x, t));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("identical(match(c(NAN, 0.0, -0.0, 5.0, rep(1.0, 40)), c(rep(2.0, 40), NAN, -0.0, 1.0, 0.0)), c(-1, 41, 41, -1, rep(42, 40)));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("identical(match(c(T, F, rep(T, 40)), c(rep(F, 40), T, F)), c(40, 0, rep(40, 40)));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("identical(match(rep(T, 40), rep(F, 40)), rep(-1, 40));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = sapply(0:49, '_Test(applyValue);'); t = c(x[25:49], x[0:24], x); identical(match(c(x, _Test(3)), t), c(25:49, 0:24, -1));", gStaticEidosValue_LogicalT);
+	
 	// nchar()
 	EidosAssertScriptRaise("nchar(NULL);", 0, "cannot be type");
 	EidosAssertScriptRaise("nchar(T);", 0, "cannot be type");
@@ -6299,6 +6411,18 @@ void _RunFunctionValueInspectionManipulationTests_m_through_r(void)
 	EidosAssertScriptSuccess("order(c('a', 'q', 'm', 'f', 'w'));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{0, 3, 2, 1, 4}));
 	EidosAssertScriptRaise("order(_Test(7));", 0, "cannot be type");
 	
+	// large integer and float vectors are ordered with a radix sort; the sort is stable, in both directions
+	EidosAssertScriptSuccess("x = rdunif(5000, -1000, 1000); o = order(x); all(x[o][0:4998] <= x[o][1:4999]);", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rdunif(5000, -1000, 1000); o = order(x, F); all(x[o][0:4998] >= x[o][1:4999]);", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rdunif(5000, -10, 10); o = order(x); identical(o, order(x * 1.0));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rdunif(5000, -10, 10); o = order(x); all(sapply(-10:10, 't = o[x[o] == applyValue]; identical(t, sort(t));'));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rdunif(5000, -10, 10); o = order(x, F); all(sapply(-10:10, 't = o[x[o] == applyValue]; identical(t, sort(t));'));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = c(runif(1000, -1, 1), 0.0, -0.0, INF, -INF, 1.0e300, -1.0e-300); identical(x[order(x)], sort(x)) & identical(x[order(x, F)], sort(x, F));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = c(9223372036854775807, -9223372036854775807 - 1, rdunif(1000, -1000, 1000)); identical(x[order(x)], sort(x)) & identical(x[order(x, F)], sort(x, F));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("identical(order(c(rep(-0.0, 300), rep(0.0, 300))), 0:599);", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("identical(order(c(2, 1, 2, 1, 2)), c(1, 3, 0, 2, 4));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("identical(order(c(2, 1, 2, 1, 2), F), c(0, 2, 4, 1, 3));", gStaticEidosValue_LogicalT);
+	
 	// paste()
 	EidosAssertScriptSuccess("paste(NULL);", gStaticEidosValue_StringEmpty);
 	EidosAssertScriptSuccess("paste(T);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton("T")));
@@ -6392,6 +6516,10 @@ void _RunFunctionValueInspectionManipulationTests_s_through_z(void)
 	EidosAssertScriptSuccess("sort(c(6.1, 19.3, -3.7, 5.2, 2.3));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{-3.7, 2.3, 5.2, 6.1, 19.3}));
 	EidosAssertScriptSuccess("sort(c('a', 'q', 'm', 'f', 'w'));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_vector{"a", "f", "m", "q", "w"}));
 	EidosAssertScriptRaise("sort(_Test(7));", 0, "cannot be type");
+	EidosAssertScriptSuccess("x = rdunif(5000, -1000, 1000); s = sort(x); all(s[0:4998] <= s[1:4999]) & identical(sort(x, F), rev(s));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = runif(5000, -1000, 1000); s = sort(x); all(s[0:4998] <= s[1:4999]) & identical(sort(x, F), rev(s));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = c(9223372036854775807, -9223372036854775807 - 1, rdunif(1000, -1000, 1000)); s = sort(x); s[0] == -9223372036854775807 - 1 & s[1001] == 9223372036854775807;", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = c(INF, -INF, runif(1000, -1, 1), -1.0e-300, 1.0e-300); s = sort(x); all(s[0:1002] <= s[1:1003]) & s[0] == -INF & s[1003] == INF;", gStaticEidosValue_LogicalT);
 	
 	// sortBy()
 	EidosAssertScriptRaise("sortBy(NULL);", 0, "missing required argument");
@@ -6527,6 +6655,13 @@ void _RunFunctionValueInspectionManipulationTests_s_through_z(void)
 	
 	EidosAssertScriptSuccess("x = asInteger(runif(10000, 0, 10000)); size(unique(x)) == size(unique(x, F));", gStaticEidosValue_LogicalT);
 	EidosAssertScriptSuccess("x = runif(10000, 0, 1); size(unique(x)) == size(unique(x, F));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rdunif(10000, 0, 1000); identical(unique(x), x[sort(match(unique(x), x))]);", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rdunif(10000, 0, 1000); identical(sort(unique(x)), unique(x, F));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rdunif(10000, 0, 1000); identical(unique(asString(x)), asString(unique(x)));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rdunif(10000, 0, 1000) / 4; identical(unique(x), x[sort(match(unique(x), x))]);", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("size(unique(c(NAN, 1.0, NAN, rep(2.0, 50), NAN)));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(5)));
+	EidosAssertScriptSuccess("x = unique(c(-0.0, rep(0.0, 40))); size(x) == 1 & 1 / x == -INF;", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = sapply(0:49, '_Test(applyValue);'); identical(unique(c(x, x, rev(x)))._yolk, 0:49);", gStaticEidosValue_LogicalT);
 	
 	// which()
 	EidosAssertScriptRaise("which(NULL);", 0, "cannot be type");
@@ -7653,6 +7788,12 @@ void _RunUserDefinedFunctionTests(void)
 	EidosAssertScriptRaise("function (i)plus(i x) { foo(); x = x + 1; return x; } function (void)foo(void) { defineConstant('x', 10); } plus(5); x; ", 108, "identifier 'x' is already defined");
 	EidosAssertScriptRaise("x = 3; function (i)plus(i y) { foo(); y = y + 1; return y; } function (void)foo(void) { defineConstant('x', 10); } plus(5); x; ", 115, "identifier 'x' is already defined");
 	
+	// Arguments are moved into the function's frame, but values referenced by the caller must not be modified in place
+	EidosAssertScriptSuccess("function (i)bump(i x) { x[0] = 10; x = x + 1; return x; } y = 1:3; z = bump(y); identical(y, 1:3) & identical(z, c(11, 3, 4));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("function (i)bump(i x) { x[0] = 10; x = x + 1; return x; } y = 1:3; z = doCall('bump', y); identical(y, 1:3) & identical(z, c(11, 3, 4));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("function (i)bump(i x) { x = x + 1; return x; } s = 0; for (i in 1:100) s = s + bump(i * 2); c(s, i);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{10200, 100}));
+	EidosAssertScriptSuccess("function (i)bump([i x = 5]) { x = x + 1; return x; } c(bump(), bump(), bump(2));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{6, 6, 3}));
+	
 	// Mutual recursion with lambdas
 	
 	
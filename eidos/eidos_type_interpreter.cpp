@@ -439,10 +439,11 @@ EidosTypeSpecifier EidosTypeInterpreter::TypeEvaluate_Call(const EidosASTNode *p
 		const EidosFunctionSignature *function_signature = call_name_node->cached_signature_.get();
 		
 		// If the function call is a built-in Eidos function, we might already have a pointer to its signature cached; if not, we'll have to look it up
-		if (!function_signature)
+		// We use the string ID cached by _OptimizeIdentifiers(), rather than looking up the (possibly half-typed) name, which would register it
+		if (!function_signature && (call_name_node->cached_stringID_ != gEidosID_none))
 		{
 			// Get the function signature
-			auto signature_iter = function_map_.find(*function_name);
+			auto signature_iter = function_map_.find(call_name_node->cached_stringID_);
 			
 			if (signature_iter != function_map_.end())
 				function_signature = signature_iter->second.get();
@@ -1081,7 +1082,7 @@ EidosTypeSpecifier EidosTypeInterpreter::TypeEvaluate_FunctionDecl(const EidosAS
 			//std::cout << *sig << std::endl;
 			
 			// Check that a built-in function is not already defined with this name; no replacing the built-ins.
-			auto signature_iter = function_map_.find(function_name);
+			auto signature_iter = function_map_.find(sig->call_id_);
 			bool can_redefine = true;
 			
 			if (signature_iter != function_map_.end())
@@ -1095,12 +1096,10 @@ EidosTypeSpecifier EidosTypeInterpreter::TypeEvaluate_FunctionDecl(const EidosAS
 			if (can_redefine)
 			{
 				// Add the user-defined function to our function map (possibly replacing a previous version)
-				auto found_iter = function_map_.find(sig->call_name_);
+				if (signature_iter != function_map_.end())
+					function_map_.erase(signature_iter);
 				
-				if (found_iter != function_map_.end())
-					function_map_.erase(found_iter);
-				
-				function_map_.insert(EidosFunctionMapPair(sig->call_name_, EidosFunctionSignature_CSP(sig)));
+				function_map_.insert(EidosFunctionMapPair(sig->call_id_, EidosFunctionSignature_CSP(sig)));
 			}
 			else
 			{
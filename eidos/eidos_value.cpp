@@ -390,6 +390,11 @@ void EidosValue::RaiseForRangeViolation(void) const
 	EIDOS_TERMINATION << "ERROR (EidosValue::RaiseForRangeViolation): (internal error) access violated the current size of an EidosValue." << EidosTerminate(nullptr);
 }
 
+void EidosValue::RaiseForSliceViolation(void) const
+{
+	EIDOS_TERMINATION << "ERROR (EidosValue::RaiseForSliceViolation): (internal error) modification of an EidosValue slice without detaching it." << EidosTerminate(nullptr);
+}
+
 EidosValue_SP EidosValue::VectorBasedCopy(void) const
 {
 	return CopyValues();
@@ -1461,6 +1466,30 @@ EidosValue_Int_vector::EidosValue_Int_vector(const int64_t *p_values, size_t p_c
 		set_int_no_check(p_values[index], index);
 }
 
+EidosValue_Int_vector::EidosValue_Int_vector(const EidosValue_SP &p_source, size_t p_start, size_t p_count) : EidosValue_Int(false)
+{
+	// A slice refers to a contiguous range of p_source's values rather than copying them.  Our reference to the value that owns
+	// the buffer (never to an intermediate slice) makes it shared, so it is copied before any in-place modification; see the
+	// copy-on-write comment in EidosInterpreter::_ProcessSubsetAssignment().
+	const EidosValue_Int_vector *source = p_source->IntVector();
+	
+	slice_source_ = (source->slice_source_ ? source->slice_source_ : p_source);
+	values_ = source->values_ + p_start;
+	count_ = p_count;
+	capacity_ = p_count;
+}
+
+void EidosValue_Int_vector::DetachSlice(void)
+{
+	int64_t *values = (int64_t *)malloc(count_ * sizeof(int64_t));
+	
+	memcpy(values, values_, count_ * sizeof(int64_t));
+	
+	values_ = values;
+	capacity_ = count_;
+	slice_source_.reset();
+}
+
 int EidosValue_Int_vector::Count_Virtual(void) const
 {
 	return (int)count_;
@@ -1516,6 +1545,9 @@ void EidosValue_Int_vector::SetValueAtIndex(const int p_idx, const EidosValue &p
 	if ((p_idx < 0) || (p_idx >= (int)size()))
 		EIDOS_TERMINATION << "ERROR (EidosValue_Int_vector::SetValueAtIndex): subscript " << p_idx << " out of range." << EidosTerminate(p_blame_token);
 	
+	if (slice_source_)
+		DetachSlice();
+	
 	values_[p_idx] = p_value.IntAtIndex(0, p_blame_token);
 }
 
@@ -1534,14 +1566,17 @@ void EidosValue_Int_vector::PushValueFromIndexOfEidosValue(int p_idx, const Eido
 
 void EidosValue_Int_vector::Sort(bool p_ascending)
 {
-	if (p_ascending)
-		std::sort(values_, values_ + count_);
-	else
-		std::sort(values_, values_ + count_, std::greater<int64_t>());
+	if (slice_source_)
+		DetachSlice();
+	
+	EidosSortValues(values_, count_, p_ascending);
 }
 
 EidosValue_Int_vector *EidosValue_Int_vector::reserve(size_t p_reserved_size)
 {
+	if (slice_source_)
+		DetachSlice();
+	
 	if (p_reserved_size > capacity_)
 	{
 		values_ = (int64_t *)realloc(values_, p_reserved_size * sizeof(int64_t));
@@ -1572,6 +1607,9 @@ void EidosValue_Int_vector::erase_index(size_t p_index)
 	if (p_index >= count_)
 		RaiseForRangeViolation();
 	
+	if (slice_source_)
+		DetachSlice();
+	
 	if (p_index == count_ - 1)
 		--count_;
 	else
@@ -1730,6 +1768,28 @@ EidosValue_Float_vector::EidosValue_Float_vector(const double *p_values, size_t
 		set_float_no_check(p_values[index], index);
 }
 
+EidosValue_Float_vector::EidosValue_Float_vector(const EidosValue_SP &p_source, size_t p_start, size_t p_count) : EidosValue_Float(false)
+{
+	// A slice of p_source's values, as for EidosValue_Int_vector
+	const EidosValue_Float_vector *source = p_source->FloatVector();
+	
+	slice_source_ = (source->slice_source_ ? source->slice_source_ : p_source);
+	values_ = source->values_ + p_start;
+	count_ = p_count;
+	capacity_ = p_count;
+}
+
+void EidosValue_Float_vector::DetachSlice(void)
+{
+	double *values = (double *)malloc(count_ * sizeof(double));
+	
+	memcpy(values, values_, count_ * sizeof(double));
+	
+	values_ = values;
+	capacity_ = count_;
+	slice_source_.reset();
+}
+
 int EidosValue_Float_vector::Count_Virtual(void) const
 {
 	return (int)count_;
@@ -1796,6 +1856,9 @@ void EidosValue_Float_vector::SetValueAtIndex(const int p_idx, const EidosValue
 	if ((p_idx < 0) || (p_idx >= (int)size()))
 		EIDOS_TERMINATION << "ERROR (EidosValue_Float_vector::SetValueAtIndex): subscript " << p_idx << " out of range." << EidosTerminate(p_blame_token);
 	
+	if (slice_source_)
+		DetachSlice();
+	
 	values_[p_idx] = p_value.FloatAtIndex(0, p_blame_token);
 }
 
@@ -1814,14 +1877,17 @@ void EidosValue_Float_vector::PushValueFromIndexOfEidosValue(int p_idx, const Ei
 
 void EidosValue_Float_vector::Sort(bool p_ascending)
 {
-	if (p_ascending)
-		std::sort(values_, values_ + count_);
-	else
-		std::sort(values_, values_ + count_, std::greater<double>());
+	if (slice_source_)
+		DetachSlice();
+	
+	EidosSortValues(values_, count_, p_ascending);
 }
 
 EidosValue_Float_vector *EidosValue_Float_vector::reserve(size_t p_reserved_size)
 {
+	if (slice_source_)
+		DetachSlice();
+	
 	if (p_reserved_size > capacity_)
 	{
 		values_ = (double *)realloc(values_, p_reserved_size * sizeof(double));
@@ -1852,6 +1918,9 @@ void EidosValue_Float_vector::erase_index(size_t p_index)
 	if (p_index >= count_)
 		RaiseForRangeViolation();
 	
+	if (slice_source_)
+		DetachSlice();
+	
 	if (p_index == count_ - 1)
 		--count_;
 	else
@@ -200,6 +200,7 @@ public:
 	void RaiseForUnsupportedConversionCall(const EidosToken *p_blame_token) const __attribute__((__noreturn__)) __attribute__((analyzer_noreturn));
 	void RaiseForCapacityViolation(void) const __attribute__((__noreturn__)) __attribute__((analyzer_noreturn));
 	void RaiseForRangeViolation(void) const __attribute__((__noreturn__)) __attribute__((analyzer_noreturn));
+	void RaiseForSliceViolation(void) const __attribute__((__noreturn__)) __attribute__((analyzer_noreturn));
 	
 	virtual const EidosValue_Logical *LogicalVector(void) const { RaiseForUnimplementedVectorCall(); }
 	virtual EidosValue_Logical *LogicalVector_Mutable(void) { RaiseForUnimplementedVectorCall(); }
@@ -648,6 +649,9 @@ class EidosValue_Int_vector : public EidosValue_Int
 protected:
 	int64_t *values_ = nullptr;
 	size_t count_ = 0, capacity_ = 0;
+	EidosValue_SP slice_source_;		// non-null for a zero-copy slice, which does not own values_; they point into this value's buffer
+	
+	void DetachSlice(void);				// gives a slice a buffer of its own, before it is modified
 	
 public:
 	EidosValue_Int_vector(const EidosValue_Int_vector &p_original) = delete;	// no copy-construct
@@ -660,12 +664,13 @@ public:
 	//explicit EidosValue_Int_vector(int64_t p_int1);		// disabled to encourage use of EidosValue_Int_singleton for this case
 	explicit EidosValue_Int_vector(std::initializer_list<int64_t> p_init_list);
 	explicit EidosValue_Int_vector(const int64_t *p_values, size_t p_count);
-	inline virtual ~EidosValue_Int_vector(void) { free(values_); }
+	explicit EidosValue_Int_vector(const EidosValue_SP &p_source, size_t p_start, size_t p_count);	// a zero-copy slice of an EidosValue_Int_vector
+	inline virtual ~EidosValue_Int_vector(void) { if (!slice_source_) free(values_); }
 	
 	virtual int Count_Virtual(void) const;
 	
 	virtual const EidosValue_Int_vector *IntVector(void) const { return this; }
-	virtual EidosValue_Int_vector *IntVector_Mutable(void) { return this; }
+	virtual EidosValue_Int_vector *IntVector_Mutable(void) { if (slice_source_) DetachSlice(); return this; }
 	
 	virtual eidos_logical_t LogicalAtIndex(int p_idx, const EidosToken *p_blame_token) const;
 	virtual std::string StringAtIndex(int p_idx, const EidosToken *p_blame_token) const;
@@ -686,7 +691,7 @@ public:
 	void expand(void);													// expand to fit (at least) one new value
 	void erase_index(size_t p_index);									// a weak substitute for erase()
 	
-	inline __attribute__((always_inline)) int64_t *data(void) { return values_; }
+	inline __attribute__((always_inline)) int64_t *data(void) { if (slice_source_) DetachSlice(); return values_; }
 	inline __attribute__((always_inline)) const int64_t *data(void) const { return values_; }
 	inline __attribute__((always_inline)) size_t size(void) const { return count_; }
 	inline __attribute__((always_inline)) void push_int(int64_t p_int)
@@ -705,6 +710,7 @@ public:
 #if DEBUG
 		// do checks only in DEBUG mode, for speed; the user should never be able to trigger these errors
 		if (p_index >= count_) RaiseForRangeViolation();
+		if (slice_source_) RaiseForSliceViolation();
 #endif
 		values_[p_index] = p_int;
 	}
@@ -786,6 +792,9 @@ class EidosValue_Float_vector : public EidosValue_Float
 protected:
 	double *values_ = nullptr;
 	size_t count_ = 0, capacity_ = 0;
+	EidosValue_SP slice_source_;		// non-null for a zero-copy slice, which does not own values_; they point into this value's buffer
+	
+	void DetachSlice(void);				// gives a slice a buffer of its own, before it is modified
 	
 public:
 	EidosValue_Float_vector(const EidosValue_Float_vector &p_original) = delete;	// no copy-construct
@@ -796,12 +805,13 @@ public:
 	//explicit EidosValue_Float_vector(double p_float1);		// disabled to encourage use of EidosValue_Float_singleton for this case
 	explicit EidosValue_Float_vector(std::initializer_list<double> p_init_list);
 	explicit EidosValue_Float_vector(const double *p_values, size_t p_count);
-	inline virtual ~EidosValue_Float_vector(void) { free(values_); }
+	explicit EidosValue_Float_vector(const EidosValue_SP &p_source, size_t p_start, size_t p_count);	// a zero-copy slice of an EidosValue_Float_vector
+	inline virtual ~EidosValue_Float_vector(void) { if (!slice_source_) free(values_); }
 	
 	virtual int Count_Virtual(void) const;
 	
 	virtual const EidosValue_Float_vector *FloatVector(void) const { return this; }
-	virtual EidosValue_Float_vector *FloatVector_Mutable(void) { return this; }
+	virtual EidosValue_Float_vector *FloatVector_Mutable(void) { if (slice_source_) DetachSlice(); return this; }
 	
 	virtual eidos_logical_t LogicalAtIndex(int p_idx, const EidosToken *p_blame_token) const;
 	virtual std::string StringAtIndex(int p_idx, const EidosToken *p_blame_token) const;
@@ -822,7 +832,7 @@ public:
 	void expand(void);													// expand to fit (at least) one new value
 	void erase_index(size_t p_index);									// a weak substitute for erase()
 	
-	inline __attribute__((always_inline)) double *data(void) { return values_; }
+	inline __attribute__((always_inline)) double *data(void) { if (slice_source_) DetachSlice(); return values_; }
 	inline __attribute__((always_inline)) const double *data(void) const { return values_; }
 	inline __attribute__((always_inline)) size_t size(void) const { return count_; }
 	inline __attribute__((always_inline)) void push_float(double p_float)
@@ -841,6 +851,7 @@ public:
 #if DEBUG
 		// do checks only in DEBUG mode, for speed; the user should never be able to trigger these errors
 		if (p_index >= count_) RaiseForRangeViolation();
+		if (slice_source_) RaiseForSliceViolation();
 #endif
 		values_[p_index] = p_float;
 	}